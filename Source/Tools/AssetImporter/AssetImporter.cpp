@@ -75,6 +75,13 @@ struct OutModel
     unsigned totalIndices_{};
 };
 
+struct TriangleCluster
+{
+    unsigned start_{};
+    unsigned count_{};
+    float sortKey_{};
+};
+
 struct OutScene
 {
     String outName_;
@@ -135,6 +142,10 @@ const char *transformSuffix[TransformationComp_MAXIMUM] =
 };
 
 static const unsigned MAX_CHANNELS = 4;
+static const unsigned VERTEX_CACHE_SIZE = 16;
+static const float OVERDRAW_THRESHOLD = 1.05f;
+/// Largest absolute texture coordinate stored as half float. Beyond 16 the half float step is 1/64 or coarser.
+static const float HALF_TEXCOORD_LIMIT = 16.0f;
 
 SharedPtr<Context> context_(new Context());
 const aiScene* scene_ = nullptr;
@@ -163,6 +174,8 @@ bool noOverwriteTexture_ = false;
 bool noOverwriteNewerTexture_ = false;
 bool checkUniqueModel_ = true;
 bool moveToBindPose_ = false;
+bool optimizeMeshes_ = false;
+bool compactVertices_ = false;
 unsigned maxBones_ = 64;
 Vector<String> nonSkinningBoneIncludes_;
 Vector<String> nonSkinningBoneExcludes_;
@@ -174,6 +187,8 @@ float defaultTicksPerSecond_ = 4800.0f;
 // For subset animation import usage
 float importStartTime_ = 0.0f;
 float importEndTime_ = 0.0f;
+bool compressAnimations_ = false;
+float animationTolerance_ = 0.0f;
 bool suppressFbxPivotNodes_ = true;
 
 int main(int argc, char** argv);
@@ -218,10 +233,21 @@ unsigned GetNumValidFaces(aiMesh* mesh);
 
 void WriteShortIndices(unsigned short*& dest, aiMesh* mesh, unsigned index, unsigned offset);
 void WriteLargeIndices(unsigned*& dest, aiMesh* mesh, unsigned index, unsigned offset);
-void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, BoundingBox& box,
+void OptimizeMesh(aiMesh* mesh, const Matrix3x4& vertexTransform, PODVector<unsigned>& indices, PODVector<unsigned>& vertexOrder);
+float GetVertexCacheScore(int cachePosition, unsigned remainingTriangles);
+void OptimizeVertexCache(PODVector<unsigned>& indices, unsigned numVertices);
+unsigned UpdateVertexCache(PODVector<unsigned>& timestamps, unsigned& time, const unsigned* triangle);
+bool CompareTriangleClusters(const TriangleCluster& lhs, const TriangleCluster& rhs);
+void OptimizeOverdraw(PODVector<unsigned>& indices, const PODVector<Vector3>& positions);
+void OptimizeVertexFetch(PODVector<unsigned>& indices, unsigned numVertices, PODVector<unsigned>& vertexOrder);
+float GetACMR(const PODVector<unsigned>& indices, unsigned numVertices);
+unsigned short FloatToHalfRounded(float value);
+bool CanUseHalfTexCoords(aiMesh* mesh, unsigned channel);
+void WriteNormalized(float*& dest, const Vector3& value, float w);
+void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, unsigned halfTexCoords, BoundingBox& box,
     const Matrix3x4& vertexTransform, const Matrix3& normalTransform, Vector<PODVector<unsigned char> >& blendIndices,
     Vector<PODVector<float> >& blendWeights);
-PODVector<VertexElement> GetVertexElements(aiMesh* mesh, bool isSkinned);
+PODVector<VertexElement> GetVertexElements(aiMesh* mesh, bool isSkinned, bool compact);
 
 aiNode* GetNode(const String& name, aiNode* rootNode, bool caseSensitive = true);
 aiMatrix4x4 GetDerivedTransform(aiNode* node, aiNode* rootNode, bool rootInclusive = true);
@@ -290,6 +316,9 @@ void Run(const Vector<String>& arguments)
             "-p <path>   Set path for scene resources. Default is output file path\n"
             "-r <name>   Use the named scene node as root node\n"
             "-f <freq>   Animation tick frequency to use if unspecified. Default 4800\n"
+            "-ac <x>     Save animations in the compressed format. Keyframes are removed while\n"
+            "            the interpolation error stays within the tolerance, given in units\n"
+            "            for position and scale, and in radians for rotation\n"
             "-o          Optimize redundant submeshes. Loses scene hierarchy and animations\n"
             "-s <filter> Include non-skinning bones in the model's skeleton. Can be given a\n"
             "            case-insensitive semicolon separated filter list. Bone is included\n"
@@ -303,6 +332,11 @@ void Run(const Vector<String>& arguments)
             "-ctn        Check and do not overwrite if texture has newer timestamp\n"
             "-am         Export all meshes even if identical (scene mode only)\n"
             "-bp         Move bones to bind pose before saving model\n"
+            "-om         Optimize geometry triangle and vertex order for the vertex cache,\n"
+            "            overdraw and vertex fetch\n"
+            "-cv         Use compact vertex formats: half float texture coordinates, 16-bit\n"
+            "            normals and tangents, 8-bit blend weights. Texture coordinates\n"
+            "            beyond +-16 are kept as floats\n"
             "-split <start> <end> (animation model only)\n"
             "            Split animation, will only import from start frame to end frame\n"
             "-np         Do not suppress $fbx pivot nodes (FBX files only)\n"
@@ -427,6 +461,12 @@ void Run(const Vector<String>& arguments)
                 defaultTicksPerSecond_ = ToFloat(value);
                 ++i;
             }
+            else if (argument == "ac" && !value.Empty())
+            {
+                compressAnimations_ = true;
+                animationTolerance_ = Max(ToFloat(value), 0.0f);
+                ++i;
+            }
             else if (argument == "s")
             {
                 includeNonSkinningBones_ = true;
@@ -456,6 +496,10 @@ void Run(const Vector<String>& arguments)
                 checkUniqueModel_ = false;
             else if (argument == "bp")
                 moveToBindPose_ = true;
+            else if (argument == "om")
+                optimizeMeshes_ = true;
+            else if (argument == "cv")
+                compactVertices_ = true;
             else if (argument == "split")
             {
                 String value2 = i + 2 < arguments.Size() ? arguments[i + 2] : String::EMPTY;
@@ -1007,13 +1051,13 @@ void BuildAndSaveModel(OutModel& model)
 
     bool combineBuffers = true;
     // Check if buffers can be combined (same vertex elements, under 65535 vertices)
-    PODVector<VertexElement> elements = GetVertexElements(model.meshes_[0], model.bones_.Size() > 0);
+    PODVector<VertexElement> elements = GetVertexElements(model.meshes_[0], model.bones_.Size() > 0, compactVertices_);
     for (unsigned i = 0; i < model.meshes_.Size(); ++i)
     {
         if (GetNumValidFaces(model.meshes_[i]))
         {
             ++numValidGeometries;
-            if (i > 0 && GetVertexElements(model.meshes_[i], model.bones_.Size() > 0) != elements)
+            if (i > 0 && GetVertexElements(model.meshes_[i], model.bones_.Size() > 0, compactVertices_) != elements)
                 combineBuffers = false;
         }
     }
@@ -1048,7 +1092,7 @@ void BuildAndSaveModel(OutModel& model)
     for (unsigned i = 0; i < model.meshes_.Size(); ++i)
     {
         aiMesh* mesh = model.meshes_[i];
-        PODVector<VertexElement> elements = GetVertexElements(mesh, isSkinned);
+        PODVector<VertexElement> elements = GetVertexElements(mesh, isSkinned, compactVertices_);
         unsigned validFaces = GetNumValidFaces(mesh);
         if (!validFaces)
             continue;
@@ -1095,6 +1139,25 @@ void BuildAndSaveModel(OutModel& model)
 
         PrintLine("Writing geometry " + String(i) + " with " + String(mesh->mNumVertices) + " vertices " +
             String(validFaces * 3) + " indices");
+        // Texture coordinate channels that are stored as half floats, as a bitmask
+        unsigned halfTexCoords = 0;
+        for (unsigned j = 0; j < elements.Size(); ++j)
+        {
+            if (elements[j].semantic_ == SEM_TEXCOORD && elements[j].type_ == TYPE_HALF2)
+                halfTexCoords |= 1u << elements[j].index_;
+        }
+
+        if (compactVertices_)
+        {
+            PrintLine("Vertex size " + String(VertexBuffer::GetVertexSize(GetVertexElements(mesh, isSkinned, false))) + " -> " +
+                String(VertexBuffer::GetVertexSize(elements)) + " bytes");
+            for (unsigned j = 0; j < mesh->GetNumUVChannels() && j < MAX_CHANNELS; ++j)
+            {
+                if (!(halfTexCoords & (1u << j)))
+                    PrintLine("Texture coordinates " + String(j) + " exceed the half float range of +-" + String(HALF_TEXCOORD_LIMIT) +
+                        ", keeping them as floats");
+            }
+        }
 
         if (model.bones_.Size() > 0 && !mesh->HasBones())
             PrintLine("Warning: model has bones but geometry " + String(i) + " has no skinning information");
@@ -1103,7 +1166,25 @@ void BuildAndSaveModel(OutModel& model)
         unsigned char* indexData = ib->GetShadowData();
 
         // Build the index data
-        if (!largeIndices)
+        PODVector<unsigned> optimizedIndices;
+        PODVector<unsigned> vertexOrder;
+        if (optimizeMeshes_)
+        {
+            OptimizeMesh(mesh, vertexTransform, optimizedIndices, vertexOrder);
+            if (!largeIndices)
+            {
+                unsigned short* dest = (unsigned short*)indexData + startIndexOffset;
+                for (unsigned j = 0; j < optimizedIndices.Size(); ++j)
+                    *dest++ = (unsigned short)(optimizedIndices[j] + startVertexOffset);
+            }
+            else
+            {
+                unsigned* dest = (unsigned*)indexData + startIndexOffset;
+                for (unsigned j = 0; j < optimizedIndices.Size(); ++j)
+                    *dest++ = optimizedIndices[j] + startVertexOffset;
+            }
+        }
+        else if (!largeIndices)
         {
             unsigned short* dest = (unsigned short*)indexData + startIndexOffset;
             for (unsigned j = 0; j < mesh->mNumFaces; ++j)
@@ -1126,7 +1207,10 @@ void BuildAndSaveModel(OutModel& model)
 
         auto* dest = (float*)((unsigned char*)vertexData + startVertexOffset * vb->GetVertexSize());
         for (unsigned j = 0; j < mesh->mNumVertices; ++j)
-            WriteVertex(dest, mesh, j, isSkinned, box, vertexTransform, normalTransform, blendIndices, blendWeights);
+        {
+            WriteVertex(dest, mesh, vertexOrder.Empty() ? j : vertexOrder[j], isSkinned, halfTexCoords, box, vertexTransform,
+                normalTransform, blendIndices, blendWeights);
+        }
 
         // Calculate the geometry center
         Vector3 center = Vector3::ZERO;
@@ -1479,6 +1563,9 @@ void BuildAndSaveAnimations(OutModel* model)
             }
         }
 
+        if (compressAnimations_)
+            outAnim->Compress(animationTolerance_, animationTolerance_, animationTolerance_);
+
         File outFile(context_);
         if (!outFile.Open(animOutName, FILE_WRITE))
             ErrorExit("Could not open output file " + animOutName);
@@ -2422,7 +2509,369 @@ void WriteLargeIndices(unsigned*& dest, aiMesh* mesh, unsigned index, unsigned o
     }
 }
 
-void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, BoundingBox& box,
+void OptimizeMesh(aiMesh* mesh, const Matrix3x4& vertexTransform, PODVector<unsigned>& indices, PODVector<unsigned>& vertexOrder)
+{
+    indices.Clear();
+    for (unsigned i = 0; i < mesh->mNumFaces; ++i)
+    {
+        if (mesh->mFaces[i].mNumIndices == 3)
+        {
+            indices.Push(mesh->mFaces[i].mIndices[0]);
+            indices.Push(mesh->mFaces[i].mIndices[1]);
+            indices.Push(mesh->mFaces[i].mIndices[2]);
+        }
+    }
+
+    PODVector<Vector3> positions(mesh->mNumVertices);
+    for (unsigned i = 0; i < mesh->mNumVertices; ++i)
+        positions[i] = vertexTransform * ToVector3(mesh->mVertices[i]);
+
+    float oldACMR = GetACMR(indices, mesh->mNumVertices);
+    OptimizeVertexCache(indices, mesh->mNumVertices);
+    OptimizeOverdraw(indices, positions);
+    OptimizeVertexFetch(indices, mesh->mNumVertices, vertexOrder);
+    float newACMR = GetACMR(indices, mesh->mNumVertices);
+
+    PrintLine("Optimized geometry, ACMR " + String(oldACMR) + " -> " + String(newACMR) + " with " +
+        String(VERTEX_CACHE_SIZE) + " entry cache");
+}
+
+float GetVertexCacheScore(int cachePosition, unsigned remainingTriangles)
+{
+    if (!remainingTriangles)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // The vertices of the last triangle get a fixed score, so that the next triangle does not prefer them
+        if (cachePosition < 3)
+            score = 0.75f;
+        else
+            score = powf(1.0f - (float)(cachePosition - 3) / (float)(VERTEX_CACHE_SIZE - 3), 1.5f);
+    }
+
+    // Boost vertices with few triangles left, so that no lone triangles are left behind
+    return score + 2.0f / sqrtf((float)remainingTriangles);
+}
+
+void OptimizeVertexCache(PODVector<unsigned>& indices, unsigned numVertices)
+{
+    // Reorder the triangles for the post-transform vertex cache with Tom Forsyth's linear-speed algorithm
+    const unsigned numTriangles = indices.Size() / 3;
+    if (numTriangles < 2)
+        return;
+
+    // Build the triangle adjacency of each vertex. The used part of each vertex's list shrinks as its triangles are output
+    PODVector<unsigned> triangleOffsets(numVertices + 1, 0);
+    PODVector<unsigned> remainingTriangles(numVertices, 0);
+    for (unsigned i = 0; i < indices.Size(); ++i)
+        ++remainingTriangles[indices[i]];
+    for (unsigned i = 0; i < numVertices; ++i)
+        triangleOffsets[i + 1] = triangleOffsets[i] + remainingTriangles[i];
+    PODVector<unsigned> adjacentTriangles(indices.Size());
+    PODVector<unsigned> fillCounts(numVertices, 0);
+    for (unsigned i = 0; i < indices.Size(); ++i)
+    {
+        unsigned vertex = indices[i];
+        adjacentTriangles[triangleOffsets[vertex] + fillCounts[vertex]++] = i / 3;
+    }
+
+    PODVector<int> cachePositions(numVertices, -1);
+    PODVector<float> vertexScores(numVertices);
+    for (unsigned i = 0; i < numVertices; ++i)
+        vertexScores[i] = GetVertexCacheScore(-1, remainingTriangles[i]);
+
+    PODVector<bool> triangleAdded(numTriangles, false);
+    int bestTriangle = 0;
+    float bestScore = 0.0f;
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        float score = vertexScores[indices[i * 3]] + vertexScores[indices[i * 3 + 1]] + vertexScores[indices[i * 3 + 2]];
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestTriangle = i;
+        }
+    }
+
+    PODVector<unsigned> newIndices;
+    newIndices.Reserve(indices.Size());
+    unsigned cache[VERTEX_CACHE_SIZE + 3];
+    unsigned newCache[VERTEX_CACHE_SIZE + 3];
+    unsigned cacheSize = 0;
+    unsigned nextTriangle = 0;
+
+    while (newIndices.Size() < indices.Size())
+    {
+        // When no triangle uses the cached vertices, continue from the first triangle not yet added
+        if (bestTriangle < 0)
+        {
+            while (triangleAdded[nextTriangle])
+                ++nextTriangle;
+            bestTriangle = nextTriangle;
+        }
+
+        const unsigned* triangle = &indices[bestTriangle * 3];
+        triangleAdded[bestTriangle] = true;
+
+        unsigned newCacheSize = 0;
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            unsigned vertex = triangle[i];
+            newIndices.Push(vertex);
+            newCache[newCacheSize++] = vertex;
+
+            // Remove the triangle from the vertex's remaining triangles
+            unsigned* begin = &adjacentTriangles[triangleOffsets[vertex]];
+            unsigned* end = begin + remainingTriangles[vertex];
+            for (unsigned* j = begin; j < end; ++j)
+            {
+                if (*j == (unsigned)bestTriangle)
+                {
+                    *j = *(end - 1);
+                    break;
+                }
+            }
+            --remainingTriangles[vertex];
+        }
+
+        // The triangle's vertices move to the front of the cache, pushing the others back
+        for (unsigned i = 0; i < cacheSize; ++i)
+        {
+            unsigned vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                newCache[newCacheSize++] = vertex;
+        }
+
+        // Update the scores of the vertices in the cache and those that fell out, then find the best triangle using them
+        for (unsigned i = 0; i < newCacheSize; ++i)
+        {
+            unsigned vertex = newCache[i];
+            cachePositions[vertex] = i < VERTEX_CACHE_SIZE ? (int)i : -1;
+            vertexScores[vertex] = GetVertexCacheScore(cachePositions[vertex], remainingTriangles[vertex]);
+        }
+
+        bestTriangle = -1;
+        bestScore = 0.0f;
+        for (unsigned i = 0; i < newCacheSize; ++i)
+        {
+            unsigned vertex = newCache[i];
+            const unsigned* begin = &adjacentTriangles[triangleOffsets[vertex]];
+            const unsigned* end = begin + remainingTriangles[vertex];
+            for (const unsigned* j = begin; j < end; ++j)
+            {
+                unsigned t = *j;
+                float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        cacheSize = Min(newCacheSize, VERTEX_CACHE_SIZE);
+        for (unsigned i = 0; i < cacheSize; ++i)
+            cache[i] = newCache[i];
+    }
+
+    // The scoring models an LRU cache, so on some meshes the original order can be better for a FIFO cache
+    if (GetACMR(newIndices, numVertices) < GetACMR(indices, numVertices))
+        indices = newIndices;
+}
+
+unsigned UpdateVertexCache(PODVector<unsigned>& timestamps, unsigned& time, const unsigned* triangle)
+{
+    // Simulate a FIFO vertex cache with timestamps, return the number of misses caused by the triangle
+    unsigned misses = 0;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        if (time - timestamps[triangle[i]] > VERTEX_CACHE_SIZE)
+        {
+            timestamps[triangle[i]] = time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+bool CompareTriangleClusters(const TriangleCluster& lhs, const TriangleCluster& rhs)
+{
+    return lhs.sortKey_ > rhs.sortKey_;
+}
+
+void OptimizeOverdraw(PODVector<unsigned>& indices, const PODVector<Vector3>& positions)
+{
+    // Split the cache-optimized triangles into clusters and draw the outward-facing clusters first, so that they occlude the
+    // rest (Sander et al, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"). The clusters are split so that
+    // their ACMR stays within the threshold of the unsplit order
+    const unsigned numTriangles = indices.Size() / 3;
+    if (numTriangles < 2)
+        return;
+
+    PODVector<unsigned> timestamps(positions.Size(), 0);
+    unsigned time = VERTEX_CACHE_SIZE + 1;
+
+    // Hard boundaries: triangles that miss the cache with all vertices, where the cache optimization started a new area
+    PODVector<unsigned> hardBoundaries;
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        if (UpdateVertexCache(timestamps, time, &indices[i * 3]) == 3 || i == 0)
+            hardBoundaries.Push(i);
+    }
+    hardBoundaries.Push(numTriangles);
+
+    // Soft boundaries: split the hard clusters further whenever the ACMR of the split part is within the threshold
+    Vector<TriangleCluster> clusters;
+    for (unsigned i = 0; i + 1 < hardBoundaries.Size(); ++i)
+    {
+        unsigned start = hardBoundaries[i];
+        unsigned end = hardBoundaries[i + 1];
+
+        time += VERTEX_CACHE_SIZE + 1;
+        unsigned clusterMisses = 0;
+        for (unsigned j = start; j < end; ++j)
+            clusterMisses += UpdateVertexCache(timestamps, time, &indices[j * 3]);
+        float threshold = OVERDRAW_THRESHOLD * (float)clusterMisses / (float)(end - start);
+
+        time += VERTEX_CACHE_SIZE + 1;
+        unsigned clusterStart = start;
+        unsigned misses = 0;
+        for (unsigned j = start; j < end; ++j)
+        {
+            misses += UpdateVertexCache(timestamps, time, &indices[j * 3]);
+            if (j + 1 == end || (float)misses / (float)(j + 1 - clusterStart) <= threshold)
+            {
+                TriangleCluster cluster;
+                cluster.start_ = clusterStart * 3;
+                cluster.count_ = (j + 1 - clusterStart) * 3;
+                clusters.Push(cluster);
+
+                clusterStart = j + 1;
+                misses = 0;
+                time += VERTEX_CACHE_SIZE + 1;
+            }
+        }
+    }
+
+    if (clusters.Size() < 2)
+        return;
+
+    Vector3 meshCenter = Vector3::ZERO;
+    for (unsigned i = 0; i < indices.Size(); ++i)
+        meshCenter += positions[indices[i]];
+    meshCenter /= (float)indices.Size();
+
+    for (unsigned i = 0; i < clusters.Size(); ++i)
+    {
+        TriangleCluster& cluster = clusters[i];
+        Vector3 center = Vector3::ZERO;
+        Vector3 normal = Vector3::ZERO;
+        float area = 0.0f;
+        for (unsigned j = cluster.start_; j < cluster.start_ + cluster.count_; j += 3)
+        {
+            const Vector3& v0 = positions[indices[j]];
+            const Vector3& v1 = positions[indices[j + 1]];
+            const Vector3& v2 = positions[indices[j + 2]];
+            Vector3 triangleNormal = (v1 - v0).CrossProduct(v2 - v0);
+            float triangleArea = triangleNormal.Length();
+            center += (v0 + v1 + v2) * (triangleArea / 3.0f);
+            normal += triangleNormal;
+            area += triangleArea;
+        }
+
+        if (area > 0.0f)
+            center /= area;
+        cluster.sortKey_ = (center - meshCenter).DotProduct(normal.Normalized());
+    }
+
+    Sort(clusters.Begin(), clusters.End(), CompareTriangleClusters);
+
+    PODVector<unsigned> newIndices;
+    newIndices.Reserve(indices.Size());
+    for (unsigned i = 0; i < clusters.Size(); ++i)
+        newIndices.Push(PODVector<unsigned>(&indices[clusters[i].start_], clusters[i].count_));
+
+    // The clusters lose the cache hits between them when reordered. Keep the cache-optimized order if this exceeds the threshold
+    if (GetACMR(newIndices, positions.Size()) <= OVERDRAW_THRESHOLD * GetACMR(indices, positions.Size()))
+        indices = newIndices;
+}
+
+void OptimizeVertexFetch(PODVector<unsigned>& indices, unsigned numVertices, PODVector<unsigned>& vertexOrder)
+{
+    // Number the vertices in the order of first use, so that the vertex fetch reads memory mostly linearly.
+    // Unused vertices go last to keep the vertex count
+    PODVector<unsigned> remap(numVertices, M_MAX_UNSIGNED);
+    vertexOrder.Clear();
+    vertexOrder.Reserve(numVertices);
+
+    for (unsigned i = 0; i < indices.Size(); ++i)
+    {
+        unsigned& newIndex = remap[indices[i]];
+        if (newIndex == M_MAX_UNSIGNED)
+        {
+            newIndex = vertexOrder.Size();
+            vertexOrder.Push(indices[i]);
+        }
+        indices[i] = newIndex;
+    }
+
+    for (unsigned i = 0; i < numVertices; ++i)
+    {
+        if (remap[i] == M_MAX_UNSIGNED)
+            vertexOrder.Push(i);
+    }
+}
+
+float GetACMR(const PODVector<unsigned>& indices, unsigned numVertices)
+{
+    const unsigned numTriangles = indices.Size() / 3;
+    if (!numTriangles)
+        return 0.0f;
+
+    PODVector<unsigned> timestamps(numVertices, 0);
+    unsigned time = VERTEX_CACHE_SIZE + 1;
+    unsigned misses = 0;
+    for (unsigned i = 0; i < numTriangles; ++i)
+        misses += UpdateVertexCache(timestamps, time, &indices[i * 3]);
+
+    return (float)misses / (float)numTriangles;
+}
+
+unsigned short FloatToHalfRounded(float value)
+{
+    // FloatToHalf() truncates the mantissa, check whether the next half float is nearer
+    unsigned short half = FloatToHalf(value);
+    auto next = (unsigned short)(half + 1);
+    if ((next & 0x7c00u) != 0x7c00u && Abs(HalfToFloat(next) - value) < Abs(HalfToFloat(half) - value))
+        return next;
+    return half;
+}
+
+bool CanUseHalfTexCoords(aiMesh* mesh, unsigned channel)
+{
+    for (unsigned i = 0; i < mesh->mNumVertices; ++i)
+    {
+        const aiVector3D& texCoord = mesh->mTextureCoords[channel][i];
+        if (Abs(texCoord.x) > HALF_TEXCOORD_LIMIT || Abs(texCoord.y) > HALF_TEXCOORD_LIMIT)
+            return false;
+    }
+
+    return true;
+}
+
+void WriteNormalized(float*& dest, const Vector3& value, float w)
+{
+    auto* destShorts = (short*)dest;
+    destShorts[0] = (short)RoundToInt(Clamp(value.x_, -1.0f, 1.0f) * 32767.0f);
+    destShorts[1] = (short)RoundToInt(Clamp(value.y_, -1.0f, 1.0f) * 32767.0f);
+    destShorts[2] = (short)RoundToInt(Clamp(value.z_, -1.0f, 1.0f) * 32767.0f);
+    destShorts[3] = (short)RoundToInt(Clamp(w, -1.0f, 1.0f) * 32767.0f);
+    dest += 2;
+}
+
+void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, unsigned halfTexCoords, BoundingBox& box,
     const Matrix3x4& vertexTransform, const Matrix3& normalTransform, Vector<PODVector<unsigned char> >& blendIndices,
     Vector<PODVector<float> >& blendWeights)
 {
@@ -2435,9 +2884,14 @@ void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, Bou
     if (mesh->HasNormals())
     {
         Vector3 normal = normalTransform * ToVector3(mesh->mNormals[index]);
-        *dest++ = normal.x_;
-        *dest++ = normal.y_;
-        *dest++ = normal.z_;
+        if (compactVertices_)
+            WriteNormalized(dest, normal.Normalized(), 0.0f);
+        else
+        {
+            *dest++ = normal.x_;
+            *dest++ = normal.y_;
+            *dest++ = normal.z_;
+        }
     }
 
     for (unsigned i = 0; i < mesh->GetNumColorChannels() && i < MAX_CHANNELS; ++i)
@@ -2450,8 +2904,18 @@ void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, Bou
     for (unsigned i = 0; i < mesh->GetNumUVChannels() && i < MAX_CHANNELS; ++i)
     {
         Vector3 texCoord = ToVector3(mesh->mTextureCoords[i][index]);
-        *dest++ = texCoord.x_;
-        *dest++ = texCoord.y_;
+        if (halfTexCoords & (1u << i))
+        {
+            auto* destShorts = (unsigned short*)dest;
+            destShorts[0] = FloatToHalfRounded(texCoord.x_);
+            destShorts[1] = FloatToHalfRounded(texCoord.y_);
+            ++dest;
+        }
+        else
+        {
+            *dest++ = texCoord.x_;
+            *dest++ = texCoord.y_;
+        }
     }
 
     if (mesh->HasTangentsAndBitangents())
@@ -2464,20 +2928,47 @@ void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, Bou
         if ((tangent.CrossProduct(normal)).DotProduct(bitangent) < 0.5f)
             w = -1.0f;
 
-        *dest++ = tangent.x_;
-        *dest++ = tangent.y_;
-        *dest++ = tangent.z_;
-        *dest++ = w;
+        if (compactVertices_)
+            WriteNormalized(dest, tangent.Normalized(), w);
+        else
+        {
+            *dest++ = tangent.x_;
+            *dest++ = tangent.y_;
+            *dest++ = tangent.z_;
+            *dest++ = w;
+        }
     }
 
     if (isSkinned)
     {
-        for (unsigned i = 0; i < 4; ++i)
+        if (compactVertices_)
         {
-            if (i < blendWeights[index].Size())
-                *dest++ = blendWeights[index][i];
-            else
-                *dest++ = 0.0f;
+            // Quantize the weights and give the rounding error to the largest weight, so that they still sum to one
+            unsigned char weights[4] = {0, 0, 0, 0};
+            unsigned sum = 0;
+            unsigned largest = 0;
+            for (unsigned i = 0; i < 4 && i < blendWeights[index].Size(); ++i)
+            {
+                weights[i] = (unsigned char)RoundToInt(Clamp(blendWeights[index][i], 0.0f, 1.0f) * 255.0f);
+                sum += weights[i];
+                if (weights[i] > weights[largest])
+                    largest = i;
+            }
+            if (sum > 0)
+                weights[largest] = (unsigned char)Clamp((int)weights[largest] + 255 - (int)sum, 0, 255);
+
+            memcpy(dest, weights, sizeof weights);
+            ++dest;
+        }
+        else
+        {
+            for (unsigned i = 0; i < 4; ++i)
+            {
+                if (i < blendWeights[index].Size())
+                    *dest++ = blendWeights[index][i];
+                else
+                    *dest++ = 0.0f;
+            }
         }
 
         auto* destBytes = (unsigned char*)dest;
@@ -2492,7 +2983,7 @@ void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, Bou
     }
 }
 
-PODVector<VertexElement> GetVertexElements(aiMesh* mesh, bool isSkinned)
+PODVector<VertexElement> GetVertexElements(aiMesh* mesh, bool isSkinned, bool compact)
 {
     PODVector<VertexElement> ret;
 
@@ -2500,21 +2991,21 @@ PODVector<VertexElement> GetVertexElements(aiMesh* mesh, bool isSkinned)
     ret.Push(VertexElement(TYPE_VECTOR3, SEM_POSITION));
 
     if (mesh->HasNormals())
-        ret.Push(VertexElement(TYPE_VECTOR3, SEM_NORMAL));
+        ret.Push(VertexElement(compact ? TYPE_SHORT4_NORM : TYPE_VECTOR3, SEM_NORMAL));
 
     for (unsigned i = 0; i < mesh->GetNumColorChannels() && i < MAX_CHANNELS; ++i)
         ret.Push(VertexElement(TYPE_UBYTE4_NORM, SEM_COLOR, i));
 
     /// \todo Assimp mesh structure can specify 3D UV-coords. How to determine the difference? For now always treated as 2D.
     for (unsigned i = 0; i < mesh->GetNumUVChannels() && i < MAX_CHANNELS; ++i)
-        ret.Push(VertexElement(TYPE_VECTOR2, SEM_TEXCOORD, i));
+        ret.Push(VertexElement(compact && CanUseHalfTexCoords(mesh, i) ? TYPE_HALF2 : TYPE_VECTOR2, SEM_TEXCOORD, i));
 
     if (mesh->HasTangentsAndBitangents())
-        ret.Push(VertexElement(TYPE_VECTOR4, SEM_TANGENT));
+        ret.Push(VertexElement(compact ? TYPE_SHORT4_NORM : TYPE_VECTOR4, SEM_TANGENT));
 
     if (isSkinned)
     {
-        ret.Push(VertexElement(TYPE_VECTOR4, SEM_BLENDWEIGHTS));
+        ret.Push(VertexElement(compact ? TYPE_UBYTE4_NORM : TYPE_VECTOR4, SEM_BLENDWEIGHTS));
         ret.Push(VertexElement(TYPE_UBYTE4, SEM_BLENDINDICES));
     }
 
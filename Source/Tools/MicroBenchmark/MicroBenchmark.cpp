@@ -0,0 +1,761 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Container/FlatHashMap.h>
+#include <Urho3D/Container/HashMap.h>
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/AnimatedModel.h>
+#include <Urho3D/Graphics/Animation.h>
+#include <Urho3D/Graphics/AnimationState.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/DynamicAABBTree.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/OcclusionBuffer.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Math/MathDefs.h>
+#include <Urho3D/Math/Random.h>
+#include <Urho3D/Scene/Node.h>
+#include <Urho3D/Scene/Scene.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <cstdarg>
+#include <cstdio>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+SharedPtr<Context> context_(new Context());
+unsigned maxThreads_ = 64;
+unsigned numFrames_ = 200;
+unsigned numItems_ = 256;
+unsigned numElements_ = 10000;
+
+int main(int argc, char** argv);
+void Run(const Vector<String>& arguments);
+void BenchmarkWorkQueue();
+void BenchmarkHashMap();
+void BenchmarkOcclusion();
+void BenchmarkSpatialIndex();
+void BenchmarkAnimation();
+
+/// Format a table row. Unlike ToString(), supports field widths and precision.
+static String FormatRow(const char* format, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof buffer, format, args);
+    va_end(args);
+    return String(buffer);
+}
+
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+    #ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+    #else
+    arguments = ParseArguments(argc, argv);
+    #endif
+
+    Run(arguments);
+    return 0;
+}
+
+void Run(const Vector<String>& arguments)
+{
+    if (arguments.Size() < 1)
+        ErrorExit(
+            "Usage: MicroBenchmark <benchmark> [options]\n"
+            "\n"
+            "Benchmarks:\n"
+            "workqueue  Compare shared queue and work-stealing WorkQueue scheduling\n"
+            "hashmap    Compare HashMap and FlatHashMap insert, find, iterate and erase\n"
+            "occlusion  Compare the tiled and scanline occlusion rasterizers for speed and accuracy\n"
+            "spatial    Compare the octree and AABB tree spatial indices for update, frustum query and raycast speed\n"
+            "animation  Measure animated bones per second applied serially, per model in parallel and in the parallel animation phase\n"
+            "\n"
+            "Options:\n"
+            "-t <num>   Maximum number of worker threads, default 64\n"
+            "-f <num>   Number of frames to run, default 200\n"
+            "-i <num>   Number of work items per frame, default 256\n"
+            "-n <num>   Number of container elements, occluders, drawables or animated models, default 10000\n"
+        );
+
+    for (unsigned i = 1; i < arguments.Size(); ++i)
+    {
+        if (arguments[i].Length() > 1 && arguments[i][0] == '-' && i + 1 < arguments.Size())
+        {
+            unsigned value = ToUInt(arguments[++i]);
+            switch (arguments[i - 1][1])
+            {
+            case 't':
+                maxThreads_ = Max(value, 1U);
+                break;
+            case 'f':
+                numFrames_ = Max(value, 1U);
+                break;
+            case 'i':
+                numItems_ = Max(value, 1U);
+                break;
+            case 'n':
+                numElements_ = Max(value, 1U);
+                break;
+            default:
+                ErrorExit("Unrecognized option " + arguments[i - 1]);
+            }
+        }
+    }
+
+    // The Time subsystem initializes the high-resolution timer frequency
+    context_->RegisterSubsystem(new Time(context_));
+
+    String benchmark = arguments[0].ToLower();
+    if (benchmark == "workqueue")
+        BenchmarkWorkQueue();
+    else if (benchmark == "hashmap")
+        BenchmarkHashMap();
+    else if (benchmark == "occlusion")
+        BenchmarkOcclusion();
+    else if (benchmark == "spatial")
+        BenchmarkSpatialIndex();
+    else if (benchmark == "animation")
+        BenchmarkAnimation();
+    else
+        ErrorExit("Unrecognized benchmark " + arguments[0]);
+}
+
+/// Work item function for the WorkQueue benchmark. Does a fixed amount of arithmetic over a slice of data.
+static void WorkQueueBenchmarkWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* start = reinterpret_cast<float*>(item->start_);
+    auto* end = reinterpret_cast<float*>(item->end_);
+
+    while (start != end)
+    {
+        *start = Sqrt(*start * *start + 1.0f);
+        ++start;
+    }
+}
+
+/// Run the WorkQueue benchmark frames with the given number of threads and scheduling mode. Return average microseconds per frame.
+static float RunWorkQueueBenchmark(unsigned numThreads, bool workStealing, PODVector<float>& data)
+{
+    SharedPtr<WorkQueue> queue(new WorkQueue(context_));
+    queue->CreateThreads(numThreads);
+    queue->SetWorkStealing(workStealing);
+
+    unsigned itemSize = data.Size() / numItems_;
+    HiresTimer timer;
+
+    for (unsigned frame = 0; frame < numFrames_; ++frame)
+    {
+        float* start = &data[0];
+
+        // Each item has a continuation processing the same data, which is released by the thread completing the item
+        for (unsigned i = 0; i < numItems_; ++i)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = WorkQueueBenchmarkWork;
+            item->start_ = start;
+            item->end_ = start + itemSize;
+
+            SharedPtr<WorkItem> continuation = queue->GetFreeItem();
+            continuation->priority_ = M_MAX_UNSIGNED;
+            continuation->workFunction_ = WorkQueueBenchmarkWork;
+            continuation->start_ = start;
+            continuation->end_ = start + itemSize;
+
+            queue->AddDependency(continuation, item);
+            queue->AddWorkItem(item);
+            queue->AddWorkItem(continuation);
+            start += itemSize;
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+
+    return (float)timer.GetUSec(false) / (float)numFrames_;
+}
+
+void BenchmarkWorkQueue()
+{
+    PODVector<float> data(numItems_ * 1024);
+    for (unsigned i = 0; i < data.Size(); ++i)
+        data[i] = (float)i;
+
+    PrintLine("Threads  Shared queue (us/frame)  Work stealing (us/frame)  Speedup");
+
+    for (unsigned numThreads = 1; numThreads <= maxThreads_; numThreads *= 2)
+    {
+        float shared = RunWorkQueueBenchmark(numThreads, false, data);
+        float stealing = RunWorkQueueBenchmark(numThreads, true, data);
+
+        PrintLine(FormatRow("%7u  %23.1f  %24.1f  %6.2fx", numThreads, shared, stealing, stealing > 0.0f ? shared / stealing : 0.0f));
+    }
+}
+
+/// Hash map benchmark results in nanoseconds per operation.
+struct HashMapBenchmarkResult
+{
+    float insert_{};
+    float findHit_{};
+    float findMiss_{};
+    float iterate_{};
+    float erase_{};
+};
+
+/// Run the hash map benchmark frames for a map type. The checksum keeps the compiler from optimizing the lookups away.
+template <class T> static HashMapBenchmarkResult RunHashMapBenchmark(const PODVector<unsigned>& keys, const PODVector<unsigned>& lookupKeys,
+    const PODVector<unsigned>& missingKeys, unsigned& checksum)
+{
+    HashMapBenchmarkResult result;
+    const auto numOps = (float)(keys.Size() * numFrames_);
+    HiresTimer timer;
+
+    for (unsigned frame = 0; frame < numFrames_; ++frame)
+    {
+        T map;
+
+        timer.Reset();
+        for (unsigned i = 0; i < keys.Size(); ++i)
+            map[typename T::KeyType(keys[i])] = i;
+        result.insert_ += (float)timer.GetUSec(false);
+
+        timer.Reset();
+        for (unsigned i = 0; i < lookupKeys.Size(); ++i)
+        {
+            typename T::ConstIterator j = map.Find(typename T::KeyType(lookupKeys[i]));
+            if (j != map.End())
+                checksum += j->second_;
+        }
+        result.findHit_ += (float)timer.GetUSec(false);
+
+        timer.Reset();
+        for (unsigned i = 0; i < missingKeys.Size(); ++i)
+        {
+            if (map.Contains(typename T::KeyType(missingKeys[i])))
+                ++checksum;
+        }
+        result.findMiss_ += (float)timer.GetUSec(false);
+
+        timer.Reset();
+        for (typename T::ConstIterator i = map.Begin(); i != map.End(); ++i)
+            checksum += i->second_;
+        result.iterate_ += (float)timer.GetUSec(false);
+
+        timer.Reset();
+        for (unsigned i = 0; i < lookupKeys.Size(); ++i)
+            map.Erase(typename T::KeyType(lookupKeys[i]));
+        result.erase_ += (float)timer.GetUSec(false);
+    }
+
+    result.insert_ *= 1000.0f / numOps;
+    result.findHit_ *= 1000.0f / numOps;
+    result.findMiss_ *= 1000.0f / numOps;
+    result.iterate_ *= 1000.0f / numOps;
+    result.erase_ *= 1000.0f / numOps;
+    return result;
+}
+
+static void PrintHashMapBenchmarkResult(const char* name, const HashMapBenchmarkResult& result)
+{
+    PrintLine(FormatRow("%-26s  %6.1f  %8.1f  %9.1f  %7.1f  %6.1f", name, result.insert_, result.findHit_, result.findMiss_,
+        result.iterate_, result.erase_));
+}
+
+void BenchmarkHashMap()
+{
+    // Use scattered keys like string hashes, and an independent sequence of keys that are not in the map for the misses
+    PODVector<unsigned> keys(numElements_);
+    PODVector<unsigned> missingKeys(numElements_);
+    unsigned seed = 1;
+    unsigned missingSeed = 2463534242u;
+    for (unsigned i = 0; i < numElements_; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        keys[i] = seed;
+        missingSeed ^= missingSeed << 13u;
+        missingSeed ^= missingSeed >> 17u;
+        missingSeed ^= missingSeed << 5u;
+        missingKeys[i] = missingSeed;
+    }
+
+    // Look up and erase in a different order than inserted, so that node allocation order does not favor the chained map
+    PODVector<unsigned> lookupKeys = keys;
+    for (unsigned i = numElements_ - 1; i > 0; --i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        Swap(lookupKeys[i], lookupKeys[(seed >> 8u) % (i + 1)]);
+    }
+
+    unsigned checksum = 0;
+    PrintLine(ToString("%u elements, times in ns/operation", numElements_));
+    PrintLine("Container                   Insert  Find hit  Find miss  Iterate   Erase");
+    PrintHashMapBenchmarkResult("HashMap<unsigned>", RunHashMapBenchmark<HashMap<unsigned, unsigned> >(keys, lookupKeys, missingKeys, checksum));
+    PrintHashMapBenchmarkResult("FlatHashMap<unsigned>", RunHashMapBenchmark<FlatHashMap<unsigned, unsigned> >(keys, lookupKeys, missingKeys, checksum));
+    PrintHashMapBenchmarkResult("HashMap<StringHash>", RunHashMapBenchmark<HashMap<StringHash, unsigned> >(keys, lookupKeys, missingKeys, checksum));
+    PrintHashMapBenchmarkResult("FlatHashMap<StringHash>", RunHashMapBenchmark<FlatHashMap<StringHash, unsigned> >(keys, lookupKeys, missingKeys, checksum));
+    PrintLine(ToString("Checksum %u", checksum));
+}
+
+/// Occlusion benchmark results of one rasterizer configuration.
+struct OcclusionBenchmarkResult
+{
+    /// Average milliseconds per frame to draw the occluders and build the depth hierarchy.
+    float drawTime_{};
+    /// Average milliseconds per frame to test the boxes.
+    float testTime_{};
+    /// Visibility of each test box on the last frame.
+    PODVector<bool> visible_;
+    /// Depth buffer of the last frame.
+    PODVector<int> depth_;
+};
+
+/// Box geometry used for both occluders and test boxes: 8 corners and 12 triangles.
+static const Vector3 occlusionBoxVertices[] =
+{
+    Vector3(-0.5f, -0.5f, -0.5f), Vector3(0.5f, -0.5f, -0.5f), Vector3(0.5f, 0.5f, -0.5f), Vector3(-0.5f, 0.5f, -0.5f),
+    Vector3(-0.5f, -0.5f, 0.5f), Vector3(0.5f, -0.5f, 0.5f), Vector3(0.5f, 0.5f, 0.5f), Vector3(-0.5f, 0.5f, 0.5f)
+};
+
+static const unsigned short occlusionBoxIndices[] =
+{
+    0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4, 3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5
+};
+
+/// Run the occlusion benchmark frames with the given rasterizer configuration.
+static OcclusionBenchmarkResult RunOcclusionBenchmark(Camera* camera, bool tiled, bool threaded, const PODVector<Matrix3x4>& occluders,
+    const PODVector<BoundingBox>& testBoxes)
+{
+    OcclusionBenchmarkResult result;
+    SharedPtr<OcclusionBuffer> buffer(new OcclusionBuffer(context_));
+    buffer->SetTiledRasterization(tiled);
+    buffer->SetSize(256, RoundToInt(256.0f / camera->GetAspectRatio()), threaded);
+    buffer->SetView(camera);
+    buffer->SetMaxTriangles(M_MAX_UNSIGNED);
+    buffer->SetCullMode(CULL_NONE);
+
+    HiresTimer timer;
+
+    for (unsigned frame = 0; frame < numFrames_; ++frame)
+    {
+        timer.Reset();
+        buffer->Clear();
+        for (unsigned i = 0; i < occluders.Size(); ++i)
+            buffer->AddTriangles(occluders[i], occlusionBoxVertices, sizeof(Vector3), occlusionBoxIndices, sizeof(unsigned short), 0, 36);
+        buffer->DrawTriangles();
+        buffer->BuildDepthHierarchy();
+        result.drawTime_ += (float)timer.GetUSec(false);
+
+        timer.Reset();
+        result.visible_.Resize(testBoxes.Size());
+        for (unsigned i = 0; i < testBoxes.Size(); ++i)
+            result.visible_[i] = buffer->IsVisible(testBoxes[i]);
+        result.testTime_ += (float)timer.GetUSec(false);
+    }
+
+    result.drawTime_ /= 1000.0f * numFrames_;
+    result.testTime_ /= 1000.0f * numFrames_;
+
+    const int* depth = buffer->GetBuffer();
+    result.depth_.Resize((unsigned)(buffer->GetWidth() * buffer->GetHeight()));
+    for (unsigned i = 0; i < result.depth_.Size(); ++i)
+        result.depth_[i] = depth[i];
+
+    return result;
+}
+
+static void PrintOcclusionBenchmarkResult(const String& name, const OcclusionBenchmarkResult& result, const OcclusionBenchmarkResult& reference)
+{
+    // Compare against the reference: boxes wrongly culled are errors, boxes wrongly kept visible only cost performance.
+    // The rasterizers sample pixels at slightly different positions, so compare the pixel coverage instead of the depth values
+    unsigned numOccluded = 0;
+    unsigned falseOccluded = 0;
+    unsigned falseVisible = 0;
+    for (unsigned i = 0; i < result.visible_.Size(); ++i)
+    {
+        if (!result.visible_[i])
+            ++numOccluded;
+        if (reference.visible_[i] && !result.visible_[i])
+            ++falseOccluded;
+        else if (!reference.visible_[i] && result.visible_[i])
+            ++falseVisible;
+    }
+
+    auto clearDepth = (int)OCCLUSION_Z_SCALE;
+    unsigned differingPixels = 0;
+    for (unsigned i = 0; i < result.depth_.Size(); ++i)
+    {
+        if ((result.depth_[i] == clearDepth) != (reference.depth_[i] == clearDepth))
+            ++differingPixels;
+    }
+
+    PrintLine(FormatRow("%-22s  %9.2f  %9.2f  %8u  %14u  %13u  %15.2f%%", name.CString(), result.drawTime_, result.testTime_, numOccluded,
+        falseOccluded, falseVisible, 100.0f * differingPixels / Max(result.depth_.Size(), 1U)));
+}
+
+void BenchmarkOcclusion()
+{
+    unsigned numThreads = Min(maxThreads_, GetNumLogicalCPUs());
+    auto* queue = new WorkQueue(context_);
+    context_->RegisterSubsystem(queue);
+    queue->CreateThreads(numThreads);
+
+    // The camera looks over a field of wall-like occluders standing on the ground, with small boxes scattered among them to test
+    SharedPtr<Camera> camera(new Camera(context_));
+    camera->SetFov(60.0f);
+    camera->SetAspectRatio(16.0f / 9.0f);
+    camera->SetFarClip(1000.0f);
+    SharedPtr<Node> cameraNode(new Node(context_));
+    cameraNode->SetPosition(Vector3(0.0f, 10.0f, 0.0f));
+    cameraNode->SetRotation(Quaternion(10.0f, 0.0f, 0.0f));
+    cameraNode->AddComponent(camera, 0, LOCAL);
+
+    SetRandomSeed(1);
+    float fieldSize = Sqrt((float)numElements_) * 10.0f;
+    PODVector<Matrix3x4> occluders(numElements_);
+    for (unsigned i = 0; i < numElements_; ++i)
+    {
+        Vector3 scale(Random(2.0f, 10.0f), Random(2.0f, 12.0f), Random(0.5f, 1.0f));
+        occluders[i] = Matrix3x4(Vector3(Random(-0.5f, 0.5f) * fieldSize, 0.5f * scale.y_, Random(5.0f, fieldSize)),
+            Quaternion(Random(360.0f), Vector3::UP), scale);
+    }
+    // Draw the occluders front to back like View does, so that the depth test can reject hidden triangles
+    Sort(occluders.Begin(), occluders.End(), [](const Matrix3x4& lhs, const Matrix3x4& rhs) { return lhs.m23_ < rhs.m23_; });
+
+    PODVector<BoundingBox> testBoxes(numElements_);
+    for (unsigned i = 0; i < numElements_; ++i)
+    {
+        Vector3 halfSize(Random(0.25f, 1.5f), Random(0.25f, 1.5f), Random(0.25f, 1.5f));
+        Vector3 center(Random(-0.5f, 0.5f) * fieldSize, halfSize.y_, Random(5.0f, fieldSize));
+        testBoxes[i] = BoundingBox(center - halfSize, center + halfSize);
+    }
+
+    OcclusionBenchmarkResult reference = RunOcclusionBenchmark(camera, false, false, occluders, testBoxes);
+
+    PrintLine(ToString("%u occluders (%u triangles), %u test boxes, times in ms/frame", numElements_, numElements_ * 12, numElements_));
+    PrintLine("Rasterizer              Draw (ms)  Test (ms)  Occluded  False occluded  False visible  Coverage differs");
+    PrintOcclusionBenchmarkResult("Scanline (reference)", reference, reference);
+    PrintOcclusionBenchmarkResult("Tiled", RunOcclusionBenchmark(camera, true, false, occluders, testBoxes), reference);
+    PrintOcclusionBenchmarkResult(ToString("Tiled, %u threads", numThreads + 1),
+        RunOcclusionBenchmark(camera, true, true, occluders, testBoxes), reference);
+}
+
+/// Drawable with a unit box and no geometry, used to fill the octree in the spatial index benchmark.
+class BenchmarkDrawable : public Drawable
+{
+    URHO3D_OBJECT(BenchmarkDrawable, Drawable);
+
+public:
+    /// Construct.
+    explicit BenchmarkDrawable(Context* context) :
+        Drawable(context, DRAWABLE_GEOMETRY)
+    {
+        boundingBox_ = BoundingBox(-0.5f, 0.5f);
+    }
+
+protected:
+    /// Recalculate the world-space bounding box.
+    void OnWorldBoundingBoxUpdate() override { worldBoundingBox_ = boundingBox_.Transformed(node_->GetWorldTransform()); }
+};
+
+/// Spatial index benchmark results of one index type.
+struct SpatialIndexBenchmarkResult
+{
+    /// Average milliseconds per frame to update the octree.
+    float updateTime_{};
+    /// Average milliseconds per frame for the frustum query.
+    float frustumTime_{};
+    /// Average milliseconds per frame for the raycasts.
+    float raycastTime_{};
+    /// Drawables found by the frustum query on the last frame.
+    unsigned numVisible_{};
+    /// Raycast hits on the last frame.
+    unsigned numHits_{};
+    /// Description of the index structure.
+    String structure_;
+};
+
+/// Run the spatial index benchmark frames with the given index type. Every frame a quarter of the drawables moves if requested.
+static SpatialIndexBenchmarkResult RunSpatialIndexBenchmark(SpatialIndexType type, bool moving)
+{
+    SpatialIndexBenchmarkResult result;
+    SetRandomSeed(1);
+
+    // Drawables of varying size are scattered over a field, with a camera looking over it from one edge
+    float fieldSize = Sqrt((float)numElements_) * 10.0f;
+    SharedPtr<Scene> scene(new Scene(context_));
+    auto* octree = scene->CreateComponent<Octree>();
+    octree->SetSize(BoundingBox(Vector3(-0.5f * fieldSize, -fieldSize, -0.5f * fieldSize), Vector3(0.5f * fieldSize, fieldSize,
+        0.5f * fieldSize)), 8);
+    octree->SetSpatialIndexType(type);
+
+    PODVector<Node*> nodes(numElements_);
+    PODVector<Vector3> velocities(numElements_);
+    for (unsigned i = 0; i < numElements_; ++i)
+    {
+        Node* node = scene->CreateChild();
+        node->SetPosition(Vector3(Random(-0.5f, 0.5f) * fieldSize, Random(0.0f, 20.0f), Random(-0.5f, 0.5f) * fieldSize));
+        node->SetScale(Random(0.5f, 4.0f));
+        node->CreateComponent<BenchmarkDrawable>();
+        nodes[i] = node;
+        velocities[i] = Vector3(Random(-1.0f, 1.0f), 0.0f, Random(-1.0f, 1.0f));
+    }
+
+    Node* cameraNode = scene->CreateChild();
+    cameraNode->SetPosition(Vector3(0.0f, 20.0f, -0.5f * fieldSize));
+    cameraNode->SetRotation(Quaternion(15.0f, 0.0f, 0.0f));
+    auto* camera = cameraNode->CreateComponent<Camera>();
+    camera->SetFarClip(0.5f * fieldSize);
+
+    FrameInfo frame;
+    frame.camera_ = camera;
+    octree->Update(frame);
+
+    PODVector<Drawable*> drawables;
+    PODVector<RayQueryResult> rayResults;
+    HiresTimer timer;
+
+    for (unsigned i = 0; i < numFrames_; ++i)
+    {
+        if (moving)
+        {
+            for (unsigned j = i % 4; j < numElements_; j += 4)
+                nodes[j]->Translate(velocities[j], TS_WORLD);
+        }
+
+        frame.frameNumber_ = i + 1;
+        timer.Reset();
+        octree->Update(frame);
+        result.updateTime_ += (float)timer.GetUSec(false);
+
+        timer.Reset();
+        FrustumOctreeQuery frustumQuery(drawables, camera->GetFrustum(), DRAWABLE_GEOMETRY);
+        octree->GetDrawables(frustumQuery);
+        result.frustumTime_ += (float)timer.GetUSec(false);
+        result.numVisible_ = drawables.Size();
+
+        timer.Reset();
+        result.numHits_ = 0;
+        for (unsigned j = 0; j < 64; ++j)
+        {
+            Vector3 origin(((float)(j % 8) / 7.0f - 0.5f) * fieldSize, 50.0f, ((float)(j / 8) / 7.0f - 0.5f) * fieldSize);
+            RayOctreeQuery rayQuery(rayResults, Ray(origin, Vector3(0.3f, -1.0f, 0.2f).Normalized()), RAY_AABB, fieldSize,
+                DRAWABLE_GEOMETRY);
+            octree->Raycast(rayQuery);
+            result.numHits_ += rayResults.Size();
+        }
+        result.raycastTime_ += (float)timer.GetUSec(false);
+    }
+
+    result.updateTime_ /= 1000.0f * numFrames_;
+    result.frustumTime_ /= 1000.0f * numFrames_;
+    result.raycastTime_ /= 1000.0f * numFrames_;
+
+    if (type == SPATIAL_INDEX_AABB_TREE)
+    {
+        auto* tree = static_cast<DynamicAABBTree*>(octree->GetSpatialIndex());
+        result.structure_ = FormatRow("height %d, area ratio %.1f", tree->GetHeight(), tree->GetAreaRatio());
+    }
+    else
+        result.structure_ = ToString("%u levels", octree->GetNumLevels());
+
+    return result;
+}
+
+static void PrintSpatialIndexBenchmarkResult(const char* name, const SpatialIndexBenchmarkResult& result)
+{
+    PrintLine(FormatRow("%-18s  %11.3f  %12.3f  %11.3f  %7u  %6u  %s", name, result.updateTime_, result.frustumTime_,
+        result.raycastTime_, result.numVisible_, result.numHits_, result.structure_.CString()));
+}
+
+void BenchmarkSpatialIndex()
+{
+    unsigned numThreads = Min(maxThreads_, GetNumLogicalCPUs());
+    auto* queue = new WorkQueue(context_);
+    context_->RegisterSubsystem(queue);
+    queue->CreateThreads(numThreads);
+
+    RegisterSceneLibrary(context_);
+    Octree::RegisterObject(context_);
+    Camera::RegisterObject(context_);
+    context_->RegisterFactory<BenchmarkDrawable>();
+
+    PrintLine(ToString("%u drawables, a quarter moving each frame in the moving scene, 64 raycasts per frame, times in ms/frame",
+        numElements_));
+    PrintLine("Index               Update (ms)  Frustum (ms)  Raycast (ms)  Visible    Hits  Structure");
+    PrintSpatialIndexBenchmarkResult("Octree, static", RunSpatialIndexBenchmark(SPATIAL_INDEX_OCTREE, false));
+    PrintSpatialIndexBenchmarkResult("AABB tree, static", RunSpatialIndexBenchmark(SPATIAL_INDEX_AABB_TREE, false));
+    PrintSpatialIndexBenchmarkResult("Octree, moving", RunSpatialIndexBenchmark(SPATIAL_INDEX_OCTREE, true));
+    PrintSpatialIndexBenchmarkResult("AABB tree, moving", RunSpatialIndexBenchmark(SPATIAL_INDEX_AABB_TREE, true));
+}
+
+/// Animation benchmark model sizes: most models have a small skeleton, and every 32nd model a large one.
+static const unsigned ANIMATION_BENCHMARK_BONES = 32;
+static const unsigned ANIMATION_BENCHMARK_HEAVY_BONES = 1024;
+static const unsigned ANIMATION_BENCHMARK_HEAVY_INTERVAL = 32;
+
+/// Animation benchmark execution modes.
+enum AnimationBenchmarkMode
+{
+    ANIMATION_BENCHMARK_SERIAL = 0,
+    ANIMATION_BENCHMARK_PER_MODEL,
+    ANIMATION_BENCHMARK_PHASE
+};
+
+/// Create a model with a branching skeleton and a looping two second animation with keyframes at 30 fps for all its bones.
+static void CreateAnimationBenchmarkModel(unsigned numBones, SharedPtr<Model>& model, SharedPtr<Animation>& animation)
+{
+    Skeleton skeleton;
+    Vector<Bone>& bones = skeleton.GetModifiableBones();
+    bones.Resize(numBones);
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        Bone& bone = bones[i];
+        bone.name_ = ToString("Bone%u", i);
+        bone.nameHash_ = bone.name_;
+        bone.parentIndex_ = i ? (i - 1) / 2 : 0;
+        bone.initialPosition_ = Vector3(0.0f, 0.1f, 0.0f);
+        bone.collisionMask_ = BONECOLLISION_SPHERE;
+        bone.radius_ = 0.1f;
+    }
+    skeleton.SetRootBoneIndex(0);
+
+    model = new Model(context_);
+    model->SetSkeleton(skeleton);
+    model->SetBoundingBox(BoundingBox(-1.0f, 1.0f));
+
+    const float length = 2.0f;
+    const unsigned numKeyFrames = 60;
+    animation = new Animation(context_);
+    animation->SetLength(length);
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        AnimationTrack* track = animation->CreateTrack(bones[i].name_);
+        track->channelMask_ = CHANNEL_POSITION | CHANNEL_ROTATION;
+        for (unsigned j = 0; j < numKeyFrames; ++j)
+        {
+            AnimationKeyFrame keyFrame;
+            keyFrame.time_ = length * j / numKeyFrames;
+            float angle = 360.0f * j / numKeyFrames + 10.0f * i;
+            keyFrame.position_ = Vector3(0.0f, 0.1f, 0.0f);
+            keyFrame.rotation_ = Quaternion(30.0f * Sin(angle), 20.0f * Cos(angle), 10.0f * Sin(2.0f * angle));
+            track->AddKeyFrame(keyFrame);
+        }
+    }
+}
+
+/// Run the animation benchmark frames. Return average milliseconds per frame.
+static float RunAnimationBenchmark(const PODVector<AnimatedModel*>& models, AnimationBenchmarkMode mode)
+{
+    auto* queue = context_->GetSubsystem<WorkQueue>();
+    HiresTimer timer;
+    float time = 0.0f;
+
+    for (unsigned frame = 0; frame < numFrames_; ++frame)
+    {
+        for (unsigned i = 0; i < models.Size(); ++i)
+            models[i]->GetAnimationState(0u)->AddTime(1.0f / 60.0f);
+
+        timer.Reset();
+        if (mode == ANIMATION_BENCHMARK_SERIAL)
+        {
+            for (unsigned i = 0; i < models.Size(); ++i)
+                models[i]->ApplyAnimation();
+        }
+        else if (mode == ANIMATION_BENCHMARK_PER_MODEL)
+            queue->ParallelFor(0, models.Size(), 0, [&](unsigned index, unsigned threadIndex) { models[index]->ApplyAnimation(); });
+        else
+            AnimatedModel::ApplyAnimations(models, queue);
+        time += (float)timer.GetUSec(false);
+    }
+
+    return time / (1000.0f * numFrames_);
+}
+
+void BenchmarkAnimation()
+{
+    unsigned numThreads = Min(maxThreads_, GetNumLogicalCPUs());
+    auto* queue = new WorkQueue(context_);
+    context_->RegisterSubsystem(queue);
+    queue->CreateThreads(numThreads);
+
+    RegisterSceneLibrary(context_);
+    RegisterGraphicsLibrary(context_);
+
+    SharedPtr<Model> model;
+    SharedPtr<Animation> animation;
+    SharedPtr<Model> heavyModel;
+    SharedPtr<Animation> heavyAnimation;
+    CreateAnimationBenchmarkModel(ANIMATION_BENCHMARK_BONES, model, animation);
+    CreateAnimationBenchmarkModel(ANIMATION_BENCHMARK_HEAVY_BONES, heavyModel, heavyAnimation);
+
+    unsigned numBones = 0;
+    for (unsigned i = 0; i < numElements_; ++i)
+        numBones += i % ANIMATION_BENCHMARK_HEAVY_INTERVAL ? ANIMATION_BENCHMARK_BONES : ANIMATION_BENCHMARK_HEAVY_BONES;
+
+    PrintLine(ToString("%u models, %u bones, every %uth model has %u bones and the others %u, %u threads, times in ms/frame",
+        numElements_, numBones, ANIMATION_BENCHMARK_HEAVY_INTERVAL, ANIMATION_BENCHMARK_HEAVY_BONES, ANIMATION_BENCHMARK_BONES,
+        numThreads + 1));
+    PrintLine("Pose         Serial (ms)  Per model (ms)  Phase (ms)  Serial (Mbones/s)  Per model (Mbones/s)  Phase (Mbones/s)");
+
+    for (unsigned nodeFree = 0; nodeFree < 2; ++nodeFree)
+    {
+        SharedPtr<Scene> scene(new Scene(context_));
+        PODVector<AnimatedModel*> models(numElements_);
+        for (unsigned i = 0; i < numElements_; ++i)
+        {
+            bool heavy = i % ANIMATION_BENCHMARK_HEAVY_INTERVAL == 0;
+            auto* object = scene->CreateChild()->CreateComponent<AnimatedModel>();
+            object->SetNodeFreePose(nodeFree != 0);
+            object->SetModel(heavy ? heavyModel : model);
+            AnimationState* state = object->AddAnimationState(heavy ? heavyAnimation : animation);
+            state->SetLooped(true);
+            state->SetWeight(1.0f);
+            state->SetTime(Random(2.0f));
+            models[i] = object;
+        }
+
+        float times[3];
+        float bonesPerSecond[3];
+        for (unsigned mode = ANIMATION_BENCHMARK_SERIAL; mode <= ANIMATION_BENCHMARK_PHASE; ++mode)
+        {
+            times[mode] = RunAnimationBenchmark(models, (AnimationBenchmarkMode)mode);
+            bonesPerSecond[mode] = times[mode] > 0.0f ? numBones / (1000.0f * times[mode]) : 0.0f;
+        }
+
+        PrintLine(FormatRow("%-11s  %11.3f  %14.3f  %10.3f  %17.2f  %20.2f  %16.2f", nodeFree ? "Node-free" : "Bone nodes", times[0],
+            times[1], times[2], bonesPerSecond[0], bonesPerSecond[1], bonesPerSecond[2]));
+    }
+}
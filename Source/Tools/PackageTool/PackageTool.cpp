@@ -54,6 +54,7 @@ String basePath_;
 Vector<FileEntry> entries_;
 unsigned checksum_ = 0;
 bool compress_ = false;
+bool blockIndex_ = true;
 bool quiet_ = false;
 unsigned blockSize_ = COMPRESSED_BLOCK_SIZE;
 
@@ -91,6 +92,7 @@ void Run(const Vector<String>& arguments)
             "\n"
             "Options:\n"
             "-c      Enable package file LZ4 compression\n"
+            "-C      Enable LZ4 compression using the legacy format without block index (ULZ4), for older readers\n"
             "-q      Enable quiet mode\n"
             "\n"
             "Basepath is an optional prefix that will be added to the file entries.\n\n"
@@ -119,6 +121,10 @@ void Run(const Vector<String>& arguments)
                     case 'c':
                         compress_ = true;
                         break;
+                    case 'C':
+                        compress_ = true;
+                        blockIndex_ = false;
+                        break;
                     case 'q':
                         quiet_ = true;
                         break;
@@ -172,6 +178,8 @@ void Run(const Vector<String>& arguments)
             PrintLine("Package size: " + String(packageFile->GetTotalSize()));
             PrintLine("Checksum: " + String(packageFile->GetChecksum()));
             PrintLine("Compressed: " + String(packageFile->IsCompressed() ? "yes" : "no"));
+            if (packageFile->IsBlockIndexed())
+                PrintLine("Block size: " + String(packageFile->GetBlockSize()));
             break;
         case 'L':
             if (!packageFile->IsCompressed())
@@ -278,6 +286,15 @@ void WritePackageFile(const String& fileName, const String& rootDir)
         {
             SharedArrayPtr<unsigned char> compressBuffer(new unsigned char[LZ4_compressBound(blockSize_)]);
 
+            // Reserve the block offset table, which is filled in after the blocks have been written
+            unsigned numBlocks = (dataSize + blockSize_ - 1) / blockSize_;
+            PODVector<unsigned> blockOffsets;
+            if (blockIndex_)
+            {
+                blockOffsets.Resize(numBlocks + 1);
+                dest.Write(blockOffsets.Buffer(), blockOffsets.Size() * sizeof(unsigned));
+            }
+
             unsigned pos = 0;
 
             while (pos < dataSize)
@@ -290,6 +307,8 @@ void WritePackageFile(const String& fileName, const String& rootDir)
                 if (!packedSize)
                     ErrorExit("LZ4 compression failed for file " + entries_[i].name_ + " at offset " + String(pos));
 
+                if (blockIndex_)
+                    blockOffsets[pos / blockSize_] = dest.GetSize() - lastOffset;
                 dest.WriteUShort((unsigned short)unpackedSize);
                 dest.WriteUShort((unsigned short)packedSize);
                 dest.Write(compressBuffer.Get(), packedSize);
@@ -297,6 +316,15 @@ void WritePackageFile(const String& fileName, const String& rootDir)
                 pos += unpackedSize;
             }
 
+            if (blockIndex_)
+            {
+                unsigned endOffset = dest.GetSize();
+                blockOffsets[numBlocks] = endOffset - lastOffset;
+                dest.Seek(lastOffset);
+                dest.Write(blockOffsets.Buffer(), blockOffsets.Size() * sizeof(unsigned));
+                dest.Seek(endOffset);
+            }
+
             if (!quiet_)
             {
                 unsigned totalPackedBytes = dest.GetSize() - lastOffset;
@@ -338,8 +366,12 @@ void WriteHeader(File& dest)
 {
     if (!compress_)
         dest.WriteFileID("UPAK");
-    else
+    else if (!blockIndex_)
         dest.WriteFileID("ULZ4");
+    else
+        dest.WriteFileID("ULZI");
     dest.WriteUInt(entries_.Size());
     dest.WriteUInt(checksum_);
+    if (compress_ && blockIndex_)
+        dest.WriteUInt(blockSize_);
 }
@@ -0,0 +1,651 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Graphics/AnimatedModel.h>
+#include <Urho3D/Graphics/AnimationController.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Graphics.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/ParticleEffect.h>
+#include <Urho3D/Graphics/ParticleEmitter.h>
+#include <Urho3D/Graphics/Renderer.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Viewport.h>
+#include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/Resource/JSONFile.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/ValueAnimation.h>
+
+#ifdef URHO3D_NULL_GRAPHICS
+#include <Urho3D/Graphics/GraphicsImpl.h>
+#endif
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <cstdlib>
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+/// Profiler blocks reported as renderer phases. The times are inclusive, so for example GetBatches contains ProcessLights.
+static const char* phaseNames[] =
+{
+    "UpdateScene",
+    "UpdateDrawables",
+    "ReinsertToOctree",
+    "UpdateViews",
+    "GetDrawables",
+    "ProcessLights",
+    "GetBatches",
+    "SortAndUpdateGeometry",
+    "PrepareInstancingBuffer",
+    "RenderViews",
+    nullptr
+};
+
+/// Built-in benchmark scenes and their default object counts.
+static const char* sceneNames[] = { "static", "lights", "animated", "particles", "moving", nullptr };
+static const unsigned defaultSceneObjects[] = { 20000, 200, 2000, 500, 20000 };
+
+SharedPtr<Context> context_(new Context());
+SharedPtr<Engine> engine_;
+unsigned numFrames_ = 300;
+unsigned numWarmupFrames_ = 10;
+unsigned numObjects_ = 0;
+int numThreads_ = -1;
+int width_ = 1280;
+int height_ = 720;
+bool cacheLightQueries_ = true;
+bool nodeFreePose_ = false;
+float poseSharingStep_ = 0.0f;
+String prefixPaths_ = ";..";
+String outputName_;
+
+int main(int argc, char** argv);
+void Run(const Vector<String>& arguments);
+SharedPtr<Scene> CreateScene(const String& name, unsigned numObjects);
+JSONValue RunScene(Scene* scene, const String& name, unsigned numObjects);
+
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+    #ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+    #else
+    arguments = ParseArguments(argc, argv);
+    #endif
+
+    Run(arguments);
+
+    // Shut down before the statics of the graphics subsystem are destroyed at exit
+    engine_.Reset();
+    context_.Reset();
+    return 0;
+}
+
+void Run(const Vector<String>& arguments)
+{
+    if (arguments.Size() < 1)
+        ErrorExit(
+            "Usage: RendererBenchmark <scene> [options]\n"
+            "\n"
+            "Renders a scene for a fixed number of frames along a fixed camera orbit with a fixed time step, and writes\n"
+            "the per-phase CPU timings of the renderer as JSON. Built with URHO3D_NULL_GRAPHICS the benchmark needs no GPU\n"
+            "or display, and also reports the null backend's vertex, state change and upload counts.\n"
+            "\n"
+            "Scenes:\n"
+            "static     StaticModels with mixed models and materials, one shadowed directional light (default 20000 objects)\n"
+            "lights     Shadowed point and spot lights over a field of StaticModels (default 200 lights)\n"
+            "animated   Walking AnimatedModels (default 2000 objects)\n"
+            "particles  Particle emitters with fire, smoke and dust effects (default 500 emitters)\n"
+            "moving     StaticModels orbiting rotating pivot nodes, so all are reinserted to the octree each frame (default 20000 objects)\n"
+            "all        Run all the above scenes in sequence\n"
+            "<file>     Load a scene file (.xml, .json or binary) relative to the resource directories or as an absolute path\n"
+            "\n"
+            "Options:\n"
+            "-f <num>   Number of measured frames, default 300\n"
+            "-w <num>   Number of warmup frames, default 10\n"
+            "-n <num>   Number of objects in a built-in scene, default depends on the scene\n"
+            "-t <num>   Number of worker threads, default one less than the number of logical CPUs\n"
+            "-x <num>   View width, default 1280\n"
+            "-y <num>   View height, default 720\n"
+            "-c <0|1>   Cache the octree queries of point and spot lights between frames, default 1\n"
+            "-a <0|1>   Keep the skeleton poses of the animated scene without bone scene nodes, default 0\n"
+            "-s <secs>  Round the animation time of the animated scene's node-free poses to share them between models, default 0\n"
+            "-p <paths> Resource prefix paths separated by ';', relative to the executable, default URHO3D_PREFIX_PATH env-var or ';..'\n"
+            "-o <file>  Write the JSON report to a file instead of the standard output\n"
+        );
+
+    if (const char* paths = getenv("URHO3D_PREFIX_PATH"))
+        prefixPaths_ = paths;
+
+    for (unsigned i = 1; i < arguments.Size(); ++i)
+    {
+        if (arguments[i].Length() > 1 && arguments[i][0] == '-' && i + 1 < arguments.Size())
+        {
+            const String& value = arguments[++i];
+            switch (arguments[i - 1][1])
+            {
+            case 'f':
+                numFrames_ = Max(ToUInt(value), 1U);
+                break;
+            case 'w':
+                numWarmupFrames_ = ToUInt(value);
+                break;
+            case 'n':
+                numObjects_ = Max(ToUInt(value), 1U);
+                break;
+            case 't':
+                numThreads_ = ToInt(value);
+                break;
+            case 'x':
+                width_ = Max(ToInt(value), 1);
+                break;
+            case 'y':
+                height_ = Max(ToInt(value), 1);
+                break;
+            case 'c':
+                cacheLightQueries_ = ToBool(value);
+                break;
+            case 'a':
+                nodeFreePose_ = ToBool(value);
+                break;
+            case 's':
+                poseSharingStep_ = Max(ToFloat(value), 0.0f);
+                break;
+            case 'p':
+                prefixPaths_ = value;
+                break;
+            case 'o':
+                outputName_ = value;
+                break;
+            default:
+                ErrorExit("Unrecognized option " + arguments[i - 1]);
+            }
+        }
+    }
+
+    VariantMap engineParameters;
+    engineParameters[EP_WINDOW_TITLE] = "RendererBenchmark";
+    engineParameters[EP_WINDOW_WIDTH] = width_;
+    engineParameters[EP_WINDOW_HEIGHT] = height_;
+    engineParameters[EP_FULL_SCREEN] = false;
+    engineParameters[EP_VSYNC] = false;
+    engineParameters[EP_FRAME_LIMITER] = false;
+    engineParameters[EP_SOUND] = false;
+    engineParameters[EP_LOG_NAME] = String::EMPTY;
+    engineParameters[EP_LOG_QUIET] = true;
+    engineParameters[EP_RESOURCE_PREFIX_PATHS] = prefixPaths_;
+    if (numThreads_ >= 0)
+        engineParameters[EP_WORKER_THREADS] = false;
+
+    engine_ = new Engine(context_);
+    if (!engine_->Initialize(engineParameters))
+        ErrorExit("Could not initialize the engine");
+    if (numThreads_ > 0)
+        context_->GetSubsystem<WorkQueue>()->CreateThreads((unsigned)numThreads_);
+    context_->GetSubsystem<Renderer>()->SetCacheLightQueries(cacheLightQueries_);
+
+    Vector<String> names;
+    String sceneName = arguments[0];
+    if (sceneName.ToLower() == "all")
+    {
+        for (unsigned i = 0; sceneNames[i]; ++i)
+            names.Push(sceneNames[i]);
+    }
+    else
+        names.Push(sceneName);
+
+    JSONFile report(context_);
+    JSONValue& root = report.GetRoot();
+    root.Set("graphicsApi", context_->GetSubsystem<Graphics>()->GetApiName());
+    root.Set("workerThreads", context_->GetSubsystem<WorkQueue>()->GetNumThreads());
+    root.Set("width", width_);
+    root.Set("height", height_);
+    root.Set("cacheLightQueries", cacheLightQueries_);
+    root.Set("nodeFreePose", nodeFreePose_);
+    root.Set("poseSharingStep", poseSharingStep_);
+    root.Set("frames", numFrames_);
+    root.Set("warmupFrames", numWarmupFrames_);
+    root.Set("profiling", context_->GetSubsystem<Profiler>() != nullptr);
+
+    JSONArray scenes;
+    for (unsigned i = 0; i < names.Size(); ++i)
+    {
+        unsigned numObjects = numObjects_;
+        for (unsigned j = 0; sceneNames[j]; ++j)
+        {
+            if (names[i].ToLower() == sceneNames[j] && !numObjects)
+                numObjects = defaultSceneObjects[j];
+        }
+
+        SharedPtr<Scene> scene = CreateScene(names[i], numObjects);
+        scenes.Push(RunScene(scene, names[i], numObjects));
+    }
+    root.Set("scenes", scenes);
+
+    if (outputName_.Empty())
+        PrintLine(report.ToString("  "));
+    else
+    {
+        File outFile(context_, outputName_, FILE_WRITE);
+        if (!outFile.IsOpen() || !report.Save(outFile, "  "))
+            ErrorExit("Could not write report " + outputName_);
+    }
+
+    engine_->Exit();
+}
+
+/// Create the octree, zone and a ground plane common to the built-in scenes, sized to contain a square of the given half size.
+static void CreateSceneBase(Scene* scene, float halfSize, const Color& ambientColor)
+{
+    auto* cache = context_->GetSubsystem<ResourceCache>();
+
+    auto* octree = scene->CreateComponent<Octree>();
+    octree->SetSize(BoundingBox(Vector3(-halfSize - 100.0f, -100.0f, -halfSize - 100.0f), Vector3(halfSize + 100.0f, 200.0f,
+        halfSize + 100.0f)), 8);
+
+    Node* zoneNode = scene->CreateChild("Zone");
+    auto* zone = zoneNode->CreateComponent<Zone>();
+    zone->SetBoundingBox(BoundingBox(Vector3(-halfSize - 100.0f, -100.0f, -halfSize - 100.0f), Vector3(halfSize + 100.0f, 200.0f,
+        halfSize + 100.0f)));
+    zone->SetAmbientColor(ambientColor);
+    zone->SetFogColor(Color(0.5f, 0.5f, 0.7f));
+    zone->SetFogStart(halfSize * 2.0f);
+    zone->SetFogEnd(halfSize * 3.0f);
+
+    Node* planeNode = scene->CreateChild("Plane");
+    planeNode->SetScale(Vector3(halfSize * 2.0f, 1.0f, halfSize * 2.0f));
+    auto* plane = planeNode->CreateComponent<StaticModel>();
+    plane->SetModel(cache->GetResource<Model>("Models/Plane.mdl"));
+    plane->SetMaterial(cache->GetResource<Material>("Materials/StoneTiled.xml"));
+}
+
+/// Return the half size of a square grid holding the given number of objects at the given spacing.
+static float GetGridHalfSize(unsigned numObjects, float spacing)
+{
+    return (float)CeilToInt(Sqrt((float)numObjects)) * spacing * 0.5f;
+}
+
+/// Return the position of a grid cell with a random offset.
+static Vector3 GetGridPosition(unsigned index, unsigned numObjects, float spacing)
+{
+    auto side = (unsigned)CeilToInt(Sqrt((float)numObjects));
+    float halfSize = GetGridHalfSize(numObjects, spacing);
+    return Vector3((float)(index % side) * spacing - halfSize + Random(spacing * 0.5f), 0.0f,
+        (float)(index / side) * spacing - halfSize + Random(spacing * 0.5f));
+}
+
+/// Create static models in a grid. Optionally return their nodes.
+static void CreateStaticModels(Scene* scene, unsigned numObjects, float spacing, PODVector<Node*>* nodes = nullptr)
+{
+    static const char* modelNames[] = { "Models/Box.mdl", "Models/Sphere.mdl", "Models/Cylinder.mdl", "Models/Cone.mdl",
+        "Models/Pyramid.mdl", "Models/Mushroom.mdl", "Models/TeaPot.mdl", nullptr };
+    static const char* materialNames[] = { "Materials/Stone.xml", "Materials/StoneSmall.xml", "Materials/Mushroom.xml",
+        "Materials/Jack.xml", nullptr };
+
+    auto* cache = context_->GetSubsystem<ResourceCache>();
+    Vector<SharedPtr<Model> > models;
+    Vector<SharedPtr<Material> > materials;
+    for (unsigned i = 0; modelNames[i]; ++i)
+        models.Push(SharedPtr<Model>(cache->GetResource<Model>(modelNames[i])));
+    for (unsigned i = 0; materialNames[i]; ++i)
+        materials.Push(SharedPtr<Material>(cache->GetResource<Material>(materialNames[i])));
+
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        Node* node = scene->CreateChild("StaticModel");
+        node->SetPosition(GetGridPosition(i, numObjects, spacing) + Vector3(0.0f, 0.5f, 0.0f));
+        node->SetRotation(Quaternion(0.0f, Random(360.0f), 0.0f));
+        node->SetScale(0.5f + Random(1.0f));
+        auto* object = node->CreateComponent<StaticModel>();
+        object->SetModel(models[i % models.Size()]);
+        object->SetMaterial(materials[(i / models.Size()) % materials.Size()]);
+        object->SetCastShadows(true);
+        if (nodes)
+            nodes->Push(node);
+    }
+}
+
+/// Create a shadowed directional light.
+static void CreateDirectionalLight(Scene* scene)
+{
+    Node* lightNode = scene->CreateChild("DirectionalLight");
+    lightNode->SetDirection(Vector3(0.6f, -1.0f, 0.8f));
+    auto* light = lightNode->CreateComponent<Light>();
+    light->SetLightType(LIGHT_DIRECTIONAL);
+    light->SetCastShadows(true);
+    light->SetShadowCascade(CascadeParameters(10.0f, 50.0f, 200.0f, 0.0f, 0.8f));
+}
+
+SharedPtr<Scene> CreateScene(const String& name, unsigned numObjects)
+{
+    auto* cache = context_->GetSubsystem<ResourceCache>();
+    SharedPtr<Scene> scene(new Scene(context_));
+    String lowerName = name.ToLower();
+
+    // Use the same pseudo-random placement on every run
+    SetRandomSeed(1);
+
+    if (lowerName == "static")
+    {
+        float spacing = 4.0f;
+        CreateSceneBase(scene, GetGridHalfSize(numObjects, spacing), Color(0.15f, 0.15f, 0.15f));
+        CreateStaticModels(scene, numObjects, spacing);
+        CreateDirectionalLight(scene);
+    }
+    else if (lowerName == "lights")
+    {
+        // Place the lights on their own, sparser grid above a dense field of objects
+        float lightSpacing = 12.0f;
+        float halfSize = GetGridHalfSize(numObjects, lightSpacing);
+        auto numStatic = (unsigned)(halfSize * halfSize * 0.25f);
+        CreateSceneBase(scene, halfSize, Color(0.05f, 0.05f, 0.05f));
+        CreateStaticModels(scene, numStatic, halfSize * 2.0f / Sqrt((float)numStatic));
+
+        for (unsigned i = 0; i < numObjects; ++i)
+        {
+            Node* lightNode = scene->CreateChild("Light");
+            lightNode->SetPosition(GetGridPosition(i, numObjects, lightSpacing) + Vector3(0.0f, 4.0f + Random(4.0f), 0.0f));
+            auto* light = lightNode->CreateComponent<Light>();
+            light->SetColor(Color(0.5f + Random(0.5f), 0.5f + Random(0.5f), 0.5f + Random(0.5f)));
+            light->SetRange(lightSpacing * 1.5f);
+            light->SetCastShadows(true);
+            if (i & 1u)
+            {
+                lightNode->SetDirection(Vector3(Random(2.0f) - 1.0f, -1.0f, Random(2.0f) - 1.0f));
+                light->SetLightType(LIGHT_SPOT);
+                light->SetFov(60.0f);
+            }
+            else
+                light->SetLightType(LIGHT_POINT);
+        }
+    }
+    else if (lowerName == "animated")
+    {
+        float spacing = 3.0f;
+        CreateSceneBase(scene, GetGridHalfSize(numObjects, spacing), Color(0.15f, 0.15f, 0.15f));
+        CreateDirectionalLight(scene);
+
+        auto* model = cache->GetResource<Model>("Models/Kachujin/Kachujin.mdl");
+        auto* material = cache->GetResource<Material>("Models/Kachujin/Materials/Kachujin.xml");
+        const String animationName("Models/Kachujin/Kachujin_Walk.ani");
+        for (unsigned i = 0; i < numObjects; ++i)
+        {
+            Node* node = scene->CreateChild("AnimatedModel");
+            node->SetPosition(GetGridPosition(i, numObjects, spacing));
+            node->SetRotation(Quaternion(0.0f, Random(360.0f), 0.0f));
+            auto* object = node->CreateComponent<AnimatedModel>();
+            object->SetNodeFreePose(nodeFreePose_);
+            object->SetPoseSharingStep(poseSharingStep_);
+            object->SetModel(model);
+            object->SetMaterial(material);
+            object->SetCastShadows(true);
+            auto* controller = node->CreateComponent<AnimationController>();
+            controller->PlayExclusive(animationName, 0, true);
+            controller->SetTime(animationName, Random(1.0f));
+        }
+    }
+    else if (lowerName == "moving")
+    {
+        float spacing = 4.0f;
+        float pivotSpacing = spacing * 8.0f;
+        float halfSize = GetGridHalfSize(numObjects, spacing);
+        CreateSceneBase(scene, halfSize, Color(0.15f, 0.15f, 0.15f));
+        PODVector<Node*> nodes;
+        CreateStaticModels(scene, numObjects, spacing, &nodes);
+        CreateDirectionalLight(scene);
+
+        // Group the objects under pivot nodes that spin around the Y axis with attribute animation
+        SharedPtr<ValueAnimation> spin(new ValueAnimation(context_));
+        spin->SetKeyFrame(0.0f, Quaternion::IDENTITY);
+        spin->SetKeyFrame(2.0f, Quaternion(120.0f, Vector3::UP));
+        spin->SetKeyFrame(4.0f, Quaternion(240.0f, Vector3::UP));
+        spin->SetKeyFrame(6.0f, Quaternion(360.0f, Vector3::UP));
+
+        auto side = (unsigned)CeilToInt(halfSize * 2.0f / pivotSpacing);
+        PODVector<Node*> pivots(side * side, nullptr);
+        for (unsigned i = 0; i < nodes.Size(); ++i)
+        {
+            Vector3 position = nodes[i]->GetPosition();
+            auto x = (unsigned)Clamp(FloorToInt((position.x_ + halfSize) / pivotSpacing), 0, (int)side - 1);
+            auto z = (unsigned)Clamp(FloorToInt((position.z_ + halfSize) / pivotSpacing), 0, (int)side - 1);
+            Node*& pivot = pivots[z * side + x];
+            if (!pivot)
+            {
+                pivot = scene->CreateChild("Pivot");
+                pivot->SetPosition(Vector3(((float)x + 0.5f) * pivotSpacing - halfSize, 0.0f, ((float)z + 0.5f) * pivotSpacing - halfSize));
+                pivot->SetAttributeAnimation("Rotation", spin, WM_LOOP);
+            }
+            nodes[i]->SetParent(pivot);
+        }
+    }
+    else if (lowerName == "particles")
+    {
+        static const char* effectNames[] = { "Particle/Fire.xml", "Particle/Smoke.xml", "Particle/Dust.xml", "Particle/SmokeStack.xml",
+            nullptr };
+
+        float spacing = 6.0f;
+        CreateSceneBase(scene, GetGridHalfSize(numObjects, spacing), Color(0.3f, 0.3f, 0.3f));
+        CreateDirectionalLight(scene);
+
+        Vector<SharedPtr<ParticleEffect> > effects;
+        for (unsigned i = 0; effectNames[i]; ++i)
+            effects.Push(SharedPtr<ParticleEffect>(cache->GetResource<ParticleEffect>(effectNames[i])));
+
+        for (unsigned i = 0; i < numObjects; ++i)
+        {
+            Node* node = scene->CreateChild("ParticleEmitter");
+            node->SetPosition(GetGridPosition(i, numObjects, spacing));
+            auto* emitter = node->CreateComponent<ParticleEmitter>();
+            emitter->SetEffect(effects[i % effects.Size()]);
+        }
+    }
+    else
+    {
+        // Load a scene file, either through the resource cache or as an absolute path
+        SharedPtr<File> file;
+        if (IsAbsolutePath(name))
+            file = new File(context_, name);
+        else
+            file = cache->GetFile(name);
+        if (!file || !file->IsOpen())
+            ErrorExit("Unrecognized scene or scene file not found: " + name);
+
+        String extension = GetExtension(name);
+        bool success;
+        if (extension == ".xml")
+            success = scene->LoadXML(*file);
+        else if (extension == ".json")
+            success = scene->LoadJSON(*file);
+        else
+            success = scene->Load(*file);
+        if (!success || !scene->GetComponent<Octree>())
+            ErrorExit("Could not load scene " + name + " or it has no octree");
+    }
+
+    return scene;
+}
+
+/// Per-frame samples of one measured value.
+struct Samples
+{
+    /// Add a sample.
+    void Add(double value) { values_.Push(value); }
+
+    /// Return the mean, median, minimum and maximum as a JSON object.
+    JSONValue ToJSON() const
+    {
+        JSONValue result;
+        if (values_.Empty())
+            return result;
+
+        PODVector<double> sorted = values_;
+        Sort(sorted.Begin(), sorted.End());
+        double sum = 0.0;
+        for (unsigned i = 0; i < sorted.Size(); ++i)
+            sum += sorted[i];
+
+        result.Set("mean", sum / (double)sorted.Size());
+        result.Set("median", sorted[sorted.Size() / 2]);
+        result.Set("min", sorted.Front());
+        result.Set("max", sorted.Back());
+        return result;
+    }
+
+    /// Sample values.
+    PODVector<double> values_;
+};
+
+/// Accumulate the previous frame's time in microseconds of each profiler block by name.
+static void CollectBlockTimes(const ProfilerBlock* block, HashMap<String, long long>& times)
+{
+    if (block->frameCount_)
+        times[String(block->name_)] += block->frameTime_;
+
+    for (unsigned i = 0; i < block->children_.Size(); ++i)
+        CollectBlockTimes(block->children_[i], times);
+}
+
+JSONValue RunScene(Scene* scene, const String& name, unsigned numObjects)
+{
+    auto* graphics = context_->GetSubsystem<Graphics>();
+    auto* renderer = context_->GetSubsystem<Renderer>();
+    auto* profiler = context_->GetSubsystem<Profiler>();
+
+    // Orbit the camera around the content of the scene
+    PODVector<Drawable*> drawables;
+    scene->GetDerivedComponents<Drawable>(drawables, true);
+    BoundingBox bounds;
+    for (unsigned i = 0; i < drawables.Size(); ++i)
+    {
+        if (drawables[i]->GetDrawableFlags() & DRAWABLE_GEOMETRY)
+            bounds.Merge(drawables[i]->GetWorldBoundingBox());
+    }
+    if (!bounds.Defined())
+        bounds = BoundingBox(-10.0f, 10.0f);
+    Vector3 center = bounds.Center();
+    float radius = Max(bounds.HalfSize().Length(), 10.0f);
+
+    Node* cameraNode = scene->CreateChild("BenchmarkCamera");
+    auto* camera = cameraNode->CreateComponent<Camera>();
+    camera->SetFarClip(radius * 3.0f);
+    renderer->SetViewport(0, new Viewport(context_, scene, camera));
+
+    Samples frameTimes;
+    HashMap<String, Samples> phaseTimes;
+    Samples batches;
+    Samples primitives;
+#ifdef URHO3D_NULL_GRAPHICS
+    Samples vertices;
+    Samples shaderChanges;
+    Samples stateChanges;
+    Samples uploadBytes;
+#endif
+
+    HashMap<String, long long> blockTimes;
+    HiresTimer timer;
+    const float timeStep = 1.0f / 60.0f;
+
+    for (unsigned frame = 0; frame < numWarmupFrames_ + numFrames_; ++frame)
+    {
+        float angle = 360.0f * (float)frame / (float)(numWarmupFrames_ + numFrames_);
+        cameraNode->SetPosition(center + Vector3(Cos(angle) * radius * 0.6f, radius * (0.25f + 0.1f * Sin(angle * 3.0f)),
+            Sin(angle) * radius * 0.6f));
+        cameraNode->LookAt(center);
+
+        engine_->SetNextTimeStep(timeStep);
+        timer.Reset();
+        engine_->RunFrame();
+        long long frameTime = timer.GetUSec(false);
+
+        if (frame < numWarmupFrames_)
+            continue;
+
+        frameTimes.Add((double)frameTime / 1000.0);
+        if (profiler)
+        {
+            blockTimes.Clear();
+            CollectBlockTimes(profiler->GetRootBlock(), blockTimes);
+            for (unsigned i = 0; phaseNames[i]; ++i)
+            {
+                HashMap<String, long long>::ConstIterator j = blockTimes.Find(phaseNames[i]);
+                phaseTimes[phaseNames[i]].Add(j != blockTimes.End() ? (double)j->second_ / 1000.0 : 0.0);
+            }
+        }
+
+        batches.Add((double)graphics->GetNumBatches());
+        primitives.Add((double)graphics->GetNumPrimitives());
+#ifdef URHO3D_NULL_GRAPHICS
+        GraphicsImpl* impl = graphics->GetImpl();
+        vertices.Add((double)impl->GetNumVertices());
+        shaderChanges.Add((double)impl->GetNumShaderChanges());
+        stateChanges.Add((double)impl->GetNumStateChanges());
+        uploadBytes.Add((double)impl->GetUploadBytes());
+#endif
+    }
+
+    renderer->SetViewport(0, nullptr);
+
+    JSONValue result;
+    result.Set("name", name);
+    if (numObjects)
+        result.Set("objects", numObjects);
+    result.Set("drawables", drawables.Size());
+    result.Set("frameTime", frameTimes.ToJSON());
+
+    JSONValue phases;
+    for (unsigned i = 0; phaseNames[i] && profiler; ++i)
+        phases.Set(phaseNames[i], phaseTimes[phaseNames[i]].ToJSON());
+    result.Set("phases", phases);
+
+    JSONValue stats;
+    stats.Set("batches", batches.ToJSON());
+    stats.Set("primitives", primitives.ToJSON());
+#ifdef URHO3D_NULL_GRAPHICS
+    stats.Set("vertices", vertices.ToJSON());
+    stats.Set("shaderChanges", shaderChanges.ToJSON());
+    stats.Set("stateChanges", stateChanges.ToJSON());
+    stats.Set("uploadBytes", uploadBytes.ToJSON());
+#endif
+    result.Set("stats", stats);
+
+    return result;
+}
@@ -1690,6 +1690,12 @@ void ASRegisterGeneratedEnums(asIScriptEngine* engine)
     // URHO3D_FLAGSET(SmoothingType, SmoothingTypeFlags) | File: ../Scene/SmoothedTransform.h
     engine->RegisterTypedef("SmoothingTypeFlags", "uint");
 
+    // enum SpatialIndexType | File: ../Graphics/SpatialIndex.h
+    engine->RegisterEnum("SpatialIndexType");
+    engine->RegisterEnumValue("SpatialIndexType", "SPATIAL_INDEX_OCTREE", SPATIAL_INDEX_OCTREE);
+    engine->RegisterEnumValue("SpatialIndexType", "SPATIAL_INDEX_AABB_TREE", SPATIAL_INDEX_AABB_TREE);
+    engine->RegisterEnumValue("SpatialIndexType", "SPATIAL_INDEX_CUSTOM", SPATIAL_INDEX_CUSTOM);
+
     // enum StencilOp | File: ../Graphics/GraphicsDefs.h
     engine->RegisterEnum("StencilOp");
     engine->RegisterEnumValue("StencilOp", "OP_KEEP", OP_KEEP);
@@ -1827,6 +1833,8 @@ void ASRegisterGeneratedEnums(asIScriptEngine* engine)
     engine->RegisterEnumValue("VertexElementType", "TYPE_VECTOR4", TYPE_VECTOR4);
     engine->RegisterEnumValue("VertexElementType", "TYPE_UBYTE4", TYPE_UBYTE4);
     engine->RegisterEnumValue("VertexElementType", "TYPE_UBYTE4_NORM", TYPE_UBYTE4_NORM);
+    engine->RegisterEnumValue("VertexElementType", "TYPE_HALF2", TYPE_HALF2);
+    engine->RegisterEnumValue("VertexElementType", "TYPE_SHORT4_NORM", TYPE_SHORT4_NORM);
     engine->RegisterEnumValue("VertexElementType", "MAX_VERTEX_ELEMENT_TYPES", MAX_VERTEX_ELEMENT_TYPES);
 
     // enum VertexLightVSVariation | File: ../Graphics/Renderer.h
@@ -244,6 +244,9 @@ void ASRegisterGeneratedGlobalVariables(asIScriptEngine* engine)
     // static const String EP_WORKER_THREADS | File: ../Engine/EngineDefs.h
     engine->RegisterGlobalProperty("const String EP_WORKER_THREADS", (void*)&EP_WORKER_THREADS);
 
+    // static const String EP_WORK_STEALING | File: ../Engine/EngineDefs.h
+    engine->RegisterGlobalProperty("const String EP_WORK_STEALING", (void*)&EP_WORK_STEALING);
+
     // static const unsigned FIRST_LOCAL_ID | File: ../Scene/Scene.h
     engine->RegisterGlobalProperty("const uint FIRST_LOCAL_ID", (void*)&FIRST_LOCAL_ID);
 
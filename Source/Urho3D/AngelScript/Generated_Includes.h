@@ -56,6 +56,7 @@
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/DecalSet.h"
 #include "../Graphics/Drawable.h"
+#include "../Graphics/DynamicAABBTree.h"
 #include "../Graphics/GPUObject.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
@@ -78,6 +79,7 @@
 #include "../Graphics/ShaderVariation.h"
 #include "../Graphics/Skeleton.h"
 #include "../Graphics/Skybox.h"
+#include "../Graphics/SpatialIndex.h"
 #include "../Graphics/StaticModel.h"
 #include "../Graphics/StaticModelGroup.h"
 #include "../Graphics/Tangent.h"
@@ -123,6 +123,18 @@ template <class T> void RegisterMembers_AnimationStateTrack(asIScriptEngine* eng
     // unsigned AnimationStateTrack::keyFrame_
     engine->RegisterObjectProperty(className, "uint keyFrame", offsetof(T, keyFrame_));
 
+    // Vector3 AnimationStateTrack::position_
+    engine->RegisterObjectProperty(className, "Vector3 position", offsetof(T, position_));
+
+    // Quaternion AnimationStateTrack::rotation_
+    engine->RegisterObjectProperty(className, "Quaternion rotation", offsetof(T, rotation_));
+
+    // Vector3 AnimationStateTrack::scale_
+    engine->RegisterObjectProperty(className, "Vector3 scale", offsetof(T, scale_));
+
+    // bool AnimationStateTrack::sampled_
+    engine->RegisterObjectProperty(className, "bool sampled", offsetof(T, sampled_));
+
     #ifdef REGISTER_MEMBERS_MANUAL_PART_AnimationStateTrack
         REGISTER_MEMBERS_MANUAL_PART_AnimationStateTrack();
     #endif
@@ -137,6 +149,15 @@ template <class T> void RegisterMembers_AnimationTrack(asIScriptEngine* engine,
     // void AnimationTrack::AddKeyFrame(const AnimationKeyFrame& keyFrame)
     engine->RegisterObjectMethod(className, "void AddKeyFrame(const AnimationKeyFrame&in)", AS_METHODPR(T, AddKeyFrame, (const AnimationKeyFrame&), void), AS_CALL_THISCALL);
 
+    // void AnimationTrack::Compress(float positionTolerance, float rotationTolerance, float scaleTolerance)
+    engine->RegisterObjectMethod(className, "void Compress(float, float, float)", AS_METHODPR(T, Compress, (float, float, float), void), AS_CALL_THISCALL);
+
+    // void AnimationTrack::Decompress()
+    engine->RegisterObjectMethod(className, "void Decompress()", AS_METHODPR(T, Decompress, (), void), AS_CALL_THISCALL);
+
+    // void AnimationTrack::DecompressKeyFrame(unsigned index, AnimationKeyFrame& dest) const
+    engine->RegisterObjectMethod(className, "void DecompressKeyFrame(uint, AnimationKeyFrame&out) const", AS_METHODPR(T, DecompressKeyFrame, (unsigned, AnimationKeyFrame&) const, void), AS_CALL_THISCALL);
+
     // bool AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
     engine->RegisterObjectMethod(className, "bool GetKeyFrameIndex(float, uint&) const", AS_METHODPR(T, GetKeyFrameIndex, (float, unsigned&) const, bool), AS_CALL_THISCALL);
 
@@ -144,6 +165,9 @@ template <class T> void RegisterMembers_AnimationTrack(asIScriptEngine* engine,
     engine->RegisterObjectMethod(className, "uint GetNumKeyFrames() const", AS_METHODPR(T, GetNumKeyFrames, () const, unsigned), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "uint get_numKeyFrames() const", AS_METHODPR(T, GetNumKeyFrames, () const, unsigned), AS_CALL_THISCALL);
 
+    // bool AnimationTrack::IsCompressed() const
+    engine->RegisterObjectMethod(className, "bool IsCompressed() const", AS_METHODPR(T, IsCompressed, () const, bool), AS_CALL_THISCALL);
+
     // void AnimationTrack::InsertKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
     engine->RegisterObjectMethod(className, "void InsertKeyFrame(uint, const AnimationKeyFrame&in)", AS_METHODPR(T, InsertKeyFrame, (unsigned, const AnimationKeyFrame&), void), AS_CALL_THISCALL);
 
@@ -157,9 +181,18 @@ template <class T> void RegisterMembers_AnimationTrack(asIScriptEngine* engine,
     engine->RegisterObjectMethod(className, "void SetKeyFrame(uint, const AnimationKeyFrame&in)", AS_METHODPR(T, SetKeyFrame, (unsigned, const AnimationKeyFrame&), void), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "void set_keyFrames(uint, const AnimationKeyFrame&in)", AS_METHODPR(T, SetKeyFrame, (unsigned, const AnimationKeyFrame&), void), AS_CALL_THISCALL);
 
+    // void AnimationTrack::UpdateKeyFrameTimes()
+    engine->RegisterObjectMethod(className, "void UpdateKeyFrameTimes()", AS_METHODPR(T, UpdateKeyFrameTimes, (), void), AS_CALL_THISCALL);
+
     // Vector<AnimationKeyFrame> AnimationTrack::keyFrames_
     // Error: type "Vector<AnimationKeyFrame>" can not automatically bind
 
+    // PODVector<float> AnimationTrack::keyFrameTimes_
+    // Error: type "PODVector<float>" can not automatically bind
+
+    // PODVector<unsigned short> AnimationTrack::compressedKeyFrames_
+    // Error: type "PODVector<unsigned short>" can not automatically bind
+
     // String AnimationTrack::name_
     engine->RegisterObjectProperty(className, "String name", offsetof(T, name_));
 
@@ -169,6 +202,24 @@ template <class T> void RegisterMembers_AnimationTrack(asIScriptEngine* engine,
     // AnimationChannelFlags AnimationTrack::channelMask_
     engine->RegisterObjectProperty(className, "AnimationChannelFlags channelMask", offsetof(T, channelMask_));
 
+    // Vector3 AnimationTrack::positionMin_
+    engine->RegisterObjectProperty(className, "Vector3 positionMin", offsetof(T, positionMin_));
+
+    // Vector3 AnimationTrack::positionRange_
+    engine->RegisterObjectProperty(className, "Vector3 positionRange", offsetof(T, positionRange_));
+
+    // Vector3 AnimationTrack::scaleMin_
+    engine->RegisterObjectProperty(className, "Vector3 scaleMin", offsetof(T, scaleMin_));
+
+    // Vector3 AnimationTrack::scaleRange_
+    engine->RegisterObjectProperty(className, "Vector3 scaleRange", offsetof(T, scaleRange_));
+
+    // bool AnimationTrack::compressed_
+    engine->RegisterObjectProperty(className, "bool compressed", offsetof(T, compressed_));
+
+    // Animation* AnimationTrack::animation_
+    // Not registered because pointer
+
     #ifdef REGISTER_MEMBERS_MANUAL_PART_AnimationTrack
         REGISTER_MEMBERS_MANUAL_PART_AnimationTrack();
     #endif
@@ -410,12 +461,24 @@ template <class T> void RegisterMembers_BatchGroupKey(asIScriptEngine* engine, c
     #endif
 }
 
+// void BatchQueue::SortBackToFront(FrameArena* arena = nullptr)
+template <class T> void BatchQueue_void_SortBackToFront_void_template(T* _ptr)
+{
+    _ptr->SortBackToFront();
+}
+
+// void BatchQueue::SortFrontToBack(FrameArena* arena = nullptr)
+template <class T> void BatchQueue_void_SortFrontToBack_void_template(T* _ptr)
+{
+    _ptr->SortFrontToBack();
+}
+
 // struct BatchQueue | File: ../Graphics/Batch.h
 template <class T> void RegisterMembers_BatchQueue(asIScriptEngine* engine, const char* className)
 {
     // void BatchQueue::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
     // Error: type "void*" can not automatically bind
-    // void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
+    // void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches, FrameArena* arena = nullptr)
     // Error: type "PODVector<Batch*>&" can not automatically bind
 
     // void BatchQueue::Clear(int maxSortedInstances)
@@ -430,11 +493,11 @@ template <class T> void RegisterMembers_BatchQueue(asIScriptEngine* engine, cons
     // bool BatchQueue::IsEmpty() const
     engine->RegisterObjectMethod(className, "bool IsEmpty() const", AS_METHODPR(T, IsEmpty, () const, bool), AS_CALL_THISCALL);
 
-    // void BatchQueue::SortBackToFront()
-    engine->RegisterObjectMethod(className, "void SortBackToFront()", AS_METHODPR(T, SortBackToFront, (), void), AS_CALL_THISCALL);
+    // void BatchQueue::SortBackToFront(FrameArena* arena = nullptr)
+    engine->RegisterObjectMethod(className, "void SortBackToFront()", AS_FUNCTION_OBJFIRST(BatchQueue_void_SortBackToFront_void_template<T>), AS_CALL_CDECL_OBJFIRST);
 
-    // void BatchQueue::SortFrontToBack()
-    engine->RegisterObjectMethod(className, "void SortFrontToBack()", AS_METHODPR(T, SortFrontToBack, (), void), AS_CALL_THISCALL);
+    // void BatchQueue::SortFrontToBack(FrameArena* arena = nullptr)
+    engine->RegisterObjectMethod(className, "void SortFrontToBack()", AS_FUNCTION_OBJFIRST(BatchQueue_void_SortFrontToBack_void_template<T>), AS_CALL_CDECL_OBJFIRST);
 
     // HashMap<BatchGroupKey, BatchGroup> BatchQueue::batchGroups_
     // Error: type "HashMap<BatchGroupKey, BatchGroup>" can not automatically bind
@@ -3138,9 +3201,6 @@ template <class T> void RegisterMembers_OcclusionBufferData(asIScriptEngine* eng
     // int* OcclusionBufferData::data_
     // Not registered because pointer
 
-    // bool OcclusionBufferData::used_
-    engine->RegisterObjectProperty(className, "bool used", offsetof(T, used_));
-
     #ifdef REGISTER_MEMBERS_MANUAL_PART_OcclusionBufferData
         REGISTER_MEMBERS_MANUAL_PART_OcclusionBufferData();
     #endif
@@ -3199,6 +3259,8 @@ template <class T> void RegisterMembers_Octant(asIScriptEngine* engine, const ch
 // class OctreeQuery | File: ../Graphics/OctreeQuery.h
 template <class T> void RegisterMembers_OctreeQuery(asIScriptEngine* engine, const char* className)
 {
+    // virtual void OctreeQuery::TestDrawableBounds(Drawable** start, Drawable** end, const BoundingBoxArray& boxes, bool inside)
+    // Not registered because have @nobind mark
     // virtual void OctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool inside) = 0
     // Error: type "Drawable**" can not automatically bind
 
@@ -7599,7 +7661,7 @@ template <class T> void RegisterMembers_BackgroundLoader(asIScriptEngine* engine
     // unsigned BackgroundLoader::GetNumQueuedResources() const
     engine->RegisterObjectMethod(className, "uint GetNumQueuedResources() const", AS_METHODPR(T, GetNumQueuedResources, () const, unsigned), AS_CALL_THISCALL);
 
-    // bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller)
+    // bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller, int priority)
     engine->RegisterObjectMethod(className, "bool QueueResource(StringHash, const String&in, bool, Resource@+)", AS_METHODPR(T, QueueResource, (StringHash, const String&, bool, Resource*), bool), AS_CALL_THISCALL);
 
     // void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
@@ -7832,8 +7894,8 @@ template <class T> void RegisterMembers_EventReceiverGroup(asIScriptEngine* engi
 {
     RegisterMembers_RefCounted<T>(engine, className);
 
-    // void EventReceiverGroup::Add(Object* object)
-    engine->RegisterObjectMethod(className, "void Add(Object@+)", AS_METHODPR(T, Add, (Object*), void), AS_CALL_THISCALL);
+    // void EventReceiverGroup::Add(Object* object, unsigned long long order)
+    engine->RegisterObjectMethod(className, "void Add(Object@+, uint64)", AS_METHODPR(T, Add, (Object*, unsigned long long), void), AS_CALL_THISCALL);
 
     // void EventReceiverGroup::BeginSendEvent()
     engine->RegisterObjectMethod(className, "void BeginSendEvent()", AS_METHODPR(T, BeginSendEvent, (), void), AS_CALL_THISCALL);
@@ -7844,6 +7906,9 @@ template <class T> void RegisterMembers_EventReceiverGroup(asIScriptEngine* engi
     // void EventReceiverGroup::Remove(Object* object)
     engine->RegisterObjectMethod(className, "void Remove(Object@+)", AS_METHODPR(T, Remove, (Object*), void), AS_CALL_THISCALL);
 
+    // PODVector<unsigned long long> EventReceiverGroup::orders_
+    // Error: type "PODVector<unsigned long long>" can not automatically bind
+
     // PODVector<Object*> EventReceiverGroup::receivers_
     // Error: type "PODVector<Object*>" can not automatically bind
 
@@ -10067,6 +10132,10 @@ template <class T> void RegisterMembers_Graphics(asIScriptEngine* engine, const
     engine->RegisterObjectMethod(className, "bool GetFullscreen() const", AS_METHODPR(T, GetFullscreen, () const, bool), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "bool get_fullscreen() const", AS_METHODPR(T, GetFullscreen, () const, bool), AS_CALL_THISCALL);
 
+    // bool Graphics::GetHalfFloatVertexSupport() const
+    engine->RegisterObjectMethod(className, "bool GetHalfFloatVertexSupport() const", AS_METHODPR(T, GetHalfFloatVertexSupport, () const, bool), AS_CALL_THISCALL);
+    engine->RegisterObjectMethod(className, "bool get_halfFloatVertexSupport() const", AS_METHODPR(T, GetHalfFloatVertexSupport, () const, bool), AS_CALL_THISCALL);
+
     // bool Graphics::GetHardwareShadowSupport() const
     engine->RegisterObjectMethod(className, "bool GetHardwareShadowSupport() const", AS_METHODPR(T, GetHardwareShadowSupport, () const, bool), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "bool get_hardwareShadowSupport() const", AS_METHODPR(T, GetHardwareShadowSupport, () const, bool), AS_CALL_THISCALL);
@@ -11003,6 +11072,9 @@ template <class T> void RegisterMembers_OcclusionBuffer(asIScriptEngine* engine,
     // void OcclusionBuffer::Clear()
     engine->RegisterObjectMethod(className, "void Clear()", AS_METHODPR(T, Clear, (), void), AS_CALL_THISCALL);
 
+    // void OcclusionBuffer::DrawBand(unsigned band)
+    engine->RegisterObjectMethod(className, "void DrawBand(uint)", AS_METHODPR(T, DrawBand, (unsigned), void), AS_CALL_THISCALL);
+
     // void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadIndex)
     engine->RegisterObjectMethod(className, "void DrawBatch(const OcclusionBatch&in, uint)", AS_METHODPR(T, DrawBatch, (const OcclusionBatch&, unsigned), void), AS_CALL_THISCALL);
 
@@ -11024,6 +11096,9 @@ template <class T> void RegisterMembers_OcclusionBuffer(asIScriptEngine* engine,
     // const Matrix4& OcclusionBuffer::GetProjection() const
     engine->RegisterObjectMethod(className, "const Matrix4& GetProjection() const", AS_METHODPR(T, GetProjection, () const, const Matrix4&), AS_CALL_THISCALL);
 
+    // bool OcclusionBuffer::GetTiledRasterization() const
+    engine->RegisterObjectMethod(className, "bool GetTiledRasterization() const", AS_METHODPR(T, GetTiledRasterization, () const, bool), AS_CALL_THISCALL);
+
     // unsigned OcclusionBuffer::GetUseTimer()
     engine->RegisterObjectMethod(className, "uint GetUseTimer()", AS_METHODPR(T, GetUseTimer, (), unsigned), AS_CALL_THISCALL);
 
@@ -11054,6 +11129,9 @@ template <class T> void RegisterMembers_OcclusionBuffer(asIScriptEngine* engine,
     // bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     engine->RegisterObjectMethod(className, "bool SetSize(int, int, bool)", AS_METHODPR(T, SetSize, (int, int, bool), bool), AS_CALL_THISCALL);
 
+    // void OcclusionBuffer::SetTiledRasterization(bool enable)
+    engine->RegisterObjectMethod(className, "void SetTiledRasterization(bool)", AS_METHODPR(T, SetTiledRasterization, (bool), void), AS_CALL_THISCALL);
+
     // void OcclusionBuffer::SetView(Camera* camera)
     engine->RegisterObjectMethod(className, "void SetView(Camera@+)", AS_METHODPR(T, SetView, (Camera*), void), AS_CALL_THISCALL);
 
@@ -11176,6 +11254,10 @@ template <class T> void RegisterMembers_Renderer(asIScriptEngine* engine, const
     // void Renderer::DrawDebugGeometry(bool depthTest)
     engine->RegisterObjectMethod(className, "void DrawDebugGeometry(bool)", AS_METHODPR(T, DrawDebugGeometry, (bool), void), AS_CALL_THISCALL);
 
+    // bool Renderer::GetCacheLightQueries() const
+    engine->RegisterObjectMethod(className, "bool GetCacheLightQueries() const", AS_METHODPR(T, GetCacheLightQueries, () const, bool), AS_CALL_THISCALL);
+    engine->RegisterObjectMethod(className, "bool get_cacheLightQueries() const", AS_METHODPR(T, GetCacheLightQueries, () const, bool), AS_CALL_THISCALL);
+
     // Texture2D* Renderer::GetDefaultLightRamp() const
     engine->RegisterObjectMethod(className, "Texture2D@+ GetDefaultLightRamp() const", AS_METHODPR(T, GetDefaultLightRamp, () const, Texture2D*), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "Texture2D@+ get_defaultLightRamp() const", AS_METHODPR(T, GetDefaultLightRamp, () const, Texture2D*), AS_CALL_THISCALL);
@@ -11402,6 +11484,10 @@ template <class T> void RegisterMembers_Renderer(asIScriptEngine* engine, const
     // void Renderer::SetBatchShaders(Batch& batch, Technique* tech, bool allowShadows, const BatchQueue& queue)
     engine->RegisterObjectMethod(className, "void SetBatchShaders(Batch&, Technique@+, bool, const BatchQueue&in)", AS_METHODPR(T, SetBatchShaders, (Batch&, Technique*, bool, const BatchQueue&), void), AS_CALL_THISCALL);
 
+    // void Renderer::SetCacheLightQueries(bool enable)
+    engine->RegisterObjectMethod(className, "void SetCacheLightQueries(bool)", AS_METHODPR(T, SetCacheLightQueries, (bool), void), AS_CALL_THISCALL);
+    engine->RegisterObjectMethod(className, "void set_cacheLightQueries(bool)", AS_METHODPR(T, SetCacheLightQueries, (bool), void), AS_CALL_THISCALL);
+
     // void Renderer::SetCullMode(CullMode mode, Camera* camera)
     engine->RegisterObjectMethod(className, "void SetCullMode(CullMode, Camera@+)", AS_METHODPR(T, SetCullMode, (CullMode, Camera*), void), AS_CALL_THISCALL);
 
@@ -11657,8 +11743,8 @@ template <class T> void RegisterMembers_ResourceCache(asIScriptEngine* engine, c
     // bool ResourceCache::AddResourceDir(const String& pathName, unsigned priority = PRIORITY_LAST)
     engine->RegisterObjectMethod(className, "bool AddResourceDir(const String&in, uint = PRIORITY_LAST)", AS_METHODPR(T, AddResourceDir, (const String&, unsigned), bool), AS_CALL_THISCALL);
 
-    // bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure = true, Resource* caller = nullptr)
-    engine->RegisterObjectMethod(className, "bool BackgroundLoadResource(StringHash, const String&in, bool = true, Resource@+ = null)", AS_METHODPR(T, BackgroundLoadResource, (StringHash, const String&, bool, Resource*), bool), AS_CALL_THISCALL);
+    // bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure = true, Resource* caller = nullptr, int priority = 0)
+    engine->RegisterObjectMethod(className, "bool BackgroundLoadResource(StringHash, const String&in, bool = true, Resource@+ = null, int = 0)", AS_METHODPR(T, BackgroundLoadResource, (StringHash, const String&, bool, Resource*, int), bool), AS_CALL_THISCALL);
 
     // bool ResourceCache::Exists(const String& name) const
     engine->RegisterObjectMethod(className, "bool Exists(const String&in) const", AS_METHODPR(T, Exists, (const String&) const, bool), AS_CALL_THISCALL);
@@ -11685,6 +11771,12 @@ template <class T> void RegisterMembers_ResourceCache(asIScriptEngine* engine, c
     engine->RegisterObjectMethod(className, "uint64 GetMemoryUse(StringHash) const", AS_METHODPR(T, GetMemoryUse, (StringHash) const, unsigned long long), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "uint64 get_memoryUse(StringHash) const", AS_METHODPR(T, GetMemoryUse, (StringHash) const, unsigned long long), AS_CALL_THISCALL);
 
+    // unsigned ResourceCache::GetNumBackgroundLoadDecodeThreads() const
+    engine->RegisterObjectMethod(className, "uint GetNumBackgroundLoadDecodeThreads() const", AS_METHODPR(T, GetNumBackgroundLoadDecodeThreads, () const, unsigned), AS_CALL_THISCALL);
+
+    // unsigned ResourceCache::GetNumBackgroundLoadIOThreads() const
+    engine->RegisterObjectMethod(className, "uint GetNumBackgroundLoadIOThreads() const", AS_METHODPR(T, GetNumBackgroundLoadIOThreads, () const, unsigned), AS_CALL_THISCALL);
+
     // unsigned ResourceCache::GetNumBackgroundLoadResources() const
     engine->RegisterObjectMethod(className, "uint GetNumBackgroundLoadResources() const", AS_METHODPR(T, GetNumBackgroundLoadResources, () const, unsigned), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "uint get_numBackgroundLoadResources() const", AS_METHODPR(T, GetNumBackgroundLoadResources, () const, unsigned), AS_CALL_THISCALL);
@@ -11767,6 +11859,12 @@ template <class T> void RegisterMembers_ResourceCache(asIScriptEngine* engine, c
     engine->RegisterObjectMethod(className, "void SetAutoReloadResources(bool)", AS_METHODPR(T, SetAutoReloadResources, (bool), void), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "void set_autoReloadResources(bool)", AS_METHODPR(T, SetAutoReloadResources, (bool), void), AS_CALL_THISCALL);
 
+    // bool ResourceCache::SetBackgroundLoadPriority(StringHash type, const String& name, int priority)
+    engine->RegisterObjectMethod(className, "bool SetBackgroundLoadPriority(StringHash, const String&in, int)", AS_METHODPR(T, SetBackgroundLoadPriority, (StringHash, const String&, int), bool), AS_CALL_THISCALL);
+
+    // void ResourceCache::SetBackgroundLoadThreads(unsigned numIOThreads, unsigned numDecodeThreads)
+    engine->RegisterObjectMethod(className, "void SetBackgroundLoadThreads(uint, uint)", AS_METHODPR(T, SetBackgroundLoadThreads, (unsigned, unsigned), void), AS_CALL_THISCALL);
+
     // void ResourceCache::SetFinishBackgroundResourcesMs(int ms)
     engine->RegisterObjectMethod(className, "void SetFinishBackgroundResourcesMs(int)", AS_METHODPR(T, SetFinishBackgroundResourcesMs, (int), void), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "void set_finishBackgroundResourcesMs(int)", AS_METHODPR(T, SetFinishBackgroundResourcesMs, (int), void), AS_CALL_THISCALL);
@@ -11786,7 +11884,7 @@ template <class T> void RegisterMembers_ResourceCache(asIScriptEngine* engine, c
     // void ResourceCache::StoreResourceDependency(Resource* resource, const String& dependency)
     engine->RegisterObjectMethod(className, "void StoreResourceDependency(Resource@+, const String&in)", AS_METHODPR(T, StoreResourceDependency, (Resource*, const String&), void), AS_CALL_THISCALL);
 
-    // template <class T> bool ResourceCache::BackgroundLoadResource(const String& name, bool sendEventOnFailure = true, Resource* caller = nullptr)
+    // template <class T> bool ResourceCache::BackgroundLoadResource(const String& name, bool sendEventOnFailure = true, Resource* caller = nullptr, int priority = 0)
     // Not registered because template
     // template <class T> T* ResourceCache::GetExistingResource(const String& name)
     // Not registered because template
@@ -14965,6 +15063,9 @@ template <class T> void RegisterMembers_Animation(asIScriptEngine* engine, const
     // SharedPtr<Animation> Animation::Clone(const String& cloneName = String::EMPTY) const
     engine->RegisterObjectMethod(className, "Animation@+ Clone(const String&in = String::EMPTY) const", AS_FUNCTION_OBJFIRST(Animation_SharedPtrlesAnimationgre_Clone_constspStringamp_template<Animation>), AS_CALL_CDECL_OBJFIRST);
 
+    // void Animation::Compress(float positionTolerance, float rotationTolerance, float scaleTolerance)
+    engine->RegisterObjectMethod(className, "void Compress(float, float, float)", AS_METHODPR(T, Compress, (float, float, float), void), AS_CALL_THISCALL);
+
     // AnimationTrack* Animation::CreateTrack(const String& name)
     engine->RegisterObjectMethod(className, "AnimationTrack@ CreateTrack(const String&in)", AS_METHODPR(T, CreateTrack, (const String&), AnimationTrack*), AS_CALL_THISCALL);
 
@@ -14997,6 +15098,10 @@ template <class T> void RegisterMembers_Animation(asIScriptEngine* engine, const
     // AnimationTrack* Animation::GetTrack(StringHash nameHash)
     engine->RegisterObjectMethod(className, "AnimationTrack@ GetTrack(StringHash)", AS_METHODPR(T, GetTrack, (StringHash), AnimationTrack*), AS_CALL_THISCALL);
 
+    // bool Animation::IsCompressed() const
+    engine->RegisterObjectMethod(className, "bool IsCompressed() const", AS_METHODPR(T, IsCompressed, () const, bool), AS_CALL_THISCALL);
+    engine->RegisterObjectMethod(className, "bool get_compressed() const", AS_METHODPR(T, IsCompressed, () const, bool), AS_CALL_THISCALL);
+
     // void Animation::RemoveAllTracks()
     engine->RegisterObjectMethod(className, "void RemoveAllTracks()", AS_METHODPR(T, RemoveAllTracks, (), void), AS_CALL_THISCALL);
 
@@ -17812,6 +17917,8 @@ template <class T> void RegisterMembers_Octree(asIScriptEngine* engine, const ch
 
     // void Octree::GetDrawables(OctreeQuery& query) const
     // Not registered because have @nobind mark
+    // SpatialIndex* Octree::GetSpatialIndex() const
+    // Not registered because have @nobind mark
     // void Octree::Raycast(RayOctreeQuery& query) const
     // Error: type "RayOctreeQuery" can not automatically bind bacause have @nobind mark
     // void Octree::RaycastSingle(RayOctreeQuery& query) const
@@ -17833,9 +17940,16 @@ template <class T> void RegisterMembers_Octree(asIScriptEngine* engine, const ch
     engine->RegisterObjectMethod(className, "uint GetNumLevels() const", AS_METHODPR(T, GetNumLevels, () const, unsigned), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "uint get_numLevels() const", AS_METHODPR(T, GetNumLevels, () const, unsigned), AS_CALL_THISCALL);
 
+    // SpatialIndexType Octree::GetSpatialIndexType() const
+    engine->RegisterObjectMethod(className, "SpatialIndexType GetSpatialIndexType() const", AS_METHODPR(T, GetSpatialIndexType, () const, SpatialIndexType), AS_CALL_THISCALL);
+    engine->RegisterObjectMethod(className, "SpatialIndexType get_spatialIndexType() const", AS_METHODPR(T, GetSpatialIndexType, () const, SpatialIndexType), AS_CALL_THISCALL);
+
     // virtual void Component::OnSetEnabled()
     engine->RegisterObjectMethod(className, "void OnSetEnabled()", AS_METHODPR(T, OnSetEnabled, (), void), AS_CALL_THISCALL);
 
+    // bool Octree::QueueAnimationUpdate(AnimatedModel* model)
+    engine->RegisterObjectMethod(className, "bool QueueAnimationUpdate(AnimatedModel@+)", AS_METHODPR(T, QueueAnimationUpdate, (AnimatedModel*), bool), AS_CALL_THISCALL);
+
     // void Octree::QueueUpdate(Drawable* drawable)
     engine->RegisterObjectMethod(className, "void QueueUpdate(Drawable@+)", AS_METHODPR(T, QueueUpdate, (Drawable*), void), AS_CALL_THISCALL);
 
@@ -17845,6 +17959,13 @@ template <class T> void RegisterMembers_Octree(asIScriptEngine* engine, const ch
     // void Octree::SetSize(const BoundingBox& box, unsigned numLevels)
     engine->RegisterObjectMethod(className, "void SetSize(const BoundingBox&in, uint)", AS_METHODPR(T, SetSize, (const BoundingBox&, unsigned), void), AS_CALL_THISCALL);
 
+    // void Octree::SetSpatialIndex(SpatialIndex* index)
+    // Not registered because have @nobind mark
+
+    // void Octree::SetSpatialIndexType(SpatialIndexType type)
+    engine->RegisterObjectMethod(className, "void SetSpatialIndexType(SpatialIndexType)", AS_METHODPR(T, SetSpatialIndexType, (SpatialIndexType), void), AS_CALL_THISCALL);
+    engine->RegisterObjectMethod(className, "void set_spatialIndexType(SpatialIndexType)", AS_METHODPR(T, SetSpatialIndexType, (SpatialIndexType), void), AS_CALL_THISCALL);
+
     // void Octree::Update(const FrameInfo& frame)
     engine->RegisterObjectMethod(className, "void Update(const FrameInfo&in)", AS_METHODPR(T, Update, (const FrameInfo&), void), AS_CALL_THISCALL);
 
@@ -24660,6 +24781,8 @@ template <class T> void RegisterMembers_AnimatedModel(asIScriptEngine* engine, c
     // Error: type "VariantVector" can not automatically bind
     // VariantVector AnimatedModel::GetBonesEnabledAttr() const
     // Error: type "VariantVector" can not automatically bind
+    // const PODVector<Matrix3x4>& AnimatedModel::GetBoneTransforms() const
+    // Error: type "const PODVector<Matrix3x4>&" can not automatically bind
     // const Vector<PODVector<unsigned>>& AnimatedModel::GetGeometryBoneMappings() const
     // Error: type "const Vector<PODVector<unsigned>>&" can not automatically bind
     // const Vector<PODVector<Matrix3x4>>& AnimatedModel::GetGeometrySkinMatrices() const
@@ -24681,6 +24804,9 @@ template <class T> void RegisterMembers_AnimatedModel(asIScriptEngine* engine, c
     // void AnimatedModel::ApplyAnimation()
     engine->RegisterObjectMethod(className, "void ApplyAnimation()", AS_METHODPR(T, ApplyAnimation, (), void), AS_CALL_THISCALL);
 
+    // Node* AnimatedModel::CreateBoneAttachment(const String& boneName)
+    engine->RegisterObjectMethod(className, "Node@+ CreateBoneAttachment(const String&in)", AS_METHODPR(T, CreateBoneAttachment, (const String&), Node*), AS_CALL_THISCALL);
+
     // float AnimatedModel::GetAnimationLodBias() const
     engine->RegisterObjectMethod(className, "float GetAnimationLodBias() const", AS_METHODPR(T, GetAnimationLodBias, () const, float), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "float get_animationLodBias() const", AS_METHODPR(T, GetAnimationLodBias, () const, float), AS_CALL_THISCALL);
@@ -24714,6 +24840,14 @@ template <class T> void RegisterMembers_AnimatedModel(asIScriptEngine* engine, c
     // float AnimatedModel::GetMorphWeight(StringHash nameHash) const
     engine->RegisterObjectMethod(className, "float GetMorphWeight(StringHash) const", AS_METHODPR(T, GetMorphWeight, (StringHash) const, float), AS_CALL_THISCALL);
 
+    // bool AnimatedModel::GetNodeFreePose() const
+    engine->RegisterObjectMethod(className, "bool GetNodeFreePose() const", AS_METHODPR(T, GetNodeFreePose, () const, bool), AS_CALL_THISCALL);
+    engine->RegisterObjectMethod(className, "bool get_nodeFreePose() const", AS_METHODPR(T, GetNodeFreePose, () const, bool), AS_CALL_THISCALL);
+
+    // float AnimatedModel::GetPoseSharingStep() const
+    engine->RegisterObjectMethod(className, "float GetPoseSharingStep() const", AS_METHODPR(T, GetPoseSharingStep, () const, float), AS_CALL_THISCALL);
+    engine->RegisterObjectMethod(className, "float get_poseSharingStep() const", AS_METHODPR(T, GetPoseSharingStep, () const, float), AS_CALL_THISCALL);
+
     // unsigned AnimatedModel::GetNumAnimationStates() const
     engine->RegisterObjectMethod(className, "uint GetNumAnimationStates() const", AS_METHODPR(T, GetNumAnimationStates, () const, unsigned), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "uint get_numAnimationStates() const", AS_METHODPR(T, GetNumAnimationStates, () const, unsigned), AS_CALL_THISCALL);
@@ -24751,6 +24885,9 @@ template <class T> void RegisterMembers_AnimatedModel(asIScriptEngine* engine, c
     // void AnimatedModel::RemoveAnimationState(unsigned index)
     engine->RegisterObjectMethod(className, "void RemoveAnimationState(uint)", AS_METHODPR(T, RemoveAnimationState, (unsigned), void), AS_CALL_THISCALL);
 
+    // void AnimatedModel::RemoveBoneAttachment(const String& boneName)
+    engine->RegisterObjectMethod(className, "void RemoveBoneAttachment(const String&in)", AS_METHODPR(T, RemoveBoneAttachment, (const String&), void), AS_CALL_THISCALL);
+
     // void AnimatedModel::ResetMorphWeights()
     engine->RegisterObjectMethod(className, "void ResetMorphWeights()", AS_METHODPR(T, ResetMorphWeights, (), void), AS_CALL_THISCALL);
 
@@ -24771,6 +24908,14 @@ template <class T> void RegisterMembers_AnimatedModel(asIScriptEngine* engine, c
     // void AnimatedModel::SetMorphWeight(StringHash nameHash, float weight)
     engine->RegisterObjectMethod(className, "void SetMorphWeight(StringHash, float)", AS_METHODPR(T, SetMorphWeight, (StringHash, float), void), AS_CALL_THISCALL);
 
+    // void AnimatedModel::SetNodeFreePose(bool enable)
+    engine->RegisterObjectMethod(className, "void SetNodeFreePose(bool)", AS_METHODPR(T, SetNodeFreePose, (bool), void), AS_CALL_THISCALL);
+    engine->RegisterObjectMethod(className, "void set_nodeFreePose(bool)", AS_METHODPR(T, SetNodeFreePose, (bool), void), AS_CALL_THISCALL);
+
+    // void AnimatedModel::SetPoseSharingStep(float step)
+    engine->RegisterObjectMethod(className, "void SetPoseSharingStep(float)", AS_METHODPR(T, SetPoseSharingStep, (float), void), AS_CALL_THISCALL);
+    engine->RegisterObjectMethod(className, "void set_poseSharingStep(float)", AS_METHODPR(T, SetPoseSharingStep, (float), void), AS_CALL_THISCALL);
+
     // void AnimatedModel::SetUpdateInvisible(bool enable)
     engine->RegisterObjectMethod(className, "void SetUpdateInvisible(bool)", AS_METHODPR(T, SetUpdateInvisible, (bool), void), AS_CALL_THISCALL);
     engine->RegisterObjectMethod(className, "void set_updateInvisible(bool)", AS_METHODPR(T, SetUpdateInvisible, (bool), void), AS_CALL_THISCALL);
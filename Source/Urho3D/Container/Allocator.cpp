@@ -22,6 +22,8 @@
 
 #include "../Precompiled.h"
 
+#include "../Math/MathDefs.h"
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -119,4 +121,80 @@ void AllocatorFree(AllocatorBlock* allocator, void* ptr)
     allocator->free_ = node;
 }
 
+/// Default size of the first frame arena chunk.
+static const size_t DEFAULT_FRAME_ARENA_CHUNK_SIZE = 64 * 1024;
+
+FrameArena::FrameArena(size_t initialCapacity) :
+    chunks_(nullptr),
+    current_(nullptr),
+    end_(nullptr),
+    usedSize_(0),
+    capacity_(0),
+    numAllocations_(0),
+    numHeapAllocations_(0)
+{
+    if (initialCapacity)
+        AddChunk(initialCapacity);
+}
+
+FrameArena::~FrameArena()
+{
+    FreeChunks();
+}
+
+void FrameArena::Reset()
+{
+    // Coalesce the chunks so that the next use of the same size fits in one
+    if (chunks_ && chunks_->next_)
+    {
+        size_t capacity = capacity_;
+        FreeChunks();
+        AddChunk(capacity);
+    }
+
+    if (chunks_)
+        current_ = ChunkData(chunks_);
+    usedSize_ = 0;
+    numAllocations_ = 0;
+    numHeapAllocations_ = 0;
+}
+
+void* FrameArena::AllocateChunk(size_t size, size_t alignment)
+{
+    if (chunks_)
+        usedSize_ += current_ - ChunkData(chunks_);
+
+    AddChunk(Max(Max(capacity_, DEFAULT_FRAME_ARENA_CHUNK_SIZE), size + alignment));
+
+    unsigned char* ptr = AlignPointer(current_, alignment);
+    current_ = ptr + size;
+    return ptr;
+}
+
+void FrameArena::AddChunk(size_t size)
+{
+    auto* chunk = reinterpret_cast<FrameArenaChunk*>(new unsigned char[sizeof(FrameArenaChunk) + size]);
+    chunk->next_ = chunks_;
+    chunk->size_ = size;
+    chunks_ = chunk;
+    current_ = ChunkData(chunk);
+    end_ = current_ + size;
+    capacity_ += size;
+    ++numHeapAllocations_;
+}
+
+void FrameArena::FreeChunks()
+{
+    while (chunks_)
+    {
+        FrameArenaChunk* next = chunks_->next_;
+        delete[] reinterpret_cast<unsigned char*>(chunks_);
+        chunks_ = next;
+    }
+
+    current_ = nullptr;
+    end_ = nullptr;
+    capacity_ = 0;
+}
+
 }
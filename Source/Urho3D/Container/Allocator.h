@@ -29,6 +29,7 @@
 #endif
 
 #include <cstddef>
+#include <cstring>
 
 namespace Urho3D
 {
@@ -124,4 +125,139 @@ private:
     AllocatorBlock* allocator_;
 };
 
+/// %Frame arena memory chunk.
+struct FrameArenaChunk
+{
+    /// Next (older) chunk.
+    FrameArenaChunk* next_;
+    /// Size of the data.
+    size_t size_;
+    /// Data follows.
+};
+
+/// Linear memory arena for short-lived allocations, such as the temporaries of one rendered frame. Allocation only advances a pointer and individual allocations are never freed; Reset() releases them all at once. Not thread-safe: use one arena per thread.
+class URHO3D_API FrameArena
+{
+public:
+    /// Construct with initial capacity in bytes.
+    explicit FrameArena(size_t initialCapacity = 0);
+    /// Destruct. Free all chunks.
+    ~FrameArena();
+
+    /// Prevent copy construction.
+    FrameArena(const FrameArena& rhs) = delete;
+    /// Prevent assignment.
+    FrameArena& operator =(const FrameArena& rhs) = delete;
+
+    /// Allocate memory with the specified alignment, which must be a power of two. Allocates a new chunk from the heap if the current one is exhausted.
+    void* Allocate(size_t size, size_t alignment = sizeof(void*))
+    {
+        ++numAllocations_;
+        unsigned char* ptr = AlignPointer(current_, alignment);
+        if (ptr && ptr <= end_ && size <= (size_t)(end_ - ptr))
+        {
+            current_ = ptr + size;
+            return ptr;
+        }
+        return AllocateChunk(size, alignment);
+    }
+
+    /// Allocate uninitialized memory for an array of objects.
+    template <class T> T* Allocate(unsigned count) { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+    /// Grow an allocation, preserving its contents. Extends in place if it was the latest allocation and the chunk has room, otherwise allocates new memory and copies.
+    void* Reallocate(void* ptr, size_t oldSize, size_t newSize, size_t alignment = sizeof(void*))
+    {
+        auto* bytes = static_cast<unsigned char*>(ptr);
+        if (bytes && bytes + oldSize == current_ && newSize - oldSize <= (size_t)(end_ - current_))
+        {
+            current_ = bytes + newSize;
+            return ptr;
+        }
+        void* newPtr = Allocate(newSize, alignment);
+        if (oldSize)
+            memcpy(newPtr, ptr, oldSize);
+        return newPtr;
+    }
+
+    /// Free all allocations. If the previous use needed more than one chunk, replace them with a single chunk large enough to hold all of it, so that steady-state use does not allocate from the heap.
+    void Reset();
+
+    /// Return bytes allocated since the last reset, including alignment padding.
+    size_t GetUsedSize() const { return usedSize_ + (chunks_ ? (size_t)(current_ - ChunkData(chunks_)) : 0); }
+    /// Return total size of the chunks.
+    size_t GetCapacity() const { return capacity_; }
+    /// Return number of allocations since the last reset.
+    unsigned GetNumAllocations() const { return numAllocations_; }
+    /// Return number of chunks allocated from the heap since the last reset.
+    unsigned GetNumHeapAllocations() const { return numHeapAllocations_; }
+
+private:
+    /// Round a pointer up to an alignment.
+    static unsigned char* AlignPointer(unsigned char* ptr, size_t alignment)
+    {
+        return reinterpret_cast<unsigned char*>((reinterpret_cast<size_t>(ptr) + alignment - 1) & ~(alignment - 1));
+    }
+    /// Return the data of a chunk.
+    static unsigned char* ChunkData(FrameArenaChunk* chunk) { return reinterpret_cast<unsigned char*>(chunk + 1); }
+    /// Allocate a new chunk from the heap to hold at least the specified size, and allocate from it.
+    void* AllocateChunk(size_t size, size_t alignment);
+    /// Allocate a new chunk from the heap and make it current.
+    void AddChunk(size_t size);
+    /// Free all chunks.
+    void FreeChunks();
+
+    /// Current (newest) chunk.
+    FrameArenaChunk* chunks_;
+    /// Next free byte in the current chunk.
+    unsigned char* current_;
+    /// End of the current chunk.
+    unsigned char* end_;
+    /// Bytes used in the chunks before the current one.
+    size_t usedSize_;
+    /// Total size of the chunks.
+    size_t capacity_;
+    /// Number of allocations since the last reset.
+    unsigned numAllocations_;
+    /// Number of heap allocated chunks since the last reset.
+    unsigned numHeapAllocations_;
+};
+
+/// STL-compatible allocator adapter which allocates from a frame arena. Deallocation is a no-op; the memory is released when the arena is reset, so the container must not be used after that.
+template <class T> class FrameAllocator
+{
+public:
+    /// Value type.
+    using value_type = T;
+
+    /// Construct with the arena.
+    explicit FrameAllocator(FrameArena* arena) noexcept :
+        arena_(arena)
+    {
+    }
+
+    /// Construct from an allocator of another type.
+    template <class U> FrameAllocator(const FrameAllocator<U>& rhs) noexcept :
+        arena_(rhs.GetArena())
+    {
+    }
+
+    /// Allocate uninitialized memory for objects.
+    T* allocate(size_t count) { return arena_->Allocate<T>((unsigned)count); }
+    /// Deallocate. Does nothing.
+    void deallocate(T* /*ptr*/, size_t /*count*/) noexcept { }
+
+    /// Return the arena.
+    FrameArena* GetArena() const { return arena_; }
+
+private:
+    /// Arena.
+    FrameArena* arena_;
+};
+
+/// Test frame allocators for equality.
+template <class T, class U> bool operator ==(const FrameAllocator<T>& lhs, const FrameAllocator<U>& rhs) { return lhs.GetArena() == rhs.GetArena(); }
+/// Test frame allocators for inequality.
+template <class T, class U> bool operator !=(const FrameAllocator<T>& lhs, const FrameAllocator<U>& rhs) { return lhs.GetArena() != rhs.GetArena(); }
+
 }
@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/FlatHashBase.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+void FlatHashBase::RehashBuckets(unsigned numBuckets)
+{
+    Bucket* oldBuckets = buckets_;
+    unsigned oldNumBuckets = numBuckets_;
+
+    buckets_ = new Bucket[numBuckets];
+    numBuckets_ = numBuckets;
+    shift_ = 32;
+    for (unsigned i = numBuckets; i > 1; i >>= 1)
+        --shift_;
+    ResetBuckets();
+
+    for (unsigned i = 0; i < oldNumBuckets; ++i)
+    {
+        if (oldBuckets[i].index_ != EMPTY_BUCKET)
+            InsertBucket(oldBuckets[i].hash_, oldBuckets[i].index_);
+    }
+
+    delete[] oldBuckets;
+}
+
+void FlatHashBase::ReserveBuckets(unsigned size)
+{
+    if (!NeedRehash(size))
+        return;
+
+    unsigned numBuckets = numBuckets_ ? numBuckets_ : MIN_BUCKETS;
+    while (size * 2 > numBuckets)
+        numBuckets <<= 1;
+
+    RehashBuckets(numBuckets);
+}
+
+void FlatHashBase::ResetBuckets()
+{
+    for (unsigned i = 0; i < numBuckets_; ++i)
+        buckets_[i].index_ = EMPTY_BUCKET;
+}
+
+void FlatHashBase::InsertBucket(unsigned hash, unsigned index)
+{
+    unsigned bucket = HomeBucket(hash);
+    while (buckets_[bucket].index_ != EMPTY_BUCKET)
+        bucket = NextBucket(bucket);
+
+    buckets_[bucket].hash_ = hash;
+    buckets_[bucket].index_ = index;
+}
+
+void FlatHashBase::EraseBucket(unsigned bucket)
+{
+    unsigned mask = numBuckets_ - 1;
+    unsigned next = NextBucket(bucket);
+
+    // Move following entries of the cluster into the hole if their home bucket allows it
+    while (buckets_[next].index_ != EMPTY_BUCKET)
+    {
+        unsigned home = HomeBucket(buckets_[next].hash_);
+        if (((next - home) & mask) >= ((next - bucket) & mask))
+        {
+            buckets_[bucket] = buckets_[next];
+            bucket = next;
+        }
+        next = NextBucket(next);
+    }
+
+    buckets_[bucket].index_ = EMPTY_BUCKET;
+}
+
+unsigned FlatHashBase::FindBucket(unsigned hash, unsigned index) const
+{
+    if (!numBuckets_)
+        return EMPTY_BUCKET;
+
+    unsigned bucket = HomeBucket(hash);
+    while (buckets_[bucket].index_ != EMPTY_BUCKET)
+    {
+        if (buckets_[bucket].index_ == index)
+            return bucket;
+        bucket = NextBucket(bucket);
+    }
+
+    return EMPTY_BUCKET;
+}
+
+}
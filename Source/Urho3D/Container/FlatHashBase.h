@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include "../Container/Hash.h"
+#include "../Container/Swap.h"
+
+namespace Urho3D
+{
+
+/// Open-addressing hash set/map base class. Manages the bucket array, which stores the full hash and the index of each element in the dense element array of the derived class.
+/** Lookups probe linearly from the home bucket and compare the stored hashes before touching the elements, and erasure uses backward shifting, so no tombstones are needed.
+    Like %HashBase, %FlatHashBase intentionally does not declare a virtual destructor and therefore %FlatHashBase pointers should never be used.
+  */
+class URHO3D_API FlatHashBase
+{
+public:
+    /// Initial amount of buckets.
+    static const unsigned MIN_BUCKETS = 8;
+    /// Bucket index value for an empty bucket.
+    static const unsigned EMPTY_BUCKET = 0xffffffff;
+
+    /// Bucket.
+    struct Bucket
+    {
+        /// Full hash of the element.
+        unsigned hash_;
+        /// Index of the element, or EMPTY_BUCKET.
+        unsigned index_;
+    };
+
+    /// Construct.
+    FlatHashBase() :
+        buckets_(nullptr),
+        numBuckets_(0),
+        shift_(0)
+    {
+    }
+
+    /// Destruct.
+    ~FlatHashBase()
+    {
+        delete[] buckets_;
+    }
+
+    /// Prevent copy construction. The derived classes copy the elements and rebuild the buckets.
+    FlatHashBase(const FlatHashBase& rhs) = delete;
+    /// Prevent assignment.
+    FlatHashBase& operator =(const FlatHashBase& rhs) = delete;
+
+    /// Swap with another flat hash set or map.
+    void Swap(FlatHashBase& rhs)
+    {
+        Urho3D::Swap(buckets_, rhs.buckets_);
+        Urho3D::Swap(numBuckets_, rhs.numBuckets_);
+        Urho3D::Swap(shift_, rhs.shift_);
+    }
+
+    /// Return number of buckets.
+    unsigned NumBuckets() const { return numBuckets_; }
+
+protected:
+    /// Return the home bucket of a hash. Uses Fibonacci hashing to spread sequential and pointer hashes.
+    unsigned HomeBucket(unsigned hash) const { return (hash * 2654435769u) >> shift_; }
+
+    /// Return the next bucket in probing order.
+    unsigned NextBucket(unsigned bucket) const { return (bucket + 1) & (numBuckets_ - 1); }
+
+    /// Return whether an element count needs more buckets than currently allocated. The maximum load factor is 1/2.
+    bool NeedRehash(unsigned size) const { return size * 2 > numBuckets_; }
+
+    /// Reallocate the buckets to a power of two count and reinsert the existing entries.
+    void RehashBuckets(unsigned numBuckets);
+
+    /// Grow the buckets if necessary to hold an element count.
+    void ReserveBuckets(unsigned size);
+
+    /// Mark all buckets empty.
+    void ResetBuckets();
+
+    /// Insert an element index into the first free bucket. The buckets must have room.
+    void InsertBucket(unsigned hash, unsigned index);
+
+    /// Erase a bucket and shift the following entries of the probe sequence backward.
+    void EraseBucket(unsigned bucket);
+
+    /// Find the bucket of an element index. Return EMPTY_BUCKET if not found.
+    unsigned FindBucket(unsigned hash, unsigned index) const;
+
+    /// Bucket array.
+    Bucket* buckets_;
+    /// Number of buckets, zero or a power of two.
+    unsigned numBuckets_;
+    /// Right shift that maps a scrambled hash to a bucket.
+    unsigned shift_;
+};
+
+}
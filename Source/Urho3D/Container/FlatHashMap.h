@@ -0,0 +1,350 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Pair.h"
+#include "../Container/Sort.h"
+#include "../Container/Vector.h"
+
+#include <cassert>
+#include <initializer_list>
+
+namespace Urho3D
+{
+
+/// Open-addressing hash map template class. Stores the key-value pairs contiguously and iterates them in insertion order, except that erasing moves the last pair into the erased position.
+/** Compared to %HashMap, lookups do not chase node pointers and no per-element allocations are made. Iterators and pointers to values are invalidated by insertion and erasure.
+  */
+template <class T, class U> class FlatHashMap : public FlatHashBase
+{
+public:
+    using KeyType = T;
+    using ValueType = U;
+    /// Key-value pair. The key must not be modified through iterators.
+    using KeyValue = Pair<T, U>;
+    /// Pair iterator.
+    using Iterator = typename Vector<KeyValue>::Iterator;
+    /// Pair const iterator.
+    using ConstIterator = typename Vector<KeyValue>::ConstIterator;
+
+    /// Construct empty.
+    FlatHashMap() = default;
+
+    /// Construct from another hash map.
+    FlatHashMap(const FlatHashMap<T, U>& map) :
+        pairs_(map.pairs_)
+    {
+        RebuildBuckets();
+    }
+
+    /// Move-construct from another hash map.
+    FlatHashMap(FlatHashMap<T, U> && map) noexcept
+    {
+        Swap(map);
+    }
+
+    /// Aggregate initialization constructor.
+    FlatHashMap(const std::initializer_list<Pair<T, U>>& list)
+    {
+        for (auto it = list.begin(); it != list.end(); it++)
+            Insert(*it);
+    }
+
+    /// Assign a hash map.
+    FlatHashMap& operator =(const FlatHashMap<T, U>& rhs)
+    {
+        if (&rhs != this)
+        {
+            pairs_ = rhs.pairs_;
+            RebuildBuckets();
+        }
+        return *this;
+    }
+
+    /// Move-assign a hash map.
+    FlatHashMap& operator =(FlatHashMap<T, U> && rhs) noexcept
+    {
+        assert(&rhs != this);
+        Swap(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash map.
+    bool operator ==(const FlatHashMap<T, U>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator i = Begin(); i != End(); ++i)
+        {
+            ConstIterator j = rhs.Find(i->first_);
+            if (j == rhs.End() || j->second_ != i->second_)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash map.
+    bool operator !=(const FlatHashMap<T, U>& rhs) const { return !(*this == rhs); }
+
+    /// Index the map. Create a new pair if key not found.
+    U& operator [](const T& key)
+    {
+        const unsigned hash = MakeHash(key);
+        unsigned index = FindIndex(key, hash);
+        if (index == EMPTY_BUCKET)
+            index = InsertIndex(key, U(), hash);
+        return pairs_[index].second_;
+    }
+
+    /// Index the map. Return null if key is not found, does not create a new pair.
+    const U* operator [](const T& key) const
+    {
+        const unsigned index = FindIndex(key, MakeHash(key));
+        return index != EMPTY_BUCKET ? &pairs_[index].second_ : nullptr;
+    }
+
+    /// Insert a pair. Return an iterator to it. An existing value is overwritten.
+    Iterator Insert(const Pair<T, U>& pair)
+    {
+        bool exists;
+        return Insert(pair, exists);
+    }
+
+    /// Insert a pair. Return iterator and set exists flag according to whether the key already existed. An existing value is overwritten.
+    Iterator Insert(const Pair<T, U>& pair, bool& exists)
+    {
+        const unsigned hash = MakeHash(pair.first_);
+        unsigned index = FindIndex(pair.first_, hash);
+        exists = index != EMPTY_BUCKET;
+        if (exists)
+            pairs_[index].second_ = pair.second_;
+        else
+            index = InsertIndex(pair.first_, pair.second_, hash);
+        return Begin() + index;
+    }
+
+    /// Insert a map.
+    void Insert(const FlatHashMap<T, U>& map)
+    {
+        for (ConstIterator i = map.Begin(); i != map.End(); ++i)
+            Insert(*i);
+    }
+
+    /// Erase a pair by key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        const unsigned hash = MakeHash(key);
+        const unsigned bucket = FindKeyBucket(key, hash);
+        if (bucket == EMPTY_BUCKET)
+            return false;
+
+        EraseAt(bucket);
+        return true;
+    }
+
+    /// Erase a pair by iterator. Return iterator to the next pair, which is the former last pair moved into its position.
+    Iterator Erase(const Iterator& it)
+    {
+        const auto index = (unsigned)(it - Begin());
+        if (index >= Size())
+            return End();
+
+        EraseAt(FindBucket(MakeHash(it->first_), index));
+        return Begin() + index;
+    }
+
+    /// Clear the map. Keeps the allocated memory.
+    void Clear()
+    {
+        pairs_.Clear();
+        ResetBuckets();
+    }
+
+    /// Reserve memory for a number of pairs.
+    void Reserve(unsigned size)
+    {
+        pairs_.Reserve(size);
+        ReserveBuckets(size);
+    }
+
+    /// Sort pairs by key. After sorting the map can be iterated in order until new elements are inserted or erased.
+    void Sort()
+    {
+        Urho3D::Sort(pairs_.Begin(), pairs_.End(), CompareKeys);
+        RebuildBuckets();
+    }
+
+    /// Swap with another hash map.
+    void Swap(FlatHashMap<T, U>& rhs)
+    {
+        FlatHashBase::Swap(rhs);
+        pairs_.Swap(rhs.pairs_);
+    }
+
+    /// Return iterator to the pair with key, or end iterator if not found.
+    Iterator Find(const T& key)
+    {
+        const unsigned index = FindIndex(key, MakeHash(key));
+        return index != EMPTY_BUCKET ? Begin() + index : End();
+    }
+
+    /// Return const iterator to the pair with key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        const unsigned index = FindIndex(key, MakeHash(key));
+        return index != EMPTY_BUCKET ? Begin() + index : End();
+    }
+
+    /// Return whether contains a pair with key.
+    bool Contains(const T& key) const { return FindIndex(key, MakeHash(key)) != EMPTY_BUCKET; }
+
+    /// Try to copy value to output. Return true if was found.
+    bool TryGetValue(const T& key, U& out) const
+    {
+        const unsigned index = FindIndex(key, MakeHash(key));
+        if (index == EMPTY_BUCKET)
+            return false;
+
+        out = pairs_[index].second_;
+        return true;
+    }
+
+    /// Return all the keys.
+    Vector<T> Keys() const
+    {
+        Vector<T> result;
+        result.Reserve(Size());
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->first_);
+        return result;
+    }
+
+    /// Return all the values.
+    Vector<U> Values() const
+    {
+        Vector<U> result;
+        result.Reserve(Size());
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->second_);
+        return result;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return pairs_.Begin(); }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return pairs_.Begin(); }
+
+    /// Return iterator to the end.
+    Iterator End() { return pairs_.End(); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return pairs_.End(); }
+
+    /// Return first pair.
+    const KeyValue& Front() const { return pairs_.Front(); }
+
+    /// Return last pair.
+    const KeyValue& Back() const { return pairs_.Back(); }
+
+    /// Return number of pairs.
+    unsigned Size() const { return pairs_.Size(); }
+
+    /// Return whether has no pairs.
+    bool Empty() const { return pairs_.Empty(); }
+
+private:
+    /// Find the bucket of a key. Return EMPTY_BUCKET if not found.
+    unsigned FindKeyBucket(const T& key, unsigned hash) const
+    {
+        if (!numBuckets_)
+            return EMPTY_BUCKET;
+
+        unsigned bucket = HomeBucket(hash);
+        while (buckets_[bucket].index_ != EMPTY_BUCKET)
+        {
+            if (buckets_[bucket].hash_ == hash && pairs_[buckets_[bucket].index_].first_ == key)
+                return bucket;
+            bucket = NextBucket(bucket);
+        }
+
+        return EMPTY_BUCKET;
+    }
+
+    /// Find the pair index of a key. Return EMPTY_BUCKET if not found.
+    unsigned FindIndex(const T& key, unsigned hash) const
+    {
+        const unsigned bucket = FindKeyBucket(key, hash);
+        return bucket != EMPTY_BUCKET ? buckets_[bucket].index_ : EMPTY_BUCKET;
+    }
+
+    /// Append a new pair and return its index.
+    unsigned InsertIndex(const T& key, const U& value, unsigned hash)
+    {
+        const unsigned index = pairs_.Size();
+        ReserveBuckets(index + 1);
+        pairs_.Push(KeyValue(key, value));
+        InsertBucket(hash, index);
+        return index;
+    }
+
+    /// Erase the pair of a bucket. The last pair is moved into its position.
+    void EraseAt(unsigned bucket)
+    {
+        const unsigned index = buckets_[bucket].index_;
+        const unsigned last = pairs_.Size() - 1;
+        EraseBucket(bucket);
+
+        if (index != last)
+            buckets_[FindBucket(MakeHash(pairs_[last].first_), last)].index_ = index;
+        pairs_.EraseSwap(index);
+    }
+
+    /// Rebuild the buckets from the pairs.
+    void RebuildBuckets()
+    {
+        ReserveBuckets(pairs_.Size());
+        ResetBuckets();
+        for (unsigned i = 0; i < pairs_.Size(); ++i)
+            InsertBucket(MakeHash(pairs_[i].first_), i);
+    }
+
+    /// Compare two pairs by key.
+    static bool CompareKeys(const KeyValue& lhs, const KeyValue& rhs) { return lhs.first_ < rhs.first_; }
+
+    /// Key-value pairs.
+    Vector<KeyValue> pairs_;
+};
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator begin(const Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::ConstIterator end(const Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator begin(Urho3D::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Urho3D::FlatHashMap<T, U>::Iterator end(Urho3D::FlatHashMap<T, U>& v) { return v.End(); }
+
+}
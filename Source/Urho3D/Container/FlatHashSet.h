@@ -0,0 +1,271 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Sort.h"
+#include "../Container/Vector.h"
+
+#include <cassert>
+#include <initializer_list>
+
+namespace Urho3D
+{
+
+/// Open-addressing hash set template class. Stores the keys contiguously and iterates them in insertion order, except that erasing moves the last key into the erased position.
+/** Compared to %HashSet, lookups do not chase node pointers and no per-element allocations are made. Iterators are invalidated by insertion and erasure.
+  */
+template <class T> class FlatHashSet : public FlatHashBase
+{
+public:
+    /// Key iterator. Keys must not be modified through it.
+    using Iterator = typename Vector<T>::ConstIterator;
+    /// Key const iterator.
+    using ConstIterator = typename Vector<T>::ConstIterator;
+
+    /// Construct empty.
+    FlatHashSet() = default;
+
+    /// Construct from another hash set.
+    FlatHashSet(const FlatHashSet<T>& set) :
+        keys_(set.keys_)
+    {
+        RebuildBuckets();
+    }
+
+    /// Move-construct from another hash set.
+    FlatHashSet(FlatHashSet<T> && set) noexcept
+    {
+        Swap(set);
+    }
+
+    /// Aggregate initialization constructor.
+    FlatHashSet(const std::initializer_list<T>& list)
+    {
+        for (auto it = list.begin(); it != list.end(); it++)
+            Insert(*it);
+    }
+
+    /// Assign a hash set.
+    FlatHashSet& operator =(const FlatHashSet<T>& rhs)
+    {
+        if (&rhs != this)
+        {
+            keys_ = rhs.keys_;
+            RebuildBuckets();
+        }
+        return *this;
+    }
+
+    /// Move-assign a hash set.
+    FlatHashSet& operator =(FlatHashSet<T> && rhs) noexcept
+    {
+        assert(&rhs != this);
+        Swap(rhs);
+        return *this;
+    }
+
+    /// Test for equality with another hash set.
+    bool operator ==(const FlatHashSet<T>& rhs) const
+    {
+        if (rhs.Size() != Size())
+            return false;
+
+        for (ConstIterator i = Begin(); i != End(); ++i)
+        {
+            if (!rhs.Contains(*i))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Test for inequality with another hash set.
+    bool operator !=(const FlatHashSet<T>& rhs) const { return !(*this == rhs); }
+
+    /// Insert a key. Return an iterator to it.
+    Iterator Insert(const T& key)
+    {
+        bool exists;
+        return Insert(key, exists);
+    }
+
+    /// Insert a key. Return iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const T& key, bool& exists)
+    {
+        const unsigned hash = MakeHash(key);
+        unsigned index = FindIndex(key, hash);
+        exists = index != EMPTY_BUCKET;
+        if (!exists)
+        {
+            index = keys_.Size();
+            ReserveBuckets(index + 1);
+            keys_.Push(key);
+            InsertBucket(hash, index);
+        }
+        return Begin() + index;
+    }
+
+    /// Insert a set.
+    void Insert(const FlatHashSet<T>& set)
+    {
+        for (ConstIterator i = set.Begin(); i != set.End(); ++i)
+            Insert(*i);
+    }
+
+    /// Erase a key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        const unsigned bucket = FindKeyBucket(key, MakeHash(key));
+        if (bucket == EMPTY_BUCKET)
+            return false;
+
+        EraseAt(bucket);
+        return true;
+    }
+
+    /// Erase a key by iterator. Return iterator to the next key, which is the former last key moved into its position.
+    Iterator Erase(const Iterator& it)
+    {
+        const auto index = (unsigned)(it - Begin());
+        if (index >= Size())
+            return End();
+
+        EraseAt(FindBucket(MakeHash(*it), index));
+        return Begin() + index;
+    }
+
+    /// Clear the set. Keeps the allocated memory.
+    void Clear()
+    {
+        keys_.Clear();
+        ResetBuckets();
+    }
+
+    /// Reserve memory for a number of keys.
+    void Reserve(unsigned size)
+    {
+        keys_.Reserve(size);
+        ReserveBuckets(size);
+    }
+
+    /// Sort keys. After sorting the set can be iterated in order until new elements are inserted or erased.
+    void Sort()
+    {
+        Urho3D::Sort(keys_.Begin(), keys_.End());
+        RebuildBuckets();
+    }
+
+    /// Swap with another hash set.
+    void Swap(FlatHashSet<T>& rhs)
+    {
+        FlatHashBase::Swap(rhs);
+        keys_.Swap(rhs.keys_);
+    }
+
+    /// Return iterator to the key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        const unsigned index = FindIndex(key, MakeHash(key));
+        return index != EMPTY_BUCKET ? Begin() + index : End();
+    }
+
+    /// Return whether contains a key.
+    bool Contains(const T& key) const { return FindIndex(key, MakeHash(key)) != EMPTY_BUCKET; }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const { return keys_.Begin(); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return keys_.End(); }
+
+    /// Return first key.
+    const T& Front() const { return keys_.Front(); }
+
+    /// Return last key.
+    const T& Back() const { return keys_.Back(); }
+
+    /// Return the keys as a contiguous array.
+    const Vector<T>& GetKeys() const { return keys_; }
+
+    /// Return number of keys.
+    unsigned Size() const { return keys_.Size(); }
+
+    /// Return whether has no keys.
+    bool Empty() const { return keys_.Empty(); }
+
+private:
+    /// Find the bucket of a key. Return EMPTY_BUCKET if not found.
+    unsigned FindKeyBucket(const T& key, unsigned hash) const
+    {
+        if (!numBuckets_)
+            return EMPTY_BUCKET;
+
+        unsigned bucket = HomeBucket(hash);
+        while (buckets_[bucket].index_ != EMPTY_BUCKET)
+        {
+            if (buckets_[bucket].hash_ == hash && keys_[buckets_[bucket].index_] == key)
+                return bucket;
+            bucket = NextBucket(bucket);
+        }
+
+        return EMPTY_BUCKET;
+    }
+
+    /// Find the index of a key. Return EMPTY_BUCKET if not found.
+    unsigned FindIndex(const T& key, unsigned hash) const
+    {
+        const unsigned bucket = FindKeyBucket(key, hash);
+        return bucket != EMPTY_BUCKET ? buckets_[bucket].index_ : EMPTY_BUCKET;
+    }
+
+    /// Erase the key of a bucket. The last key is moved into its position.
+    void EraseAt(unsigned bucket)
+    {
+        const unsigned index = buckets_[bucket].index_;
+        const unsigned last = keys_.Size() - 1;
+        EraseBucket(bucket);
+
+        if (index != last)
+            buckets_[FindBucket(MakeHash(keys_[last]), last)].index_ = index;
+        keys_.EraseSwap(index);
+    }
+
+    /// Rebuild the buckets from the keys.
+    void RebuildBuckets()
+    {
+        ReserveBuckets(keys_.Size());
+        ResetBuckets();
+        for (unsigned i = 0; i < keys_.Size(); ++i)
+            InsertBucket(MakeHash(keys_[i]), i);
+    }
+
+    /// Keys.
+    Vector<T> keys_;
+};
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator begin(const Urho3D::FlatHashSet<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FlatHashSet<T>::ConstIterator end(const Urho3D::FlatHashSet<T>& v) { return v.End(); }
+
+}
@@ -0,0 +1,257 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Allocator.h"
+#include "../Container/VectorBase.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace Urho3D
+{
+
+/// %Vector template class for POD types which allocates its buffer from a frame arena. Clearing or destroying it does not free memory; that happens in O(1) when the arena is reset, after which the vector must be cleared or assigned an arena again before use. Without an arena it owns a heap buffer like PODVector. Copies use the same arena as the source.
+template <class T> class FrameVector
+{
+public:
+    using ValueType = T;
+    using Iterator = RandomAccessIterator<T>;
+    using ConstIterator = RandomAccessConstIterator<T>;
+
+    /// Construct empty with an optional arena.
+    explicit FrameVector(FrameArena* arena = nullptr) noexcept :
+        arena_(arena)
+    {
+    }
+
+    /// Copy-construct from another vector.
+    FrameVector(const FrameVector<T>& vector) :
+        arena_(vector.arena_)
+    {
+        *this = vector;
+    }
+
+    /// Move-construct from another vector.
+    FrameVector(FrameVector<T>&& vector) noexcept :
+        arena_(vector.arena_),
+        buffer_(vector.buffer_),
+        size_(vector.size_),
+        capacity_(vector.capacity_)
+    {
+        vector.buffer_ = nullptr;
+        vector.size_ = 0;
+        vector.capacity_ = 0;
+    }
+
+    /// Destruct. Free the buffer only if it was allocated from the heap.
+    ~FrameVector()
+    {
+        FreeBuffer();
+    }
+
+    /// Assign from another vector. Keeps the current arena.
+    FrameVector<T>& operator =(const FrameVector<T>& rhs)
+    {
+        if (&rhs != this)
+        {
+            Resize(rhs.size_);
+            if (rhs.size_)
+                memcpy(buffer_, rhs.buffer_, rhs.size_ * sizeof(T));
+        }
+        return *this;
+    }
+
+    /// Move-assign from another vector.
+    FrameVector<T>& operator =(FrameVector<T>&& rhs) noexcept
+    {
+        if (&rhs != this)
+        {
+            FreeBuffer();
+            arena_ = rhs.arena_;
+            buffer_ = rhs.buffer_;
+            size_ = rhs.size_;
+            capacity_ = rhs.capacity_;
+            rhs.buffer_ = nullptr;
+            rhs.size_ = 0;
+            rhs.capacity_ = 0;
+        }
+        return *this;
+    }
+
+    /// Return element at index.
+    T& operator [](unsigned index)
+    {
+        assert(index < size_);
+        return buffer_[index];
+    }
+
+    /// Return const element at index.
+    const T& operator [](unsigned index) const
+    {
+        assert(index < size_);
+        return buffer_[index];
+    }
+
+    /// Return element at index.
+    T& At(unsigned index) { return (*this)[index]; }
+    /// Return const element at index.
+    const T& At(unsigned index) const { return (*this)[index]; }
+
+    /// Add an element at the end.
+    void Push(const T& value)
+    {
+        if (size_ < capacity_)
+            buffer_[size_++] = value;
+        else
+        {
+            // Value may reference the buffer, so take a copy before it moves
+            T valueCopy = value;
+            Resize(size_ + 1);
+            Back() = valueCopy;
+        }
+    }
+
+    /// Add another vector at the end.
+    void Push(const FrameVector<T>& vector)
+    {
+        if (vector.size_)
+        {
+            unsigned oldSize = size_;
+            Resize(size_ + vector.size_);
+            memcpy(buffer_ + oldSize, vector.buffer_, vector.size_ * sizeof(T));
+        }
+    }
+
+    /// Remove the last element.
+    void Pop()
+    {
+        if (size_)
+            --size_;
+    }
+
+    /// Resize the vector. New elements are uninitialized.
+    void Resize(unsigned newSize)
+    {
+        if (newSize > capacity_)
+        {
+            unsigned newCapacity = capacity_ + ((capacity_ + 1) >> 1u);
+            Reserve(newCapacity > newSize ? newCapacity : newSize);
+        }
+        size_ = newSize;
+    }
+
+    /// Set new capacity. Never shrinks.
+    void Reserve(unsigned newCapacity)
+    {
+        if (newCapacity <= capacity_)
+            return;
+
+        if (arena_)
+            buffer_ = static_cast<T*>(arena_->Reallocate(buffer_, capacity_ * sizeof(T), newCapacity * sizeof(T), alignof(T)));
+        else
+        {
+            auto* newBuffer = reinterpret_cast<T*>(new unsigned char[newCapacity * sizeof(T)]);
+            if (size_)
+                memcpy(newBuffer, buffer_, size_ * sizeof(T));
+            delete[] reinterpret_cast<unsigned char*>(buffer_);
+            buffer_ = newBuffer;
+        }
+        capacity_ = newCapacity;
+    }
+
+    /// Remove all elements. An arena buffer is forgotten, a heap buffer is kept for reuse.
+    void Clear()
+    {
+        if (arena_)
+        {
+            buffer_ = nullptr;
+            capacity_ = 0;
+        }
+        size_ = 0;
+    }
+
+    /// Clear and set the arena to allocate from. Null allocates from the heap instead.
+    void SetArena(FrameArena* arena)
+    {
+        FreeBuffer();
+        buffer_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+        arena_ = arena;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin() { return Iterator(buffer_); }
+    /// Return const iterator to the beginning.
+    ConstIterator Begin() const { return ConstIterator(buffer_); }
+    /// Return iterator to the end.
+    Iterator End() { return Iterator(buffer_ + size_); }
+    /// Return const iterator to the end.
+    ConstIterator End() const { return ConstIterator(buffer_ + size_); }
+    /// Return first element.
+    T& Front() { return (*this)[0]; }
+    /// Return const first element.
+    const T& Front() const { return (*this)[0]; }
+    /// Return last element.
+    T& Back() { return (*this)[size_ - 1]; }
+    /// Return const last element.
+    const T& Back() const { return (*this)[size_ - 1]; }
+    /// Return size of vector.
+    unsigned Size() const { return size_; }
+    /// Return capacity of vector.
+    unsigned Capacity() const { return capacity_; }
+    /// Return whether vector is empty.
+    bool Empty() const { return size_ == 0; }
+    /// Return the buffer with right type.
+    T* Buffer() const { return buffer_; }
+    /// Return the arena, or null if allocating from the heap.
+    FrameArena* GetArena() const { return arena_; }
+
+private:
+    /// Free the buffer if it was allocated from the heap.
+    void FreeBuffer()
+    {
+        if (!arena_)
+            delete[] reinterpret_cast<unsigned char*>(buffer_);
+    }
+
+    /// Arena to allocate from.
+    FrameArena* arena_;
+    /// Buffer.
+    T* buffer_{};
+    /// Number of elements.
+    unsigned size_{};
+    /// Buffer capacity.
+    unsigned capacity_{};
+};
+
+template <class T> typename Urho3D::FrameVector<T>::ConstIterator begin(const Urho3D::FrameVector<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FrameVector<T>::ConstIterator end(const Urho3D::FrameVector<T>& v) { return v.End(); }
+
+template <class T> typename Urho3D::FrameVector<T>::Iterator begin(Urho3D::FrameVector<T>& v) { return v.Begin(); }
+
+template <class T> typename Urho3D::FrameVector<T>::Iterator end(Urho3D::FrameVector<T>& v) { return v.End(); }
+
+}
@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Math/MathDefs.h"
+
+#include <atomic>
+#include <utility>
+
+namespace Urho3D
+{
+
+/// Bounded lock-free queue for multiple producer threads and a single consumer thread. The capacity is rounded up to a power of two.
+/** Each cell carries a sequence number that tells whether it is free for the producer at a given position or holds a
+    value for the consumer, so pushing costs one compare-and-swap and neither side ever blocks the other.
+  */
+template <class T> class MPSCRingBuffer
+{
+public:
+    /// Construct with capacity.
+    explicit MPSCRingBuffer(unsigned capacity) :
+        mask_(NextPowerOfTwo(Max(capacity, 2U)) - 1),
+        enqueuePos_(0),
+        dequeuePos_(0)
+    {
+        cells_ = new Cell[mask_ + 1];
+        for (unsigned i = 0; i <= mask_; ++i)
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+
+    /// Destruct.
+    ~MPSCRingBuffer() { delete[] cells_; }
+
+    /// Prevent copy construction.
+    MPSCRingBuffer(const MPSCRingBuffer<T>& rhs) = delete;
+    /// Prevent assignment.
+    MPSCRingBuffer<T>& operator =(const MPSCRingBuffer<T>& rhs) = delete;
+
+    /// Move a value into the queue. Return false and leave the value untouched if the queue is full. Can be called from any thread.
+    bool TryPush(T& value)
+    {
+        Cell* cell;
+        unsigned pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &cells_[pos & mask_];
+            unsigned sequence = cell->sequence_.load(std::memory_order_acquire);
+            int diff = (int)(sequence - pos);
+            if (!diff)
+            {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+
+        cell->value_ = std::move(value);
+        cell->sequence_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Move the oldest value out of the queue. Return false if the queue is empty. Must only be called from the consumer thread.
+    bool TryPop(T& value)
+    {
+        Cell& cell = cells_[dequeuePos_ & mask_];
+        unsigned sequence = cell.sequence_.load(std::memory_order_acquire);
+        if ((int)(sequence - (dequeuePos_ + 1)) < 0)
+            return false;
+
+        value = std::move(cell.value_);
+        cell.sequence_.store(dequeuePos_ + mask_ + 1, std::memory_order_release);
+        ++dequeuePos_;
+        return true;
+    }
+
+    /// Return whether the queue is empty, counting values still being pushed. Must only be called from the consumer thread.
+    bool IsEmpty() const { return enqueuePos_.load(std::memory_order_acquire) == dequeuePos_; }
+
+    /// Return capacity.
+    unsigned GetCapacity() const { return mask_ + 1; }
+
+private:
+    /// Queue cell.
+    struct Cell
+    {
+        /// Sequence number. Equals the position when free for a producer, position + 1 when holding a value.
+        std::atomic<unsigned> sequence_;
+        /// Value.
+        T value_;
+    };
+
+    /// Cells.
+    Cell* cells_;
+    /// Capacity minus one.
+    unsigned mask_;
+    /// Padding to keep the producer position on its own cache line.
+    char padding0_[64];
+    /// Next position to push to.
+    std::atomic<unsigned> enqueuePos_;
+    /// Padding to keep the consumer position on its own cache line.
+    char padding1_[64];
+    /// Next position to pop from.
+    unsigned dequeuePos_;
+};
+
+}
@@ -25,10 +25,13 @@
 #include "../Container/Swap.h"
 #include "../Container/VectorBase.h"
 
+#include <cstring>
+
 namespace Urho3D
 {
 
 static const int QUICKSORT_THRESHOLD = 16;
+static const unsigned RADIXSORT_THRESHOLD = 64;
 
 // Based on Comparison of several sorting algorithms by Juha Nieminen
 // http://warp.povusers.org/SortComparison/
@@ -141,4 +144,77 @@ template <class T, class U> void Sort(RandomAccessIterator<T> begin, RandomAcces
     InsertionSort(begin, end, compare);
 }
 
+/// Sort values by 64-bit keys in ascending order using a stable least significant digit radix sort. Keys and values are permuted together. Byte positions in which all keys are equal are skipped, and short arrays are insertion sorted instead. The temporary arrays must hold as many elements as the sorted arrays.
+template <class T> void RadixSort(unsigned long long* keys, T* values, unsigned long long* tempKeys, T* tempValues, unsigned count)
+{
+    if (count < RADIXSORT_THRESHOLD)
+    {
+        for (unsigned i = 1; i < count; ++i)
+        {
+            unsigned long long key = keys[i];
+            T value = values[i];
+            unsigned j = i;
+            while (j > 0 && key < keys[j - 1])
+            {
+                keys[j] = keys[j - 1];
+                values[j] = values[j - 1];
+                --j;
+            }
+            keys[j] = key;
+            values[j] = value;
+        }
+        return;
+    }
+
+    // Count the occurrences of each digit for all byte positions at once
+    unsigned counts[8][256];
+    memset(counts, 0, sizeof counts);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        unsigned long long key = keys[i];
+        for (unsigned j = 0; j < 8; ++j)
+            ++counts[j][(key >> (j * 8)) & 0xffu];
+    }
+
+    unsigned long long* srcKeys = keys;
+    T* srcValues = values;
+    unsigned long long* destKeys = tempKeys;
+    T* destValues = tempValues;
+
+    for (unsigned j = 0; j < 8; ++j)
+    {
+        unsigned shift = j * 8;
+        unsigned* digitCounts = counts[j];
+        if (digitCounts[(keys[0] >> shift) & 0xffu] == count)
+            continue;
+
+        // Turn the counts into start offsets, then scatter
+        unsigned offset = 0;
+        for (unsigned k = 0; k < 256; ++k)
+        {
+            unsigned digitCount = digitCounts[k];
+            digitCounts[k] = offset;
+            offset += digitCount;
+        }
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+            unsigned index = digitCounts[(srcKeys[i] >> shift) & 0xffu]++;
+            destKeys[index] = srcKeys[i];
+            destValues[index] = srcValues[i];
+        }
+
+        Swap(srcKeys, destKeys);
+        Swap(srcValues, destValues);
+    }
+
+    // After an odd number of passes the result is in the temporary arrays
+    if (srcKeys != keys)
+    {
+        memcpy(keys, srcKeys, count * sizeof(unsigned long long));
+        for (unsigned i = 0; i < count; ++i)
+            values[i] = srcValues[i];
+    }
+}
+
 }
@@ -70,32 +70,152 @@ void EventReceiverGroup::EndSendEvent()
         for (unsigned i = receivers_.Size() - 1; i < receivers_.Size(); --i)
         {
             if (!receivers_[i])
+            {
                 receivers_.Erase(i);
+                orders_.Erase(i);
+            }
         }
 
         dirty_ = false;
     }
 }
 
-void EventReceiverGroup::Add(Object* object)
+void EventReceiverGroup::Add(Object* object, unsigned long long order)
 {
     if (object)
+    {
         receivers_.Push(object);
+        orders_.Push(order);
+    }
 }
 
 void EventReceiverGroup::Remove(Object* object)
 {
+    PODVector<Object*>::Iterator i = receivers_.Find(object);
+    if (i == receivers_.End())
+        return;
+
     if (inSend_ > 0)
     {
-        PODVector<Object*>::Iterator i = receivers_.Find(object);
-        if (i != receivers_.End())
+        (*i) = nullptr;
+        dirty_ = true;
+    }
+    else
+    {
+        orders_.Erase((unsigned)(i - receivers_.Begin()));
+        receivers_.Erase(i);
+    }
+}
+
+TypedEventReceiverGroup::~TypedEventReceiverGroup()
+{
+    for (PODVector<TypedEventHandler*>::Iterator i = handlers_.Begin(); i != handlers_.End(); ++i)
+        delete *i;
+    for (PODVector<TypedEventHandler*>::Iterator i = removedHandlers_.Begin(); i != removedHandlers_.End(); ++i)
+        delete *i;
+}
+
+void TypedEventReceiverGroup::BeginSendEvent()
+{
+    ++inSend_;
+}
+
+void TypedEventReceiverGroup::EndSendEvent()
+{
+    assert(inSend_ > 0);
+    --inSend_;
+
+    if (inSend_ == 0 && dirty_)
+    {
+        // Keep the handler order
+        for (unsigned i = handlers_.Size() - 1; i < handlers_.Size(); --i)
+        {
+            if (!handlers_[i])
+            {
+                handlers_.Erase(i);
+                orders_.Erase(i);
+            }
+        }
+
+        // Handlers may have been removed while they were executing, so delete only now
+        for (PODVector<TypedEventHandler*>::Iterator i = removedHandlers_.Begin(); i != removedHandlers_.End(); ++i)
+            delete *i;
+        removedHandlers_.Clear();
+
+        dirty_ = false;
+    }
+}
+
+void TypedEventReceiverGroup::Add(TypedEventHandler* handler, unsigned long long order)
+{
+    if (!handler)
+        return;
+
+    // Replace an existing subscription in place, like VariantMap event handlers, so that it keeps its order
+    unsigned index = FindIndex(handler->GetReceiver(), handler->GetSender());
+    if (index != M_MAX_UNSIGNED)
+    {
+        if (inSend_ > 0)
         {
-            (*i) = nullptr;
+            // The old handler may be executing, so delete it once the send ends
+            removedHandlers_.Push(handlers_[index]);
             dirty_ = true;
         }
+        else
+            delete handlers_[index];
+        handlers_[index] = handler;
+    }
+    else
+    {
+        handlers_.Push(handler);
+        orders_.Push(order);
+    }
+}
+
+void TypedEventReceiverGroup::Remove(Object* receiver, Object* sender, bool allSenders)
+{
+    for (unsigned i = handlers_.Size() - 1; i < handlers_.Size(); --i)
+    {
+        TypedEventHandler* handler = handlers_[i];
+        if (handler && handler->GetReceiver() == receiver && (allSenders || (handler->IsSpecific() == (sender != nullptr) &&
+            handler->GetSender() == sender)))
+            RemoveAt(i);
+    }
+}
+
+TypedEventHandler* TypedEventReceiverGroup::Find(Object* receiver, Object* sender) const
+{
+    unsigned index = FindIndex(receiver, sender);
+    return index != M_MAX_UNSIGNED ? handlers_[index] : nullptr;
+}
+
+unsigned TypedEventReceiverGroup::FindIndex(Object* receiver, Object* sender) const
+{
+    for (unsigned i = 0; i < handlers_.Size(); ++i)
+    {
+        TypedEventHandler* handler = handlers_[i];
+        if (handler && handler->GetReceiver() == receiver && handler->IsSpecific() == (sender != nullptr) &&
+            handler->GetSender() == sender)
+            return i;
+    }
+
+    return M_MAX_UNSIGNED;
+}
+
+void TypedEventReceiverGroup::RemoveAt(unsigned index)
+{
+    if (inSend_ > 0)
+    {
+        removedHandlers_.Push(handlers_[index]);
+        handlers_[index] = nullptr;
+        dirty_ = true;
     }
     else
-        receivers_.Remove(object);
+    {
+        delete handlers_[index];
+        handlers_.Erase(index);
+        orders_.Erase(index);
+    }
 }
 
 void RemoveNamedAttribute(HashMap<StringHash, Vector<AttributeInfo> >& attributes, StringHash objectType, const char* name)
@@ -121,7 +241,8 @@ void RemoveNamedAttribute(HashMap<StringHash, Vector<AttributeInfo> >& attribute
 }
 
 Context::Context() :
-    eventHandler_(nullptr)
+    eventHandler_(nullptr),
+    nextEventOrder_(0)
 {
 #ifdef __ANDROID__
     // Always reset the random seed on Android, as the Urho3D library might not be unloaded between runs
@@ -408,7 +529,7 @@ void Context::AddEventReceiver(Object* receiver, StringHash eventType)
     SharedPtr<EventReceiverGroup>& group = eventReceivers_[eventType];
     if (!group)
         group = new EventReceiverGroup();
-    group->Add(receiver);
+    group->Add(receiver, nextEventOrder_++);
 }
 
 void Context::AddEventReceiver(Object* receiver, Object* sender, StringHash eventType)
@@ -416,7 +537,7 @@ void Context::AddEventReceiver(Object* receiver, Object* sender, StringHash even
     SharedPtr<EventReceiverGroup>& group = specificEventReceivers_[sender][eventType];
     if (!group)
         group = new EventReceiverGroup();
-    group->Add(receiver);
+    group->Add(receiver, nextEventOrder_++);
 }
 
 void Context::RemoveEventSender(Object* sender)
@@ -451,6 +572,26 @@ void Context::RemoveEventReceiver(Object* receiver, Object* sender, StringHash e
         group->Remove(receiver);
 }
 
+void Context::AddTypedEventHandler(unsigned index, TypedEventHandler* handler)
+{
+    if (typedEventReceivers_.Size() <= index)
+        typedEventReceivers_.Resize(index + 1);
+
+    SharedPtr<TypedEventReceiverGroup>& group = typedEventReceivers_[index];
+    if (!group)
+        group = new TypedEventReceiverGroup();
+    group->Add(handler, nextEventOrder_++);
+}
+
+void Context::RemoveTypedEventReceiver(Object* receiver)
+{
+    for (Vector<SharedPtr<TypedEventReceiverGroup> >::Iterator i = typedEventReceivers_.Begin(); i != typedEventReceivers_.End(); ++i)
+    {
+        if (*i)
+            (*i)->Remove(receiver, nullptr, true);
+    }
+}
+
 void Context::BeginSendEvent(Object* sender, StringHash eventType)
 {
 #ifdef URHO3D_PROFILING
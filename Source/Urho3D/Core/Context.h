@@ -46,14 +46,16 @@ public:
     /// End event send. Clean up if necessary.
     void EndSendEvent();
 
-    /// Add receiver. Same receiver must not be double-added!
-    void Add(Object* object);
+    /// Add receiver with its subscription order. Same receiver must not be double-added!
+    void Add(Object* object, unsigned long long order);
 
     /// Remove receiver. Leave holes during send, which requires later cleanup.
     void Remove(Object* object);
 
     /// Receivers. May contain holes during sending.
     PODVector<Object*> receivers_;
+    /// Subscription order of each receiver, shared with typed event handlers so that both kinds are invoked in the order they subscribed.
+    PODVector<unsigned long long> orders_;
 
 private:
     /// "In send" recursion counter.
@@ -62,6 +64,54 @@ private:
     bool dirty_;
 };
 
+/// Tracking structure for typed event handlers of one event type. Owns the handlers.
+class URHO3D_API TypedEventReceiverGroup : public RefCounted
+{
+public:
+    /// Construct.
+    TypedEventReceiverGroup() :
+        inSend_(0),
+        dirty_(false)
+    {
+    }
+
+    /// Destruct. Delete the handlers.
+    ~TypedEventReceiverGroup() override;
+
+    /// Begin event send. When handlers are removed during send, group has to be cleaned up afterward.
+    void BeginSendEvent();
+
+    /// End event send. Clean up and delete removed handlers if necessary.
+    void EndSendEvent();
+
+    /// Add handler with its subscription order and take ownership. An existing handler of the same receiver and sender is replaced in place and keeps its order.
+    void Add(TypedEventHandler* handler, unsigned long long order);
+
+    /// Remove handlers of a receiver, either for a specific sender or for all senders. Leave holes during send, which requires later cleanup.
+    void Remove(Object* receiver, Object* sender, bool allSenders);
+
+    /// Return handler of a receiver for a specific sender, or for no specific sender if null.
+    TypedEventHandler* Find(Object* receiver, Object* sender) const;
+
+    /// Handlers. May contain holes during sending.
+    PODVector<TypedEventHandler*> handlers_;
+    /// Subscription order of each handler, shared with VariantMap event receivers.
+    PODVector<unsigned long long> orders_;
+
+private:
+    /// Return index of the handler of a receiver for a specific sender, or for no specific sender if null. Return M_MAX_UNSIGNED if not found.
+    unsigned FindIndex(Object* receiver, Object* sender) const;
+    /// Remove handler at index.
+    void RemoveAt(unsigned index);
+
+    /// Handlers removed during send, deleted once the send ends.
+    PODVector<TypedEventHandler*> removedHandlers_;
+    /// "In send" recursion counter.
+    unsigned inSend_;
+    /// Cleanup required flag.
+    bool dirty_;
+};
+
 /// Urho3D execution context. Provides access to subsystems, object factories and attributes, and event receivers.
 class URHO3D_API Context : public RefCounted
 {
@@ -203,6 +253,12 @@ public:
         return i != eventReceivers_.End() ? i->second_ : nullptr;
     }
 
+    /// Return typed event handlers for a typed event index, or null if they do not exist.
+    TypedEventReceiverGroup* GetTypedEventReceivers(unsigned index) const
+    {
+        return index < typedEventReceivers_.Size() ? typedEventReceivers_[index].Get() : nullptr;
+    }
+
 private:
     /// Add event receiver.
     void AddEventReceiver(Object* receiver, StringHash eventType);
@@ -214,6 +270,10 @@ private:
     void RemoveEventReceiver(Object* receiver, Object* sender, StringHash eventType);
     /// Remove event receiver from non-specific events.
     void RemoveEventReceiver(Object* receiver, StringHash eventType);
+    /// Add typed event handler.
+    void AddTypedEventHandler(unsigned index, TypedEventHandler* handler);
+    /// Remove all typed event handlers of a receiver. Called on its destruction.
+    void RemoveTypedEventReceiver(Object* receiver);
     /// Begin event send.
     void BeginSendEvent(Object* sender, StringHash eventType);
     /// End event send. Clean up event receivers removed in the meanwhile.
@@ -234,12 +294,16 @@ private:
     HashMap<StringHash, SharedPtr<EventReceiverGroup> > eventReceivers_;
     /// Event receivers for specific senders' events.
     HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > > specificEventReceivers_;
+    /// Typed event handlers indexed by typed event index.
+    Vector<SharedPtr<TypedEventReceiverGroup> > typedEventReceivers_;
     /// Event sender stack.
     PODVector<Object*> eventSenders_;
     /// Event data stack.
     PODVector<VariantMap*> eventDataMaps_;
     /// Active event handler. Not stored in a stack for performance reasons; is needed only in esoteric cases.
     EventHandler* eventHandler_;
+    /// Subscription order of the next event receiver or typed event handler.
+    unsigned long long nextEventOrder_;
     /// Object categories.
     HashMap<String, Vector<StringHash> > objectCategories_;
     /// Variant map for global variables that can persist throughout application execution.
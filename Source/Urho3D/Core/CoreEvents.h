@@ -46,6 +46,30 @@ URHO3D_EVENT(E_POSTUPDATE, PostUpdate)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Typed event data of the application-wide logic update event.
+struct UpdateEventData
+{
+    /// Return event type.
+    static StringHash GetEventTypeStatic() { return E_UPDATE; }
+    /// Convert to event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const { eventData[Update::P_TIMESTEP] = timeStep_; }
+
+    /// Timestep in seconds.
+    float timeStep_;
+};
+
+/// Typed event data of the application-wide logic post-update event.
+struct PostUpdateEventData
+{
+    /// Return event type.
+    static StringHash GetEventTypeStatic() { return E_POSTUPDATE; }
+    /// Convert to event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const { eventData[PostUpdate::P_TIMESTEP] = timeStep_; }
+
+    /// Timestep in seconds.
+    float timeStep_;
+};
+
 /// Render update event.
 URHO3D_EVENT(E_RENDERUPDATE, RenderUpdate)
 {
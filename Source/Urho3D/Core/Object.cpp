@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Mutex.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Thread.h"
 #include "../Core/Profiler.h"
@@ -76,7 +77,8 @@ bool TypeInfo::IsTypeOf(const TypeInfo* typeInfo) const
 
 Object::Object(Context* context) :
     context_(context),
-    blockEvents_(false)
+    blockEvents_(false),
+    hasTypedEventHandlers_(false)
 {
     assert(context_);
 }
@@ -84,6 +86,8 @@ Object::Object(Context* context) :
 Object::~Object()
 {
     UnsubscribeFromAllEvents();
+    if (hasTypedEventHandlers_)
+        context_->RemoveTypedEventReceiver(this);
     context_->RemoveEventSender(this);
 }
 
@@ -406,6 +410,143 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     context->EndSendEvent();
 }
 
+void Object::DispatchTypedEvent(unsigned index, StringHash eventType, const void* event, VariantMap* eventData)
+{
+    if (!Thread::IsMainThread())
+    {
+        URHO3D_LOGERROR("Sending events is only supported from the main thread");
+        return;
+    }
+
+    if (blockEvents_)
+        return;
+
+    TypedEventReceiverGroup* typedGroup = context_->GetTypedEventReceivers(index);
+    if (!eventData && (!typedGroup || typedGroup->handlers_.Empty()))
+        return;
+
+#ifdef URHO3D_TRACY_PROFILING
+    URHO3D_PROFILE_COLOR(SendTypedEvent, URHO3D_PROFILE_EVENT_COLOR);
+
+    const String& eventName = GetEventNameRegister().GetString(eventType);
+    URHO3D_PROFILE_STR(eventName.CString(), eventName.Length());
+#endif
+
+    // Make a weak pointer to self to check for destruction during event handling
+    WeakPtr<Object> self(this);
+    Context* context = context_;
+    HashSet<Object*> processed;
+
+    context->BeginSendEvent(this, eventType);
+    if (typedGroup)
+        typedGroup->BeginSendEvent();
+
+    // Handlers added during the send are not invoked until the next send
+    const unsigned numHandlers = typedGroup ? typedGroup->handlers_.Size() : 0;
+
+    // As with VariantMap events, first the specific receivers, then the non-specific receivers
+    // Note: group is held alive with a shared ptr, as it may get destroyed along with the sender
+    SharedPtr<EventReceiverGroup> group(eventData ? context->GetEventReceivers(this, eventType) : nullptr);
+    if (DispatchTypedEventReceivers(group, typedGroup, numHandlers, true, eventType, event, eventData, processed))
+    {
+        group = eventData ? context->GetEventReceivers(eventType) : nullptr;
+        DispatchTypedEventReceivers(group, typedGroup, numHandlers, false, eventType, event, eventData, processed);
+    }
+
+    if (typedGroup)
+        typedGroup->EndSendEvent();
+    context->EndSendEvent();
+}
+
+bool Object::DispatchTypedEventReceivers(EventReceiverGroup* group, TypedEventReceiverGroup* typedGroup, unsigned numHandlers,
+    bool specific, StringHash eventType, const void* event, VariantMap* eventData, HashSet<Object*>& processed)
+{
+    WeakPtr<Object> self(this);
+    const unsigned numReceivers = group ? group->receivers_.Size() : 0;
+    unsigned j = 0;
+
+    if (group)
+        group->BeginSendEvent();
+
+    for (unsigned i = 0; i <= numReceivers; ++i)
+    {
+        // Invoke the typed handlers that subscribed before the next VariantMap receiver, so that both kinds are invoked
+        // in subscription order
+        const unsigned long long order = i < numReceivers ? group->orders_[i] : std::numeric_limits<unsigned long long>::max();
+        for (; j < numHandlers && typedGroup->orders_[j] < order; ++j)
+        {
+            TypedEventHandler* handler = typedGroup->handlers_[j];
+            // Holes may exist if handlers removed during send
+            if (!handler || handler->IsSpecific() != specific || (specific && handler->GetSender() != this) ||
+                handler->GetReceiver()->GetBlockEvents())
+                continue;
+
+            handler->Invoke(event);
+
+            // If self has been destroyed as a result of event handling, exit
+            if (self.Expired())
+            {
+                if (group)
+                    group->EndSendEvent();
+                return false;
+            }
+        }
+
+        if (i == numReceivers)
+            break;
+
+        Object* receiver = group->receivers_[i];
+        // Holes may exist if receivers removed during send. If there were specific receivers, check that the event is
+        // not sent doubly to them
+        if (!receiver || (!specific && processed.Contains(receiver)))
+            continue;
+
+        receiver->OnEvent(this, eventType, *eventData);
+
+        if (self.Expired())
+        {
+            group->EndSendEvent();
+            return false;
+        }
+
+        if (specific)
+            processed.Insert(receiver);
+    }
+
+    if (group)
+        group->EndSendEvent();
+    return true;
+}
+
+bool Object::HasEventReceivers(StringHash eventType) const
+{
+    EventReceiverGroup* group = context_->GetEventReceivers(const_cast<Object*>(this), eventType);
+    if (group && !group->receivers_.Empty())
+        return true;
+
+    group = context_->GetEventReceivers(eventType);
+    return group && !group->receivers_.Empty();
+}
+
+void Object::AddTypedEventHandler(unsigned index, TypedEventHandler* handler)
+{
+    context_->AddTypedEventHandler(index, handler);
+    hasTypedEventHandlers_ = true;
+}
+
+void Object::RemoveTypedEventHandlers(unsigned index, Object* sender, bool allSenders)
+{
+    TypedEventReceiverGroup* group = context_->GetTypedEventReceivers(index);
+    if (group)
+        group->Remove(this, sender, allSenders);
+}
+
+bool Object::HasTypedEventHandler(unsigned index, Object* sender) const
+{
+    TypedEventReceiverGroup* group = context_->GetTypedEventReceivers(index);
+    return group && group->Find(const_cast<Object*>(this), sender) != nullptr;
+}
+
 VariantMap& Object::GetEventDataMap() const
 {
     return context_->GetEventDataMap();
@@ -547,4 +688,20 @@ StringHashRegister& GetEventNameRegister()
     return eventNameRegister;
 }
 
+unsigned RegisterTypedEvent(StringHash eventType)
+{
+    // Typed event indices may be requested from worker threads through static initialization
+    static Mutex typedEventMutex;
+    static HashMap<StringHash, unsigned> typedEventIndices;
+
+    MutexLock lock(typedEventMutex);
+    HashMap<StringHash, unsigned>::ConstIterator i = typedEventIndices.Find(eventType);
+    if (i != typedEventIndices.End())
+        return i->second_;
+
+    unsigned index = typedEventIndices.Size();
+    typedEventIndices[eventType] = index;
+    return index;
+}
+
 }
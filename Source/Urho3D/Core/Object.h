@@ -33,6 +33,10 @@ namespace Urho3D
 
 class Context;
 class EventHandler;
+class EventReceiverGroup;
+class TypedEventHandler;
+class TypedEventReceiverGroup;
+template <class T> class HashSet;
 
 /// Type info.
 /// @nobind
@@ -78,6 +82,16 @@ private:
         static const Urho3D::String& GetTypeNameStatic() { return GetTypeInfoStatic()->GetTypeName(); } \
         static const Urho3D::TypeInfo* GetTypeInfoStatic() { static const Urho3D::TypeInfo typeInfoStatic(#typeName, BaseClassName::GetTypeInfoStatic()); return &typeInfoStatic; }
 
+/// Return typed event index of an event type. Typed event data structures of the same event type share the index, also across shared library boundaries.
+URHO3D_API unsigned RegisterTypedEvent(StringHash eventType);
+
+/// Return typed event index of a typed event data structure.
+template <class T> unsigned GetTypedEventIndex()
+{
+    static const unsigned index = RegisterTypedEvent(T::GetEventTypeStatic());
+    return index;
+}
+
 /// Base class for objects with type identification, subsystem access and event sending/receiving capability.
 /// @templateversion
 class URHO3D_API Object : public RefCounted
@@ -144,6 +158,23 @@ public:
         SendEvent(eventType, GetEventDataMap().Populate(args...));
     }
 
+    /// Subscribe to a typed event that can be sent by any sender. The handler receives the event data structure directly.
+    template <class T> void SubscribeToTypedEvent(const std::function<void(const T&)>& function);
+    /// Subscribe to a specific sender's typed event.
+    template <class T> void SubscribeToTypedEvent(Object* sender, const std::function<void(const T&)>& function);
+    /// Subscribe to a typed event that can be sent by any sender, using a member function of the receiver.
+    template <class T, class U> void SubscribeToTypedEvent(void (U::*function)(const T&));
+    /// Subscribe to a specific sender's typed event, using a member function of the receiver.
+    template <class T, class U> void SubscribeToTypedEvent(Object* sender, void (U::*function)(const T&));
+    /// Unsubscribe from a typed event, including the subscriptions to specific senders.
+    template <class T> void UnsubscribeFromTypedEvent() { RemoveTypedEventHandlers(GetTypedEventIndex<T>(), nullptr, true); }
+    /// Unsubscribe from a specific sender's typed event.
+    template <class T> void UnsubscribeFromTypedEvent(Object* sender) { RemoveTypedEventHandlers(GetTypedEventIndex<T>(), sender, false); }
+    /// Send a typed event. Typed subscribers receive the event data structure directly without a VariantMap. If there are also VariantMap subscribers (including script) to the same event type, the structure is converted to event data for them. Handlers of both kinds are invoked in the order they subscribed, the subscribers to this specific sender before the others.
+    template <class T> void SendTypedEvent(const T& event);
+    /// Return whether has subscribed to a typed event, either without specific sender (null) or from a specific sender.
+    template <class T> bool HasSubscribedToTypedEvent(Object* sender = nullptr) const { return HasTypedEventHandler(GetTypedEventIndex<T>(), sender); }
+
     /// Return execution context.
     Context* GetContext() const { return context_; }
     /// Return global variable based on key.
@@ -193,12 +224,27 @@ private:
     EventHandler* FindSpecificEventHandler(Object* sender, StringHash eventType, EventHandler** previous = nullptr) const;
     /// Remove event handlers related to a specific sender.
     void RemoveEventSender(Object* sender);
+    /// Add a typed event handler, replacing an existing subscription to the same sender.
+    void AddTypedEventHandler(unsigned index, TypedEventHandler* handler);
+    /// Remove typed event handlers of an event, either for a specific sender or for all senders.
+    void RemoveTypedEventHandlers(unsigned index, Object* sender, bool allSenders);
+    /// Return whether has a typed event handler for a sender.
+    bool HasTypedEventHandler(unsigned index, Object* sender) const;
+    /// Send a typed event to typed subscribers, and to VariantMap subscribers if event data is given, in subscription order.
+    void DispatchTypedEvent(unsigned index, StringHash eventType, const void* event, VariantMap* eventData);
+    /// Invoke the VariantMap receivers of a group and the typed handlers to a specific sender or to no specific sender, merged in subscription order. Return false if self was destroyed.
+    bool DispatchTypedEventReceivers(EventReceiverGroup* group, TypedEventReceiverGroup* typedGroup, unsigned numHandlers, bool specific,
+        StringHash eventType, const void* event, VariantMap* eventData, HashSet<Object*>& processed);
+    /// Return whether an event type has VariantMap receivers for this sender.
+    bool HasEventReceivers(StringHash eventType) const;
 
     /// Event handlers. Sender is null for non-specific handlers.
     LinkedList<EventHandler> eventHandlers_;
 
     /// Block object from sending and receiving any events.
     bool blockEvents_;
+    /// Has subscribed to typed events. Used to skip the typed event cleanup on destruction.
+    bool hasTypedEventHandlers_;
 };
 
 template <class T> T* Object::GetSubsystem() const { return static_cast<T*>(GetSubsystem(T::GetTypeStatic())); }
@@ -367,6 +413,102 @@ private:
 /// Get register of event names.
 URHO3D_API StringHashRegister& GetEventNameRegister();
 
+/// Typed event handler. Receives a typed event data structure instead of a VariantMap.
+class URHO3D_API TypedEventHandler
+{
+public:
+    /// Construct with receiver and optional specific sender.
+    TypedEventHandler(Object* receiver, Object* sender) :
+        receiver_(receiver),
+        sender_(sender),
+        specific_(sender != nullptr)
+    {
+    }
+
+    /// Destruct.
+    virtual ~TypedEventHandler() = default;
+
+    /// Invoke handler function with a pointer to the event data structure.
+    virtual void Invoke(const void* event) = 0;
+
+    /// Return event receiver.
+    Object* GetReceiver() const { return receiver_; }
+
+    /// Return specific sender, or null if not specific or the sender has been destroyed.
+    Object* GetSender() const { return sender_; }
+
+    /// Return whether is subscribed to a specific sender.
+    bool IsSpecific() const { return specific_; }
+
+protected:
+    /// Event receiver.
+    Object* receiver_;
+    /// Specific event sender. Weak so that handlers of destroyed senders never match a new object at the same address.
+    WeakPtr<Object> sender_;
+    /// Specific sender flag.
+    bool specific_;
+};
+
+/// Template implementation of the typed event handler.
+template <class T> class TypedEventHandlerImpl : public TypedEventHandler
+{
+public:
+    /// Construct with receiver, optional specific sender and function.
+    TypedEventHandlerImpl(Object* receiver, Object* sender, const std::function<void(const T&)>& function) :
+        TypedEventHandler(receiver, sender),
+        function_(function)
+    {
+    }
+
+    /// Invoke handler function.
+    void Invoke(const void* event) override { function_(*static_cast<const T*>(event)); }
+
+private:
+    /// Handler function.
+    std::function<void(const T&)> function_;
+};
+
+template <class T> void Object::SubscribeToTypedEvent(const std::function<void(const T&)>& function)
+{
+    AddTypedEventHandler(GetTypedEventIndex<T>(), new TypedEventHandlerImpl<T>(this, nullptr, function));
+}
+
+template <class T> void Object::SubscribeToTypedEvent(Object* sender, const std::function<void(const T&)>& function)
+{
+    // If a null sender was specified, the event can not be subscribed to. Accept but do nothing.
+    if (!sender)
+        return;
+
+    AddTypedEventHandler(GetTypedEventIndex<T>(), new TypedEventHandlerImpl<T>(this, sender, function));
+}
+
+template <class T, class U> void Object::SubscribeToTypedEvent(void (U::*function)(const T&))
+{
+    U* receiver = static_cast<U*>(this);
+    SubscribeToTypedEvent<T>([receiver, function](const T& event) { (receiver->*function)(event); });
+}
+
+template <class T, class U> void Object::SubscribeToTypedEvent(Object* sender, void (U::*function)(const T&))
+{
+    U* receiver = static_cast<U*>(this);
+    SubscribeToTypedEvent<T>(sender, [receiver, function](const T& event) { (receiver->*function)(event); });
+}
+
+template <class T> void Object::SendTypedEvent(const T& event)
+{
+    const StringHash eventType = T::GetEventTypeStatic();
+
+    // Adapter for VariantMap subscribers: fill the event data only if someone listens
+    if (HasEventReceivers(eventType))
+    {
+        VariantMap& eventData = GetEventDataMap();
+        event.ToVariantMap(eventData);
+        DispatchTypedEvent(GetTypedEventIndex<T>(), eventType, &event, &eventData);
+    }
+    else
+        DispatchTypedEvent(GetTypedEventIndex<T>(), eventType, &event, nullptr);
+}
+
 /// Describe an event's hash ID and begin a namespace in which to define its parameters.
 #define URHO3D_EVENT(eventID, eventName) static const Urho3D::StringHash eventID(Urho3D::GetEventNameRegister().RegisterString(#eventName)); namespace eventName
 /// Describe an event's parameter hash ID. Should be used inside an event namespace.
@@ -67,6 +67,41 @@ void Profiler::BeginInterval()
 {
     root_->BeginInterval();
     intervalFrames_ = 0;
+
+    for (Vector<ProfilerCounter>::Iterator i = counters_.Begin(); i != counters_.End(); ++i)
+    {
+        i->intervalTotal_ = 0;
+        i->intervalMax_ = 0;
+        i->intervalCount_ = 0;
+    }
+}
+
+void Profiler::SetCounter(const char* name, long long value)
+{
+    if (!Thread::IsMainThread())
+        return;
+
+    ProfilerCounter* counter = nullptr;
+    for (Vector<ProfilerCounter>::Iterator i = counters_.Begin(); i != counters_.End(); ++i)
+    {
+        if (i->name_ == name)
+        {
+            counter = &*i;
+            break;
+        }
+    }
+    if (!counter)
+    {
+        counters_.Resize(counters_.Size() + 1);
+        counter = &counters_.Back();
+        counter->name_ = name;
+    }
+
+    counter->frameValue_ = value;
+    counter->intervalTotal_ += value;
+    if (value > counter->intervalMax_)
+        counter->intervalMax_ = value;
+    ++counter->intervalCount_;
 }
 
 const String& Profiler::PrintData(bool showUnused, bool showTotal, unsigned maxDepth) const
@@ -86,6 +121,22 @@ const String& Profiler::PrintData(bool showUnused, bool showTotal, unsigned maxD
 
     PrintData(root_, output, 0, maxDepth, showUnused, showTotal);
 
+    if (!counters_.Empty())
+    {
+        char line[256];
+
+        output += "\nCounter                           Frame        Avg        Max\n\n";
+        for (Vector<ProfilerCounter>::ConstIterator i = counters_.Begin(); i != counters_.End(); ++i)
+        {
+            if (!showUnused && !i->intervalCount_)
+                continue;
+
+            long long avg = i->intervalCount_ ? i->intervalTotal_ / i->intervalCount_ : 0;
+            snprintf(line, sizeof(line), "%-30.30s %10lld %10lld %10lld\n", i->name_.CString(), i->frameValue_, avg, i->intervalMax_);
+            output += String(line);
+        }
+    }
+
     return output;
 }
 
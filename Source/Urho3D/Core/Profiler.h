@@ -174,6 +174,22 @@ public:
     unsigned totalCount_;
 };
 
+/// Named per-frame value reported to the profiler, such as an allocation count.
+/// @nobind
+struct ProfilerCounter
+{
+    /// Counter name.
+    String name_;
+    /// Value on the previous frame.
+    long long frameValue_{};
+    /// Sum of values during current profiler interval.
+    long long intervalTotal_{};
+    /// Maximum value during current profiler interval.
+    long long intervalMax_{};
+    /// Frames with a value during current profiler interval.
+    unsigned intervalCount_{};
+};
+
 /// Hierarchical performance profiler subsystem.
 class URHO3D_API Profiler : public Object
 {
@@ -213,6 +229,8 @@ public:
     void EndFrame();
     /// Begin a new interval.
     void BeginInterval();
+    /// Set the value of a named counter for the current frame. Should be called at most once per frame for each counter.
+    void SetCounter(const char* name, long long value);
 
     /// Return profiling data as text output. This method is not thread-safe.
     const String& PrintData(bool showUnused = false, bool showTotal = false, unsigned maxDepth = M_MAX_UNSIGNED) const;
@@ -220,6 +238,8 @@ public:
     const ProfilerBlock* GetCurrentBlock() { return current_; }
     /// Return the root profiling block.
     const ProfilerBlock* GetRootBlock() { return root_; }
+    /// Return the counters.
+    const Vector<ProfilerCounter>& GetCounters() const { return counters_; }
 
 protected:
     /// Return profiling data as text output for a specified profiling block.
@@ -231,6 +251,8 @@ protected:
     ProfilerBlock* root_;
     /// Frames in the current interval.
     unsigned intervalFrames_;
+    /// Counters.
+    Vector<ProfilerCounter> counters_;
 };
 
 /// Helper class for automatically beginning and ending a profiling block.
@@ -268,6 +290,16 @@ private:
     #define URHO3D_PROFILE(name)
 #endif
 
+#ifdef URHO3D_TRACY_PROFILING // Use Tracy profiler
+    /// Macro for reporting a per-frame value with a string literal name.
+    #define URHO3D_PROFILE_VALUE(name, value) TracyPlot(name, (int64_t)(value))
+#elif defined(URHO3D_PROFILING) // Use default profiler
+    /// Macro for reporting a per-frame value with a string literal name.
+    #define URHO3D_PROFILE_VALUE(name, value) do { if (auto* profiler_ = GetSubsystem<Urho3D::Profiler>()) profiler_->SetCounter(name, value); } while (false)
+#else // Profiling off
+    #define URHO3D_PROFILE_VALUE(name, value)
+#endif
+
 #ifdef URHO3D_TRACY_PROFILING // Use Tracy profiler
     /// Macro for scoped profiling with a name and color.
     #define URHO3D_PROFILE_COLOR(name, color) ZoneScopedNC(#name, color)
@@ -31,6 +31,94 @@
 namespace Urho3D
 {
 
+/// Number of work items per thread when choosing the grain of parallel calls automatically. More than one item per thread allows balancing uneven work.
+static const unsigned PARALLEL_ITEMS_PER_THREAD = 4;
+
+/// Capacity of a work-stealing queue. Must be a power of two.
+static const unsigned STEAL_QUEUE_CAPACITY = 1024;
+
+/// Bounded lock-free work-stealing deque. The owner thread pushes and pops items at the bottom in LIFO order, so that it
+/// continues with the work it has just released while its data is still in cache, and other threads steal the oldest items
+/// from the top.
+class WorkStealingQueue
+{
+public:
+    /// Construct.
+    WorkStealingQueue() :
+        top_(0),
+        bottom_(0)
+    {
+        for (unsigned i = 0; i < STEAL_QUEUE_CAPACITY; ++i)
+            items_[i] = nullptr;
+    }
+
+    /// Push an item to the bottom. Must only be called from the owner thread. Return false if the queue is full.
+    bool Push(WorkItem* item)
+    {
+        unsigned bottom = bottom_.load(std::memory_order_relaxed);
+        unsigned top = top_.load(std::memory_order_acquire);
+        if (bottom - top >= STEAL_QUEUE_CAPACITY)
+            return false;
+
+        items_[bottom & (STEAL_QUEUE_CAPACITY - 1)].store(item, std::memory_order_relaxed);
+        bottom_.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Take the newest item from the bottom. Must only be called from the owner thread. Return null if the queue is empty.
+    WorkItem* Pop()
+    {
+        unsigned bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        unsigned top = top_.load(std::memory_order_relaxed);
+
+        if ((int)(bottom - top) < 0)
+        {
+            // Was empty
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        WorkItem* item = items_[bottom & (STEAL_QUEUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (bottom == top)
+        {
+            // Last item, race against the thieves for it
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                item = nullptr;
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return item;
+    }
+
+    /// Take the oldest item from the top. Can be called from any thread. Return null if the queue is empty.
+    WorkItem* Steal()
+    {
+        unsigned top = top_.load(std::memory_order_acquire);
+        for (;;)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            unsigned bottom = bottom_.load(std::memory_order_acquire);
+            if ((int)(bottom - top) <= 0)
+                return nullptr;
+
+            // The slot can only be overwritten after top has advanced past it, in which case the exchange fails
+            WorkItem* item = items_[top & (STEAL_QUEUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+            if (top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_acquire))
+                return item;
+        }
+    }
+
+private:
+    /// Index of the next item to steal.
+    std::atomic<unsigned> top_;
+    /// Index of the next item to push.
+    std::atomic<unsigned> bottom_;
+    /// Item ring buffer.
+    std::atomic<WorkItem*> items_[STEAL_QUEUE_CAPACITY];
+};
+
 /// Worker thread managed by the work queue.
 class WorkerThread : public Thread, public RefCounted
 {
@@ -57,8 +145,12 @@ public:
 
     /// Return thread index.
     unsigned GetIndex() const { return index_; }
+    /// Return the work-stealing deque owned by the thread.
+    WorkStealingQueue& GetStealQueue() { return stealQueue_; }
 
 private:
+    /// Work-stealing deque.
+    WorkStealingQueue stealQueue_;
     /// Work queue.
     WorkQueue* owner_;
     /// Thread index.
@@ -67,14 +159,18 @@ private:
 
 WorkQueue::WorkQueue(Context* context) :
     Object(context),
+    mainStealQueue_(new WorkStealingQueue()),
     shutDown_(false),
     pausing_(false),
     paused_(false),
     completing_(false),
+    workStealing_(false),
     tolerance_(10),
     lastSize_(0),
     maxNonThreadedWorkMs_(5)
 {
+    frameArenas_.Push(UniquePtr<FrameArena>(new FrameArena()));
+
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WorkQueue, HandleBeginFrame));
 }
 
@@ -96,8 +192,14 @@ void WorkQueue::CreateThreads(unsigned numThreads)
     if (!threads_.Empty())
         return;
 
-    // Start threads in paused mode
+    // Start threads in paused mode. Also suspend work stealing, as the threads must not access each other's queues
+    // while the thread vector is still being modified
     Pause();
+    bool workStealing = workStealing_;
+    workStealing_ = false;
+
+    for (unsigned i = 0; i < numThreads; ++i)
+        frameArenas_.Push(UniquePtr<FrameArena>(new FrameArena()));
 
     for (unsigned i = 0; i < numThreads; ++i)
     {
@@ -105,6 +207,8 @@ void WorkQueue::CreateThreads(unsigned numThreads)
         thread->Run();
         threads_.Push(thread);
     }
+
+    workStealing_ = workStealing;
 #else
     URHO3D_LOGERROR("Can not create worker threads as threading is disabled");
 #endif
@@ -143,31 +247,35 @@ void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
     workItems_.Push(item);
     item->completed_ = false;
 
-    // Make sure worker threads' list is safe to modify
-    if (threads_.Size() && !paused_)
-        queueMutex_.Acquire();
-
-    // Find position for new item
-    if (queue_.Empty())
-        queue_.Push(item);
-    else
+    // If the item has dependencies, release the count held until it was added. If dependencies remain, the item will be
+    // queued by the thread completing the last of them. If a dependency was removed, complete the item without executing
+    if (item->pendingDependencies_.load())
     {
-        bool inserted = false;
-
-        for (List<WorkItem*>::Iterator i = queue_.Begin(); i != queue_.End(); ++i)
+        if (--item->pendingDependencies_)
+            return;
+        if (item->cancelled_)
         {
-            if ((*i)->priority_ <= item->priority_)
-            {
-                queue_.Insert(i, item);
-                inserted = true;
-                break;
-            }
+            FinishItem(item, 0);
+            return;
         }
+    }
+    else
+        item->cancelled_ = false;
 
-        if (!inserted)
-            queue_.Push(item);
+    // In work-stealing mode push highest priority items to the main thread's deque, from which the worker threads steal.
+    // If the deque is full, fall back to the shared queue
+    if (workStealing_ && threads_.Size() && item->priority_ == M_MAX_UNSIGNED && mainStealQueue_->Push(item))
+    {
+        Resume();
+        return;
     }
 
+    // Make sure worker threads' list is safe to modify
+    if (threads_.Size() && !paused_)
+        queueMutex_.Acquire();
+
+    InsertItem(item);
+
     if (threads_.Size())
     {
         queueMutex_.Release();
@@ -175,6 +283,27 @@ void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
     }
 }
 
+void WorkQueue::AddDependency(const SharedPtr<WorkItem>& item, const SharedPtr<WorkItem>& dependency)
+{
+    if (!item || !dependency || item == dependency)
+    {
+        URHO3D_LOGERROR("Invalid work item dependency");
+        return;
+    }
+
+    // Dependencies can only be declared before the items have been added
+    assert(!workItems_.Contains(item) && !workItems_.Contains(dependency));
+
+    // The first dependency also adds the count that is held until the item is added
+    if (!item->pendingDependencies_.load())
+    {
+        ++item->pendingDependencies_;
+        item->cancelled_ = false;
+    }
+    ++item->pendingDependencies_;
+    dependency->continuations_.Push(item.Get());
+}
+
 bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
 {
     if (!item)
@@ -190,6 +319,8 @@ bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
         if (j != workItems_.End())
         {
             queue_.Erase(i);
+            item->cancelled_ = true;
+            ReleaseContinuations(item, 0);
             ReturnToPool(item);
             workItems_.Erase(j);
             return true;
@@ -213,6 +344,8 @@ unsigned WorkQueue::RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items)
             if (k != workItems_.End())
             {
                 queue_.Erase(j);
+                (*k)->cancelled_ = true;
+                ReleaseContinuations(*k, 0);
                 ReturnToPool(*k);
                 workItems_.Erase(k);
                 ++removed;
@@ -223,6 +356,18 @@ unsigned WorkQueue::RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items)
     return removed;
 }
 
+void WorkQueue::SetWorkStealing(bool enable)
+{
+    if (enable == workStealing_)
+        return;
+
+    // Make sure no items are left in the work-stealing queues
+    if (workStealing_)
+        Complete(M_MAX_UNSIGNED);
+
+    workStealing_ = enable;
+}
+
 void WorkQueue::Pause()
 {
     if (!paused_)
@@ -254,28 +399,12 @@ void WorkQueue::Complete(unsigned priority)
     {
         Resume();
 
-        // Take work items also in the main thread until queue empty or no high-priority items anymore
-        while (!queue_.Empty())
+        // Take work items also in the main thread until no high-priority items remain and all threaded work has completed.
+        // Items released by completed dependencies may appear in the queues while waiting
+        for (;;)
         {
-            queueMutex_.Acquire();
-            if (!queue_.Empty() && queue_.Front()->priority_ >= priority)
-            {
-                WorkItem* item = queue_.Front();
-                queue_.PopFront();
-                queueMutex_.Release();
-                item->workFunction_(item, 0);
-                item->completed_ = true;
-            }
-            else
-            {
-                queueMutex_.Release();
+            if (!ExecuteItem(priority) && IsCompleted(priority))
                 break;
-            }
-        }
-
-        // Wait for threaded work to complete
-        while (!IsCompleted(priority))
-        {
         }
 
         // If no work at all remaining, pause worker threads by leaving the mutex locked
@@ -285,12 +414,9 @@ void WorkQueue::Complete(unsigned priority)
     else
     {
         // No worker threads: ensure all high-priority items are completed in the main thread
-        while (!queue_.Empty() && queue_.Front()->priority_ >= priority)
+        while (ExecuteItem(priority))
         {
-            WorkItem* item = queue_.Front();
-            queue_.PopFront();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            // Items released by completed dependencies are queued and executed in turn
         }
     }
 
@@ -298,6 +424,91 @@ void WorkQueue::Complete(unsigned priority)
     completing_ = false;
 }
 
+bool WorkQueue::ExecuteItem(unsigned priority)
+{
+    WorkItem* item = nullptr;
+
+    if (threads_.Size())
+    {
+        // In work-stealing mode first take the highest priority items from the own deque, then help with the worker threads' deques
+        if (workStealing_)
+            item = StealItem(0);
+
+        if (!item && !queue_.Empty())
+        {
+            queueMutex_.Acquire();
+            if (!queue_.Empty() && queue_.Front()->priority_ >= priority)
+            {
+                item = queue_.Front();
+                queue_.PopFront();
+            }
+            queueMutex_.Release();
+        }
+    }
+    else if (!queue_.Empty() && queue_.Front()->priority_ >= priority)
+    {
+        item = queue_.Front();
+        queue_.PopFront();
+    }
+
+    if (!item)
+        return false;
+
+    item->workFunction_(item, 0);
+    FinishItem(item, 0);
+    return true;
+}
+
+unsigned WorkQueue::GetParallelGrain(unsigned count, unsigned grain) const
+{
+    if (grain)
+        return grain;
+
+    return Max(count / ((threads_.Size() + 1) * PARALLEL_ITEMS_PER_THREAD), 1U);
+}
+
+void WorkQueue::ParallelRange(unsigned begin, unsigned end, unsigned grain, void (*workFunction)(const WorkItem*, unsigned), void* data,
+    const char* name)
+{
+    if (!Thread::IsMainThread())
+    {
+        URHO3D_LOGERROR("Parallel work can not be started from worker threads");
+        return;
+    }
+
+#if defined(URHO3D_TRACY_PROFILING)
+    URHO3D_PROFILE(ParallelRange);
+    URHO3D_PROFILE_STR(name, String::CStringLength(name));
+#elif defined(URHO3D_PROFILING)
+    AutoProfileBlock profileBlock(GetSubsystem<Profiler>(), name);
+#endif
+
+    // Execute directly in the main thread if there are no worker threads or the range fits one item
+    if (threads_.Empty() || end - begin <= grain)
+    {
+        WorkItem item;
+        item.workFunction_ = workFunction;
+        item.start_ = reinterpret_cast<void*>((size_t)begin);
+        item.end_ = reinterpret_cast<void*>((size_t)end);
+        item.aux_ = data;
+        workFunction(&item, 0);
+        return;
+    }
+
+    for (unsigned start = begin; start < end; start += grain)
+    {
+        SharedPtr<WorkItem> item = GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = workFunction;
+        item->start_ = reinterpret_cast<void*>((size_t)start);
+        item->end_ = reinterpret_cast<void*>((size_t)Min(start + grain, end));
+        item->aux_ = data;
+        AddWorkItem(item);
+    }
+
+    Complete(M_MAX_UNSIGNED);
+}
+
 bool WorkQueue::IsCompleted(unsigned priority) const
 {
     for (List<SharedPtr<WorkItem> >::ConstIterator i = workItems_.Begin(); i != workItems_.End(); ++i)
@@ -318,6 +529,19 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
         if (shutDown_)
             return;
 
+        // In work-stealing mode take highest priority items from the own deque first, then steal from other threads' deques
+        if (workStealing_)
+        {
+            if (WorkItem* item = StealItem(threadIndex))
+            {
+                wasActive = true;
+
+                item->workFunction_(item, threadIndex);
+                FinishItem(item, threadIndex);
+                continue;
+            }
+        }
+
         if (pausing_ && !wasActive)
             Time::Sleep(0);
         else
@@ -331,7 +555,7 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
                 queue_.PopFront();
                 queueMutex_.Release();
                 item->workFunction_(item, threadIndex);
-                item->completed_ = true;
+                FinishItem(item, threadIndex);
             }
             else
             {
@@ -344,6 +568,91 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
     }
 }
 
+void WorkQueue::InsertItem(WorkItem* item)
+{
+    // Find position for new item
+    if (queue_.Empty())
+        queue_.Push(item);
+    else
+    {
+        bool inserted = false;
+
+        for (List<WorkItem*>::Iterator i = queue_.Begin(); i != queue_.End(); ++i)
+        {
+            if ((*i)->priority_ <= item->priority_)
+            {
+                queue_.Insert(i, item);
+                inserted = true;
+                break;
+            }
+        }
+
+        if (!inserted)
+            queue_.Push(item);
+    }
+}
+
+void WorkQueue::FinishItem(WorkItem* item, unsigned threadIndex)
+{
+    // Release continuations before signaling completion, as the item may be returned to the pool right after
+    if (!item->continuations_.Empty())
+        ReleaseContinuations(item, threadIndex);
+
+    item->completed_ = true;
+}
+
+void WorkQueue::ReleaseContinuations(WorkItem* item, unsigned threadIndex)
+{
+    for (PODVector<WorkItem*>::ConstIterator i = item->continuations_.Begin(); i != item->continuations_.End(); ++i)
+    {
+        // Items depending on a cancelled item are cancelled as well, as their inputs were not produced
+        if (item->cancelled_)
+            (*i)->cancelled_ = true;
+
+        // The continuation can only reach zero after it has been added, so it is safe to queue now
+        if (--(*i)->pendingDependencies_ == 0)
+        {
+            // Complete a cancelled continuation without executing, which cancels its own continuations in turn
+            if ((*i)->cancelled_)
+            {
+                FinishItem(*i, threadIndex);
+                continue;
+            }
+
+            // In work-stealing mode push highest priority continuations to the releasing thread's own deque, so that it
+            // likely executes them next with the dependency's results still in cache
+            if (workStealing_ && threads_.Size() && (*i)->priority_ == M_MAX_UNSIGNED && GetStealQueue(threadIndex).Push(*i))
+                continue;
+
+            MutexLock lock(queueMutex_);
+            InsertItem(*i);
+        }
+    }
+
+    item->continuations_.Clear();
+}
+
+WorkStealingQueue& WorkQueue::GetStealQueue(unsigned threadIndex)
+{
+    return threadIndex ? threads_[threadIndex - 1]->GetStealQueue() : *mainStealQueue_;
+}
+
+WorkItem* WorkQueue::StealItem(unsigned threadIndex)
+{
+    if (WorkItem* item = GetStealQueue(threadIndex).Pop())
+        return item;
+
+    // Steal from the other threads' deques, starting from the next thread so that thieves spread out
+    unsigned numQueues = threads_.Size() + 1;
+    for (unsigned i = 1; i < numQueues; ++i)
+    {
+        if (WorkItem* item = GetStealQueue((threadIndex + i) % numQueues).Steal())
+            return item;
+    }
+
+    return nullptr;
+}
+
 void WorkQueue::PurgeCompleted(unsigned priority)
 {
     // Purge completed work items and send completion events. Do not signal items lower than priority threshold,
@@ -398,11 +707,34 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
         item->priority_ = M_MAX_UNSIGNED;
         item->sendEvent_ = false;
         item->completed_ = false;
+        item->cancelled_ = false;
+        item->continuations_.Clear();
+        item->pendingDependencies_ = 0;
 
         poolItems_.Push(item);
     }
 }
 
+void WorkQueue::ResetFrameArenas()
+{
+    size_t usedSize = 0;
+    unsigned numAllocations = 0;
+    unsigned numHeapAllocations = 0;
+
+    for (unsigned i = 0; i < frameArenas_.Size(); ++i)
+    {
+        FrameArena* arena = frameArenas_[i].Get();
+        usedSize += arena->GetUsedSize();
+        numAllocations += arena->GetNumAllocations();
+        numHeapAllocations += arena->GetNumHeapAllocations();
+        arena->Reset();
+    }
+
+    URHO3D_PROFILE_VALUE("FrameArenaAllocations", numAllocations);
+    URHO3D_PROFILE_VALUE("FrameArenaHeapAllocations", numHeapAllocations);
+    URHO3D_PROFILE_VALUE("FrameArenaKB", (long long)(usedSize >> 10u));
+}
+
 void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     // If no worker threads, complete low-priority work here
@@ -417,13 +749,15 @@ void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
             WorkItem* item = queue_.Front();
             queue_.PopFront();
             item->workFunction_(item, 0);
-            item->completed_ = true;
+            FinishItem(item, 0);
         }
     }
 
     // Complete and signal items down to the lowest priority
     PurgeCompleted(0);
     PurgePool();
+
+    ResetFrameArenas();
 }
 
 }
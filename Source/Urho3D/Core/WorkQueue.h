@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/Allocator.h"
 #include "../Container/List.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
@@ -38,6 +39,7 @@ URHO3D_EVENT(E_WORKITEMCOMPLETED, WorkItemCompleted)
 }
 
 class WorkerThread;
+class WorkStealingQueue;
 
 /// Work queue item.
 /// @nobind
@@ -60,9 +62,15 @@ public:
     bool sendEvent_{};
     /// Completed flag.
     std::atomic<bool> completed_{};
+    /// Cancelled flag. Set when a work item it depends on was removed, in which case it is completed without executing.
+    std::atomic<bool> cancelled_{};
 
 private:
     bool pooled_{};
+    /// Work items that depend on this item. Accessed by the main thread before the item is queued, and by the executing thread after completion.
+    PODVector<WorkItem*> continuations_;
+    /// Number of uncompleted dependencies, plus one until the item has been added to the work queue if it has any dependencies.
+    std::atomic<unsigned> pendingDependencies_{};
 };
 
 /// Work queue subsystem for multithreading.
@@ -82,9 +90,11 @@ public:
     void CreateThreads(unsigned numThreads);
     /// Get pointer to an usable WorkItem from the item pool. Allocate one if no more free items.
     SharedPtr<WorkItem> GetFreeItem();
-    /// Add a work item and resume worker threads.
+    /// Add a work item and resume worker threads. If the item has dependencies, it is held back until they have completed.
     void AddWorkItem(const SharedPtr<WorkItem>& item);
-    /// Remove a work item before it has started executing. Return true if successfully removed.
+    /// Declare that a work item can only start after another work item has completed. Neither item may have been added yet. The dependency should have at least the priority of the dependent item, so that completing work of that priority does not wait for lower priority work.
+    void AddDependency(const SharedPtr<WorkItem>& item, const SharedPtr<WorkItem>& dependency);
+    /// Remove a work item before it has started executing. Return true if successfully removed. Items depending on a removed item, directly or through other items, are cancelled: they are completed without executing once their other dependencies have completed. Items which have been pushed to the work-stealing deques can not be removed.
     bool RemoveWorkItem(SharedPtr<WorkItem> item);
     /// Remove a number of work items before they have started executing. Return the number of items successfully removed.
     unsigned RemoveWorkItems(const Vector<SharedPtr<WorkItem> >& items);
@@ -92,8 +102,50 @@ public:
     void Pause();
     /// Resume worker threads.
     void Resume();
-    /// Finish all queued work which has at least the specified priority. Main thread will also execute priority work. Pause worker threads if no more work remains.
+    /// Finish all queued work which has at least the specified priority, including work released by completed dependencies. Main thread will also execute priority work. Pause worker threads if no more work remains.
     void Complete(unsigned priority);
+    /// Execute queued work which has at least the specified priority in the main thread until the condition function returns true, so that the main thread can continue as soon as the results it needs next are ready instead of waiting for all work. Completed items are not purged and the worker threads are left running.
+    template <class T> void CompleteUntil(unsigned priority, const T& condition)
+    {
+        completing_ = true;
+        Resume();
+
+        while (!condition())
+            ExecuteItem(priority);
+
+        completing_ = false;
+    }
+
+    /// Enable or disable work-stealing scheduling. When enabled, highest priority work items go to lock-free per-thread deques instead of the shared queue: items added by the main thread to its own deque, and continuations to the deque of the thread that released them. Each thread takes the newest items from its own deque and idle threads steal the oldest items from the others, instead of contending for the shared queue mutex. Completes all highest priority work before switching.
+    void SetWorkStealing(bool enable);
+
+    /// Execute a function for each index in [begin, end) in the worker threads and the main thread, and wait until all have been processed. The function is called as function(index, threadIndex). Each work item processes a range of grain indices; zero grain chooses one automatically from the range size and number of threads. Must be called from the main thread. The name is used for profiling.
+    template <class T> void ParallelFor(unsigned begin, unsigned end, unsigned grain, const T& function, const char* name = "ParallelFor")
+    {
+        if (begin >= end)
+            return;
+
+        grain = GetParallelGrain(end - begin, grain);
+        ParallelRange(begin, end, grain, ParallelForWork<T>, const_cast<T*>(&function), name);
+    }
+
+    /// Reduce the indices in [begin, end) in the worker threads and the main thread, and return the result. Each range of grain indices starts from the identity value and accumulates its indices with function(index, value). The partial results are then merged in index order with combine(value, partialValue), so the result does not depend on thread scheduling. Zero grain chooses one automatically from the range size and number of threads. Must be called from the main thread. The name is used for profiling.
+    template <class T, class U, class V> T ParallelReduce(unsigned begin, unsigned end, unsigned grain, const T& identity, const U& function,
+        const V& combine, const char* name = "ParallelReduce")
+    {
+        T result = identity;
+        if (begin >= end)
+            return result;
+
+        grain = GetParallelGrain(end - begin, grain);
+        Vector<T> partials((end - begin + grain - 1) / grain, identity);
+        ParallelReduceData<T, U> data{begin, grain, &function, partials.Buffer()};
+        ParallelRange(begin, end, grain, ParallelReduceWork<T, U>, &data, name);
+
+        for (unsigned i = 0; i < partials.Size(); ++i)
+            combine(result, partials[i]);
+        return result;
+    }
 
     /// Set the pool telerance before it starts deleting pool items.
     void SetTolerance(int tolerance) { tolerance_ = tolerance; }
@@ -104,6 +156,12 @@ public:
     /// Return number of worker threads.
     unsigned GetNumThreads() const { return threads_.Size(); }
 
+    /// Return whether work-stealing scheduling is enabled.
+    bool GetWorkStealing() const { return workStealing_; }
+
+    /// Return the frame arena of a thread for temporary allocations, which are all freed at the beginning of the next frame. Thread index 0 is the main thread and worker threads are numbered from 1, as passed to work functions. An arena may only be used by its own thread, and only for work that is completed within the frame.
+    FrameArena* GetFrameArena(unsigned threadIndex) const { return frameArenas_[threadIndex].Get(); }
+
     /// Return whether all work with at least the specified priority is finished.
     bool IsCompleted(unsigned priority) const;
     /// Return whether the queue is currently completing work in the main thread.
@@ -116,19 +174,77 @@ public:
     int GetNonThreadedWorkMs() const { return maxNonThreadedWorkMs_; }
 
 private:
+    /// Parallel reduce call data.
+    template <class T, class U> struct ParallelReduceData
+    {
+        /// First index of the whole range.
+        unsigned begin_;
+        /// Indices per work item.
+        unsigned grain_;
+        /// Accumulate function.
+        const U* function_;
+        /// Partial result for each work item.
+        T* partials_;
+    };
+
+    /// Work function for ParallelFor.
+    template <class T> static void ParallelForWork(const WorkItem* item, unsigned threadIndex)
+    {
+        const T& function = *reinterpret_cast<const T*>(item->aux_);
+        auto end = (unsigned)reinterpret_cast<size_t>(item->end_);
+
+        for (auto i = (unsigned)reinterpret_cast<size_t>(item->start_); i < end; ++i)
+            function(i, threadIndex);
+    }
+
+    /// Work function for ParallelReduce.
+    template <class T, class U> static void ParallelReduceWork(const WorkItem* item, unsigned threadIndex)
+    {
+        const ParallelReduceData<T, U>& data = *reinterpret_cast<const ParallelReduceData<T, U>*>(item->aux_);
+        auto start = (unsigned)reinterpret_cast<size_t>(item->start_);
+        auto end = (unsigned)reinterpret_cast<size_t>(item->end_);
+
+        // Accumulate into a local copy to avoid false sharing between threads
+        T& partial = data.partials_[(start - data.begin_) / data.grain_];
+        T value = partial;
+        for (unsigned i = start; i < end; ++i)
+            (*data.function_)(i, value);
+        partial = value;
+    }
+
+    /// Return the number of indices per work item for a parallel call.
+    unsigned GetParallelGrain(unsigned count, unsigned grain) const;
+    /// Split an index range into work items of the specified function, and complete them. The start and end of each item are the index range and aux is the data.
+    void ParallelRange(unsigned begin, unsigned end, unsigned grain, void (*workFunction)(const WorkItem*, unsigned), void* data, const char* name);
+    /// Take one queued work item which has at least the specified priority and execute it in the main thread. Return false if none was available.
+    bool ExecuteItem(unsigned priority);
     /// Process work items until shut down. Called by the worker threads.
     void ProcessItems(unsigned threadIndex);
+    /// Insert a work item into the prioritized queue. The queue mutex must be held if there are worker threads.
+    void InsertItem(WorkItem* item);
+    /// Mark a work item completed and queue the items depending on it whose dependencies have all completed. Called from the thread that executed the item.
+    void FinishItem(WorkItem* item, unsigned threadIndex);
+    /// Queue the items depending on a work item whose dependencies have all completed. Called from the specified thread.
+    void ReleaseContinuations(WorkItem* item, unsigned threadIndex);
+    /// Return the work-stealing deque owned by a thread.
+    WorkStealingQueue& GetStealQueue(unsigned threadIndex);
+    /// Take a work item from the own work-stealing deque of a thread, or steal one from the other threads' deques. Return null if all are empty.
+    WorkItem* StealItem(unsigned threadIndex);
     /// Purge completed work items which have at least the specified priority, and send completion events as necessary.
     void PurgeCompleted(unsigned priority);
     /// Purge the pool to reduce allocation where its unneeded.
     void PurgePool();
     /// Return a work item to the pool.
     void ReturnToPool(SharedPtr<WorkItem>& item);
+    /// Report the frame arena statistics to the profiler and reset the arenas.
+    void ResetFrameArenas();
     /// Handle frame start event. Purge completed work from the main thread queue, and perform work if no threads at all.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
 
     /// Worker threads.
     Vector<SharedPtr<WorkerThread> > threads_;
+    /// Frame arenas of the main thread and the worker threads.
+    Vector<UniquePtr<FrameArena> > frameArenas_;
     /// Work item pool for reuse to cut down on allocation. The bool is a flag for item pooling and whether it is available or not.
     List<SharedPtr<WorkItem> > poolItems_;
     /// Work item collection. Accessed only by the main thread.
@@ -137,6 +253,8 @@ private:
     List<WorkItem*> queue_;
     /// Worker queue mutex.
     Mutex queueMutex_;
+    /// Work-stealing deque of the main thread.
+    UniquePtr<WorkStealingQueue> mainStealQueue_;
     /// Shutting down flag.
     std::atomic<bool> shutDown_;
     /// Pausing flag. Indicates the worker threads should not contend for the queue mutex.
@@ -145,6 +263,8 @@ private:
     bool paused_;
     /// Completing work in the main thread flag.
     bool completing_;
+    /// Work-stealing scheduling flag.
+    std::atomic<bool> workStealing_;
     /// Tolerance for the shared pool before it begins to deallocate.
     int tolerance_;
     /// Last size of the shared pool.
@@ -33,6 +33,7 @@
 #include "../Engine/Engine.h"
 #include "../Engine/EngineDefs.h"
 #include "../Graphics/Graphics.h"
+#include "../Graphics/PoseCache.h"
 #include "../Graphics/Renderer.h"
 #include "../Input/Input.h"
 #include "../IO/FileSystem.h"
@@ -124,6 +125,7 @@ Engine::Engine(Context* context) :
     // Create subsystems which do not depend on engine initialization or startup parameters
     context_->RegisterSubsystem(new Time(context_));
     context_->RegisterSubsystem(new WorkQueue(context_));
+    context_->RegisterSubsystem(new PoseCache(context_));
 #ifdef URHO3D_PROFILING
     context_->RegisterSubsystem(new Profiler(context_));
 #endif
@@ -217,7 +219,9 @@ bool Engine::Initialize(const VariantMap& parameters)
     unsigned numThreads = GetParameter(parameters, EP_WORKER_THREADS, true).GetBool() ? GetNumPhysicalCPUs() - 1 : 0;
     if (numThreads)
     {
-        GetSubsystem<WorkQueue>()->CreateThreads(numThreads);
+        auto* queue = GetSubsystem<WorkQueue>();
+        queue->CreateThreads(numThreads);
+        queue->SetWorkStealing(GetParameter(parameters, EP_WORK_STEALING, false).GetBool());
 
         URHO3D_LOGINFO("Created {} worker thread{}", numThreads, numThreads > 1 ? "s" : "");
     }
@@ -696,16 +700,16 @@ void Engine::Update()
     URHO3D_PROFILE(Update);
 
     // Logic update event
-    using namespace Update;
-
-    VariantMap& eventData = GetEventDataMap();
-    eventData[P_TIMESTEP] = timeStep_;
-    SendEvent(E_UPDATE, eventData);
+    SendTypedEvent(UpdateEventData{timeStep_});
 
     // Logic post-update event
-    SendEvent(E_POSTUPDATE, eventData);
+    SendTypedEvent(PostUpdateEventData{timeStep_});
 
     // Rendering update event
+    using namespace RenderUpdate;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_TIMESTEP] = timeStep_;
     SendEvent(E_RENDERUPDATE, eventData);
 
     // Post-render update event
@@ -852,6 +856,8 @@ VariantMap Engine::ParseParameters(const Vector<String>& arguments)
                 ret[EP_LOW_QUALITY_SHADOWS] = true;
             else if (argument == "nothreads")
                 ret[EP_WORKER_THREADS] = false;
+            else if (argument == "workstealing")
+                ret[EP_WORK_STEALING] = true;
             else if (argument == "v")
                 ret[EP_VSYNC] = true;
             else if (argument == "t")
@@ -72,6 +72,7 @@ static const String EP_WINDOW_POSITION_Y = "WindowPositionY";
 static const String EP_WINDOW_RESIZABLE = "WindowResizable";
 static const String EP_WINDOW_TITLE = "WindowTitle";
 static const String EP_WINDOW_WIDTH = "WindowWidth";
+static const String EP_WORK_STEALING = "WorkStealing";
 static const String EP_WORKER_THREADS = "WorkerThreads";
 
 }
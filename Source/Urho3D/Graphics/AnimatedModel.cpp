@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Animation.h"
 #include "../Graphics/AnimationState.h"
@@ -36,6 +37,7 @@
 #include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/Octree.h"
+#include "../Graphics/PoseCache.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
@@ -66,6 +68,20 @@ static bool CompareAnimationOrder(const SharedPtr<AnimationState>& lhs, const Sh
 }
 
 static const unsigned MAX_ANIMATION_STATES = 256;
+static const unsigned POSE_SHARING_WEIGHT_STEPS = 32;
+/// Number of animation tracks sampled per work item in the parallel animation phase.
+static const unsigned ANIMATION_SAMPLE_TRACKS = 32;
+
+/// Range of animation state tracks to sample in the parallel animation phase.
+struct AnimationSampleRange
+{
+    /// Animation state.
+    AnimationState* state_;
+    /// First track index.
+    unsigned begin_;
+    /// Track index after the last.
+    unsigned end_;
+};
 
 AnimatedModel::AnimatedModel(Context* context) :
     StaticModel(context),
@@ -74,6 +90,7 @@ AnimatedModel::AnimatedModel(Context* context) :
     animationLodBias_(1.0f),
     animationLodTimer_(-1.0f),
     animationLodDistance_(0.0f),
+    poseSharingStep_(0.0f),
     updateInvisible_(false),
     animationDirty_(false),
     animationOrderDirty_(false),
@@ -83,7 +100,8 @@ AnimatedModel::AnimatedModel(Context* context) :
     isMaster_(true),
     loading_(false),
     assignBonesPending_(false),
-    forceAnimationUpdate_(false)
+    forceAnimationUpdate_(false),
+    nodeFreePose_(false)
 {
 }
 
@@ -97,6 +115,14 @@ AnimatedModel::~AnimatedModel()
         if (parent && !parent->GetComponent<AnimatedModel>())
             RemoveRootBone();
     }
+
+    // Likewise remove the bone attachments of a node-free pose
+    for (Vector<BoneAttachment>::Iterator i = boneAttachments_.Begin(); i != boneAttachments_.End(); ++i)
+    {
+        Node* parent = i->node_ ? i->node_->GetParent() : nullptr;
+        if (parent && !parent->GetComponent<AnimatedModel>())
+            i->node_->Remove();
+    }
 }
 
 void AnimatedModel::RegisterObject(Context* context)
@@ -123,6 +149,8 @@ void AnimatedModel::RegisterObject(Context* context)
         .SetMetadata(AttributeMetadata::P_VECTOR_STRUCT_ELEMENTS, animationStatesStructureElementNames);
     URHO3D_ACCESSOR_ATTRIBUTE("Morphs", GetMorphsAttr, SetMorphsAttr, PODVector<unsigned char>, Variant::emptyBuffer,
         AM_DEFAULT | AM_NOEDIT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Node-Free Pose", GetNodeFreePose, SetNodeFreePose, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Pose Sharing Step", GetPoseSharingStep, SetPoseSharingStep, float, 0.0f, AM_DEFAULT);
 }
 
 bool AnimatedModel::Load(Deserializer& source)
@@ -178,7 +206,12 @@ void AnimatedModel::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQu
     for (unsigned i = 0; i < bones.Size(); ++i)
     {
         const Bone& bone = bones[i];
-        if (!bone.node_)
+        Matrix3x4 transform;
+        if (bone.node_)
+            transform = bone.node_->GetWorldTransform();
+        else if (i < boneTransforms_.Size())
+            transform = node_->GetWorldTransform() * boneTransforms_[i];
+        else
             continue;
 
         float distance;
@@ -188,7 +221,6 @@ void AnimatedModel::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQu
         {
             // Do an initial crude test using the bone's AABB
             const BoundingBox& box = bone.boundingBox_;
-            const Matrix3x4& transform = bone.node_->GetWorldTransform();
             distance = query.ray_.HitDistance(box.Transformed(transform));
             if (distance >= query.maxDistance_)
                 continue;
@@ -204,7 +236,7 @@ void AnimatedModel::ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQu
         }
         else if (bone.collisionMask_ & BONECOLLISION_SPHERE)
         {
-            boneSphere.center_ = bone.node_->GetWorldPosition();
+            boneSphere.center_ = transform.Translation();
             boneSphere.radius_ = bone.radius_;
             distance = query.ray_.HitDistance(boneSphere);
             if (distance >= query.maxDistance_)
@@ -325,7 +357,29 @@ void AnimatedModel::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     if (debug && IsEnabledEffective())
     {
         debug->AddBoundingBox(GetWorldBoundingBox(), Color::GREEN, depthTest);
-        debug->AddSkeleton(skeleton_, Color(0.75f, 0.75f, 0.75f), depthTest);
+        if (boneTransforms_.Empty())
+            debug->AddSkeleton(skeleton_, Color(0.75f, 0.75f, 0.75f), depthTest);
+        else
+        {
+            // Node-free pose: draw the bones that skin geometry from the pose, like DebugRenderer::AddSkeleton()
+            const Vector<Bone>& bones = skeleton_.GetBones();
+            const Matrix3x4& worldTransform = node_->GetWorldTransform();
+            Color color(0.75f, 0.75f, 0.75f);
+            for (unsigned i = 0; i < bones.Size(); ++i)
+            {
+                if (bones[i].radius_ < M_EPSILON && bones[i].boundingBox_.Size().LengthSquared() < M_EPSILON)
+                    continue;
+
+                Vector3 start = worldTransform * boneTransforms_[i].Translation();
+                Vector3 end = start;
+                unsigned j = bones[i].parentIndex_;
+                if (j != i && j < bones.Size() &&
+                    (bones[j].radius_ >= M_EPSILON || bones[j].boundingBox_.Size().LengthSquared() >= M_EPSILON))
+                    end = worldTransform * boneTransforms_[j].Translation();
+
+                debug->AddLine(start, end, color, depthTest);
+            }
+        }
     }
 }
 
@@ -548,6 +602,153 @@ void AnimatedModel::SetUpdateInvisible(bool enable)
     MarkNetworkUpdate();
 }
 
+void AnimatedModel::SetPoseSharingStep(float step)
+{
+    poseSharingStep_ = Max(step, 0.0f);
+    MarkAnimationDirty();
+    MarkNetworkUpdate();
+}
+
+void AnimatedModel::SetNodeFreePose(bool enable)
+{
+    if (enable == nodeFreePose_)
+        return;
+
+    nodeFreePose_ = enable;
+
+    // When loading or when the bone nodes are still to be assigned, the pose is set up in AssignBoneNodes()
+    if (isMaster_ && node_ && !loading_ && !assignBonesPending_ && skeleton_.GetNumBones())
+    {
+        if (enable)
+        {
+            // Move other nodes parented to the bone nodes, such as weapons, to bone attachments so that they are not removed
+            const Vector<Bone>& bones = skeleton_.GetBones();
+            for (unsigned i = 0; i < bones.Size(); ++i)
+            {
+                Node* boneNode = bones[i].node_;
+                if (!boneNode)
+                    continue;
+
+                PODVector<Node*> userNodes;
+                const Vector<SharedPtr<Node> >& children = boneNode->GetChildren();
+                for (Vector<SharedPtr<Node> >::ConstIterator j = children.Begin(); j != children.End(); ++j)
+                {
+                    Bone* childBone = skeleton_.GetBone((*j)->GetNameHash());
+                    if (!childBone || childBone->node_.Get() != j->Get())
+                        userNodes.Push(*j);
+                }
+                if (userNodes.Empty())
+                    continue;
+
+                Node* attachment = CreateBoneAttachment(bones[i].name_);
+                attachment->SetWorldTransform(boneNode->GetWorldTransform());
+                for (PODVector<Node*>::Iterator j = userNodes.Begin(); j != userNodes.End(); ++j)
+                    (*j)->SetParent(attachment);
+            }
+
+            RemoveRootBone();
+            InitializePose();
+        }
+        else
+        {
+            // Likewise keep the children of the bone attachments in the model's node until the bone nodes exist
+            Vector<Pair<unsigned, SharedPtr<Node> > > userNodes;
+            for (Vector<BoneAttachment>::Iterator i = boneAttachments_.Begin(); i != boneAttachments_.End(); ++i)
+            {
+                if (!i->node_)
+                    continue;
+                Vector<SharedPtr<Node> > children = i->node_->GetChildren();
+                for (Vector<SharedPtr<Node> >::Iterator j = children.Begin(); j != children.End(); ++j)
+                {
+                    userNodes.Push(MakePair(i->boneIndex_, *j));
+                    (*j)->SetParent(node_);
+                }
+                i->node_->Remove();
+            }
+            boneAttachments_.Clear();
+            InitializePose();
+            CreateBoneNodes();
+
+            for (Vector<Pair<unsigned, SharedPtr<Node> > >::Iterator i = userNodes.Begin(); i != userNodes.End(); ++i)
+            {
+                Bone* bone = skeleton_.GetBone(i->first_);
+                if (bone && bone->node_)
+                    i->second_->SetParent(bone->node_);
+            }
+
+            // Let the other models in the node find the new bone nodes
+            PODVector<AnimatedModel*> models;
+            GetComponents<AnimatedModel>(models);
+            for (PODVector<AnimatedModel*>::Iterator i = models.Begin(); i != models.End(); ++i)
+            {
+                if (*i != this)
+                    (*i)->AssignBoneNodes();
+            }
+        }
+
+        RebindAnimationStates();
+        MarkAnimationDirty();
+    }
+
+    MarkNetworkUpdate();
+}
+
+Node* AnimatedModel::CreateBoneAttachment(const String& boneName)
+{
+    if (!node_)
+        return nullptr;
+
+    // Non-master models share the bones of the master model
+    if (!isMaster_)
+    {
+        auto* master = node_->GetComponent<AnimatedModel>();
+        return master && master != this ? master->CreateBoneAttachment(boneName) : nullptr;
+    }
+
+    Bone* bone = skeleton_.GetBone(boneName);
+    if (!bone)
+        return nullptr;
+    if (!nodeFreePose_)
+        return bone->node_;
+
+    const unsigned boneIndex = skeleton_.GetBoneIndex(bone);
+    for (Vector<BoneAttachment>::ConstIterator i = boneAttachments_.Begin(); i != boneAttachments_.End(); ++i)
+    {
+        if (i->boneIndex_ == boneIndex && i->node_)
+            return i->node_;
+    }
+
+    // Create as local like the bone nodes. The name identifies the bone when the scene is loaded
+    Node* attachment = node_->CreateChild(bone->name_, LOCAL);
+    attachment->SetTemporary(IsTemporary());
+    if (boneIndex < boneTransforms_.Size())
+        attachment->SetTransform(boneTransforms_[boneIndex]);
+    boneAttachments_.Push(BoneAttachment{boneIndex, WeakPtr<Node>(attachment)});
+    return attachment;
+}
+
+void AnimatedModel::RemoveBoneAttachment(const String& boneName)
+{
+    const unsigned boneIndex = skeleton_.GetBoneIndex(boneName);
+    for (unsigned i = 0; i < boneAttachments_.Size(); ++i)
+    {
+        if (boneAttachments_[i].boneIndex_ == boneIndex)
+        {
+            if (boneAttachments_[i].node_)
+                boneAttachments_[i].node_->Remove();
+            boneAttachments_.Erase(i);
+            return;
+        }
+    }
+
+    if (!isMaster_ && node_)
+    {
+        auto* master = node_->GetComponent<AnimatedModel>();
+        if (master && master != this)
+            master->RemoveBoneAttachment(boneName);
+    }
+}
+
 
 void AnimatedModel::SetMorphWeight(unsigned index, float weight)
 {
@@ -710,8 +911,8 @@ void AnimatedModel::SetSkeleton(const Skeleton& skeleton, bool createBones)
 
             for (unsigned i = 0; i < destBones.Size(); ++i)
             {
-                if (destBones[i].node_ && destBones[i].name_ == srcBones[i].name_ && destBones[i].parentIndex_ ==
-                                                                                     srcBones[i].parentIndex_)
+                if ((destBones[i].node_ || nodeFreePose_) && destBones[i].name_ == srcBones[i].name_ &&
+                    destBones[i].parentIndex_ == srcBones[i].parentIndex_)
                 {
                     // If compatible, just copy the values and retain the old node and animated status
                     Node* boneNode = destBones[i].node_;
@@ -727,7 +928,11 @@ void AnimatedModel::SetSkeleton(const Skeleton& skeleton, bool createBones)
                 }
             }
             if (compatible)
+            {
+                if (nodeFreePose_)
+                    InitializePose();
                 return;
+            }
         }
 
         RemoveAllAnimationStates();
@@ -741,28 +946,11 @@ void AnimatedModel::SetSkeleton(const Skeleton& skeleton, bool createBones)
         // Merge bounding boxes from non-master models
         FinalizeBoneBoundingBoxes();
 
-        Vector<Bone>& bones = skeleton_.GetModifiableBones();
-        // Create scene nodes for the bones
-        if (createBones)
-        {
-            for (Vector<Bone>::Iterator i = bones.Begin(); i != bones.End(); ++i)
-            {
-                // Create bones as local, as they are never to be directly synchronized over the network
-                Node* boneNode = node_->CreateChild(i->name_, LOCAL);
-                boneNode->AddListener(this);
-                boneNode->SetTransform(i->initialPosition_, i->initialRotation_, i->initialScale_);
-                // Copy the model component's temporary status
-                boneNode->SetTemporary(IsTemporary());
-                i->node_ = boneNode;
-            }
-
-            for (unsigned i = 0; i < bones.Size(); ++i)
-            {
-                unsigned parentIndex = bones[i].parentIndex_;
-                if (parentIndex != i && parentIndex < bones.Size())
-                    bones[parentIndex].node_->AddChild(bones[i].node_);
-            }
-        }
+        // Create scene nodes for the bones, unless the pose is kept without them
+        if (nodeFreePose_)
+            InitializePose();
+        else if (createBones)
+            CreateBoneNodes();
 
         using namespace BoneHierarchyCreated;
 
@@ -912,6 +1100,24 @@ void AnimatedModel::UpdateBoneBoundingBox()
         Matrix3x4 inverseNodeTransform = node_->GetWorldTransform().Inverse();
 
         const Vector<Bone>& bones = skeleton_.GetBones();
+
+        // A node-free pose is already in model space
+        if (!boneTransforms_.Empty())
+        {
+            for (unsigned i = 0; i < bones.Size(); ++i)
+            {
+                const Bone& bone = bones[i];
+                if (bone.collisionMask_ & BONECOLLISION_BOX)
+                    boneBoundingBox_.Merge(bone.boundingBox_.Transformed(boneTransforms_[i]));
+                else if (bone.collisionMask_ & BONECOLLISION_SPHERE)
+                    boneBoundingBox_.Merge(Sphere(boneTransforms_[i].Translation(), bone.radius_ * 0.5f));
+            }
+
+            boneBoundingBoxDirty_ = false;
+            worldBoundingBoxDirty_ = true;
+            return;
+        }
+
         for (Vector<Bone>::ConstIterator i = bones.Begin(); i != bones.End(); ++i)
         {
             Node* boneNode = i->node_;
@@ -983,6 +1189,22 @@ void AnimatedModel::AssignBoneNodes()
     if (!node_)
         return;
 
+    if (nodeFreePose_ && isMaster_)
+    {
+        // Adopt the bone attachments saved along with the scene: child nodes named after bones
+        boneAttachments_.Clear();
+        const Vector<Bone>& bones = skeleton_.GetBones();
+        for (unsigned i = 0; i < bones.Size(); ++i)
+        {
+            Node* attachment = node_->GetChild(bones[i].nameHash_);
+            if (attachment)
+                boneAttachments_.Push(BoneAttachment{i, WeakPtr<Node>(attachment)});
+        }
+        InitializePose();
+        RebindAnimationStates();
+        return;
+    }
+
     // Find the bone nodes from the node hierarchy and add listeners
     Vector<Bone>& bones = skeleton_.GetModifiableBones();
     bool boneFound = false;
@@ -1079,6 +1301,139 @@ void AnimatedModel::RemoveRootBone()
         rootBone->node_->Remove();
 }
 
+void AnimatedModel::CreateBoneNodes()
+{
+    Vector<Bone>& bones = skeleton_.GetModifiableBones();
+    for (Vector<Bone>::Iterator i = bones.Begin(); i != bones.End(); ++i)
+    {
+        // Create bones as local, as they are never to be directly synchronized over the network
+        Node* boneNode = node_->CreateChild(i->name_, LOCAL);
+        boneNode->AddListener(this);
+        boneNode->SetTransform(i->initialPosition_, i->initialRotation_, i->initialScale_);
+        // Copy the model component's temporary status
+        boneNode->SetTemporary(IsTemporary());
+        i->node_ = boneNode;
+    }
+
+    for (unsigned i = 0; i < bones.Size(); ++i)
+    {
+        unsigned parentIndex = bones[i].parentIndex_;
+        if (parentIndex != i && parentIndex < bones.Size())
+            bones[parentIndex].node_->AddChild(bones[i].node_);
+    }
+}
+
+void AnimatedModel::InitializePose()
+{
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    const unsigned numBones = nodeFreePose_ && isMaster_ ? bones.Size() : 0;
+
+    bonePositions_.Resize(numBones);
+    boneRotations_.Resize(numBones);
+    boneScales_.Resize(numBones);
+    boneTransforms_.Resize(numBones);
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        bonePositions_[i] = bones[i].initialPosition_;
+        boneRotations_[i] = bones[i].initialRotation_;
+        boneScales_[i] = bones[i].initialScale_;
+    }
+
+    // Order the bones so that the model-space transform of a parent is calculated before its children
+    PODVector<bool> ordered(numBones, false);
+    PODVector<unsigned> chain;
+    boneOrder_.Clear();
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        chain.Clear();
+        for (unsigned j = i; j < numBones && !ordered[j]; j = bones[j].parentIndex_)
+        {
+            ordered[j] = true;
+            chain.Push(j);
+        }
+        for (unsigned j = chain.Size(); j-- > 0;)
+            boneOrder_.Push(chain[j]);
+    }
+
+    // The attachments are named after their bones, so find their bones again in case the skeleton changed
+    for (unsigned i = 0; i < boneAttachments_.Size();)
+    {
+        Node* attachment = boneAttachments_[i].node_;
+        const unsigned boneIndex = attachment && numBones ? skeleton_.GetBoneIndex(attachment->GetNameHash()) : M_MAX_UNSIGNED;
+        if (boneIndex < numBones)
+            boneAttachments_[i++].boneIndex_ = boneIndex;
+        else
+            boneAttachments_.Erase(i);
+    }
+
+    UpdatePoseTransforms();
+    if (node_ && !boneAttachments_.Empty())
+        node_->MarkDirty();
+
+    skinningDirty_ = true;
+    boneBoundingBoxDirty_ = true;
+}
+
+void AnimatedModel::ResetPose()
+{
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    for (unsigned i = 0; i < bonePositions_.Size(); ++i)
+    {
+        const Bone& bone = bones[i];
+        if (bone.animated_)
+        {
+            bonePositions_[i] = bone.initialPosition_;
+            boneRotations_[i] = bone.initialRotation_;
+            boneScales_[i] = bone.initialScale_;
+        }
+    }
+}
+
+void AnimatedModel::UpdatePoseTransforms()
+{
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    const unsigned numBones = boneTransforms_.Size();
+
+    for (PODVector<unsigned>::ConstIterator i = boneOrder_.Begin(); i != boneOrder_.End(); ++i)
+    {
+        const unsigned index = *i;
+        const unsigned parentIndex = bones[index].parentIndex_;
+        const Matrix3x4 transform(bonePositions_[index], boneRotations_[index], boneScales_[index]);
+        if (parentIndex != index && parentIndex < numBones)
+            boneTransforms_[index] = boneTransforms_[parentIndex] * transform;
+        else
+            boneTransforms_[index] = transform;
+    }
+
+    MoveBoneAttachments();
+}
+
+void AnimatedModel::MoveBoneAttachments()
+{
+    // Move the attachments silently, the caller marks the model's node and its children dirty
+    for (Vector<BoneAttachment>::ConstIterator i = boneAttachments_.Begin(); i != boneAttachments_.End(); ++i)
+    {
+        if (i->node_)
+        {
+            Vector3 position;
+            Quaternion rotation;
+            Vector3 scale;
+            boneTransforms_[i->boneIndex_].Decompose(position, rotation, scale);
+            i->node_->SetTransformSilent(position, rotation, scale);
+        }
+    }
+}
+
+void AnimatedModel::RebindAnimationStates()
+{
+    for (Vector<SharedPtr<AnimationState> >::Iterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
+    {
+        AnimationState* state = *i;
+        state->stateTracks_.Clear();
+        state->SetStartBone(state->startBone_);
+    }
+}
+
 void AnimatedModel::MarkAnimationDirty()
 {
     if (isMaster_)
@@ -1270,7 +1625,10 @@ void AnimatedModel::UpdateAnimation(const FrameInfo& frame)
             animationLodTimer_ = 0.0f;
     }
 
-    ApplyAnimation();
+    // Inside the octree's threaded update, defer to its parallel animation phase
+    Octree* octree = octant_ ? octant_->GetRoot() : nullptr;
+    if (!octree || !octree->QueueAnimationUpdate(this))
+        ApplyAnimation();
 }
 
 void AnimatedModel::ApplyAnimation()
@@ -1286,40 +1644,208 @@ void AnimatedModel::ApplyAnimation()
     // (first AnimatedModel in a node)
     if (isMaster_)
     {
-        skeleton_.ResetSilent();
-        for (Vector<SharedPtr<AnimationState> >::Iterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
-            (*i)->Apply();
+        if (!nodeFreePose_ || poseSharingStep_ <= 0.0f || !ApplySharedPose())
+        {
+            if (nodeFreePose_)
+                ResetPose();
+            else
+                skeleton_.ResetSilent();
+            for (Vector<SharedPtr<AnimationState> >::Iterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
+                (*i)->Apply();
+            if (nodeFreePose_)
+                UpdatePoseTransforms();
+        }
+
+        // Calculate new bone bounding box. This is not shared along with the pose, as the bone bounds of the models differ
+        UpdateBoneBoundingBox();
 
         // Skeleton reset and animations apply the node transforms "silently" to avoid repeated marking dirty. Mark dirty now
         node_->MarkDirty();
-
-        // Calculate new bone bounding box
-        UpdateBoneBoundingBox();
     }
 
     animationDirty_ = false;
 }
 
+void AnimatedModel::ApplyAnimations(const PODVector<AnimatedModel*>& models, WorkQueue* queue)
+{
+    // Split the tracks of the animation states into ranges. Shared poses are evaluated only when not found in the pose
+    // cache, so those models sample their own tracks
+    PODVector<AnimationSampleRange> ranges;
+    for (PODVector<AnimatedModel*>::ConstIterator i = models.Begin(); i != models.End(); ++i)
+    {
+        AnimatedModel* model = *i;
+        if (!model->isMaster_ || (model->nodeFreePose_ && model->poseSharingStep_ > 0.0f))
+            continue;
+
+        for (Vector<SharedPtr<AnimationState> >::ConstIterator j = model->animationStates_.Begin();
+             j != model->animationStates_.End(); ++j)
+        {
+            AnimationState* state = *j;
+            if (!state->GetAnimation() || !state->IsEnabled())
+                continue;
+
+            const unsigned numTracks = state->stateTracks_.Size();
+            for (unsigned k = 0; k < numTracks; k += ANIMATION_SAMPLE_TRACKS)
+                ranges.Push(AnimationSampleRange{state, k, Min(k + ANIMATION_SAMPLE_TRACKS, numTracks)});
+            state->samplesReady_ = true;
+        }
+    }
+
+    queue->ParallelFor(0, ranges.Size(), 0, [&](unsigned index, unsigned threadIndex)
+    {
+        const AnimationSampleRange& range = ranges[index];
+        range.state_->SampleTracks(range.state_->GetTime(), range.begin_, range.end_);
+    }, "SampleAnimationsWork");
+
+    queue->ParallelFor(0, models.Size(), 0, [&](unsigned index, unsigned threadIndex)
+    {
+        models[index]->ApplyAnimation();
+    }, "ApplyAnimationsWork");
+}
+
+bool AnimatedModel::ApplySharedPose()
+{
+    auto* poseCache = GetSubsystem<PoseCache>();
+    if (!poseCache || !model_ || boneTransforms_.Empty())
+        return false;
+
+    // Bones with animation disabled may hold a pose of their own, which can not be shared
+    const Vector<Bone>& bones = skeleton_.GetBones();
+    for (Vector<Bone>::ConstIterator i = bones.Begin(); i != bones.End(); ++i)
+    {
+        if (!i->animated_)
+            return false;
+    }
+
+    // Build the key from the model and the animation states at quantized time positions and weights. The states are already
+    // in blending order
+    PODVector<unsigned>& key = poseKey_;
+    key.Clear();
+    auto modelAddress = (unsigned long long)(size_t)model_.Get();
+    key.Push((unsigned)modelAddress);
+    key.Push((unsigned)(modelAddress >> 32u));
+
+    for (Vector<SharedPtr<AnimationState> >::ConstIterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
+    {
+        const AnimationState* state = *i;
+        Animation* animation = state->GetAnimation();
+        if (!animation || !state->IsEnabled())
+            continue;
+
+        auto weightStep = (unsigned)(state->GetWeight() * POSE_SHARING_WEIGHT_STEPS + 0.5f);
+        if (!weightStep)
+            continue;
+
+        const float length = animation->GetLength();
+        auto timeStep = (unsigned)(state->GetTime() / poseSharingStep_ + 0.5f);
+        if (state->IsLooped() && timeStep * poseSharingStep_ >= length)
+            timeStep = 0;
+
+        auto animationAddress = (unsigned long long)(size_t)animation;
+        key.Push((unsigned)animationAddress);
+        key.Push((unsigned)(animationAddress >> 32u));
+        key.Push(timeStep);
+        key.Push(weightStep);
+        Bone* startBone = state->GetStartBone();
+        key.Push(startBone ? (unsigned)(startBone - &bones[0]) : M_MAX_UNSIGNED);
+        key.Push((unsigned)state->GetBlendMode() | (state->IsLooped() ? 2u : 0u));
+
+        // Partial track weights are included exactly
+        for (unsigned j = 0; j < state->stateTracks_.Size(); ++j)
+        {
+            const float trackWeight = state->stateTracks_[j].weight_;
+            if (trackWeight != 1.0f)
+            {
+                key.Push(j);
+                unsigned weightBits;
+                memcpy(&weightBits, &trackWeight, sizeof weightBits);
+                key.Push(weightBits);
+            }
+        }
+        key.Push(M_MAX_UNSIGNED);
+    }
+
+    unsigned hash = 0;
+    for (PODVector<unsigned>::ConstIterator i = key.Begin(); i != key.End(); ++i)
+        CombineHash(hash, *i);
+
+    if (const SharedPose* pose = poseCache->GetPose(hash, key))
+    {
+        bonePositions_ = pose->positions_;
+        boneRotations_ = pose->rotations_;
+        boneScales_ = pose->scales_;
+        boneTransforms_ = pose->transforms_;
+        MoveBoneAttachments();
+        return true;
+    }
+
+    ResetPose();
+    for (Vector<SharedPtr<AnimationState> >::Iterator i = animationStates_.Begin(); i != animationStates_.End(); ++i)
+    {
+        AnimationState* state = *i;
+        Animation* animation = state->GetAnimation();
+        if (!animation || !state->IsEnabled())
+            continue;
+
+        auto weightStep = (unsigned)(state->GetWeight() * POSE_SHARING_WEIGHT_STEPS + 0.5f);
+        if (!weightStep)
+            continue;
+
+        const float length = animation->GetLength();
+        float time = (unsigned)(state->GetTime() / poseSharingStep_ + 0.5f) * poseSharingStep_;
+        if (time >= length)
+            time = state->IsLooped() ? 0.0f : length;
+
+        state->ApplyToModel(time, (float)weightStep / POSE_SHARING_WEIGHT_STEPS);
+    }
+    UpdatePoseTransforms();
+
+    poseCache->StorePose(hash, key, bonePositions_, boneRotations_, boneScales_, boneTransforms_);
+    return true;
+}
+
 void AnimatedModel::UpdateSkinning()
 {
     // Note: the model's world transform will be baked in the skin matrices
     const Vector<Bone>& bones = skeleton_.GetBones();
     // Use model's world transform in case a bone is missing
     const Matrix3x4& worldTransform = node_->GetWorldTransform();
+    // With a node-free pose, the master model holds the bone transforms
+    AnimatedModel* master = isMaster_ ? this : node_->GetComponent<AnimatedModel>();
 
-    // Skinning with global matrices only
-    if (!geometrySkinMatrices_.Size())
+    if (master && !master->boneTransforms_.Empty())
     {
-        for (unsigned i = 0; i < bones.Size(); ++i)
+        const PODVector<Matrix3x4>& boneTransforms = master->boneTransforms_;
+
+        if (master == this)
         {
-            const Bone& bone = bones[i];
-            if (bone.node_)
-                skinMatrices_[i] = bone.node_->GetWorldTransform() * bone.offsetMatrix_;
-            else
-                skinMatrices_[i] = worldTransform;
+            for (unsigned i = 0; i < bones.Size(); ++i)
+                skinMatrices_[i] = worldTransform * boneTransforms[i] * bones[i].offsetMatrix_;
+        }
+        else
+        {
+            // Find the bones in the master's skeleton by name, checking the earlier result in case its model has changed
+            const Vector<Bone>& masterBones = master->skeleton_.GetBones();
+            if (masterBoneIndices_.Size() != bones.Size())
+            {
+                masterBoneIndices_.Resize(bones.Size());
+                for (unsigned i = 0; i < bones.Size(); ++i)
+                    masterBoneIndices_[i] = M_MAX_UNSIGNED;
+            }
+
+            for (unsigned i = 0; i < bones.Size(); ++i)
+            {
+                unsigned& index = masterBoneIndices_[i];
+                if (index >= masterBones.Size() || masterBones[index].nameHash_ != bones[i].nameHash_)
+                    index = master->skeleton_.GetBoneIndex(bones[i].nameHash_);
+
+                if (index < boneTransforms.Size())
+                    skinMatrices_[i] = worldTransform * boneTransforms[index] * bones[i].offsetMatrix_;
+                else
+                    skinMatrices_[i] = worldTransform;
+            }
         }
     }
-    // Skinning with per-geometry matrices
     else
     {
         for (unsigned i = 0; i < bones.Size(); ++i)
@@ -1329,8 +1855,14 @@ void AnimatedModel::UpdateSkinning()
                 skinMatrices_[i] = bone.node_->GetWorldTransform() * bone.offsetMatrix_;
             else
                 skinMatrices_[i] = worldTransform;
+        }
+    }
 
-            // Copy the skin matrix to per-geometry matrices as needed
+    // Copy the skin matrices to per-geometry matrices as needed
+    if (geometrySkinMatrices_.Size())
+    {
+        for (unsigned i = 0; i < bones.Size(); ++i)
+        {
             for (unsigned j = 0; j < geometrySkinMatrixPtrs_[i].Size(); ++j)
                 *geometrySkinMatrixPtrs_[i][j] = skinMatrices_[i];
         }
@@ -1400,31 +1932,41 @@ void AnimatedModel::ApplyMorph(VertexBuffer* buffer, void* destVertexData, unsig
         unsigned vertexIndex = *((unsigned*)srcData) - morphRangeStart;
         srcData += sizeof(unsigned);
 
-        if (elementMask & MASK_POSITION)
+        // Skip the morph data for elements the buffer does not have in float format, such as packed normals
+        if (morph.elementMask_ & MASK_POSITION)
         {
-            auto* dest = (float*)(destData + vertexIndex * vertexSize);
-            auto* src = (float*)srcData;
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
+            if (elementMask & MASK_POSITION)
+            {
+                auto* dest = (float*)(destData + vertexIndex * vertexSize);
+                auto* src = (float*)srcData;
+                dest[0] += src[0] * weight;
+                dest[1] += src[1] * weight;
+                dest[2] += src[2] * weight;
+            }
             srcData += 3 * sizeof(float);
         }
-        if (elementMask & MASK_NORMAL)
+        if (morph.elementMask_ & MASK_NORMAL)
         {
-            auto* dest = (float*)(destData + vertexIndex * vertexSize + normalOffset);
-            auto* src = (float*)srcData;
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
+            if (elementMask & MASK_NORMAL)
+            {
+                auto* dest = (float*)(destData + vertexIndex * vertexSize + normalOffset);
+                auto* src = (float*)srcData;
+                dest[0] += src[0] * weight;
+                dest[1] += src[1] * weight;
+                dest[2] += src[2] * weight;
+            }
             srcData += 3 * sizeof(float);
         }
-        if (elementMask & MASK_TANGENT)
+        if (morph.elementMask_ & MASK_TANGENT)
         {
-            auto* dest = (float*)(destData + vertexIndex * vertexSize + tangentOffset);
-            auto* src = (float*)srcData;
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
+            if (elementMask & MASK_TANGENT)
+            {
+                auto* dest = (float*)(destData + vertexIndex * vertexSize + tangentOffset);
+                auto* src = (float*)srcData;
+                dest[0] += src[0] * weight;
+                dest[1] += src[1] * weight;
+                dest[2] += src[2] * weight;
+            }
             srcData += 3 * sizeof(float);
         }
     }
@@ -31,6 +31,16 @@ namespace Urho3D
 
 class Animation;
 class AnimationState;
+class WorkQueue;
+
+/// Scene node that follows a bone of a node-free skeleton pose.
+struct BoneAttachment
+{
+    /// Bone index.
+    unsigned boneIndex_;
+    /// Scene node.
+    WeakPtr<Node> node_;
+};
 
 /// Animated model component.
 class URHO3D_API AnimatedModel : public StaticModel
@@ -91,6 +101,16 @@ public:
     /// Set whether to update animation and the bounding box when not visible. Recommended to enable for physically controlled models like ragdolls.
     /// @property
     void SetUpdateInvisible(bool enable);
+    /// Set whether to keep the skeleton pose in arrays instead of bone scene nodes, which saves the node updates for large numbers of animated models. Scene nodes are then created only for the bones that are attached to with CreateBoneAttachment(). Other nodes parented to the bone nodes are kept and moved to such attachments, and back when disabled. Default false.
+    /// @property
+    void SetNodeFreePose(bool enable);
+    /// Set the time step in seconds that animation time positions are rounded to for sharing node-free poses with other models that play the same animations. Weights are rounded to 1/32 steps. Zero (default) disables sharing.
+    /// @property
+    void SetPoseSharingStep(float step);
+    /// Return a scene node that follows a bone, for attaching objects such as weapons. With a node-free pose the node is created as a child of the model's scene node on first use, otherwise it is the bone's own node. Return null if the bone does not exist.
+    Node* CreateBoneAttachment(const String& boneName);
+    /// Remove a bone attachment node created for a node-free pose.
+    void RemoveBoneAttachment(const String& boneName);
     /// Set vertex morph weight by index.
     void SetMorphWeight(unsigned index, float weight);
     /// Set vertex morph weight by name.
@@ -102,6 +122,8 @@ public:
     void ResetMorphWeights();
     /// Apply all animation states to nodes.
     void ApplyAnimation();
+    /// Apply the animation states of several models. The animation tracks are sampled in parallel in ranges, after which each model blends its pose. Called by the octree update. Must be called from the main thread.
+    static void ApplyAnimations(const PODVector<AnimatedModel*>& models, WorkQueue* queue);
 
     /// Return skeleton.
     /// @property
@@ -132,6 +154,17 @@ public:
     /// @property
     bool GetUpdateInvisible() const { return updateInvisible_; }
 
+    /// Return whether the skeleton pose is kept in arrays instead of bone scene nodes.
+    /// @property
+    bool GetNodeFreePose() const { return nodeFreePose_; }
+
+    /// Return the time step for sharing node-free poses.
+    /// @property
+    float GetPoseSharingStep() const { return poseSharingStep_; }
+
+    /// Return the model-space bone transforms of a node-free pose. Empty when the bone scene nodes are used.
+    const PODVector<Matrix3x4>& GetBoneTransforms() const { return boneTransforms_; }
+
     /// Return all vertex morphs.
     const Vector<ModelMorph>& GetMorphs() const { return morphs_; }
 
@@ -202,6 +235,20 @@ private:
     void MarkMorphsDirty();
     /// Set skeleton.
     void SetSkeleton(const Skeleton& skeleton, bool createBones);
+    /// Create scene nodes for the bones.
+    void CreateBoneNodes();
+    /// Size the node-free pose to the skeleton and reset it to the initial bone transforms.
+    void InitializePose();
+    /// Reset the animated bones of the node-free pose to their initial transforms.
+    void ResetPose();
+    /// Calculate the model-space bone transforms of the node-free pose and move the bone attachments.
+    void UpdatePoseTransforms();
+    /// Move the bone attachments to the node-free pose silently.
+    void MoveBoneAttachments();
+    /// Apply the animation states through the pose cache. Return false if the pose cannot be shared.
+    bool ApplySharedPose();
+    /// Rebind animation state tracks after the bone nodes have been created or removed.
+    void RebindAnimationStates();
     /// Set mapping of subgeometry bone indices.
     void SetGeometryBoneMappings();
     /// Clone geometries for vertex morphing.
@@ -236,6 +283,22 @@ private:
     Vector<PODVector<Matrix3x4> > geometrySkinMatrices_;
     /// Subgeometry skinning matrix pointers, if more bones than skinning shader can manage.
     Vector<PODVector<Matrix3x4*> > geometrySkinMatrixPtrs_;
+    /// Bone positions of the node-free pose, relative to the parent bone.
+    PODVector<Vector3> bonePositions_;
+    /// Bone rotations of the node-free pose, relative to the parent bone.
+    PODVector<Quaternion> boneRotations_;
+    /// Bone scales of the node-free pose, relative to the parent bone.
+    PODVector<Vector3> boneScales_;
+    /// Model-space bone transforms of the node-free pose.
+    PODVector<Matrix3x4> boneTransforms_;
+    /// Bone indices ordered so that parents come before their children.
+    PODVector<unsigned> boneOrder_;
+    /// Bone attachment nodes of the node-free pose.
+    Vector<BoneAttachment> boneAttachments_;
+    /// Bone indices in the master model's skeleton, used when skinning from the master's node-free pose.
+    PODVector<unsigned> masterBoneIndices_;
+    /// Pose cache key of the current animation states.
+    PODVector<unsigned> poseKey_;
     /// Bounding box calculated from bones.
     BoundingBox boneBoundingBox_;
     /// Attribute buffer.
@@ -250,6 +313,8 @@ private:
     float animationLodTimer_;
     /// Animation LOD distance, the minimum of all LOD view distances last frame.
     float animationLodDistance_;
+    /// Time step for sharing node-free poses.
+    float poseSharingStep_;
     /// Update animation when invisible flag.
     bool updateInvisible_;
     /// Animation dirty flag.
@@ -270,6 +335,8 @@ private:
     bool assignBonesPending_;
     /// Force animation update after becoming visible flag.
     bool forceAnimationUpdate_;
+    /// Node-free pose flag.
+    bool nodeFreePose_;
 };
 
 }
@@ -49,12 +49,128 @@ inline bool CompareKeyFrames(AnimationKeyFrame& lhs, AnimationKeyFrame& rhs)
     return lhs.time_ < rhs.time_;
 }
 
+/// Largest absolute value of the three smallest quaternion components.
+static const float SMALLEST_THREE_RANGE = 0.70710678f;
+/// Maximum value of 16-bit fixed point position and scale.
+static const float FIXED_POINT_MAX = 65535.0f;
+/// Maximum value of 15-bit smallest three rotation components.
+static const float ROTATION_COMPONENT_MAX = 32767.0f;
+
+inline unsigned GetCompressedStride(AnimationChannelFlags channelMask)
+{
+    return ((channelMask & CHANNEL_POSITION) ? 3 : 0) + ((channelMask & CHANNEL_ROTATION) ? 3 : 0) +
+        ((channelMask & CHANNEL_SCALE) ? 3 : 0);
+}
+
+inline void QuantizeVector3(const Vector3& value, const Vector3& min, const Vector3& range, unsigned short* dest)
+{
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        const float r = range.Data()[i];
+        dest[i] = r > 0.0f ? (unsigned short)RoundToInt(Clamp((value.Data()[i] - min.Data()[i]) / r, 0.0f, 1.0f) *
+            FIXED_POINT_MAX) : 0;
+    }
+}
+
+inline Vector3 DequantizeVector3(const unsigned short* src, const Vector3& min, const Vector3& range)
+{
+    const Vector3 step = range * (1.0f / FIXED_POINT_MAX);
+    return Vector3(min.x_ + src[0] * step.x_, min.y_ + src[1] * step.y_, min.z_ + src[2] * step.z_);
+}
+
+/// Store the three smallest components of a rotation in 15 bits each. The largest component is reconstructed from the
+/// unit length, and its index is stored in the top bits of the first two components.
+inline void QuantizeRotation(const Quaternion& rotation, unsigned short* dest)
+{
+    const Quaternion normalized = rotation.Normalized();
+    const float* values = normalized.Data();
+
+    unsigned largest = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(values[i]) > Abs(values[largest]))
+            largest = i;
+    }
+
+    // q and -q are the same rotation, so flip the sign to make the largest component positive
+    const float scale = (values[largest] < 0.0f ? -0.5f : 0.5f) / SMALLEST_THREE_RANGE;
+    unsigned j = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largest)
+            dest[j++] = (unsigned short)RoundToInt(Clamp(values[i] * scale + 0.5f, 0.0f, 1.0f) * ROTATION_COMPONENT_MAX);
+    }
+
+    dest[0] |= (largest & 1u) << 15u;
+    dest[1] |= (largest & 2u) << 14u;
+}
+
+inline Quaternion DequantizeRotation(const unsigned short* src)
+{
+    const unsigned largest = (src[0] >> 15u) | ((src[1] >> 14u) & 2u);
+
+    float values[4];
+    float sumSquares = 0.0f;
+    unsigned j = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+        const float value = ((src[j++] & 0x7fffu) * (1.0f / ROTATION_COMPONENT_MAX) - 0.5f) * (2.0f * SMALLEST_THREE_RANGE);
+        values[i] = value;
+        sumSquares += value * value;
+    }
+    values[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+
+    return Quaternion(values[0], values[1], values[2], values[3]);
+}
+
+/// Return the angle in radians between two rotations.
+inline float GetRotationError(const Quaternion& lhs, const Quaternion& rhs)
+{
+    // The chord length between unit quaternions is 2 * sin(angle / 4), which does not lose precision at small angles like acos
+    const Quaternion difference = lhs.DotProduct(rhs) < 0.0f ? lhs + rhs : lhs - rhs;
+    return 4.0f * asinf(Min(sqrtf(difference.DotProduct(difference)) * 0.5f, 1.0f));
+}
+
+/// Return whether the keyframes between first and last can be interpolated within the tolerances from the quantized first and
+/// last keyframes.
+static bool CanInterpolateKeyFrames(const Vector<AnimationKeyFrame>& keyFrames, const Vector<AnimationKeyFrame>& quantizedKeyFrames,
+    unsigned first, unsigned last, AnimationChannelFlags channelMask, float positionTolerance, float rotationTolerance,
+    float scaleTolerance)
+{
+    const AnimationKeyFrame& keyFrame = quantizedKeyFrames[first];
+    const AnimationKeyFrame& nextKeyFrame = quantizedKeyFrames[last];
+    const float timeInterval = nextKeyFrame.time_ - keyFrame.time_;
+
+    for (unsigned i = first + 1; i < last; ++i)
+    {
+        const AnimationKeyFrame& removed = keyFrames[i];
+        const float t = timeInterval > 0.0f ? (removed.time_ - keyFrame.time_) / timeInterval : 0.0f;
+
+        if ((channelMask & CHANNEL_POSITION) &&
+            (keyFrame.position_.Lerp(nextKeyFrame.position_, t) - removed.position_).Length() > positionTolerance)
+            return false;
+        if ((channelMask & CHANNEL_ROTATION) &&
+            GetRotationError(keyFrame.rotation_.Slerp(nextKeyFrame.rotation_, t), removed.rotation_) > rotationTolerance)
+            return false;
+        if ((channelMask & CHANNEL_SCALE) &&
+            (keyFrame.scale_.Lerp(nextKeyFrame.scale_, t) - removed.scale_).Length() > scaleTolerance)
+            return false;
+    }
+
+    return true;
+}
+
 void AnimationTrack::SetKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
+    Decompress();
+
     if (index < keyFrames_.Size())
     {
         keyFrames_[index] = keyFrame;
         Urho3D::Sort(keyFrames_.Begin(), keyFrames_.End(), CompareKeyFrames);
+        UpdateKeyFrameTimes();
     }
     else if (index == keyFrames_.Size())
         AddKeyFrame(keyFrame);
@@ -62,55 +178,234 @@ void AnimationTrack::SetKeyFrame(unsigned index, const AnimationKeyFrame& keyFra
 
 void AnimationTrack::AddKeyFrame(const AnimationKeyFrame& keyFrame)
 {
+    Decompress();
+
     bool needSort = keyFrames_.Size() ? keyFrames_.Back().time_ > keyFrame.time_ : false;
     keyFrames_.Push(keyFrame);
     if (needSort)
         Urho3D::Sort(keyFrames_.Begin(), keyFrames_.End(), CompareKeyFrames);
+    UpdateKeyFrameTimes();
 }
 
 void AnimationTrack::InsertKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
+    Decompress();
     keyFrames_.Insert(index, keyFrame);
     Urho3D::Sort(keyFrames_.Begin(), keyFrames_.End(), CompareKeyFrames);
+    UpdateKeyFrameTimes();
 }
 
 void AnimationTrack::RemoveKeyFrame(unsigned index)
 {
+    Decompress();
     keyFrames_.Erase(index);
+    UpdateKeyFrameTimes();
 }
 
 void AnimationTrack::RemoveAllKeyFrames()
 {
     keyFrames_.Clear();
+    keyFrameTimes_.Clear();
+    compressedKeyFrames_.Clear();
+    compressed_ = false;
+}
+
+void AnimationTrack::Compress(float positionTolerance, float rotationTolerance, float scaleTolerance)
+{
+    // Start from the full precision keyframes, so that compressing again does not accumulate error
+    Decompress();
+    UpdateKeyFrameTimes();
+
+    // Quantize position and scale relative to their range in the track
+    Vector3 positionMax;
+    Vector3 scaleMax;
+    for (unsigned i = 0; i < keyFrames_.Size(); ++i)
+    {
+        const AnimationKeyFrame& keyFrame = keyFrames_[i];
+        positionMin_ = i ? VectorMin(positionMin_, keyFrame.position_) : keyFrame.position_;
+        positionMax = i ? VectorMax(positionMax, keyFrame.position_) : keyFrame.position_;
+        scaleMin_ = i ? VectorMin(scaleMin_, keyFrame.scale_) : keyFrame.scale_;
+        scaleMax = i ? VectorMax(scaleMax, keyFrame.scale_) : keyFrame.scale_;
+    }
+    positionRange_ = positionMax - positionMin_;
+    scaleRange_ = scaleMax - scaleMin_;
+
+    const unsigned stride = GetCompressedStride(channelMask_);
+    compressedKeyFrames_.Resize(keyFrames_.Size() * stride);
+    for (unsigned i = 0; i < keyFrames_.Size(); ++i)
+    {
+        const AnimationKeyFrame& keyFrame = keyFrames_[i];
+        unsigned short* dest = compressedKeyFrames_.Buffer() + i * stride;
+        if (channelMask_ & CHANNEL_POSITION)
+        {
+            QuantizeVector3(keyFrame.position_, positionMin_, positionRange_, dest);
+            dest += 3;
+        }
+        if (channelMask_ & CHANNEL_ROTATION)
+        {
+            QuantizeRotation(keyFrame.rotation_, dest);
+            dest += 3;
+        }
+        if (channelMask_ & CHANNEL_SCALE)
+            QuantizeVector3(keyFrame.scale_, scaleMin_, scaleRange_, dest);
+    }
+
+    // Greedily extend each interpolated span until a removed keyframe would exceed the tolerance. The error is measured from
+    // the quantized keyframes, so that it includes the quantization error. The first and last keyframes are always kept,
+    // so that looping wraps around the same way
+    if (keyFrames_.Size() > 2)
+    {
+        Vector<AnimationKeyFrame> quantizedKeyFrames(keyFrames_.Size());
+        for (unsigned i = 0; i < keyFrames_.Size(); ++i)
+            DecompressKeyFrame(i, quantizedKeyFrames[i]);
+
+        PODVector<unsigned> keptIndices;
+        keptIndices.Push(0);
+        unsigned first = 0;
+        for (unsigned last = 2; last < keyFrames_.Size(); ++last)
+        {
+            if (!CanInterpolateKeyFrames(keyFrames_, quantizedKeyFrames, first, last, channelMask_, positionTolerance,
+                rotationTolerance, scaleTolerance))
+            {
+                first = last - 1;
+                keptIndices.Push(first);
+            }
+        }
+        keptIndices.Push(keyFrames_.Size() - 1);
+
+        // Compact the kept keyframes in place, they are in ascending order
+        for (unsigned i = 0; i < keptIndices.Size(); ++i)
+        {
+            const unsigned index = keptIndices[i];
+            keyFrameTimes_[i] = keyFrameTimes_[index];
+            for (unsigned j = 0; j < stride; ++j)
+                compressedKeyFrames_[i * stride + j] = compressedKeyFrames_[index * stride + j];
+        }
+        keyFrameTimes_.Resize(keptIndices.Size());
+        compressedKeyFrames_.Resize(keptIndices.Size() * stride);
+        keyFrameTimes_.Compact();
+        compressedKeyFrames_.Compact();
+    }
+
+    keyFrames_.Clear();
+    keyFrames_.Compact();
+    compressed_ = true;
+
+    if (animation_)
+        animation_->UpdateMemoryUse();
+}
+
+void AnimationTrack::Decompress()
+{
+    if (!compressed_)
+        return;
+
+    keyFrames_.Resize(keyFrameTimes_.Size());
+    for (unsigned i = 0; i < keyFrames_.Size(); ++i)
+        DecompressKeyFrame(i, keyFrames_[i]);
+
+    compressedKeyFrames_.Clear();
+    compressedKeyFrames_.Compact();
+    compressed_ = false;
+
+    // The track may belong to a shared resource, so keep its memory use up to date
+    if (animation_)
+        animation_->UpdateMemoryUse();
 }
 
 AnimationKeyFrame* AnimationTrack::GetKeyFrame(unsigned index)
 {
+    Decompress();
     return index < keyFrames_.Size() ? &keyFrames_[index] : nullptr;
 }
 
 bool AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
 {
-    if (keyFrames_.Empty())
+    const unsigned numKeyFrames = GetNumKeyFrames();
+    if (!numKeyFrames)
         return false;
 
     if (time < 0.0f)
         time = 0.0f;
 
-    if (index >= keyFrames_.Size())
-        index = keyFrames_.Size() - 1;
+    if (index >= numKeyFrames)
+        index = numKeyFrames - 1;
+
+    // The keyframes have been modified directly without updating the times, fall back to searching linearly
+    if (keyFrameTimes_.Size() != numKeyFrames)
+    {
+        // Check for being too far ahead
+        while (index && time < keyFrames_[index].time_)
+            --index;
 
-    // Check for being too far ahead
-    while (index && time < keyFrames_[index].time_)
-        --index;
+        // Check for being too far behind
+        while (index < numKeyFrames - 1 && time >= keyFrames_[index + 1].time_)
+            ++index;
+
+        return true;
+    }
+
+    // During playback the keyframe usually stays the same or advances by one, check those first
+    const float* times = &keyFrameTimes_[0];
+    if (time >= times[index])
+    {
+        if (index + 1 >= numKeyFrames || time < times[index + 1])
+            return true;
+        if (index + 2 >= numKeyFrames || time < times[index + 2])
+        {
+            ++index;
+            return true;
+        }
+    }
 
-    // Check for being too far behind
-    while (index < keyFrames_.Size() - 1 && time >= keyFrames_[index + 1].time_)
-        ++index;
+    // Binary search for the last keyframe at or before the time
+    unsigned first = 0;
+    unsigned count = numKeyFrames;
+    while (count)
+    {
+        unsigned half = count >> 1u;
+        if (time >= times[first + half])
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+            count = half;
+    }
+    index = first ? first - 1 : 0;
 
     return true;
 }
 
+void AnimationTrack::DecompressKeyFrame(unsigned index, AnimationKeyFrame& dest) const
+{
+    const unsigned short* src = compressedKeyFrames_.Buffer() + index * GetCompressedStride(channelMask_);
+    dest.time_ = keyFrameTimes_[index];
+    if (channelMask_ & CHANNEL_POSITION)
+    {
+        dest.position_ = DequantizeVector3(src, positionMin_, positionRange_);
+        src += 3;
+    }
+    if (channelMask_ & CHANNEL_ROTATION)
+    {
+        dest.rotation_ = DequantizeRotation(src);
+        src += 3;
+    }
+    if (channelMask_ & CHANNEL_SCALE)
+        dest.scale_ = DequantizeVector3(src, scaleMin_, scaleRange_);
+}
+
+void AnimationTrack::UpdateKeyFrameTimes()
+{
+    // The times of a compressed track are authoritative
+    if (compressed_)
+        return;
+
+    keyFrameTimes_.Resize(keyFrames_.Size());
+    for (unsigned i = 0; i < keyFrames_.Size(); ++i)
+        keyFrameTimes_[i] = keyFrames_[i].time_;
+}
+
 Animation::Animation(Context* context) :
     ResourceWithMetadata(context),
     length_(0.f)
@@ -128,8 +423,10 @@ bool Animation::BeginLoad(Deserializer& source)
 {
     unsigned memoryUse = sizeof(Animation);
 
-    // Check ID
-    if (source.ReadFileID() != "UANI")
+    // Check ID. UANC is the compressed format
+    String fileID = source.ReadFileID();
+    const bool compressed = fileID == "UANC";
+    if (fileID != "UANI" && !compressed)
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid animation file");
         return false;
@@ -151,6 +448,32 @@ bool Animation::BeginLoad(Deserializer& source)
         newTrack->channelMask_ = AnimationChannelFlags(source.ReadUByte());
 
         unsigned keyFrames = source.ReadUInt();
+        if (compressed)
+        {
+            // Read the keyframe times, quantization ranges and quantized keyframes of the track
+            const unsigned stride = GetCompressedStride(newTrack->channelMask_);
+            newTrack->keyFrameTimes_.Resize(keyFrames);
+            if (keyFrames)
+                source.Read(&newTrack->keyFrameTimes_[0], keyFrames * sizeof(float));
+            if (newTrack->channelMask_ & CHANNEL_POSITION)
+            {
+                newTrack->positionMin_ = source.ReadVector3();
+                newTrack->positionRange_ = source.ReadVector3();
+            }
+            if (newTrack->channelMask_ & CHANNEL_SCALE)
+            {
+                newTrack->scaleMin_ = source.ReadVector3();
+                newTrack->scaleRange_ = source.ReadVector3();
+            }
+            newTrack->compressedKeyFrames_.Resize(keyFrames * stride);
+            if (keyFrames && stride)
+                source.Read(&newTrack->compressedKeyFrames_[0], keyFrames * stride * sizeof(unsigned short));
+            newTrack->compressed_ = true;
+
+            memoryUse += keyFrames * (sizeof(float) + stride * sizeof(unsigned short));
+            continue;
+        }
+
         newTrack->keyFrames_.Resize(keyFrames);
         memoryUse += keyFrames * sizeof(AnimationKeyFrame);
 
@@ -166,6 +489,9 @@ bool Animation::BeginLoad(Deserializer& source)
             if (newTrack->channelMask_ & CHANNEL_SCALE)
                 newKeyFrame.scale_ = source.ReadVector3();
         }
+
+        newTrack->UpdateKeyFrameTimes();
+        memoryUse += keyFrames * sizeof(float);
     }
 
     // Optionally read triggers from an XML file
@@ -228,8 +554,9 @@ bool Animation::BeginLoad(Deserializer& source)
 
 bool Animation::Save(Serializer& dest) const
 {
-    // Write ID, name and length
-    dest.WriteFileID("UANI");
+    // Write ID, name and length. Use the compressed format if any track is compressed
+    const bool compressed = IsCompressed();
+    dest.WriteFileID(compressed ? "UANC" : "UANI");
     dest.WriteString(animationName_);
     dest.WriteFloat(length_);
 
@@ -238,6 +565,42 @@ bool Animation::Save(Serializer& dest) const
     for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
     {
         const AnimationTrack& track = i->second_;
+
+        if (compressed)
+        {
+            // Quantize uncompressed tracks without removing keyframes
+            AnimationTrack quantizedTrack;
+            if (!track.compressed_)
+            {
+                quantizedTrack = track;
+                quantizedTrack.Compress(0.0f, 0.0f, 0.0f);
+            }
+            const AnimationTrack& compressedTrack = track.compressed_ ? track : quantizedTrack;
+            const unsigned numKeyFrames = compressedTrack.keyFrameTimes_.Size();
+
+            dest.WriteString(compressedTrack.name_);
+            dest.WriteUByte(compressedTrack.channelMask_);
+            dest.WriteUInt(numKeyFrames);
+            if (numKeyFrames)
+                dest.Write(&compressedTrack.keyFrameTimes_[0], numKeyFrames * sizeof(float));
+            if (compressedTrack.channelMask_ & CHANNEL_POSITION)
+            {
+                dest.WriteVector3(compressedTrack.positionMin_);
+                dest.WriteVector3(compressedTrack.positionRange_);
+            }
+            if (compressedTrack.channelMask_ & CHANNEL_SCALE)
+            {
+                dest.WriteVector3(compressedTrack.scaleMin_);
+                dest.WriteVector3(compressedTrack.scaleRange_);
+            }
+            if (!compressedTrack.compressedKeyFrames_.Empty())
+            {
+                dest.Write(&compressedTrack.compressedKeyFrames_[0], compressedTrack.compressedKeyFrames_.Size() *
+                    sizeof(unsigned short));
+            }
+            continue;
+        }
+
         dest.WriteString(track.name_);
         dest.WriteUByte(track.channelMask_);
         dest.WriteUInt(track.keyFrames_.Size());
@@ -308,6 +671,7 @@ AnimationTrack* Animation::CreateTrack(const String& name)
     AnimationTrack& newTrack = tracks_[nameHash];
     newTrack.name_ = name;
     newTrack.nameHash_ = nameHash;
+    newTrack.animation_ = this;
     return &newTrack;
 }
 
@@ -371,6 +735,13 @@ void Animation::SetNumTriggers(unsigned num)
     triggers_.Resize(num);
 }
 
+void Animation::Compress(float positionTolerance, float rotationTolerance, float scaleTolerance)
+{
+    // The tracks update the memory use
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+        i->second_.Compress(positionTolerance, rotationTolerance, scaleTolerance);
+}
+
 SharedPtr<Animation> Animation::Clone(const String& cloneName) const
 {
     SharedPtr<Animation> ret(new Animation(context_));
@@ -379,6 +750,8 @@ SharedPtr<Animation> Animation::Clone(const String& cloneName) const
     ret->SetAnimationName(animationName_);
     ret->length_ = length_;
     ret->tracks_ = tracks_;
+    for (HashMap<StringHash, AnimationTrack>::Iterator i = ret->tracks_.Begin(); i != ret->tracks_.End(); ++i)
+        i->second_.animation_ = ret;
     ret->triggers_ = triggers_;
     ret->CopyMetadata(*this);
     ret->SetMemoryUse(GetMemoryUse());
@@ -420,4 +793,30 @@ AnimationTriggerPoint* Animation::GetTrigger(unsigned index)
     return index < triggers_.Size() ? &triggers_[index] : nullptr;
 }
 
+bool Animation::IsCompressed() const
+{
+    for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        if (i->second_.compressed_)
+            return true;
+    }
+
+    return false;
+}
+
+void Animation::UpdateMemoryUse()
+{
+    unsigned memoryUse = sizeof(Animation) + tracks_.Size() * sizeof(AnimationTrack) +
+        triggers_.Size() * sizeof(AnimationTriggerPoint);
+
+    for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks_.Begin(); i != tracks_.End(); ++i)
+    {
+        const AnimationTrack& track = i->second_;
+        memoryUse += track.keyFrames_.Size() * sizeof(AnimationKeyFrame) + track.keyFrameTimes_.Size() * sizeof(float) +
+            track.compressedKeyFrames_.Size() * sizeof(unsigned short);
+    }
+
+    SetMemoryUse(memoryUse);
+}
+
 }
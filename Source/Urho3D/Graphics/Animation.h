@@ -42,6 +42,8 @@ enum AnimationChannel : unsigned char
 };
 URHO3D_FLAGSET(AnimationChannel, AnimationChannelFlags);
 
+class Animation;
+
 /// Skeletal animation keyframe.
 struct AnimationKeyFrame
 {
@@ -83,13 +85,24 @@ struct URHO3D_API AnimationTrack
     /// Remove all keyframes.
     void RemoveAllKeyFrames();
 
-    /// Return keyframe at index, or null if not found.
+    /// Quantize the keyframes, then remove keyframes that can be interpolated from their quantized neighbours within the error tolerances (position and scale in units, rotation in radians). The kept keyframes have a quantization error of up to 1/131070 of the track's value range in position and scale, and about 1e-4 radians in rotation, which smaller tolerances can not go below.
+    void Compress(float positionTolerance, float rotationTolerance, float scaleTolerance);
+    /// Decompress the keyframes for editing. Called by the keyframe functions.
+    void Decompress();
+
+    /// Return keyframe at index, or null if not found. Decompresses the track if compressed, which also affects the other users of the animation and increases its memory use.
     AnimationKeyFrame* GetKeyFrame(unsigned index);
     /// Return number of keyframes.
     /// @property
-    unsigned GetNumKeyFrames() const { return keyFrames_.Size(); }
+    unsigned GetNumKeyFrames() const { return compressed_ ? keyFrameTimes_.Size() : keyFrames_.Size(); }
+    /// Return whether the keyframes are stored compressed.
+    bool IsCompressed() const { return compressed_; }
     /// Return keyframe index based on time and previous index. Return false if animation is empty.
     bool GetKeyFrameIndex(float time, unsigned& index) const;
+    /// Decompress a keyframe of a compressed track. The index must be valid.
+    void DecompressKeyFrame(unsigned index, AnimationKeyFrame& dest) const;
+    /// Copy the keyframe times to the time array used for searching. Called by the keyframe functions, call manually after modifying the keyframes directly.
+    void UpdateKeyFrameTimes();
 
     /// Bone or scene node name.
     String name_;
@@ -99,6 +112,22 @@ struct URHO3D_API AnimationTrack
     AnimationChannelFlags channelMask_{};
     /// Keyframes.
     Vector<AnimationKeyFrame> keyFrames_;
+    /// Keyframe times stored separately, so that the keyframe search reads consecutive memory.
+    PODVector<float> keyFrameTimes_;
+    /// Compressed keyframes: 16-bit fixed point position and scale, smallest three rotation. Empty unless compressed.
+    PODVector<unsigned short> compressedKeyFrames_;
+    /// Minimum position of a compressed track.
+    Vector3 positionMin_;
+    /// Position range of a compressed track.
+    Vector3 positionRange_;
+    /// Minimum scale of a compressed track.
+    Vector3 scaleMin_;
+    /// Scale range of a compressed track.
+    Vector3 scaleRange_;
+    /// Compressed flag. When set, the keyframes vector is empty and the keyframe times hold the times.
+    bool compressed_{};
+    /// Animation that the track belongs to, for updating its memory use when compressing or decompressing.
+    Animation* animation_{};
 };
 
 /// %Animation trigger point.
@@ -121,6 +150,8 @@ class URHO3D_API Animation : public ResourceWithMetadata
 {
     URHO3D_OBJECT(Animation, ResourceWithMetadata);
 
+    friend struct AnimationTrack;
+
 public:
     /// Construct.
     explicit Animation(Context* context);
@@ -161,6 +192,8 @@ public:
     /// Resize trigger point vector.
     /// @property
     void SetNumTriggers(unsigned num);
+    /// Compress all tracks with the given error tolerances (position and scale in units, rotation in radians). A compressed animation is saved in the compressed format.
+    void Compress(float positionTolerance, float rotationTolerance, float scaleTolerance);
     /// Clone the animation.
     SharedPtr<Animation> Clone(const String& cloneName = String::EMPTY) const;
 
@@ -201,7 +234,14 @@ public:
     /// Return a trigger point by index.
     AnimationTriggerPoint* GetTrigger(unsigned index);
 
+    /// Return whether any track is compressed.
+    /// @property
+    bool IsCompressed() const;
+
 private:
+    /// Recalculate memory use from the tracks and triggers.
+    void UpdateMemoryUse();
+
     /// Animation name.
     String animationName_;
     /// Animation name hash.
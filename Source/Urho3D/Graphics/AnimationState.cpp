@@ -28,6 +28,10 @@
 #include "../Graphics/DrawableEvents.h"
 #include "../IO/Log.h"
 
+#ifdef URHO3D_SSE
+#include <xmmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -36,13 +40,32 @@ namespace Urho3D
 AnimationStateTrack::AnimationStateTrack() :
     track_(nullptr),
     bone_(nullptr),
+    boneIndex_(M_MAX_UNSIGNED),
     weight_(1.0f),
-    keyFrame_(0)
+    keyFrame_(0),
+    scale_(Vector3::ONE),
+    sampled_(false)
 {
 }
 
 AnimationStateTrack::~AnimationStateTrack() = default;
 
+static bool IsBoneInHierarchy(const Skeleton& skeleton, unsigned boneIndex, unsigned rootIndex)
+{
+    const Vector<Bone>& bones = skeleton.GetBones();
+    for (unsigned i = 0; i < bones.Size() && boneIndex < bones.Size(); ++i)
+    {
+        if (boneIndex == rootIndex)
+            return true;
+        unsigned parentIndex = bones[boneIndex].parentIndex_;
+        if (parentIndex == boneIndex)
+            break;
+        boneIndex = parentIndex;
+    }
+
+    return false;
+}
+
 AnimationState::AnimationState(AnimatedModel* model, Animation* animation) :
     model_(model),
     animation_(animation),
@@ -51,7 +74,8 @@ AnimationState::AnimationState(AnimatedModel* model, Animation* animation) :
     weight_(0.0f),
     time_(0.0f),
     layer_(0),
-    blendingMode_(ABM_LERP)
+    blendingMode_(ABM_LERP),
+    samplesReady_(false)
 {
     // Set default start bone (use all tracks)
     SetStartBone(nullptr);
@@ -65,7 +89,8 @@ AnimationState::AnimationState(Node* node, Animation* animation) :
     weight_(1.0f),
     time_(0.0f),
     layer_(0),
-    blendingMode_(ABM_LERP)
+    blendingMode_(ABM_LERP),
+    samplesReady_(false)
 {
     if (animation_)
     {
@@ -125,7 +150,10 @@ void AnimationState::SetStartBone(Bone* startBone)
     const HashMap<StringHash, AnimationTrack>& tracks = animation_->GetTracks();
     stateTracks_.Clear();
 
-    if (!startBone->node_)
+    // With a node-free pose the tracks are bound to bone indices, and the hierarchy is found through the skeleton
+    const bool nodeFree = model_->GetNodeFreePose();
+    const unsigned startBoneIndex = skeleton.GetBoneIndex(startBone);
+    if (!nodeFree && !startBone->node_)
         return;
 
     for (HashMap<StringHash, AnimationTrack>::ConstIterator i = tracks.Begin(); i != tracks.End(); ++i)
@@ -139,6 +167,12 @@ void AnimationState::SetStartBone(Bone* startBone)
 
         if (nameHash == startBone->nameHash_)
             trackBone = startBone;
+        else if (nodeFree)
+        {
+            Bone* bone = skeleton.GetBone(nameHash);
+            if (bone && IsBoneInHierarchy(skeleton, skeleton.GetBoneIndex(bone), startBoneIndex))
+                trackBone = bone;
+        }
         else
         {
             Node* trackBoneNode = startBone->node_->GetChild(nameHash, true);
@@ -146,9 +180,10 @@ void AnimationState::SetStartBone(Bone* startBone)
                 trackBone = skeleton.GetBone(nameHash);
         }
 
-        if (trackBone && trackBone->node_)
+        if (trackBone && (nodeFree || trackBone->node_))
         {
             stateTrack.bone_ = trackBone;
+            stateTrack.boneIndex_ = skeleton.GetBoneIndex(trackBone);
             stateTrack.node_ = trackBone->node_;
             stateTracks_.Push(stateTrack);
         }
@@ -229,6 +264,17 @@ void AnimationState::SetBoneWeight(unsigned index, float weight, bool recursive)
                     SetBoneWeight(childTrackIndex, weight, true);
             }
         }
+        else if (stateTracks_[index].bone_)
+        {
+            // Node-free pose: find the tracks of the child bones through the skeleton
+            unsigned boneIndex = stateTracks_[index].boneIndex_;
+            for (unsigned i = 0; i < stateTracks_.Size(); ++i)
+            {
+                const AnimationStateTrack& childTrack = stateTracks_[i];
+                if (childTrack.bone_ && childTrack.bone_->parentIndex_ == boneIndex && childTrack.boneIndex_ != boneIndex)
+                    SetBoneWeight(i, weight, true);
+            }
+        }
     }
 }
 
@@ -406,7 +452,8 @@ unsigned AnimationState::GetTrackIndex(const String& name) const
     for (unsigned i = 0; i < stateTracks_.Size(); ++i)
     {
         Node* node = stateTracks_[i].node_;
-        if (node && node->GetName() == name)
+        const Bone* bone = stateTracks_[i].bone_;
+        if (node ? node->GetName() == name : bone && bone->name_ == name)
             return i;
     }
 
@@ -429,7 +476,8 @@ unsigned AnimationState::GetTrackIndex(StringHash nameHash) const
     for (unsigned i = 0; i < stateTracks_.Size(); ++i)
     {
         Node* node = stateTracks_[i].node_;
-        if (node && node->GetNameHash() == nameHash)
+        const Bone* bone = stateTracks_[i].bone_;
+        if (node ? node->GetNameHash() == nameHash : bone && bone->nameHash_ == nameHash)
             return i;
     }
 
@@ -447,108 +495,328 @@ void AnimationState::Apply()
         return;
 
     if (model_)
-        ApplyToModel();
+        ApplyToModel(time_, weight_);
     else
         ApplyToNodes();
 }
 
-void AnimationState::ApplyToModel()
+void AnimationState::ApplyToModel(float time, float weight)
 {
+    // The tracks may have been sampled in parallel already, which is only done at the current time position
+    if (!samplesReady_ || time != time_)
+        SampleTracks(time, 0, stateTracks_.Size());
+    samplesReady_ = false;
+
+    ApplySamples(weight);
+}
+
+void AnimationState::ApplyToNodes()
+{
+    SampleTracks(time_, 0, stateTracks_.Size());
+
+    // When applying to a node hierarchy, can only use full weight (nothing to blend to)
     for (Vector<AnimationStateTrack>::Iterator i = stateTracks_.Begin(); i != stateTracks_.End(); ++i)
+        ApplyTrack(*i, 1.0f, false);
+}
+
+#ifdef URHO3D_SSE
+/// Interpolate the keyframes of four tracks with SSE, with the rotations in structure of arrays layout. The rotations are
+/// interpolated with a normalized lerp whose interpolation factor is corrected for the angle between the keyframes, which
+/// stays within 1e-4 radians of slerp for keyframes less than 120 degrees apart. Further apart keyframes use slerp.
+static void InterpolateKeyFrames(AnimationStateTrack* const* stateTracks, const AnimationKeyFrame* const* keyFrames,
+    const AnimationKeyFrame* const* nextKeyFrames, const float* factors)
+{
+    const __m128 t = _mm_loadu_ps(factors);
+
+#define URHO3D_GATHER(keys, member) _mm_setr_ps(keys[0]->member, keys[1]->member, keys[2]->member, keys[3]->member)
+    __m128 px = URHO3D_GATHER(keyFrames, position_.x_);
+    __m128 py = URHO3D_GATHER(keyFrames, position_.y_);
+    __m128 pz = URHO3D_GATHER(keyFrames, position_.z_);
+    px = _mm_add_ps(px, _mm_mul_ps(_mm_sub_ps(URHO3D_GATHER(nextKeyFrames, position_.x_), px), t));
+    py = _mm_add_ps(py, _mm_mul_ps(_mm_sub_ps(URHO3D_GATHER(nextKeyFrames, position_.y_), py), t));
+    pz = _mm_add_ps(pz, _mm_mul_ps(_mm_sub_ps(URHO3D_GATHER(nextKeyFrames, position_.z_), pz), t));
+
+    __m128 sx = URHO3D_GATHER(keyFrames, scale_.x_);
+    __m128 sy = URHO3D_GATHER(keyFrames, scale_.y_);
+    __m128 sz = URHO3D_GATHER(keyFrames, scale_.z_);
+    sx = _mm_add_ps(sx, _mm_mul_ps(_mm_sub_ps(URHO3D_GATHER(nextKeyFrames, scale_.x_), sx), t));
+    sy = _mm_add_ps(sy, _mm_mul_ps(_mm_sub_ps(URHO3D_GATHER(nextKeyFrames, scale_.y_), sy), t));
+    sz = _mm_add_ps(sz, _mm_mul_ps(_mm_sub_ps(URHO3D_GATHER(nextKeyFrames, scale_.z_), sz), t));
+
+    const __m128 aw = URHO3D_GATHER(keyFrames, rotation_.w_);
+    const __m128 ax = URHO3D_GATHER(keyFrames, rotation_.x_);
+    const __m128 ay = URHO3D_GATHER(keyFrames, rotation_.y_);
+    const __m128 az = URHO3D_GATHER(keyFrames, rotation_.z_);
+    __m128 bw = URHO3D_GATHER(nextKeyFrames, rotation_.w_);
+    __m128 bx = URHO3D_GATHER(nextKeyFrames, rotation_.x_);
+    __m128 by = URHO3D_GATHER(nextKeyFrames, rotation_.y_);
+    __m128 bz = URHO3D_GATHER(nextKeyFrames, rotation_.z_);
+#undef URHO3D_GATHER
+
+    // Take the shortest path by flipping the sign of the next rotation when the dot product is negative
+    __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bw), _mm_mul_ps(ax, bx)), _mm_add_ps(_mm_mul_ps(ay, by), _mm_mul_ps(az, bz)));
+    const __m128 signBit = _mm_and_ps(d, _mm_set1_ps(-0.0f));
+    bw = _mm_xor_ps(bw, signBit);
+    bx = _mm_xor_ps(bx, signBit);
+    by = _mm_xor_ps(by, signBit);
+    bz = _mm_xor_ps(bz, signBit);
+    d = _mm_xor_ps(d, signBit);
+
+    // The correction is only accurate for keyframes less than 120 degrees apart, so use slerp for the others
+    const int slerpMask = _mm_movemask_ps(_mm_cmplt_ps(d, _mm_set1_ps(0.5f)));
+
+    // Correct the interpolation factor for the angle between the rotations
+    const __m128 ka = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d,
+        _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)))))));
+    const __m128 kb = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, _mm_add_ps(_mm_set1_ps(-1.06021f),
+        _mm_mul_ps(d, _mm_set1_ps(0.215638f)))));
+    const __m128 tc = _mm_sub_ps(t, _mm_set1_ps(0.5f));
+    const __m128 k = _mm_add_ps(_mm_mul_ps(ka, _mm_mul_ps(tc, tc)), kb);
+    const __m128 ot = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, tc), _mm_sub_ps(t, _mm_set1_ps(1.0f))), k));
+
+    __m128 rw = _mm_add_ps(aw, _mm_mul_ps(_mm_sub_ps(bw, aw), ot));
+    __m128 rx = _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(bx, ax), ot));
+    __m128 ry = _mm_add_ps(ay, _mm_mul_ps(_mm_sub_ps(by, ay), ot));
+    __m128 rz = _mm_add_ps(az, _mm_mul_ps(_mm_sub_ps(bz, az), ot));
+    const __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rw, rw),
+        _mm_mul_ps(rx, rx)), _mm_add_ps(_mm_mul_ps(ry, ry), _mm_mul_ps(rz, rz)))));
+    rw = _mm_mul_ps(rw, invLength);
+    rx = _mm_mul_ps(rx, invLength);
+    ry = _mm_mul_ps(ry, invLength);
+    rz = _mm_mul_ps(rz, invLength);
+
+    alignas(16) float values[10][4];
+    _mm_store_ps(values[0], px);
+    _mm_store_ps(values[1], py);
+    _mm_store_ps(values[2], pz);
+    _mm_store_ps(values[3], rw);
+    _mm_store_ps(values[4], rx);
+    _mm_store_ps(values[5], ry);
+    _mm_store_ps(values[6], rz);
+    _mm_store_ps(values[7], sx);
+    _mm_store_ps(values[8], sy);
+    _mm_store_ps(values[9], sz);
+
+    for (unsigned j = 0; j < 4; ++j)
     {
-        AnimationStateTrack& stateTrack = *i;
-        float finalWeight = weight_ * stateTrack.weight_;
+        AnimationStateTrack& stateTrack = *stateTracks[j];
+        stateTrack.position_ = Vector3(values[0][j], values[1][j], values[2][j]);
+        if (slerpMask & (1 << j))
+            stateTrack.rotation_ = keyFrames[j]->rotation_.Slerp(nextKeyFrames[j]->rotation_, factors[j]);
+        else
+            stateTrack.rotation_ = Quaternion(values[3][j], values[4][j], values[5][j], values[6][j]);
+        stateTrack.scale_ = Vector3(values[7][j], values[8][j], values[9][j]);
+    }
+}
+#endif
 
-        // Do not apply if zero effective weight or the bone has animation disabled
-        if (Equals(finalWeight, 0.0f) || !stateTrack.bone_->animated_)
+void AnimationState::SampleTracks(float time, unsigned begin, unsigned end)
+{
+#ifdef URHO3D_SSE
+    // Interpolate four tracks at a time. Tracks without keyframes are skipped, and the last group is padded by repeating
+    // its last track, so that every track is interpolated the same way regardless of its position in the range
+    AnimationKeyFrame storage[4][2];
+    AnimationStateTrack* stateTracks[4];
+    const AnimationKeyFrame* keyFrames[4];
+    const AnimationKeyFrame* nextKeyFrames[4];
+    float factors[4];
+    unsigned count = 0;
+
+    for (unsigned i = begin; i < end; ++i)
+    {
+        AnimationStateTrack& stateTrack = stateTracks_[i];
+        stateTrack.sampled_ = FindKeyFrames(stateTrack, time, storage[count], keyFrames[count], nextKeyFrames[count],
+            factors[count]);
+        if (!stateTrack.sampled_)
             continue;
 
-        ApplyTrack(stateTrack, finalWeight, true);
+        stateTracks[count] = &stateTrack;
+        if (++count == 4)
+        {
+            InterpolateKeyFrames(stateTracks, keyFrames, nextKeyFrames, factors);
+            count = 0;
+        }
+    }
+
+    if (count)
+    {
+        for (unsigned j = count; j < 4; ++j)
+        {
+            stateTracks[j] = stateTracks[count - 1];
+            keyFrames[j] = keyFrames[count - 1];
+            nextKeyFrames[j] = nextKeyFrames[count - 1];
+            factors[j] = factors[count - 1];
+        }
+        InterpolateKeyFrames(stateTracks, keyFrames, nextKeyFrames, factors);
     }
+#else
+    for (unsigned i = begin; i < end; ++i)
+        SampleTrack(stateTracks_[i], time);
+#endif
 }
 
-void AnimationState::ApplyToNodes()
+void AnimationState::ApplySamples(float weight)
 {
-    // When applying to a node hierarchy, can only use full weight (nothing to blend to)
+    AnimatedModel* model = model_;
+    const bool nodeFree = model->GetNodeFreePose();
+
     for (Vector<AnimationStateTrack>::Iterator i = stateTracks_.Begin(); i != stateTracks_.End(); ++i)
-        ApplyTrack(*i, 1.0f, false);
+    {
+        AnimationStateTrack& stateTrack = *i;
+        float finalWeight = weight * stateTrack.weight_;
+
+        // Do not apply if zero effective weight, no keyframes or the bone has animation disabled
+        if (Equals(finalWeight, 0.0f) || !stateTrack.sampled_ || !stateTrack.bone_->animated_)
+            continue;
+
+        if (nodeFree)
+        {
+            const unsigned index = stateTrack.boneIndex_;
+            if (index < model->bonePositions_.Size())
+            {
+                BlendTrack(stateTrack, finalWeight, model->bonePositions_[index], model->boneRotations_[index],
+                    model->boneScales_[index]);
+            }
+        }
+        else
+            ApplyTrack(stateTrack, finalWeight, true);
+    }
 }
 
 void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent)
 {
-    const AnimationTrack* track = stateTrack.track_;
     Node* node = stateTrack.node_;
-
-    if (track->keyFrames_.Empty() || !node)
+    if (!node || !stateTrack.sampled_)
         return;
 
+    Vector3 position = node->GetPosition();
+    Quaternion rotation = node->GetRotation();
+    Vector3 scale = node->GetScale();
+    BlendTrack(stateTrack, weight, position, rotation, scale);
+
+    const AnimationChannelFlags channelMask = stateTrack.track_->channelMask_;
+    if (silent)
+    {
+        if (channelMask & CHANNEL_POSITION)
+            node->SetPositionSilent(position);
+        if (channelMask & CHANNEL_ROTATION)
+            node->SetRotationSilent(rotation);
+        if (channelMask & CHANNEL_SCALE)
+            node->SetScaleSilent(scale);
+    }
+    else
+    {
+        if (channelMask & CHANNEL_POSITION)
+            node->SetPosition(position);
+        if (channelMask & CHANNEL_ROTATION)
+            node->SetRotation(rotation);
+        if (channelMask & CHANNEL_SCALE)
+            node->SetScale(scale);
+    }
+}
+
+bool AnimationState::FindKeyFrames(AnimationStateTrack& stateTrack, float time, AnimationKeyFrame* storage,
+    const AnimationKeyFrame*& keyFrame, const AnimationKeyFrame*& nextKeyFrame, float& t) const
+{
+    const AnimationTrack* track = stateTrack.track_;
     unsigned& frame = stateTrack.keyFrame_;
-    track->GetKeyFrameIndex(time_, frame);
+    if (!track->GetKeyFrameIndex(time, frame))
+        return false;
+
+    const bool compressed = track->IsCompressed();
+    if (compressed)
+    {
+        track->DecompressKeyFrame(frame, storage[0]);
+        keyFrame = &storage[0];
+    }
+    else
+        keyFrame = &track->keyFrames_[frame];
 
     // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
     unsigned nextFrame = frame + 1;
-    bool interpolate = true;
-    if (nextFrame >= track->keyFrames_.Size())
+    if (nextFrame >= track->GetNumKeyFrames())
     {
         if (!looped_)
         {
-            nextFrame = frame;
-            interpolate = false;
+            nextKeyFrame = keyFrame;
+            t = 0.0f;
+            return true;
         }
-        else
-            nextFrame = 0;
+        nextFrame = 0;
     }
 
-    const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
-    const AnimationChannelFlags channelMask = track->channelMask_;
+    if (compressed)
+    {
+        track->DecompressKeyFrame(nextFrame, storage[1]);
+        nextKeyFrame = &storage[1];
+    }
+    else
+        nextKeyFrame = &track->keyFrames_[nextFrame];
 
-    Vector3 newPosition;
-    Quaternion newRotation;
-    Vector3 newScale;
+    float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
+    if (timeInterval < 0.0f)
+        timeInterval += animation_->GetLength();
+    t = timeInterval > 0.0f ? (time - keyFrame->time_) / timeInterval : 1.0f;
+    return true;
+}
 
-    if (interpolate)
-    {
-        const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
-        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
-        if (timeInterval < 0.0f)
-            timeInterval += animation_->GetLength();
-        float t = timeInterval > 0.0f ? (time_ - keyFrame->time_) / timeInterval : 1.0f;
+void AnimationState::SampleTrack(AnimationStateTrack& stateTrack, float time) const
+{
+    AnimationKeyFrame storage[2];
+    const AnimationKeyFrame* keyFrame;
+    const AnimationKeyFrame* nextKeyFrame;
+    float t;
+    stateTrack.sampled_ = FindKeyFrames(stateTrack, time, storage, keyFrame, nextKeyFrame, t);
+    if (!stateTrack.sampled_)
+        return;
 
+    const AnimationChannelFlags channelMask = stateTrack.track_->channelMask_;
+
+    if (keyFrame != nextKeyFrame)
+    {
         if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
+            stateTrack.position_ = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
         if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
+            stateTrack.rotation_ = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
         if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
+            stateTrack.scale_ = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
     }
     else
     {
         if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_;
+            stateTrack.position_ = keyFrame->position_;
         if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_;
+            stateTrack.rotation_ = keyFrame->rotation_;
         if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_;
+            stateTrack.scale_ = keyFrame->scale_;
     }
+}
+
+void AnimationState::BlendTrack(const AnimationStateTrack& stateTrack, float weight, Vector3& position, Quaternion& rotation,
+    Vector3& scale) const
+{
+    const AnimationChannelFlags channelMask = stateTrack.track_->channelMask_;
+    const Vector3& newPosition = stateTrack.position_;
+    const Quaternion& newRotation = stateTrack.rotation_;
+    const Vector3& newScale = stateTrack.scale_;
 
     if (blendingMode_ == ABM_ADDITIVE) // not ABM_LERP
     {
         if (channelMask & CHANNEL_POSITION)
         {
             Vector3 delta = newPosition - stateTrack.bone_->initialPosition_;
-            newPosition = node->GetPosition() + delta * weight;
+            position += delta * weight;
         }
         if (channelMask & CHANNEL_ROTATION)
         {
             Quaternion delta = newRotation * stateTrack.bone_->initialRotation_.Inverse();
-            newRotation = (delta * node->GetRotation()).Normalized();
-            if (!Equals(weight, 1.0f))
-                newRotation = node->GetRotation().Slerp(newRotation, weight);
+            Quaternion added = (delta * rotation).Normalized();
+            rotation = Equals(weight, 1.0f) ? added : rotation.Slerp(added, weight);
         }
         if (channelMask & CHANNEL_SCALE)
         {
             Vector3 delta = newScale - stateTrack.bone_->initialScale_;
-            newScale = node->GetScale() + delta * weight;
+            scale += delta * weight;
         }
     }
     else
@@ -556,31 +824,21 @@ void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, b
         if (!Equals(weight, 1.0f)) // not full weight
         {
             if (channelMask & CHANNEL_POSITION)
-                newPosition = node->GetPosition().Lerp(newPosition, weight);
+                position = position.Lerp(newPosition, weight);
             if (channelMask & CHANNEL_ROTATION)
-                newRotation = node->GetRotation().Slerp(newRotation, weight);
+                rotation = rotation.Slerp(newRotation, weight);
             if (channelMask & CHANNEL_SCALE)
-                newScale = node->GetScale().Lerp(newScale, weight);
+                scale = scale.Lerp(newScale, weight);
+        }
+        else
+        {
+            if (channelMask & CHANNEL_POSITION)
+                position = newPosition;
+            if (channelMask & CHANNEL_ROTATION)
+                rotation = newRotation;
+            if (channelMask & CHANNEL_SCALE)
+                scale = newScale;
         }
-    }
-
-    if (silent)
-    {
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPositionSilent(newPosition);
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotationSilent(newRotation);
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScaleSilent(newScale);
-    }
-    else
-    {
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPosition(newPosition);
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotation(newRotation);
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScale(newScale);
     }
 }
 
@@ -26,6 +26,7 @@
 
 #include "../Container/HashMap.h"
 #include "../Container/Ptr.h"
+#include "../Math/Quaternion.h"
 
 namespace Urho3D
 {
@@ -35,6 +36,7 @@ class AnimatedModel;
 class Deserializer;
 class Serializer;
 class Skeleton;
+struct AnimationKeyFrame;
 struct AnimationTrack;
 struct Bone;
 
@@ -61,15 +63,27 @@ struct AnimationStateTrack
     Bone* bone_;
     /// Scene node pointer.
     WeakPtr<Node> node_;
+    /// Bone index in the model's skeleton.
+    unsigned boneIndex_;
     /// Blending weight.
     float weight_;
     /// Last key frame.
     unsigned keyFrame_;
+    /// Sampled position.
+    Vector3 position_;
+    /// Sampled rotation.
+    Quaternion rotation_;
+    /// Sampled scale.
+    Vector3 scale_;
+    /// Whether the track has been sampled, false if it has no keyframes.
+    bool sampled_;
 };
 
 /// %Animation instance.
 class URHO3D_API AnimationState : public RefCounted
 {
+    friend class AnimatedModel;
+
 public:
     /// Construct with animated model and animation pointers.
     AnimationState(AnimatedModel* model, Animation* animation);
@@ -166,12 +180,23 @@ public:
     void Apply();
 
 private:
-    /// Apply animation to a skeleton. Transform changes are applied silently, so the model needs to dirty its root model afterward.
-    void ApplyToModel();
+    /// Apply animation to a skeleton at the given time position and weight. Transform changes are applied silently, so the model needs to dirty its root model afterward.
+    void ApplyToModel(float time, float weight);
     /// Apply animation to a scene node hierarchy.
     void ApplyToNodes();
-    /// Apply track.
+    /// Sample a range of tracks at a time position. Different ranges may be sampled from different threads.
+    void SampleTracks(float time, unsigned begin, unsigned end);
+    /// Blend the sampled tracks into the skeleton of the model.
+    void ApplySamples(float weight);
+    /// Apply the sampled transform of a track to its scene node.
     void ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent);
+    /// Find the keyframes to interpolate between and the interpolation factor. Keyframes of a compressed track are decompressed into the two element storage. Return false if the track has no keyframes.
+    bool FindKeyFrames(AnimationStateTrack& stateTrack, float time, AnimationKeyFrame* storage, const AnimationKeyFrame*& keyFrame,
+        const AnimationKeyFrame*& nextKeyFrame, float& t) const;
+    /// Sample a track at a time position.
+    void SampleTrack(AnimationStateTrack& stateTrack, float time) const;
+    /// Blend the sampled transform of a track into the current transform of a bone.
+    void BlendTrack(const AnimationStateTrack& stateTrack, float weight, Vector3& position, Quaternion& rotation, Vector3& scale) const;
 
     /// Animated model (model mode).
     WeakPtr<AnimatedModel> model_;
@@ -193,6 +218,8 @@ private:
     unsigned char layer_;
     /// Blending mode.
     AnimationBlendMode blendingMode_;
+    /// Whether the tracks have been sampled at the current time position in advance, by AnimatedModel::ApplyAnimations().
+    bool samplesReady_;
 };
 
 }
@@ -40,44 +40,35 @@
 namespace Urho3D
 {
 
-inline bool CompareBatchesState(Batch* lhs, Batch* rhs)
+/// Return an unsigned integer that sorts in the same order as a float.
+inline unsigned FloatToSortKey(float value)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->sortKey_ != rhs->sortKey_)
-        return lhs->sortKey_ < rhs->sortKey_;
-    else
-        return lhs->distance_ < rhs->distance_;
+    unsigned bits;
+    memcpy(&bits, &value, sizeof bits);
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
 }
 
-inline bool CompareBatchesFrontToBack(Batch* lhs, Batch* rhs)
+/// Sort batches or batch groups by the 64-bit keys a function returns, using radix sort. Batches with equal keys keep their order.
+template <class T, class U> void SortBatchesByKey(PODVector<T*>& batches, U keyFunction, FrameArena* arena)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ < rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
-}
+    unsigned count = batches.Size();
+    if (count < 2)
+        return;
 
-inline bool CompareBatchesBackToFront(Batch* lhs, Batch* rhs)
-{
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ > rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
-}
+    FrameVector<unsigned long long> keys(arena);
+    FrameVector<unsigned long long> tempKeys(arena);
+    FrameVector<T*> tempBatches(arena);
+    keys.Resize(count);
+    if (count >= RADIXSORT_THRESHOLD)
+    {
+        tempKeys.Resize(count);
+        tempBatches.Resize(count);
+    }
 
-inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceData& rhs)
-{
-    return lhs.distance_ < rhs.distance_;
-}
+    for (unsigned i = 0; i < count; ++i)
+        keys[i] = keyFunction(batches[i]);
 
-inline bool CompareBatchGroupOrder(BatchGroup* lhs, BatchGroup* rhs)
-{
-    return lhs->renderOrder_ < rhs->renderOrder_;
+    RadixSort(keys.Buffer(), &batches[0], tempKeys.Buffer(), tempBatches.Buffer(), count);
 }
 
 void CalculateShadowMatrix(Matrix4& dest, LightBatchQueue* queue, unsigned split, Renderer* renderer)
@@ -725,46 +716,69 @@ void BatchQueue::Clear(int maxSortedInstances)
     maxSortedInstances_ = (unsigned)maxSortedInstances;
 }
 
-void BatchQueue::SortBackToFront()
+void BatchQueue::SortBackToFront(FrameArena* arena)
 {
     sortedBatches_.Resize(batches_.Size());
 
     for (unsigned i = 0; i < batches_.Size(); ++i)
         sortedBatches_[i] = &batches_[i];
 
-    Sort(sortedBatches_.Begin(), sortedBatches_.End(), CompareBatchesBackToFront);
+    // Sort by render order, then by decreasing distance, then by state. The radix sort is stable, so sort by state first
+    // and then by render order and distance at full precision
+    SortBatchesByKey(sortedBatches_, [](const Batch* batch) { return batch->sortKey_; }, arena);
+    SortBatchesByKey(sortedBatches_, [](const Batch* batch)
+    {
+        return ((unsigned long long)batch->renderOrder_ << 32u) | ~FloatToSortKey(batch->distance_);
+    }, arena);
 
     sortedBatchGroups_.Resize(batchGroups_.Size());
 
     unsigned index = 0;
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
         sortedBatchGroups_[index++] = &i->second_;
 
-    Sort(sortedBatchGroups_.Begin(), sortedBatchGroups_.End(), CompareBatchGroupOrder);
+    SortBatchesByKey(sortedBatchGroups_, [](const BatchGroup* group) { return (unsigned long long)group->renderOrder_; }, arena);
 }
 
-void BatchQueue::SortFrontToBack()
+void BatchQueue::SortFrontToBack(FrameArena* arena)
 {
     sortedBatches_.Clear();
 
     for (unsigned i = 0; i < batches_.Size(); ++i)
         sortedBatches_.Push(&batches_[i]);
 
-    SortFrontToBack2Pass(sortedBatches_);
+    SortFrontToBack2Pass(sortedBatches_, arena);
+
+    // Sort each group front to back. The temporary buffers are shared by the groups
+    FrameVector<unsigned long long> keys(arena);
+    FrameVector<unsigned long long> tempKeys(arena);
+    FrameVector<InstanceData> tempInstances(arena);
 
-    // Sort each group front to back
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
     {
-        if (i->second_.instances_.Size() <= maxSortedInstances_)
+        FrameVector<InstanceData>& instances = i->second_.instances_;
+        unsigned count = instances.Size();
+        if (count <= maxSortedInstances_)
         {
-            Sort(i->second_.instances_.Begin(), i->second_.instances_.End(), CompareInstancesFrontToBack);
-            if (i->second_.instances_.Size())
-                i->second_.distance_ = i->second_.instances_[0].distance_;
+            if (count > 1)
+            {
+                keys.Resize(count);
+                for (unsigned j = 0; j < count; ++j)
+                    keys[j] = FloatToSortKey(instances[j].distance_);
+                if (count >= RADIXSORT_THRESHOLD)
+                {
+                    tempKeys.Resize(count);
+                    tempInstances.Resize(count);
+                }
+                RadixSort(keys.Buffer(), instances.Buffer(), tempKeys.Buffer(), tempInstances.Buffer(), count);
+            }
+            if (count)
+                i->second_.distance_ = instances[0].distance_;
         }
         else
         {
             float minDistance = M_INFINITY;
-            for (PODVector<InstanceData>::ConstIterator j = i->second_.instances_.Begin(); j != i->second_.instances_.End(); ++j)
+            for (FrameVector<InstanceData>::ConstIterator j = i->second_.instances_.Begin(); j != i->second_.instances_.End(); ++j)
                 minDistance = Min(minDistance, j->distance_);
             i->second_.distance_ = minDistance;
         }
@@ -773,21 +787,29 @@ void BatchQueue::SortFrontToBack()
     sortedBatchGroups_.Resize(batchGroups_.Size());
 
     unsigned index = 0;
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
         sortedBatchGroups_[index++] = &i->second_;
 
-    SortFrontToBack2Pass(reinterpret_cast<PODVector<Batch*>& >(sortedBatchGroups_));
+    SortFrontToBack2Pass(reinterpret_cast<PODVector<Batch*>& >(sortedBatchGroups_), arena);
 }
 
-void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
+void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches, FrameArena* arena)
 {
     // Mobile devices likely use a tiled deferred approach, with which front-to-back sorting is irrelevant. The 2-pass
-    // method is also time consuming, so just sort with state having priority
+    // method is also time consuming, so just sort with state having priority and distance breaking ties. The radix sort is
+    // stable, so sort by distance first, then by state and then by render order
 #ifdef GL_ES_VERSION_2_0
-    Sort(batches.Begin(), batches.End(), CompareBatchesState);
+    SortBatchesByKey(batches, [](const Batch* batch) { return (unsigned long long)FloatToSortKey(batch->distance_); }, arena);
+    SortBatchesByKey(batches, [](const Batch* batch) { return batch->sortKey_; }, arena);
+    SortBatchesByKey(batches, [](const Batch* batch) { return (unsigned long long)batch->renderOrder_; }, arena);
 #else
-    // For desktop, first sort by distance and remap shader/material/geometry IDs in the sort key
-    Sort(batches.Begin(), batches.End(), CompareBatchesFrontToBack);
+    // For desktop, first sort by render order and distance at full precision, with state breaking ties, and remap
+    // shader/material/geometry IDs in the sort key
+    SortBatchesByKey(batches, [](const Batch* batch) { return batch->sortKey_; }, arena);
+    SortBatchesByKey(batches, [](const Batch* batch)
+    {
+        return ((unsigned long long)batch->renderOrder_ << 32u) | FloatToSortKey(batch->distance_);
+    }, arena);
 
     unsigned freeShaderID = 0;
     unsigned short freeMaterialID = 0;
@@ -798,7 +820,7 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
         Batch* batch = *i;
 
         auto shaderID = (unsigned)(batch->sortKey_ >> 32u);
-        HashMap<unsigned, unsigned>::ConstIterator j = shaderRemapping_.Find(shaderID);
+        FlatHashMap<unsigned, unsigned>::ConstIterator j = shaderRemapping_.Find(shaderID);
         if (j != shaderRemapping_.End())
             shaderID = j->second_;
         else
@@ -808,7 +830,7 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
         }
 
         auto materialID = (unsigned short)((batch->sortKey_ & 0xffff0000) >> 16u);
-        HashMap<unsigned short, unsigned short>::ConstIterator k = materialRemapping_.Find(materialID);
+        FlatHashMap<unsigned short, unsigned short>::ConstIterator k = materialRemapping_.Find(materialID);
         if (k != materialRemapping_.End())
             materialID = k->second_;
         else
@@ -818,7 +840,7 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
         }
 
         auto geometryID = (unsigned short)(batch->sortKey_ & 0xffffu);
-        HashMap<unsigned short, unsigned short>::ConstIterator l = geometryRemapping_.Find(geometryID);
+        FlatHashMap<unsigned short, unsigned short>::ConstIterator l = geometryRemapping_.Find(geometryID);
         if (l != geometryRemapping_.End())
             geometryID = l->second_;
         else
@@ -834,14 +856,20 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches)
     materialRemapping_.Clear();
     geometryRemapping_.Clear();
 
-    // Finally sort again with the rewritten ID's
-    Sort(batches.Begin(), batches.End(), CompareBatchesState);
+    // Finally sort again by render order and the rewritten IDs. The IDs are small enough to pack with the render order into the
+    // key, keeping the non-base flag of the shader ID. Batches with the same state stay sorted by distance
+    SortBatchesByKey(batches, [](const Batch* batch)
+    {
+        auto shaderID = (unsigned)(batch->sortKey_ >> 32u);
+        return ((unsigned long long)batch->renderOrder_ << 56u) | ((unsigned long long)(shaderID >> 31u) << 55u) |
+            ((unsigned long long)(shaderID & 0x7fffffu) << 32u) | (batch->sortKey_ & 0xffffffffu);
+    }, arena);
 #endif
 }
 
 void BatchQueue::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
 {
-    for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
         i->second_.SetInstancingData(lockedData, stride, freeIndex);
 }
 
@@ -892,7 +920,7 @@ unsigned BatchQueue::GetNumInstances() const
 {
     unsigned total = 0;
 
-    for (HashMap<BatchGroupKey, BatchGroup>::ConstIterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
+    for (FlatHashMap<BatchGroupKey, BatchGroup>::ConstIterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
     {
         if (i->second_.geometryType_ == GEOM_INSTANCED)
             total += i->second_.instances_.Size();
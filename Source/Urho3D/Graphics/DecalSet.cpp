@@ -59,6 +59,40 @@ static const unsigned DEFAULT_MAX_INDICES = 1024;
 static const VertexMaskFlags STATIC_ELEMENT_MASK = MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT;
 static const VertexMaskFlags SKINNED_ELEMENT_MASK = MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT |
     MASK_BLENDWEIGHTS | MASK_BLENDINDICES;
+static const unsigned DECODED_SKINNING_SIZE = 4 * sizeof(float) + 4;
+
+/// Decode the 16-bit normalized normals of a compact vertex format.
+static void DecodeNormals(PODVector<Vector3>& dest, VertexBuffer* vb)
+{
+    const unsigned char* src = vb->GetShadowData() + vb->GetElementOffset(SEM_NORMAL);
+    const unsigned vertexSize = vb->GetVertexSize();
+
+    dest.Resize(vb->GetVertexCount());
+    for (unsigned i = 0; i < dest.Size(); ++i, src += vertexSize)
+    {
+        const auto* normal = reinterpret_cast<const short*>(src);
+        dest[i] = Vector3(Max(normal[0] / 32767.0f, -1.0f), Max(normal[1] / 32767.0f, -1.0f), Max(normal[2] / 32767.0f, -1.0f));
+    }
+}
+
+/// Decode the 8-bit normalized blend weights of a compact vertex format into float weights followed by the blend indices.
+static void DecodeSkinning(PODVector<unsigned char>& dest, VertexBuffer* vb)
+{
+    const unsigned char* src = vb->GetShadowData();
+    const unsigned weightOffset = vb->GetElementOffset(SEM_BLENDWEIGHTS);
+    const unsigned indexOffset = vb->GetElementOffset(SEM_BLENDINDICES);
+    const unsigned vertexSize = vb->GetVertexSize();
+
+    dest.Resize(vb->GetVertexCount() * DECODED_SKINNING_SIZE);
+    for (unsigned i = 0; i < vb->GetVertexCount(); ++i, src += vertexSize)
+    {
+        unsigned char* skinning = &dest[i * DECODED_SKINNING_SIZE];
+        auto* weights = reinterpret_cast<float*>(skinning);
+        for (unsigned j = 0; j < 4; ++j)
+            weights[j] = src[weightOffset + j] / 255.0f;
+        memcpy(skinning + 4 * sizeof(float), src + indexOffset, 4);
+    }
+}
 
 static DecalVertex ClipEdge(const DecalVertex& v0, const DecalVertex& v1, float d0, float d1, bool skinned)
 {
@@ -710,6 +744,8 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
     unsigned normalStride = 0;
     unsigned skinningStride = 0;
     unsigned indexStride = 0;
+    PODVector<Vector3> decodedNormals;
+    PODVector<unsigned char> decodedSkinning;
 
     IndexBuffer* ib = geometry->GetIndexBuffer();
     if (ib)
@@ -740,11 +776,23 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
             normalData = data + vb->GetElementOffset(SEM_NORMAL);
             normalStride = vb->GetVertexSize();
         }
+        else if (vb->HasElement(TYPE_SHORT4_NORM, SEM_NORMAL))
+        {
+            DecodeNormals(decodedNormals, vb);
+            normalData = reinterpret_cast<const unsigned char*>(decodedNormals.Buffer());
+            normalStride = sizeof(Vector3);
+        }
         if (elementMask & MASK_BLENDWEIGHTS)
         {
             skinningData = data + vb->GetElementOffset(SEM_BLENDWEIGHTS);
             skinningStride = vb->GetVertexSize();
         }
+        else if (vb->HasElement(TYPE_UBYTE4_NORM, SEM_BLENDWEIGHTS) && vb->HasElement(TYPE_UBYTE4, SEM_BLENDINDICES))
+        {
+            DecodeSkinning(decodedSkinning, vb);
+            skinningData = decodedSkinning.Buffer();
+            skinningStride = DECODED_SKINNING_SIZE;
+        }
     }
 
     // Positions and indices are needed
@@ -2267,6 +2267,7 @@ void Graphics::CheckFeatureSupport()
     dummyColorFormat_ = DXGI_FORMAT_UNKNOWN;
     sRGBSupport_ = true;
     sRGBWriteSupport_ = true;
+    halfFloatVertexSupport_ = true;
 }
 
 void Graphics::ResetCachedState()
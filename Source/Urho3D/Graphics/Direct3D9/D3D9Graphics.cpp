@@ -2387,6 +2387,7 @@ void Graphics::CheckFeatureSupport()
     deferredSupport_ = false;
     hardwareShadowSupport_ = false;
     instancingSupport_ = false;
+    halfFloatVertexSupport_ = false;
     readableDepthFormat = 0;
 
     // Check hardware shadow map support: prefer NVIDIA style hardware depth compared shadow maps if available
@@ -2457,6 +2458,10 @@ void Graphics::CheckFeatureSupport()
     if (impl_->deviceCaps_.DevCaps2 & D3DDEVCAPS2_STREAMOFFSET)
         instancingSupport_ = true;
 
+    // Check for half float vertex declaration type
+    if (impl_->deviceCaps_.DeclTypes & D3DDTCAPS_FLOAT16_2)
+        halfFloatVertexSupport_ = true;
+
     // Check for sRGB read & write
     /// \todo Should be checked for each texture format separately
     sRGBSupport_ = impl_->CheckFormatSupport(D3DFMT_X8R8G8B8, D3DUSAGE_QUERY_SRGBREAD, D3DRTYPE_TEXTURE);
@@ -67,6 +67,8 @@ Drawable::Drawable(Context* context, unsigned char drawableFlags) :
     updateQueued_(false),
     zoneDirty_(false),
     octant_(nullptr),
+    octantIndex_(0),
+    spatialIndexProxy_(M_MAX_UNSIGNED),
     zone_(nullptr),
     viewMask_(DEFAULT_VIEWMASK),
     lightMask_(DEFAULT_LIGHTMASK),
@@ -190,6 +192,9 @@ void Drawable::SetLodBias(float bias)
 
 void Drawable::SetViewMask(unsigned mask)
 {
+    // Octree queries filter by the view mask, so any cached results within the drawable's bounds may change
+    if (mask != viewMask_ && octant_)
+        octant_->GetRoot()->RecordChange(worldBoundingBox_);
     viewMask_ = mask;
     MarkNetworkUpdate();
 }
@@ -256,6 +261,9 @@ const BoundingBox& Drawable::GetWorldBoundingBox()
     {
         OnWorldBoundingBoxUpdate();
         worldBoundingBoxDirty_ = false;
+        // Keep the octant's copy used for batched culling in sync
+        if (octant_)
+            octant_->OnDrawableBoxUpdate(this);
     }
 
     return worldBoundingBox_;
@@ -393,7 +401,10 @@ void Drawable::AddToOctree()
     {
         auto* octree = scene->GetComponent<Octree>();
         if (octree)
+        {
             octree->InsertDrawable(this);
+            octree->RecordChange(GetWorldBoundingBox());
+        }
         else
             URHO3D_LOGERROR("No Octree component in scene, drawable will not render");
     }
@@ -415,6 +426,7 @@ void Drawable::RemoveFromOctree()
         // Perform subclass specific deinitialization if necessary
         OnRemoveFromOctree();
 
+        octree->RecordChange(worldBoundingBox_);
         octant_->RemoveDrawable(this);
     }
 }
@@ -113,6 +113,7 @@ class URHO3D_API Drawable : public Component
 
     friend class Octant;
     friend class Octree;
+    friend class SpatialIndex;
     friend void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex);
 
 public:
@@ -374,6 +375,10 @@ protected:
     bool zoneDirty_;
     /// Octree octant.
     Octant* octant_;
+    /// Index in the octant's drawable and bounding box arrays.
+    unsigned octantIndex_;
+    /// Proxy in the octree's alternative spatial index, if one is used.
+    unsigned spatialIndexProxy_;
     /// Current zone.
     Zone* zone_;
     /// View mask.
@@ -0,0 +1,546 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Graphics/DebugRenderer.h"
+#include "../Graphics/DynamicAABBTree.h"
+#include "../Graphics/OctreeQuery.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Proxy flag of drawables kept in the list of drawables that are not occludees. The rest of the proxy is the list index.
+static const unsigned UNCULLED_PROXY_FLAG = 0x80000000;
+
+/// Traversal stack capacity that needs no heap allocation. The tree is kept balanced, so it is rarely deeper than this.
+static const unsigned AABB_TREE_INLINE_STACK = 64;
+
+/// Tree traversal stack in a fixed-size array, which falls back to the heap when the tree is deeper than the array.
+template <class T> class TraversalStack
+{
+public:
+    /// Construct with the maximum number of entries.
+    explicit TraversalStack(unsigned capacity) :
+        data_(inline_)
+    {
+        if (capacity > AABB_TREE_INLINE_STACK)
+        {
+            heap_.Resize(capacity);
+            data_ = &heap_[0];
+        }
+    }
+
+    /// Push an entry.
+    void Push(const T& value) { data_[size_++] = value; }
+    /// Pop and return the last entry.
+    T Pop() { return data_[--size_]; }
+    /// Return whether is empty.
+    bool Empty() const { return !size_; }
+
+private:
+    /// Fixed-size storage.
+    T inline_[AABB_TREE_INLINE_STACK];
+    /// Heap storage for deep trees.
+    PODVector<T> heap_;
+    /// Storage in use.
+    T* data_;
+    /// Number of entries.
+    unsigned size_{};
+};
+
+/// Return the surface area of a bounding box, halved as only comparisons matter.
+static inline float SurfaceArea(const BoundingBox& box)
+{
+    Vector3 size = box.max_ - box.min_;
+    return size.x_ * size.y_ + size.y_ * size.z_ + size.z_ * size.x_;
+}
+
+/// Return the union of two bounding boxes.
+static inline BoundingBox MergeBoxes(const BoundingBox& lhs, const BoundingBox& rhs)
+{
+    return BoundingBox(VectorMin(lhs.min_, rhs.min_), VectorMax(lhs.max_, rhs.max_));
+}
+
+/// Return the enlarged leaf bounding box of a drawable.
+static inline BoundingBox GetLeafBox(Drawable* drawable, float margin)
+{
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    Vector3 extension(margin, margin, margin);
+    if (box.Defined())
+        return BoundingBox(box.min_ - extension, box.max_ + extension);
+    else
+        return BoundingBox(-extension, extension);
+}
+
+DynamicAABBTree::DynamicAABBTree() :
+    root_(NO_PROXY),
+    freeList_(NO_PROXY),
+    numLeaves_(0),
+    margin_(DEFAULT_AABB_TREE_MARGIN)
+{
+}
+
+DynamicAABBTree::~DynamicAABBTree()
+{
+    Clear();
+}
+
+void DynamicAABBTree::AddDrawable(Drawable* drawable)
+{
+    if (GetProxy(drawable) != NO_PROXY)
+        return;
+
+    if (!drawable->IsOccludee())
+    {
+        SetProxy(drawable, unculledDrawables_.Size() | UNCULLED_PROXY_FLAG);
+        unculledDrawables_.Push(drawable);
+        return;
+    }
+
+    unsigned leaf = AllocateNode();
+    AABBTreeNode& node = nodes_[leaf];
+    node.box_ = GetLeafBox(drawable, margin_);
+    node.drawable_ = drawable;
+    node.height_ = 0;
+    InsertLeaf(leaf);
+    SetProxy(drawable, leaf);
+    ++numLeaves_;
+}
+
+void DynamicAABBTree::RemoveDrawable(Drawable* drawable)
+{
+    unsigned proxy = GetProxy(drawable);
+    if (proxy == NO_PROXY)
+        return;
+
+    if (proxy & UNCULLED_PROXY_FLAG)
+    {
+        unsigned index = proxy & ~UNCULLED_PROXY_FLAG;
+        assert(unculledDrawables_[index] == drawable);
+        Drawable* last = unculledDrawables_.Back();
+        unculledDrawables_[index] = last;
+        SetProxy(last, index | UNCULLED_PROXY_FLAG);
+        unculledDrawables_.Pop();
+    }
+    else
+    {
+        assert(nodes_[proxy].drawable_ == drawable);
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        --numLeaves_;
+    }
+
+    SetProxy(drawable, NO_PROXY);
+}
+
+void DynamicAABBTree::UpdateDrawable(Drawable* drawable)
+{
+    unsigned proxy = GetProxy(drawable);
+    if (proxy == NO_PROXY)
+    {
+        AddDrawable(drawable);
+        return;
+    }
+
+    // Move between the tree and the unculled list if the occludee flag has changed
+    bool unculled = (proxy & UNCULLED_PROXY_FLAG) != 0;
+    if (unculled == drawable->IsOccludee())
+    {
+        RemoveDrawable(drawable);
+        AddDrawable(drawable);
+        return;
+    }
+    if (unculled)
+        return;
+
+    // Reinsert only if the drawable has moved outside its enlarged box
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    if (box.Defined() && nodes_[proxy].box_.IsInside(box) == INSIDE)
+        return;
+
+    // If the parent still contains the new box, refit the ancestors in place. Otherwise find a new place by reinserting
+    BoundingBox leafBox = GetLeafBox(drawable, margin_);
+    unsigned parent = nodes_[proxy].parent_;
+    if (parent != NO_PROXY && nodes_[parent].box_.IsInside(leafBox) == INSIDE)
+    {
+        nodes_[proxy].box_ = leafBox;
+        Refit(parent);
+        return;
+    }
+
+    RemoveLeaf(proxy);
+    nodes_[proxy].box_ = leafBox;
+    InsertLeaf(proxy);
+}
+
+void DynamicAABBTree::Clear()
+{
+    for (PODVector<AABBTreeNode>::ConstIterator i = nodes_.Begin(); i != nodes_.End(); ++i)
+    {
+        if (i->height_ == 0)
+            SetProxy(i->drawable_, NO_PROXY);
+    }
+    for (PODVector<Drawable*>::ConstIterator i = unculledDrawables_.Begin(); i != unculledDrawables_.End(); ++i)
+        SetProxy(*i, NO_PROXY);
+
+    nodes_.Clear();
+    unculledDrawables_.Clear();
+    root_ = NO_PROXY;
+    freeList_ = NO_PROXY;
+    numLeaves_ = 0;
+}
+
+void DynamicAABBTree::GetDrawables(OctreeQuery& query) const
+{
+    if (!unculledDrawables_.Empty())
+    {
+        auto** start = const_cast<Drawable**>(&unculledDrawables_[0]);
+        query.TestDrawables(start, start + unculledDrawables_.Size(), false);
+    }
+
+    if (root_ == NO_PROXY)
+        return;
+
+    // Test the internal nodes like octants. Collect the leaves' drawables and test them in two batches, depending on whether
+    // their parent was fully inside. Visiting one child while the other waits needs at most the tree height plus one entries
+    TraversalStack<Pair<unsigned, bool> > stack((unsigned)nodes_[root_].height_ + 1);
+    PODVector<Drawable*> drawables[2];
+    stack.Push(MakePair(root_, false));
+
+    while (!stack.Empty())
+    {
+        Pair<unsigned, bool> entry = stack.Pop();
+
+        const AABBTreeNode& node = nodes_[entry.first_];
+        if (node.IsLeaf())
+        {
+            drawables[entry.second_ ? 1 : 0].Push(node.drawable_);
+            continue;
+        }
+
+        Intersection res = query.TestOctant(node.box_, entry.second_);
+        if (res == OUTSIDE)
+            continue;
+
+        bool inside = res == INSIDE;
+        stack.Push(MakePair(node.children_[0], inside));
+        stack.Push(MakePair(node.children_[1], inside));
+    }
+
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        if (!drawables[i].Empty())
+            query.TestDrawables(drawables[i].Begin().ptr_, drawables[i].End().ptr_, i == 1);
+    }
+}
+
+void DynamicAABBTree::Raycast(RayOctreeQuery& query) const
+{
+    PODVector<Drawable*> drawables;
+    GetRaycastDrawables(query, drawables);
+
+    for (PODVector<Drawable*>::ConstIterator i = drawables.Begin(); i != drawables.End(); ++i)
+        (*i)->ProcessRayQuery(query, query.result_);
+}
+
+void DynamicAABBTree::GetRaycastDrawables(RayOctreeQuery& query, PODVector<Drawable*>& drawables) const
+{
+    for (PODVector<Drawable*>::ConstIterator i = unculledDrawables_.Begin(); i != unculledDrawables_.End(); ++i)
+    {
+        Drawable* drawable = *i;
+        if ((drawable->GetDrawableFlags() & query.drawableFlags_) && (drawable->GetViewMask() & query.viewMask_))
+            drawables.Push(drawable);
+    }
+
+    if (root_ == NO_PROXY)
+        return;
+
+    TraversalStack<unsigned> stack((unsigned)nodes_[root_].height_ + 1);
+    stack.Push(root_);
+
+    while (!stack.Empty())
+    {
+        const AABBTreeNode& node = nodes_[stack.Pop()];
+
+        if (query.ray_.HitDistance(node.box_) >= query.maxDistance_)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            Drawable* drawable = node.drawable_;
+            if ((drawable->GetDrawableFlags() & query.drawableFlags_) && (drawable->GetViewMask() & query.viewMask_))
+                drawables.Push(drawable);
+        }
+        else
+        {
+            stack.Push(node.children_[0]);
+            stack.Push(node.children_[1]);
+        }
+    }
+}
+
+void DynamicAABBTree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest) const
+{
+    if (!debug)
+        return;
+
+    for (PODVector<AABBTreeNode>::ConstIterator i = nodes_.Begin(); i != nodes_.End(); ++i)
+    {
+        if (i->height_ > 0 && debug->IsInside(i->box_))
+            debug->AddBoundingBox(i->box_, Color(0.25f, 0.25f, 0.25f), depthTest);
+    }
+}
+
+void DynamicAABBTree::SetMargin(float margin)
+{
+    margin_ = Max(margin, 0.0f);
+}
+
+float DynamicAABBTree::GetAreaRatio() const
+{
+    if (root_ == NO_PROXY)
+        return 0.0f;
+
+    float rootArea = SurfaceArea(nodes_[root_].box_);
+    if (rootArea <= 0.0f)
+        return 0.0f;
+
+    float totalArea = 0.0f;
+    for (PODVector<AABBTreeNode>::ConstIterator i = nodes_.Begin(); i != nodes_.End(); ++i)
+    {
+        if (i->height_ > 0)
+            totalArea += SurfaceArea(i->box_);
+    }
+
+    return totalArea / rootArea;
+}
+
+unsigned DynamicAABBTree::AllocateNode()
+{
+    if (freeList_ == NO_PROXY)
+    {
+        // Grow the node array and chain the new nodes to the free list
+        unsigned oldSize = nodes_.Size();
+        unsigned newSize = Max(oldSize * 2, 16U);
+        nodes_.Resize(newSize);
+        for (unsigned i = oldSize; i < newSize; ++i)
+        {
+            nodes_[i].parent_ = i + 1 < newSize ? i + 1 : NO_PROXY;
+            nodes_[i].height_ = -1;
+            nodes_[i].drawable_ = nullptr;
+        }
+        freeList_ = oldSize;
+    }
+
+    unsigned index = freeList_;
+    AABBTreeNode& node = nodes_[index];
+    freeList_ = node.parent_;
+    node.parent_ = NO_PROXY;
+    node.children_[0] = node.children_[1] = NO_PROXY;
+    node.drawable_ = nullptr;
+    node.height_ = 0;
+    return index;
+}
+
+void DynamicAABBTree::FreeNode(unsigned index)
+{
+    AABBTreeNode& node = nodes_[index];
+    node.parent_ = freeList_;
+    node.height_ = -1;
+    node.drawable_ = nullptr;
+    freeList_ = index;
+}
+
+void DynamicAABBTree::InsertLeaf(unsigned leaf)
+{
+    if (root_ == NO_PROXY)
+    {
+        root_ = leaf;
+        nodes_[leaf].parent_ = NO_PROXY;
+        return;
+    }
+
+    // Descend to the best sibling by the surface area heuristic. The cost of pairing with a node is the area of the new
+    // parent, plus the area increase the leaf causes to all the ancestors on the way
+    BoundingBox leafBox = nodes_[leaf].box_;
+    unsigned index = root_;
+    while (!nodes_[index].IsLeaf())
+    {
+        const AABBTreeNode& node = nodes_[index];
+        float area = SurfaceArea(node.box_);
+        float combinedArea = SurfaceArea(MergeBoxes(node.box_, leafBox));
+
+        // Cost of creating a new parent for this node and the leaf, and the minimum cost of pushing the leaf further down
+        float cost = 2.0f * combinedArea;
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCosts[2];
+        for (unsigned i = 0; i < 2; ++i)
+        {
+            const AABBTreeNode& child = nodes_[node.children_[i]];
+            float childArea = SurfaceArea(MergeBoxes(child.box_, leafBox));
+            if (!child.IsLeaf())
+                childArea -= SurfaceArea(child.box_);
+            childCosts[i] = childArea + inheritanceCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+            break;
+
+        index = childCosts[0] < childCosts[1] ? node.children_[0] : node.children_[1];
+    }
+
+    // Create a new parent for the sibling and the leaf
+    unsigned sibling = index;
+    unsigned oldParent = nodes_[sibling].parent_;
+    unsigned newParent = AllocateNode();
+    AABBTreeNode& parentNode = nodes_[newParent];
+    parentNode.parent_ = oldParent;
+    parentNode.box_ = MergeBoxes(leafBox, nodes_[sibling].box_);
+    parentNode.height_ = nodes_[sibling].height_ + 1;
+    parentNode.children_[0] = sibling;
+    parentNode.children_[1] = leaf;
+    nodes_[sibling].parent_ = newParent;
+    nodes_[leaf].parent_ = newParent;
+
+    if (oldParent != NO_PROXY)
+    {
+        AABBTreeNode& oldParentNode = nodes_[oldParent];
+        oldParentNode.children_[oldParentNode.children_[0] == sibling ? 0 : 1] = newParent;
+    }
+    else
+        root_ = newParent;
+
+    Refit(nodes_[leaf].parent_);
+}
+
+void DynamicAABBTree::RemoveLeaf(unsigned leaf)
+{
+    if (leaf == root_)
+    {
+        root_ = NO_PROXY;
+        return;
+    }
+
+    // Replace the parent with the sibling
+    unsigned parent = nodes_[leaf].parent_;
+    unsigned grandParent = nodes_[parent].parent_;
+    unsigned sibling = nodes_[parent].children_[nodes_[parent].children_[0] == leaf ? 1 : 0];
+
+    if (grandParent != NO_PROXY)
+    {
+        AABBTreeNode& grandParentNode = nodes_[grandParent];
+        grandParentNode.children_[grandParentNode.children_[0] == parent ? 0 : 1] = sibling;
+        nodes_[sibling].parent_ = grandParent;
+        FreeNode(parent);
+        Refit(grandParent);
+    }
+    else
+    {
+        root_ = sibling;
+        nodes_[sibling].parent_ = NO_PROXY;
+        FreeNode(parent);
+    }
+
+    nodes_[leaf].parent_ = NO_PROXY;
+}
+
+void DynamicAABBTree::Refit(unsigned index)
+{
+    unsigned start = index;
+
+    while (index != NO_PROXY)
+    {
+        unsigned balanced = Balance(index);
+
+        AABBTreeNode& node = nodes_[balanced];
+        const AABBTreeNode& child0 = nodes_[node.children_[0]];
+        const AABBTreeNode& child1 = nodes_[node.children_[1]];
+        BoundingBox box = MergeBoxes(child0.box_, child1.box_);
+        int height = 1 + Max(child0.height_, child1.height_);
+
+        // If nothing changed, the ancestors need no refit either. The first node may have been set up by the caller already
+        if (index != start && balanced == index && box == node.box_ && height == node.height_)
+            break;
+
+        node.box_ = box;
+        node.height_ = height;
+        index = node.parent_;
+    }
+}
+
+unsigned DynamicAABBTree::Balance(unsigned indexA)
+{
+    AABBTreeNode& a = nodes_[indexA];
+    if (a.IsLeaf() || a.height_ < 2)
+        return indexA;
+
+    // Rotate the higher child up if the children's heights differ by more than one. Its higher child then replaces it as
+    // a child of A, and its lower child takes A's place under it
+    int balance = nodes_[a.children_[1]].height_ - nodes_[a.children_[0]].height_;
+    if (balance >= -1 && balance <= 1)
+        return indexA;
+
+    unsigned up = balance > 1 ? 1 : 0;
+    unsigned indexB = a.children_[1 - up];
+    unsigned indexC = a.children_[up];
+    AABBTreeNode& b = nodes_[indexB];
+    AABBTreeNode& c = nodes_[indexC];
+    unsigned indexF = c.children_[0];
+    unsigned indexG = c.children_[1];
+    AABBTreeNode& f = nodes_[indexF];
+    AABBTreeNode& g = nodes_[indexG];
+
+    // Swap A and C
+    c.children_[0] = indexA;
+    c.parent_ = a.parent_;
+    a.parent_ = indexC;
+
+    if (c.parent_ != NO_PROXY)
+    {
+        AABBTreeNode& parent = nodes_[c.parent_];
+        parent.children_[parent.children_[0] == indexA ? 0 : 1] = indexC;
+    }
+    else
+        root_ = indexC;
+
+    // Keep the higher grandchild under C and move the lower one under A, where C was
+    unsigned indexHigh = f.height_ > g.height_ ? indexF : indexG;
+    unsigned indexLow = f.height_ > g.height_ ? indexG : indexF;
+    AABBTreeNode& high = nodes_[indexHigh];
+    AABBTreeNode& low = nodes_[indexLow];
+
+    c.children_[1] = indexHigh;
+    a.children_[up] = indexLow;
+    low.parent_ = indexA;
+    a.box_ = MergeBoxes(b.box_, low.box_);
+    c.box_ = MergeBoxes(a.box_, high.box_);
+    a.height_ = 1 + Max(b.height_, low.height_);
+    c.height_ = 1 + Max(a.height_, high.height_);
+
+    return indexC;
+}
+
+}
@@ -0,0 +1,122 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Graphics/SpatialIndex.h"
+
+namespace Urho3D
+{
+
+static const float DEFAULT_AABB_TREE_MARGIN = 0.25f;
+
+/// Node of a dynamic AABB tree.
+struct AABBTreeNode
+{
+    /// Bounding box. For leaves this is the drawable's bounding box enlarged by the margin.
+    BoundingBox box_;
+    /// Drawable of a leaf, null for internal nodes.
+    Drawable* drawable_;
+    /// Parent node index, or the next free node index if the node is free.
+    unsigned parent_;
+    /// Child node indices. Leaves have none.
+    unsigned children_[2];
+    /// Height of the subtree. Leaves have height 0 and free nodes -1.
+    int height_;
+
+    /// Return whether is a leaf.
+    bool IsLeaf() const { return height_ == 0; }
+};
+
+/// Dynamic bounding volume hierarchy of drawables. New leaves are inserted next to the sibling that increases the surface area of the tree the least, and the boxes of their ancestors are refitted and rebalanced with tree rotations. Leaf boxes are enlarged by a margin, so that a drawable that moves only a little needs no update. Drawables that are not occludees are kept in a separate list and tested individually by queries, so that occlusion tests of the tree nodes can not hide them.
+/// @nobind
+class URHO3D_API DynamicAABBTree : public SpatialIndex
+{
+public:
+    /// Construct empty.
+    DynamicAABBTree();
+    /// Destruct.
+    ~DynamicAABBTree() override;
+
+    /// Add a drawable.
+    void AddDrawable(Drawable* drawable) override;
+    /// Remove a drawable.
+    void RemoveDrawable(Drawable* drawable) override;
+    /// Update a drawable after its world bounding box or occludee flag has changed. Reinserts it only if it has moved outside its enlarged box.
+    void UpdateDrawable(Drawable* drawable) override;
+    /// Remove all drawables.
+    void Clear() override;
+    /// Add the drawables that pass an octree query to its result.
+    void GetDrawables(OctreeQuery& query) const override;
+    /// Process a ray query on the drawables whose bounds the ray hits within the query's maximum distance.
+    void Raycast(RayOctreeQuery& query) const override;
+    /// Return the drawables that match a ray query's flags and whose bounds the ray hits, without processing them.
+    void GetRaycastDrawables(RayOctreeQuery& query, PODVector<Drawable*>& drawables) const override;
+    /// Draw the node bounding boxes to the debug graphics.
+    void DrawDebugGeometry(DebugRenderer* debug, bool depthTest) const override;
+
+    /// Set the distance by which leaf bounding boxes are enlarged. Only affects drawables inserted afterward.
+    void SetMargin(float margin);
+
+    /// Return the distance by which leaf bounding boxes are enlarged.
+    float GetMargin() const { return margin_; }
+
+    /// Return number of drawables, including those that are not occludees.
+    unsigned GetNumDrawables() const { return numLeaves_ + unculledDrawables_.Size(); }
+
+    /// Return height of the tree.
+    int GetHeight() const { return root_ != NO_PROXY ? nodes_[root_].height_ : 0; }
+
+    /// Return the summed surface area of the internal nodes relative to the root. Lower means a tighter tree and cheaper queries.
+    float GetAreaRatio() const;
+
+private:
+    /// Take a node from the free list, growing the node array if necessary.
+    unsigned AllocateNode();
+    /// Return a node to the free list.
+    void FreeNode(unsigned index);
+    /// Insert a leaf node into the tree.
+    void InsertLeaf(unsigned leaf);
+    /// Remove a leaf node from the tree. The node itself is not freed.
+    void RemoveLeaf(unsigned leaf);
+    /// Refit the boxes and heights from a node up to the root, rebalancing on the way.
+    void Refit(unsigned index);
+    /// Rotate a node's subtree if it is imbalanced and return the index of the node now at its place.
+    unsigned Balance(unsigned index);
+
+    /// Tree nodes, including free ones.
+    PODVector<AABBTreeNode> nodes_;
+    /// Drawables that are not occludees.
+    PODVector<Drawable*> unculledDrawables_;
+    /// Root node index.
+    unsigned root_;
+    /// First free node index.
+    unsigned freeList_;
+    /// Number of leaves.
+    unsigned numLeaves_;
+    /// Leaf box enlargement.
+    float margin_;
+};
+
+}
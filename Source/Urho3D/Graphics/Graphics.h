@@ -475,6 +475,10 @@ public:
     /// @property
     bool GetSRGBWriteSupport() const { return sRGBWriteSupport_; }
 
+    /// Return whether half float vertex elements (TYPE_HALF2) are supported. If not, models expand them to floats when loading.
+    /// @property
+    bool GetHalfFloatVertexSupport() const { return halfFloatVertexSupport_; }
+
     /// Return supported fullscreen resolutions (third component is refreshRate). Will be empty if listing the resolutions is not supported on the platform (e.g. Web).
     /// @property
     PODVector<IntVector3> GetResolutions(int monitor) const;
@@ -810,6 +814,8 @@ private:
     bool sRGBSupport_{};
     /// sRGB conversion on write support flag.
     bool sRGBWriteSupport_{};
+    /// Half float vertex element support flag.
+    bool halfFloatVertexSupport_{};
     /// Number of primitives this frame.
     unsigned numPrimitives_{};
     /// Number of batches this frame.
@@ -161,6 +161,8 @@ enum VertexElementType
     TYPE_VECTOR4,
     TYPE_UBYTE4,
     TYPE_UBYTE4_NORM,
+    TYPE_HALF2,
+    TYPE_SHORT4_NORM,
     MAX_VERTEX_ELEMENT_TYPES
 };
 
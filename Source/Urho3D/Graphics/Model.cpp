@@ -60,6 +60,57 @@ unsigned LookupIndexBuffer(IndexBuffer* buffer, const Vector<SharedPtr<IndexBuff
     return 0;
 }
 
+/// Return whether vertex elements include half floats.
+static bool HasHalfFloats(const PODVector<VertexElement>& elements)
+{
+    for (unsigned i = 0; i < elements.Size(); ++i)
+    {
+        if (elements[i].type_ == TYPE_HALF2)
+            return true;
+    }
+    return false;
+}
+
+/// Convert the half float elements of vertex data to floats, for hardware that does not support half float vertex elements.
+static SharedArrayPtr<unsigned char> ExpandHalfFloats(const unsigned char* src, unsigned vertexCount,
+    PODVector<VertexElement>& elements)
+{
+    PODVector<VertexElement> srcElements = elements;
+    VertexBuffer::UpdateOffsets(srcElements);
+    const unsigned srcVertexSize = VertexBuffer::GetVertexSize(srcElements);
+    for (unsigned i = 0; i < elements.Size(); ++i)
+    {
+        if (elements[i].type_ == TYPE_HALF2)
+            elements[i].type_ = TYPE_VECTOR2;
+    }
+    VertexBuffer::UpdateOffsets(elements);
+    const unsigned vertexSize = VertexBuffer::GetVertexSize(elements);
+
+    SharedArrayPtr<unsigned char> data(new unsigned char[vertexCount * vertexSize]);
+    unsigned char* dest = data.Get();
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        for (unsigned j = 0; j < elements.Size(); ++j)
+        {
+            const unsigned char* srcElement = src + srcElements[j].offset_;
+            unsigned char* destElement = dest + elements[j].offset_;
+            if (srcElements[j].type_ == TYPE_HALF2)
+            {
+                unsigned short halves[2];
+                memcpy(halves, srcElement, sizeof halves);
+                const float values[2] = { HalfToFloat(halves[0]), HalfToFloat(halves[1]) };
+                memcpy(destElement, values, sizeof values);
+            }
+            else
+                memcpy(destElement, srcElement, ELEMENT_TYPESIZES[srcElements[j].type_]);
+        }
+        src += srcVertexSize;
+        dest += vertexSize;
+    }
+
+    return data;
+}
+
 Model::Model(Context* context) :
     ResourceWithMetadata(context)
 {
@@ -93,6 +144,7 @@ bool Model::BeginLoad(Deserializer& source)
 
     unsigned memoryUse = sizeof(Model);
     bool async = GetAsyncLoadState() == ASYNC_LOADING;
+    auto* graphics = GetSubsystem<Graphics>();
 
     // Read vertex buffers
     unsigned numVertexBuffers = source.ReadUInt();
@@ -120,6 +172,11 @@ bool Model::BeginLoad(Deserializer& source)
                 auto type = (VertexElementType)(elementDesc & 0xffu);
                 auto semantic = (VertexElementSemantic)((elementDesc >> 8u) & 0xffu);
                 auto index = (unsigned char)((elementDesc >> 16u) & 0xffu);
+                if (type >= MAX_VERTEX_ELEMENT_TYPES || semantic >= MAX_VERTEX_ELEMENT_SEMANTICS)
+                {
+                    URHO3D_LOGERROR(source.GetName() + " has an unsupported vertex element type");
+                    return false;
+                }
                 desc.vertexElements_.Push(VertexElement(type, semantic, index));
             }
         }
@@ -132,7 +189,15 @@ bool Model::BeginLoad(Deserializer& source)
         desc.dataSize_ = desc.vertexCount_ * vertexSize;
 
         // Prepare vertex buffer data to be uploaded during EndLoad()
-        if (async)
+        if (graphics && !graphics->GetHalfFloatVertexSupport() && HasHalfFloats(desc.vertexElements_))
+        {
+            SharedArrayPtr<unsigned char> halfData(new unsigned char[desc.dataSize_]);
+            source.Read(halfData.Get(), desc.dataSize_);
+            desc.data_ = ExpandHalfFloats(halfData.Get(), desc.vertexCount_, desc.vertexElements_);
+            vertexSize = VertexBuffer::GetVertexSize(desc.vertexElements_);
+            desc.dataSize_ = desc.vertexCount_ * vertexSize;
+        }
+        else if (async)
         {
             desc.data_ = new unsigned char[desc.dataSize_];
             source.Read(desc.data_.Get(), desc.dataSize_);
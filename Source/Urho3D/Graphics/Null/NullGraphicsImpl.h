@@ -0,0 +1,122 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../../Graphics/ConstantBuffer.h"
+#include "../../Graphics/GraphicsDefs.h"
+#include "../../Graphics/ShaderProgram.h"
+#include "../../Math/Color.h"
+
+namespace Urho3D
+{
+
+/// Texture formats of the null graphics backend. The values only need to be unique, as no device ever sees them.
+enum NullTextureFormat
+{
+    NULLFMT_UNKNOWN = 0,
+    NULLFMT_A8,
+    NULLFMT_R8,
+    NULLFMT_RG8,
+    NULLFMT_RGBA8,
+    NULLFMT_RGBA8_SRGB,
+    NULLFMT_RGBA16,
+    NULLFMT_RGBA16F,
+    NULLFMT_RGBA32F,
+    NULLFMT_RG16,
+    NULLFMT_RG16F,
+    NULLFMT_RG32F,
+    NULLFMT_R16F,
+    NULLFMT_R32F,
+    NULLFMT_D16,
+    NULLFMT_D24S8,
+    NULLFMT_D32,
+    NULLFMT_DXT1,
+    NULLFMT_DXT1_SRGB,
+    NULLFMT_DXT3,
+    NULLFMT_DXT3_SRGB,
+    NULLFMT_DXT5,
+    NULLFMT_DXT5_SRGB
+};
+
+using ShaderProgramMap = HashMap<Pair<ShaderVariation*, ShaderVariation*>, SharedPtr<ShaderProgram> >;
+using ConstantBufferMap = HashMap<unsigned, SharedPtr<ConstantBuffer> >;
+
+/// %Graphics implementation. Holds the emulated device state of the null graphics backend.
+class URHO3D_API GraphicsImpl
+{
+    friend class Graphics;
+
+public:
+    /// Construct.
+    GraphicsImpl();
+
+    /// Return number of vertices submitted this frame.
+    unsigned long long GetNumVertices() const { return numVertices_; }
+
+    /// Return number of indices submitted this frame.
+    unsigned long long GetNumIndices() const { return numIndices_; }
+
+    /// Return number of vertex or pixel shader switches this frame.
+    unsigned GetNumShaderChanges() const { return numShaderChanges_; }
+
+    /// Return number of render state changes (blend, depth, rasterizer or rendertarget) flushed by draw calls this frame.
+    unsigned GetNumStateChanges() const { return numStateChanges_; }
+
+    /// Return number of bytes uploaded to buffers and textures this frame.
+    unsigned long long GetUploadBytes() const { return uploadBytes_; }
+
+    /// Add bytes uploaded to a buffer or texture.
+    void AddUploadBytes(unsigned bytes) { uploadBytes_ += bytes; }
+
+private:
+    /// Rendertargets dirty flag.
+    bool renderTargetsDirty_;
+    /// Textures dirty flag.
+    bool texturesDirty_;
+    /// Vertex buffers dirty flag.
+    bool vertexBuffersDirty_;
+    /// Blend state dirty flag.
+    bool blendStateDirty_;
+    /// Depth state dirty flag.
+    bool depthStateDirty_;
+    /// Rasterizer state dirty flag.
+    bool rasterizerStateDirty_;
+    /// Vertices submitted this frame.
+    unsigned long long numVertices_;
+    /// Indices submitted this frame.
+    unsigned long long numIndices_;
+    /// Bytes uploaded to buffers and textures this frame.
+    unsigned long long uploadBytes_;
+    /// Shader switches this frame.
+    unsigned numShaderChanges_;
+    /// State changes this frame.
+    unsigned numStateChanges_;
+    /// Constant buffer search map.
+    ConstantBufferMap allConstantBuffers_;
+    /// Shader programs.
+    ShaderProgramMap shaderPrograms_;
+    /// Shader program in use.
+    ShaderProgram* shaderProgram_;
+};
+
+}
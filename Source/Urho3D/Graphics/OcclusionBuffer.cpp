@@ -28,11 +28,20 @@
 #include "../Graphics/OcclusionBuffer.h"
 #include "../IO/Log.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+/// Width of a rasterizer tile in pixels.
+static const int OCCLUSION_TILE_WIDTH = 8;
+/// Height of a rasterizer tile in pixels.
+static const int OCCLUSION_TILE_HEIGHT = 4;
+
 enum ClipMask : unsigned
 {
     CLIPMASK_X_POS = 0x1,
@@ -44,12 +53,36 @@ enum ClipMask : unsigned
 };
 URHO3D_FLAGSET(ClipMask, ClipMaskFlags);
 
-void DrawOcclusionBatchWork(const WorkItem* item, unsigned threadIndex)
+/// Screen-space triangle set up for the tiled rasterizer.
+struct OcclusionTriangle
 {
-    auto* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
-    OcclusionBatch& batch = *reinterpret_cast<OcclusionBatch*>(item->start_);
-    buffer->DrawBatch(batch, threadIndex);
-}
+    /// Edge function X coefficients. The edge functions are non-negative inside the triangle.
+    float edgeA_[3];
+    /// Edge function Y coefficients.
+    float edgeB_[3];
+    /// Edge function constants.
+    float edgeC_[3];
+    /// Depth plane X coefficient.
+    float depthA_;
+    /// Depth plane Y coefficient.
+    float depthB_;
+    /// Depth plane constant.
+    float depthC_;
+    /// Minimum vertex depth. Interpolated depth is clamped to the vertex depth range, so it can never be closer than the triangle.
+    float minZ_;
+    /// Maximum vertex depth.
+    float maxZ_;
+    /// Minimum vertex depth as integer, rounded down.
+    int minZInt_;
+    /// Left pixel of the bounding rectangle.
+    int left_;
+    /// Top pixel of the bounding rectangle.
+    int top_;
+    /// Right pixel of the bounding rectangle, inclusive.
+    int right_;
+    /// Bottom pixel of the bounding rectangle, inclusive.
+    int bottom_;
+};
 
 OcclusionBuffer::OcclusionBuffer(Context* context) :
     Object(context)
@@ -63,8 +96,11 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     // Force the height to an even amount of pixels for better mip generation
     if (height & 1u)
         ++height;
+    // The width must hold at least one tile
+    if (width > 0 && width < OCCLUSION_TILE_WIDTH)
+        width = OCCLUSION_TILE_WIDTH;
 
-    if (width == width_ && height == height_)
+    if (width == width_ && height == height_ && threaded == threaded_)
         return true;
 
     if (width <= 0 || height <= 0)
@@ -78,18 +114,25 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
 
     width_ = width;
     height_ = height;
-
-    // Build work buffers for threading
-    unsigned numThreadBuffers = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
-    buffers_.Resize(numThreadBuffers);
-    for (unsigned i = 0; i < numThreadBuffers; ++i)
-    {
-        // Reserve extra memory in case 3D clipping is not exact
-        OcclusionBufferData& buffer = buffers_[i];
-        buffer.dataWithSafety_ = new int[width * (height + 2) + 2];
-        buffer.data_ = buffer.dataWithSafety_.Get() + width + 1;
-        buffer.used_ = false;
-    }
+    threaded_ = threaded;
+    tilesX_ = width / OCCLUSION_TILE_WIDTH;
+    tilesY_ = (height + OCCLUSION_TILE_HEIGHT - 1) / OCCLUSION_TILE_HEIGHT;
+
+    // Reserve extra memory in case 3D clipping is not exact
+    buffer_.dataWithSafety_ = new int[width * (height + 2) + 2];
+    buffer_.data_ = buffer_.dataWithSafety_.Get() + width + 1;
+    tileDepths_ = new DepthValue[tilesX_ * tilesY_];
+
+    // When threaded, split the tile rows to horizontal bands that the threads rasterize independently. Use a few bands per
+    // thread to balance uneven triangle distribution
+    unsigned numThreads = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
+    unsigned numBands = threaded ? Min(numThreads * 2, (unsigned)tilesY_) : 1;
+    bandTileRows_ = (tilesY_ + numBands - 1) / numBands;
+    numBands_ = (unsigned)(tilesY_ + bandTileRows_ - 1) / bandTileRows_;
+    triangles_.Clear();
+    triangles_.Resize(numThreads);
+    bins_.Clear();
+    bins_.Resize(numThreads * numBands_);
 
     mipBuffers_.Clear();
 
@@ -106,9 +149,10 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     }
 
     URHO3D_LOGDEBUG("Set occlusion buffer size " + String(width_) + "x" + String(height_) + " with " +
-             String(mipBuffers_.Size()) + " mip levels and " + String(numThreadBuffers) + " thread buffers");
+             String(mipBuffers_.Size()) + " mip levels and " + String(numBands_) + " rasterizer bands");
 
     CalculateViewport();
+    ClearBuffer();
     return true;
 }
 
@@ -143,6 +187,11 @@ void OcclusionBuffer::SetCullMode(CullMode mode)
     cullMode_ = mode;
 }
 
+void OcclusionBuffer::SetTiledRasterization(bool enable)
+{
+    tiledRasterization_ = enable;
+}
+
 void OcclusionBuffer::Reset()
 {
     numTriangles_ = 0;
@@ -152,12 +201,7 @@ void OcclusionBuffer::Reset()
 void OcclusionBuffer::Clear()
 {
     Reset();
-
-    // Only clear the main thread buffer. Rest are cleared on-demand when drawing the first batch
-    ClearBuffer(0);
-    for (unsigned i = 1; i < buffers_.Size(); ++i)
-        buffers_[i].used_ = false;
-
+    ClearBuffer();
     depthHierarchyDirty_ = true;
 }
 
@@ -199,41 +243,76 @@ bool OcclusionBuffer::AddTriangles(const Matrix3x4& model, const void* vertexDat
 
 void OcclusionBuffer::DrawTriangles()
 {
-    if (buffers_.Size() == 1)
+    if (!buffer_.data_)
     {
-        // Not threaded
-        for (Vector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
-            DrawBatch(*i, 0);
-
-        depthHierarchyDirty_ = true;
+        batches_.Clear();
+        return;
     }
-    else if (buffers_.Size() > 1)
+
+    if (threaded_ && tiledRasterization_ && batches_.Size())
     {
-        // Threaded
+        // Transform, clip and bin the triangles of each batch, then rasterize each band of tiles in its own work item.
+        // The bands do not overlap, so no merging of per-thread buffers is needed
         auto* queue = GetSubsystem<WorkQueue>();
 
-        for (Vector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
+        queue->ParallelFor(0, batches_.Size(), 1, [&](unsigned index, unsigned threadIndex)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = DrawOcclusionBatchWork;
-            item->aux_ = this;
-            item->start_ = &(*i);
-            queue->AddWorkItem(item);
-        }
+            DrawBatch(batches_[index], threadIndex);
+        }, "SetupOcclusionTriangles");
 
-        queue->Complete(M_MAX_UNSIGNED);
+        queue->ParallelFor(0, numBands_, 1, [&](unsigned band, unsigned threadIndex)
+        {
+            DrawBand(band);
+        }, "RasterizeOcclusionBands");
+    }
+    else
+    {
+        for (PODVector<OcclusionBatch>::Iterator i = batches_.Begin(); i != batches_.End(); ++i)
+            DrawBatch(*i, 0);
 
-        MergeBuffers();
-        depthHierarchyDirty_ = true;
+        if (tiledRasterization_)
+        {
+            for (unsigned i = 0; i < numBands_; ++i)
+                DrawBand(i);
+        }
+        else
+        {
+            // The scanline rasterizer does not track the tile depth ranges, so recalculate them all
+            for (int y = 0; y < tilesY_; ++y)
+            {
+                for (int x = 0; x < tilesX_; ++x)
+                    UpdateTileDepth(x, y);
+            }
+        }
     }
 
+    for (unsigned i = 0; i < triangles_.Size(); ++i)
+        triangles_[i].Clear();
+    for (unsigned i = 0; i < bins_.Size(); ++i)
+        bins_[i].Clear();
+
+    depthHierarchyDirty_ = true;
     batches_.Clear();
 }
 
+void OcclusionBuffer::DrawBand(unsigned band)
+{
+    int top = (int)band * bandTileRows_ * OCCLUSION_TILE_HEIGHT;
+    int bottom = Min(top + bandTileRows_ * OCCLUSION_TILE_HEIGHT, height_) - 1;
+
+    for (unsigned i = 0; i < triangles_.Size(); ++i)
+    {
+        const PODVector<OcclusionTriangle>& triangles = triangles_[i];
+        const PODVector<unsigned>& bin = bins_[i * numBands_ + band];
+
+        for (PODVector<unsigned>::ConstIterator j = bin.Begin(); j != bin.End(); ++j)
+            DrawTriangleTiled(triangles[*j], top, bottom);
+    }
+}
+
 void OcclusionBuffer::BuildDepthHierarchy()
 {
-    if (buffers_.Empty() || !depthHierarchyDirty_)
+    if (!buffer_.data_ || !depthHierarchyDirty_)
         return;
 
     URHO3D_PROFILE(BuildDepthHierarchy);
@@ -245,7 +324,7 @@ void OcclusionBuffer::BuildDepthHierarchy()
     {
         for (int y = 0; y < height; ++y)
         {
-            int* src = buffers_[0].data_ + (y * 2) * width_;
+            int* src = buffer_.data_ + (y * 2) * width_;
             DepthValue* dest = mipBuffers_[0].Get() + y * width;
             DepthValue* end = dest + width;
 
@@ -335,7 +414,7 @@ void OcclusionBuffer::ResetUseTimer()
 
 bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
 {
-    if (buffers_.Empty())
+    if (!buffer_.data_)
         return true;
 
     // Transform corners to projection space
@@ -436,20 +515,35 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
         }
     }
 
-    // If no conclusive result, finally check the pixel-level data
-    int* row = buffers_[0].data_ + rect.top_ * width_;
-    int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
-    while (row <= endRow)
+    // If no conclusive result, check the tile depth ranges, which are always up to date, and finally the pixel-level data
+    // of the inconclusive tiles
+    for (int tileY = rect.top_ / OCCLUSION_TILE_HEIGHT; tileY <= rect.bottom_ / OCCLUSION_TILE_HEIGHT; ++tileY)
     {
-        int* src = row + rect.left_;
-        int* end = row + rect.right_;
-        while (src <= end)
+        for (int tileX = rect.left_ / OCCLUSION_TILE_WIDTH; tileX <= rect.right_ / OCCLUSION_TILE_WIDTH; ++tileX)
         {
-            if (z <= *src)
+            const DepthValue& tile = tileDepths_[tileY * tilesX_ + tileX];
+            if (z <= tile.min_)
                 return true;
-            ++src;
+            if (z > tile.max_)
+                continue;
+
+            int left = Max(tileX * OCCLUSION_TILE_WIDTH, rect.left_);
+            int right = Min(tileX * OCCLUSION_TILE_WIDTH + OCCLUSION_TILE_WIDTH - 1, rect.right_);
+            int top = Max(tileY * OCCLUSION_TILE_HEIGHT, rect.top_);
+            int bottom = Min(tileY * OCCLUSION_TILE_HEIGHT + OCCLUSION_TILE_HEIGHT - 1, rect.bottom_);
+
+            for (int y = top; y <= bottom; ++y)
+            {
+                int* src = buffer_.data_ + y * width_ + left;
+                int* end = buffer_.data_ + y * width_ + right;
+                while (src <= end)
+                {
+                    if (z <= *src)
+                        return true;
+                    ++src;
+                }
+            }
         }
-        row += width_;
     }
 
     return false;
@@ -463,81 +557,178 @@ unsigned OcclusionBuffer::GetUseTimer()
 
 void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadIndex)
 {
-    // If buffer not yet used, clear it
-    if (threadIndex > 0 && !buffers_[threadIndex].used_)
+    Matrix4 modelViewProj = viewProj_ * batch.model_;
+
+    const auto* srcData = (const unsigned char*)batch.vertexData_;
+    const unsigned vertexSize = batch.vertexSize_;
+    const unsigned numIndices = batch.drawCount_ - batch.drawCount_ % 3;
+
+    // Gather the vertex positions of four triangles at a time
+    const Vector3* vertices[4 * 3];
+    unsigned count = 0;
+
+    for (unsigned i = batch.drawStart_; i < batch.drawStart_ + numIndices; ++i)
     {
-        ClearBuffer(threadIndex);
-        buffers_[threadIndex].used_ = true;
+        unsigned index;
+        if (!batch.indexData_)
+            index = i;
+        // 16-bit indices
+        else if (batch.indexSize_ == sizeof(unsigned short))
+            index = ((const unsigned short*)batch.indexData_)[i];
+        else
+            index = ((const unsigned*)batch.indexData_)[i];
+
+        vertices[count++] = (const Vector3*)(&srcData[index * vertexSize]);
+        if (count == 4 * 3)
+        {
+            DrawTriangleGroup(modelViewProj, vertices, 4, threadIndex);
+            count = 0;
+        }
     }
 
-    Matrix4 modelViewProj = viewProj_ * batch.model_;
+    if (count)
+        DrawTriangleGroup(modelViewProj, vertices, count / 3, threadIndex);
+}
 
+void OcclusionBuffer::DrawTriangleGroup(const Matrix4& transform, const Vector3* const* vertices, unsigned numTriangles,
+    unsigned threadIndex)
+{
     // Theoretical max. amount of vertices if each of the 6 clipping planes doubles the triangle count
-    Vector4 vertices[64 * 3];
+    Vector4 clipVertices[64 * 3];
 
-    if (!batch.indexData_)
+#ifdef URHO3D_SSE
+    // Structure of arrays layout: one register holds a coordinate of the same vertex of the four triangles. Unused lanes
+    // repeat the last triangle
+    __m128 x[3], y[3], z[3], w[3];
+    for (unsigned k = 0; k < 3; ++k)
     {
-        const unsigned char* srcData = ((const unsigned char*)batch.vertexData_) + batch.drawStart_ * batch.vertexSize_;
+        const Vector3* v0 = vertices[k];
+        const Vector3* v1 = vertices[(numTriangles > 1 ? 3 : 0) + k];
+        const Vector3* v2 = vertices[(numTriangles > 2 ? 6 : 3 * (numTriangles - 1)) + k];
+        const Vector3* v3 = vertices[3 * (numTriangles - 1) + k];
+        const __m128 vx = _mm_setr_ps(v0->x_, v1->x_, v2->x_, v3->x_);
+        const __m128 vy = _mm_setr_ps(v0->y_, v1->y_, v2->y_, v3->y_);
+        const __m128 vz = _mm_setr_ps(v0->z_, v1->z_, v2->z_, v3->z_);
+
+#define URHO3D_TRANSFORM_ROW(row) _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(transform.m##row##0_), vx), \
+    _mm_mul_ps(_mm_set1_ps(transform.m##row##1_), vy)), _mm_mul_ps(_mm_set1_ps(transform.m##row##2_), vz)), \
+    _mm_set1_ps(transform.m##row##3_))
+        x[k] = URHO3D_TRANSFORM_ROW(0);
+        y[k] = URHO3D_TRANSFORM_ROW(1);
+        z[k] = URHO3D_TRANSFORM_ROW(2);
+        w[k] = URHO3D_TRANSFORM_ROW(3);
+#undef URHO3D_TRANSFORM_ROW
+    }
 
-        unsigned index = 0;
-        while (index + 2 < batch.drawCount_)
-        {
-            const Vector3& v0 = *((const Vector3*)(&srcData[index * batch.vertexSize_]));
-            const Vector3& v1 = *((const Vector3*)(&srcData[(index + 1) * batch.vertexSize_]));
-            const Vector3& v2 = *((const Vector3*)(&srcData[(index + 2) * batch.vertexSize_]));
+    // Test the vertices against the clip planes. A triangle is rejected when all its vertices are outside the same plane,
+    // and needs clipping when any vertex is outside any plane
+    const __m128 zero = _mm_setzero_ps();
+    __m128 outside[3];
+    __m128 reject = zero;
+    for (unsigned k = 0; k < 3; ++k)
+        outside[k] = zero;
+
+#define URHO3D_CLIP_PLANE(test) \
+    { \
+        __m128 all = _mm_castsi128_ps(_mm_set1_epi32(-1)); \
+        for (unsigned k = 0; k < 3; ++k) \
+        { \
+            const __m128 out = test; \
+            outside[k] = _mm_or_ps(outside[k], out); \
+            all = _mm_and_ps(all, out); \
+        } \
+        reject = _mm_or_ps(reject, all); \
+    }
+    URHO3D_CLIP_PLANE(_mm_cmpgt_ps(x[k], w[k]));
+    URHO3D_CLIP_PLANE(_mm_cmplt_ps(x[k], _mm_sub_ps(zero, w[k])));
+    URHO3D_CLIP_PLANE(_mm_cmpgt_ps(y[k], w[k]));
+    URHO3D_CLIP_PLANE(_mm_cmplt_ps(y[k], _mm_sub_ps(zero, w[k])));
+    URHO3D_CLIP_PLANE(_mm_cmpgt_ps(z[k], w[k]));
+    URHO3D_CLIP_PLANE(_mm_cmplt_ps(z[k], zero));
+#undef URHO3D_CLIP_PLANE
+
+    const int rejectMask = _mm_movemask_ps(reject);
+    const int clipMask = _mm_movemask_ps(_mm_or_ps(_mm_or_ps(outside[0], outside[1]), outside[2])) & ~rejectMask;
+    const int laneMask = (1 << numTriangles) - 1;
+    if (!((~rejectMask) & laneMask))
+        return;
 
-            vertices[0] = ModelTransform(modelViewProj, v0);
-            vertices[1] = ModelTransform(modelViewProj, v1);
-            vertices[2] = ModelTransform(modelViewProj, v2);
-            DrawTriangle(vertices, threadIndex);
+    // Project the vertices to the viewport. For triangles needing clipping the results are not used
+    __m128 px[3], py[3], pz[3];
+    for (unsigned k = 0; k < 3; ++k)
+    {
+        const __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), w[k]);
+        px[k] = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(invW, x[k]), _mm_set1_ps(scaleX_)), _mm_set1_ps(offsetX_));
+        py[k] = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(invW, y[k]), _mm_set1_ps(scaleY_)), _mm_set1_ps(offsetY_));
+        pz[k] = _mm_mul_ps(_mm_mul_ps(invW, z[k]), _mm_set1_ps(OCCLUSION_Z_SCALE));
+    }
 
-            index += 3;
+    // Cull by winding. If the signed area is negative, the triangle is clockwise
+    const __m128 area = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(px[0], px[1]), _mm_sub_ps(py[2], py[1])),
+        _mm_mul_ps(_mm_sub_ps(py[0], py[1]), _mm_sub_ps(px[2], px[1])));
+    const int clockwiseMask = _mm_movemask_ps(_mm_cmplt_ps(area, zero));
+    int cullMask = 0;
+    if (cullMode_ == CULL_CCW)
+        cullMask = ~clockwiseMask;
+    else if (cullMode_ == CULL_CW)
+        cullMask = clockwiseMask;
+
+    alignas(16) float values[9][4];
+    alignas(16) float clipValues[12][4];
+    for (unsigned k = 0; k < 3; ++k)
+    {
+        _mm_store_ps(values[k * 3], px[k]);
+        _mm_store_ps(values[k * 3 + 1], py[k]);
+        _mm_store_ps(values[k * 3 + 2], pz[k]);
+    }
+    if (clipMask & laneMask)
+    {
+        for (unsigned k = 0; k < 3; ++k)
+        {
+            _mm_store_ps(clipValues[k * 4], x[k]);
+            _mm_store_ps(clipValues[k * 4 + 1], y[k]);
+            _mm_store_ps(clipValues[k * 4 + 2], z[k]);
+            _mm_store_ps(clipValues[k * 4 + 3], w[k]);
         }
     }
-    else
+
+    for (unsigned i = 0; i < numTriangles; ++i)
     {
-        const auto* srcData = (const unsigned char*)batch.vertexData_;
+        const int bit = 1 << i;
+        if (rejectMask & bit)
+            continue;
 
-        // 16-bit indices
-        if (batch.indexSize_ == sizeof(unsigned short))
+        if (clipMask & bit)
         {
-            const unsigned short* indices = ((const unsigned short*)batch.indexData_) + batch.drawStart_;
-            const unsigned short* indicesEnd = indices + batch.drawCount_;
-
-            while (indices < indicesEnd)
+            for (unsigned k = 0; k < 3; ++k)
             {
-                const Vector3& v0 = *((const Vector3*)(&srcData[indices[0] * batch.vertexSize_]));
-                const Vector3& v1 = *((const Vector3*)(&srcData[indices[1] * batch.vertexSize_]));
-                const Vector3& v2 = *((const Vector3*)(&srcData[indices[2] * batch.vertexSize_]));
-
-                vertices[0] = ModelTransform(modelViewProj, v0);
-                vertices[1] = ModelTransform(modelViewProj, v1);
-                vertices[2] = ModelTransform(modelViewProj, v2);
-                DrawTriangle(vertices, threadIndex);
-
-                indices += 3;
+                clipVertices[k] = Vector4(clipValues[k * 4][i], clipValues[k * 4 + 1][i], clipValues[k * 4 + 2][i],
+                    clipValues[k * 4 + 3][i]);
             }
+            DrawTriangle(clipVertices, threadIndex);
         }
-        else
+        else if (!(cullMask & bit))
         {
-            const unsigned* indices = ((const unsigned*)batch.indexData_) + batch.drawStart_;
-            const unsigned* indicesEnd = indices + batch.drawCount_;
-
-            while (indices < indicesEnd)
-            {
-                const Vector3& v0 = *((const Vector3*)(&srcData[indices[0] * batch.vertexSize_]));
-                const Vector3& v1 = *((const Vector3*)(&srcData[indices[1] * batch.vertexSize_]));
-                const Vector3& v2 = *((const Vector3*)(&srcData[indices[2] * batch.vertexSize_]));
-
-                vertices[0] = ModelTransform(modelViewProj, v0);
-                vertices[1] = ModelTransform(modelViewProj, v1);
-                vertices[2] = ModelTransform(modelViewProj, v2);
-                DrawTriangle(vertices, threadIndex);
+            Vector3 projected[3];
+            for (unsigned k = 0; k < 3; ++k)
+                projected[k] = Vector3(values[k * 3][i], values[k * 3 + 1][i], values[k * 3 + 2][i]);
 
-                indices += 3;
-            }
+            if (tiledRasterization_)
+                SetupTriangle2D(projected, threadIndex);
+            else
+                DrawTriangle2D(projected, (clockwiseMask & bit) != 0);
+            ++numTriangles_;
         }
     }
+#else
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        clipVertices[0] = ModelTransform(transform, *vertices[i * 3]);
+        clipVertices[1] = ModelTransform(transform, *vertices[i * 3 + 1]);
+        clipVertices[2] = ModelTransform(transform, *vertices[i * 3 + 2]);
+        DrawTriangle(clipVertices, threadIndex);
+    }
+#endif
 }
 
 inline Vector4 OcclusionBuffer::ModelTransform(const Matrix4& transform, const Vector3& vertex) const
@@ -633,7 +824,10 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
         bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
         if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
         {
-            DrawTriangle2D(projected, clockwise, threadIndex);
+            if (tiledRasterization_)
+                SetupTriangle2D(projected, threadIndex);
+            else
+                DrawTriangle2D(projected, clockwise);
             drawOk = true;
         }
     }
@@ -671,7 +865,10 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
                 bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
                 if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
                 {
-                    DrawTriangle2D(projected, clockwise, threadIndex);
+                    if (tiledRasterization_)
+                        SetupTriangle2D(projected, threadIndex);
+                    else
+                        DrawTriangle2D(projected, clockwise);
                     drawOk = true;
                 }
             }
@@ -812,7 +1009,7 @@ struct Edge
     int invZStep_;
 };
 
-void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise)
 {
     int top, middle, bottom;
     bool middleIsRight;
@@ -889,7 +1086,7 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     Gradients gradients(vertices);
     Edge topToBottom(gradients, vertices[top], vertices[bottom], topY);
 
-    int* bufferData = buffers_[threadIndex].data_;
+    int* bufferData = buffer_.data_;
 
     if (middleIsRight)
     {
@@ -1001,41 +1198,239 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     }
 }
 
-void OcclusionBuffer::MergeBuffers()
+void OcclusionBuffer::SetupTriangle2D(const Vector3* vertices, unsigned threadIndex)
 {
-    URHO3D_PROFILE(MergeBuffers);
+    const Vector3& v0 = vertices[0];
+    const Vector3& v1 = vertices[1];
+    const Vector3& v2 = vertices[2];
+
+    // Pixels are sampled at their bottom right corners, which matches the coverage of the scanline rasterizer. Clamp the
+    // bounding rectangle to the buffer in case clipping was not exact, and reject triangles that cover no pixel rows or columns
+    OcclusionTriangle triangle;
+    triangle.left_ = Max(FloorToInt(Min(Min(v0.x_, v1.x_), v2.x_) - 1.0f), 0);
+    triangle.right_ = Min(FloorToInt(Max(Max(v0.x_, v1.x_), v2.x_) - 1.0f), width_ - 1);
+    if (triangle.left_ > triangle.right_)
+        return;
+    triangle.top_ = Max(FloorToInt(Min(Min(v0.y_, v1.y_), v2.y_) - 1.0f), 0);
+    triangle.bottom_ = Min(FloorToInt(Max(Max(v0.y_, v1.y_), v2.y_) - 1.0f), height_ - 1);
+    if (triangle.top_ > triangle.bottom_)
+        return;
+
+    float dX1 = v1.x_ - v0.x_;
+    float dY1 = v1.y_ - v0.y_;
+    float dZ1 = v1.z_ - v0.z_;
+    float dX2 = v2.x_ - v0.x_;
+    float dY2 = v2.y_ - v0.y_;
+    float dZ2 = v2.z_ - v0.z_;
+    float area = dX1 * dY2 - dX2 * dY1;
+    if (area == 0.0f)
+        return;
 
-    for (unsigned i = 1; i < buffers_.Size(); ++i)
+    // Edge functions for the edges 0-1, 1-2 and 2-0. Flip their signs if necessary so that they are positive inside
+    float sign = area > 0.0f ? 1.0f : -1.0f;
+    triangle.edgeA_[0] = sign * (v0.y_ - v1.y_);
+    triangle.edgeB_[0] = sign * (v1.x_ - v0.x_);
+    triangle.edgeC_[0] = sign * (v0.x_ * v1.y_ - v0.y_ * v1.x_);
+    triangle.edgeA_[1] = sign * (v1.y_ - v2.y_);
+    triangle.edgeB_[1] = sign * (v2.x_ - v1.x_);
+    triangle.edgeC_[1] = sign * (v1.x_ * v2.y_ - v1.y_ * v2.x_);
+    triangle.edgeA_[2] = sign * (v2.y_ - v0.y_);
+    triangle.edgeB_[2] = sign * (v0.x_ - v2.x_);
+    triangle.edgeC_[2] = sign * (v2.x_ * v0.y_ - v2.y_ * v0.x_);
+
+    // Depth is linear in screen space, so it can be interpolated as a plane
+    float invArea = 1.0f / area;
+    triangle.depthA_ = (dZ1 * dY2 - dZ2 * dY1) * invArea;
+    triangle.depthB_ = (dX1 * dZ2 - dX2 * dZ1) * invArea;
+    triangle.depthC_ = v0.z_ - triangle.depthA_ * v0.x_ - triangle.depthB_ * v0.y_;
+    triangle.minZ_ = Min(Min(v0.z_, v1.z_), v2.z_);
+    triangle.maxZ_ = Max(Max(v0.z_, v1.z_), v2.z_);
+    triangle.minZInt_ = FloorToInt(triangle.minZ_);
+
+    PODVector<OcclusionTriangle>& triangles = triangles_[threadIndex];
+    unsigned index = triangles.Size();
+    triangles.Push(triangle);
+
+    if (numBands_ == 1)
     {
-        if (!buffers_[i].used_)
-            continue;
+        bins_[threadIndex].Push(index);
+        return;
+    }
+
+    unsigned bandHeight = (unsigned)(bandTileRows_ * OCCLUSION_TILE_HEIGHT);
+    unsigned firstBand = (unsigned)triangle.top_ / bandHeight;
+    unsigned lastBand = (unsigned)triangle.bottom_ / bandHeight;
+    for (unsigned band = firstBand; band <= lastBand; ++band)
+        bins_[threadIndex * numBands_ + band].Push(index);
+}
+
+void OcclusionBuffer::DrawTriangleTiled(const OcclusionTriangle& triangle, int top, int bottom)
+{
+    top = Max(top, triangle.top_);
+    bottom = Min(bottom, triangle.bottom_);
+    if (top > bottom)
+        return;
+
+    int* bufferData = buffer_.data_;
 
-        int* src = buffers_[i].data_;
-        int* dest = buffers_[0].data_;
-        int count = width_ * height_;
+#ifdef URHO3D_SSE
+    const __m128 edgeA0 = _mm_set1_ps(triangle.edgeA_[0]);
+    const __m128 edgeA1 = _mm_set1_ps(triangle.edgeA_[1]);
+    const __m128 edgeA2 = _mm_set1_ps(triangle.edgeA_[2]);
+    const __m128 depthA = _mm_set1_ps(triangle.depthA_);
+    const __m128 minZ = _mm_set1_ps(triangle.minZ_);
+    const __m128 maxZ = _mm_set1_ps(triangle.maxZ_);
+    const __m128 sampleOffsets = _mm_set_ps(4.0f, 3.0f, 2.0f, 1.0f);
+    const __m128 zero = _mm_setzero_ps();
+#endif
 
-        while (count--)
+    for (int tileY = top / OCCLUSION_TILE_HEIGHT; tileY <= bottom / OCCLUSION_TILE_HEIGHT; ++tileY)
+    {
+        int tileTop = tileY * OCCLUSION_TILE_HEIGHT;
+        int rowStart = Max(tileTop, top);
+        int rowEnd = Min(tileTop + OCCLUSION_TILE_HEIGHT - 1, bottom);
+
+        for (int tileX = triangle.left_ / OCCLUSION_TILE_WIDTH; tileX <= triangle.right_ / OCCLUSION_TILE_WIDTH; ++tileX)
         {
-            // If thread buffer's depth value is closer, overwrite the original
-            if (*src < *dest)
-                *dest = *src;
-            ++src;
-            ++dest;
+            // Hierarchical rejection: skip the tile if all its pixels are already closer than the triangle
+            if (triangle.minZInt_ >= tileDepths_[tileY * tilesX_ + tileX].max_)
+                continue;
+
+            // Skip the tile if it is fully outside an edge, by testing the sample point where the edge function is largest
+            int tileLeft = tileX * OCCLUSION_TILE_WIDTH;
+            bool outside = false;
+            for (unsigned i = 0; i < 3; ++i)
+            {
+                float x = (float)tileLeft + (triangle.edgeA_[i] >= 0.0f ? (float)OCCLUSION_TILE_WIDTH : 1.0f);
+                float y = (float)tileTop + (triangle.edgeB_[i] >= 0.0f ? (float)OCCLUSION_TILE_HEIGHT : 1.0f);
+                if (triangle.edgeA_[i] * x + triangle.edgeB_[i] * y + triangle.edgeC_[i] < 0.0f)
+                {
+                    outside = true;
+                    break;
+                }
+            }
+            if (outside)
+                continue;
+
+            bool written = false;
+
+            for (int y = rowStart; y <= rowEnd; ++y)
+            {
+                float sampleY = (float)(y + 1);
+                int* row = bufferData + y * width_ + tileLeft;
+
+#ifdef URHO3D_SSE
+                __m128 edgeRow0 = _mm_set1_ps(triangle.edgeB_[0] * sampleY + triangle.edgeC_[0]);
+                __m128 edgeRow1 = _mm_set1_ps(triangle.edgeB_[1] * sampleY + triangle.edgeC_[1]);
+                __m128 edgeRow2 = _mm_set1_ps(triangle.edgeB_[2] * sampleY + triangle.edgeC_[2]);
+                __m128 depthRow = _mm_set1_ps(triangle.depthB_ * sampleY + triangle.depthC_);
+
+                // Rasterize the tile row four pixels at a time
+                for (int x = 0; x < OCCLUSION_TILE_WIDTH; x += 4)
+                {
+                    __m128 sampleX = _mm_add_ps(_mm_set1_ps((float)(tileLeft + x)), sampleOffsets);
+                    __m128 inside = _mm_and_ps(_mm_and_ps(
+                        _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA0, sampleX), edgeRow0), zero),
+                        _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA1, sampleX), edgeRow1), zero)),
+                        _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA2, sampleX), edgeRow2), zero));
+                    if (!_mm_movemask_ps(inside))
+                        continue;
+
+                    __m128 depth = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(depthA, sampleX), depthRow), minZ), maxZ);
+                    __m128i invZ = _mm_cvtps_epi32(depth);
+                    __m128i dest = _mm_loadu_si128(reinterpret_cast<__m128i*>(row + x));
+                    __m128i closer = _mm_and_si128(_mm_cmplt_epi32(invZ, dest), _mm_castps_si128(inside));
+                    if (!_mm_movemask_epi8(closer))
+                        continue;
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x),
+                        _mm_or_si128(_mm_and_si128(closer, invZ), _mm_andnot_si128(closer, dest)));
+                    written = true;
+                }
+#else
+                for (int x = 0; x < OCCLUSION_TILE_WIDTH; ++x)
+                {
+                    float sampleX = (float)(tileLeft + x + 1);
+                    if (triangle.edgeA_[0] * sampleX + (triangle.edgeB_[0] * sampleY + triangle.edgeC_[0]) < 0.0f ||
+                        triangle.edgeA_[1] * sampleX + (triangle.edgeB_[1] * sampleY + triangle.edgeC_[1]) < 0.0f ||
+                        triangle.edgeA_[2] * sampleX + (triangle.edgeB_[2] * sampleY + triangle.edgeC_[2]) < 0.0f)
+                        continue;
+
+                    int invZ = RoundToInt(Min(Max(triangle.depthA_ * sampleX + (triangle.depthB_ * sampleY + triangle.depthC_),
+                        triangle.minZ_), triangle.maxZ_));
+                    if (invZ < row[x])
+                    {
+                        row[x] = invZ;
+                        written = true;
+                    }
+                }
+#endif
+            }
+
+            // Only refresh the tile depth range if some pixel was actually brought closer
+            if (written)
+                UpdateTileDepth(tileX, tileY);
+        }
+    }
+}
+
+void OcclusionBuffer::UpdateTileDepth(int tileX, int tileY)
+{
+    int top = tileY * OCCLUSION_TILE_HEIGHT;
+    int bottom = Min(top + OCCLUSION_TILE_HEIGHT, height_);
+    const int* src = buffer_.data_ + top * width_ + tileX * OCCLUSION_TILE_WIDTH;
+    DepthValue& tile = tileDepths_[tileY * tilesX_ + tileX];
+
+#ifdef URHO3D_SSE
+    // SSE2 has no 32-bit integer min/max, so select with comparisons
+    __m128i minValue = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i maxValue = minValue;
+    for (int y = top; y < bottom; ++y, src += width_)
+    {
+        for (int x = 0; x < OCCLUSION_TILE_WIDTH; x += 4)
+        {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+            __m128i less = _mm_cmplt_epi32(value, minValue);
+            minValue = _mm_or_si128(_mm_and_si128(less, value), _mm_andnot_si128(less, minValue));
+            __m128i greater = _mm_cmpgt_epi32(value, maxValue);
+            maxValue = _mm_or_si128(_mm_and_si128(greater, value), _mm_andnot_si128(greater, maxValue));
+        }
+    }
+
+    int mins[4];
+    int maxs[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(mins), minValue);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(maxs), maxValue);
+    tile.min_ = Min(Min(mins[0], mins[1]), Min(mins[2], mins[3]));
+    tile.max_ = Max(Max(maxs[0], maxs[1]), Max(maxs[2], maxs[3]));
+#else
+    tile.min_ = tile.max_ = *src;
+    for (int y = top; y < bottom; ++y, src += width_)
+    {
+        for (int x = 0; x < OCCLUSION_TILE_WIDTH; ++x)
+        {
+            tile.min_ = Min(tile.min_, src[x]);
+            tile.max_ = Max(tile.max_, src[x]);
         }
     }
+#endif
 }
 
-void OcclusionBuffer::ClearBuffer(unsigned threadIndex)
+void OcclusionBuffer::ClearBuffer()
 {
-    if (threadIndex >= buffers_.Size())
+    if (!buffer_.data_)
         return;
 
-    int* dest = buffers_[threadIndex].data_;
+    int* dest = buffer_.data_;
     int count = width_ * height_;
     auto fillValue = (int)OCCLUSION_Z_SCALE;
 
     while (count--)
         *dest++ = fillValue;
+
+    DepthValue* tile = tileDepths_.Get();
+    for (int i = 0; i < tilesX_ * tilesY_; ++i, ++tile)
+        tile->min_ = tile->max_ = fillValue;
 }
 
 }
@@ -40,6 +40,7 @@ class IntRect;
 class VertexBuffer;
 struct Edge;
 struct Gradients;
+struct OcclusionTriangle;
 
 /// Occlusion hierarchy depth value.
 struct DepthValue
@@ -50,15 +51,13 @@ struct DepthValue
     int max_;
 };
 
-/// Per-thread occlusion buffer data.
+/// Occlusion buffer data.
 struct OcclusionBufferData
 {
     /// Full buffer data with safety padding.
     SharedArrayPtr<int> dataWithSafety_;
     /// Buffer data.
     int* data_;
-    /// Use flag.
-    bool used_;
 };
 
 /// Stored occlusion render job.
@@ -98,7 +97,7 @@ public:
     /// Destruct.
     ~OcclusionBuffer() override;
 
-    /// Set occlusion buffer size and whether to reserve multiple buffers for threading optimization.
+    /// Set occlusion buffer size and whether to rasterize in worker threads.
     bool SetSize(int width, int height, bool threaded);
     /// Set camera view to render from.
     void SetView(Camera* camera);
@@ -106,6 +105,8 @@ public:
     void SetMaxTriangles(unsigned triangles);
     /// Set culling mode.
     void SetCullMode(CullMode mode);
+    /// Set whether to use the tiled rasterizer (default) or the scanline reference rasterizer. The reference rasterizer does not use worker threads.
+    void SetTiledRasterization(bool enable);
     /// Reset number of triangles.
     void Reset();
     /// Clear the buffer.
@@ -123,7 +124,7 @@ public:
     void ResetUseTimer();
 
     /// Return highest level depth values.
-    int* GetBuffer() const { return buffers_.Size() ? buffers_[0].data_ : nullptr; }
+    int* GetBuffer() const { return buffer_.data_; }
 
     /// Return view transform matrix.
     const Matrix3x4& GetView() const { return view_; }
@@ -147,15 +148,20 @@ public:
     CullMode GetCullMode() const { return cullMode_; }
 
     /// Return whether is using threads to speed up rendering.
-    bool IsThreaded() const { return buffers_.Size() > 1; }
+    bool IsThreaded() const { return threaded_; }
+
+    /// Return whether uses the tiled rasterizer.
+    bool GetTiledRasterization() const { return tiledRasterization_; }
 
     /// Test a bounding box for visibility. For best performance, build depth hierarchy first.
     bool IsVisible(const BoundingBox& worldSpaceBox) const;
     /// Return time since last use in milliseconds.
     unsigned GetUseTimer();
 
-    /// Draw a batch. Called internally.
+    /// Draw a batch. With the tiled rasterizer only transforms, clips and bins the triangles. Called internally.
     void DrawBatch(const OcclusionBatch& batch, unsigned threadIndex);
+    /// Rasterize the binned triangles of a horizontal band of tiles. Called internally.
+    void DrawBand(unsigned band);
 
 private:
     /// Apply modelview transform to vertex.
@@ -168,27 +174,47 @@ private:
     inline float SignedArea(const Vector3& v0, const Vector3& v1, const Vector3& v2) const;
     /// Calculate viewport transform.
     void CalculateViewport();
+    /// Transform, clip and draw up to four triangles given by pointers to their vertex positions. With SSE the triangles are transformed, tested against the clip planes, projected and culled together, and only the ones needing clipping take the per-triangle path.
+    void DrawTriangleGroup(const Matrix4& transform, const Vector3* const* vertices, unsigned numTriangles, unsigned threadIndex);
     /// Draw a triangle.
     void DrawTriangle(Vector4* vertices, unsigned threadIndex);
     /// Clip vertices against a plane.
     void ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles);
-    /// Draw a clipped triangle.
-    void DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
-    /// Clear a thread work buffer.
-    void ClearBuffer(unsigned threadIndex);
-    /// Merge thread work buffers into the first buffer.
-    void MergeBuffers();
-
-    /// Highest-level buffer data per thread.
-    Vector<OcclusionBufferData> buffers_;
+    /// Draw a clipped triangle with the scanline reference rasterizer.
+    void DrawTriangle2D(const Vector3* vertices, bool clockwise);
+    /// Set up a clipped triangle for the tiled rasterizer and add it to the bins it overlaps.
+    void SetupTriangle2D(const Vector3* vertices, unsigned threadIndex);
+    /// Rasterize a set up triangle within a pixel row range with the tiled rasterizer.
+    void DrawTriangleTiled(const OcclusionTriangle& triangle, int top, int bottom);
+    /// Recalculate the depth range of a tile.
+    void UpdateTileDepth(int tileX, int tileY);
+    /// Clear the buffer data and tile depth ranges.
+    void ClearBuffer();
+
+    /// Highest-level buffer data.
+    OcclusionBufferData buffer_{};
+    /// Depth ranges of the rasterizer tiles.
+    SharedArrayPtr<DepthValue> tileDepths_;
     /// Reduced size depth buffers.
     Vector<SharedArrayPtr<DepthValue> > mipBuffers_;
+    /// Set up triangles per thread.
+    Vector<PODVector<OcclusionTriangle> > triangles_;
+    /// Indices of the set up triangles overlapping each band, per thread and band.
+    Vector<PODVector<unsigned> > bins_;
     /// Submitted render jobs.
     PODVector<OcclusionBatch> batches_;
     /// Buffer width.
     int width_{};
     /// Buffer height.
     int height_{};
+    /// Number of tile columns.
+    int tilesX_{};
+    /// Number of tile rows.
+    int tilesY_{};
+    /// Number of horizontal bands for binning.
+    unsigned numBands_{};
+    /// Number of tile rows per band.
+    int bandTileRows_{};
     /// Number of rendered triangles.
     unsigned numTriangles_{};
     /// Maximum number of triangles.
@@ -199,6 +225,10 @@ private:
     bool depthHierarchyDirty_{true};
     /// Culling reverse flag.
     bool reverseCulling_{};
+    /// Threaded rasterization flag.
+    bool threaded_{};
+    /// Tiled rasterizer flag.
+    bool tiledRasterization_{true};
     /// View transform matrix.
     Matrix3x4 view_;
     /// Projection matrix.
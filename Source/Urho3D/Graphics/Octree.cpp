@@ -27,7 +27,9 @@
 #include "../Core/Profiler.h"
 #include "../Core/Thread.h"
 #include "../Core/WorkQueue.h"
+#include "../Graphics/AnimatedModel.h"
 #include "../Graphics/DebugRenderer.h"
+#include "../Graphics/DynamicAABBTree.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Octree.h"
 #include "../IO/Log.h"
@@ -45,29 +47,28 @@ namespace Urho3D
 
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
+static const unsigned OCTANT_ALLOCATOR_CAPACITY = 64;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
-void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
+static const char* spatialIndexNames[] =
 {
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
-
-    while (start != end)
-    {
-        Drawable* drawable = *start;
-        if (drawable)
-            drawable->Update(frame);
-        ++start;
-    }
-}
+    "Octree",
+    "AABB Tree",
+    "Custom",
+    nullptr
+};
 
 inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
 }
 
+inline bool CompareOctantLevels(Octant* lhs, Octant* rhs)
+{
+    return lhs->GetLevel() != rhs->GetLevel() ? lhs->GetLevel() > rhs->GetLevel() : lhs < rhs;
+}
+
 Octant::Octant(const BoundingBox& box, unsigned level, Octant* parent, Octree* root, unsigned index) :
     level_(level),
     parent_(parent),
@@ -82,13 +83,17 @@ Octant::~Octant()
     if (root_)
     {
         // Remove the drawables (if any) from this octant to the root octant
-        for (PODVector<Drawable*>::Iterator i = drawables_.Begin(); i != drawables_.End(); ++i)
+        for (unsigned i = 0; i < drawables_.Size(); ++i)
         {
-            (*i)->SetOctant(root_);
-            root_->drawables_.Push(*i);
-            root_->QueueUpdate(*i);
+            Drawable* drawable = drawables_[i];
+            drawable->SetOctant(root_);
+            drawable->octantIndex_ = root_->drawables_.Size();
+            root_->drawables_.Push(drawable);
+            root_->drawableBoxes_.Push(drawableBoxes_.Get(i));
+            root_->QueueUpdate(drawable);
         }
         drawables_.Clear();
+        drawableBoxes_.Clear();
         numDrawables_ = 0;
     }
 
@@ -120,38 +125,52 @@ Octant* Octant::GetOrCreateChild(unsigned index)
     else
         newMax.z_ = oldCenter.z_;
 
-    children_[index] = new Octant(BoundingBox(newMin, newMax), level_ + 1, this, root_, index);
-    return children_[index];
+    // Child octants are allocated from the octree's pool instead of the heap
+    auto* child = static_cast<Octant*>(AllocatorReserve(root_->octantAllocator_));
+    new(child) Octant(BoundingBox(newMin, newMax), level_ + 1, this, root_, index);
+    children_[index] = child;
+    return child;
 }
 
 void Octant::DeleteChild(unsigned index)
 {
     assert(index < NUM_OCTANTS);
-    delete children_[index];
-    children_[index] = nullptr;
+    Octant* child = children_[index];
+    if (child)
+    {
+        children_[index] = nullptr;
+        child->~Octant();
+        AllocatorFree(root_->octantAllocator_, child);
+    }
 }
 
 void Octant::InsertDrawable(Drawable* drawable)
 {
     const BoundingBox& box = drawable->GetWorldBoundingBox();
 
-    // If root octant, insert all non-occludees here, so that octant occlusion does not hide the drawable.
-    // Also if drawable is outside the root octant bounds, insert to root
-    bool insertHere;
-    if (this == root_)
-        insertHere = !drawable->IsOccludee() || cullingBox_.IsInside(box) != INSIDE || CheckDrawableFit(box);
-    else
-        insertHere = CheckDrawableFit(box);
-
-    if (insertHere)
+    if (CheckDrawableInsert(drawable, box))
     {
         Octant* oldOctant = drawable->octant_;
-        if (oldOctant != this)
+        if (oldOctant == this)
         {
-            // Add first, then remove, because drawable count going to zero deletes the octree branch in question
-            AddDrawable(drawable);
-            if (oldOctant)
-                oldOctant->RemoveDrawable(drawable, false);
+            if (this == root_ && root_->spatialIndex_)
+                root_->spatialIndex_->UpdateDrawable(drawable);
+        }
+        else
+        {
+            if (oldOctant && oldOctant->root_ == root_)
+                MoveDrawable(drawable, box);
+            else
+            {
+                // Add first, then remove, because drawable count going to zero deletes the octree branch in question
+                unsigned oldIndex = drawable->octantIndex_;
+                AddDrawable(drawable, box);
+                if (oldOctant)
+                    oldOctant->RemoveDrawable(drawable, oldIndex, false);
+            }
+
+            if (this == root_ && root_->spatialIndex_)
+                root_->spatialIndex_->AddDrawable(drawable);
         }
     }
     else
@@ -226,6 +245,96 @@ void Octant::Initialize(const BoundingBox& box)
     cullingBox_ = BoundingBox(worldBoundingBox_.min_ - halfSize_, worldBoundingBox_.max_ + halfSize_);
 }
 
+bool Octant::CheckDrawableInsert(Drawable* drawable, const BoundingBox& box) const
+{
+    // If root octant, insert all non-occludees here, so that octant occlusion does not hide the drawable.
+    // Also if drawable is outside the root octant bounds, insert to root. When a spatial index is used, all drawables are
+    // inserted to root
+    if (this == root_)
+        return root_->spatialIndex_ || !drawable->IsOccludee() || cullingBox_.IsInside(box) != INSIDE || CheckDrawableFit(box);
+    else
+        return CheckDrawableFit(box);
+}
+
+Octant* Octant::FindDrawableOctant(Drawable* drawable, const BoundingBox& box)
+{
+    Octant* octant = this;
+    Vector3 boxCenter = box.Center();
+
+    while (!octant->CheckDrawableInsert(drawable, box))
+    {
+        unsigned x = boxCenter.x_ < octant->center_.x_ ? 0 : 1;
+        unsigned y = boxCenter.y_ < octant->center_.y_ ? 0 : 2;
+        unsigned z = boxCenter.z_ < octant->center_.z_ ? 0 : 4;
+
+        Octant* child = octant->children_[x + y + z];
+        if (!child)
+            break;
+        octant = child;
+    }
+
+    return octant;
+}
+
+void Octant::MoveDrawable(Drawable* drawable, const BoundingBox& box)
+{
+    Octant* oldOctant = drawable->octant_;
+    oldOctant->EraseDrawable(drawable, drawable->octantIndex_);
+    PushDrawable(drawable, box);
+
+    // The drawable counts change only below the common parent of the old and new octant, so walk up from both until they meet
+    Octant* added = this;
+    Octant* removed = oldOctant;
+    while (added != removed)
+    {
+        if (added->level_ >= removed->level_)
+        {
+            ++added->numDrawables_;
+            added = added->parent_;
+        }
+        else
+        {
+            Octant* parent = removed->parent_;
+            if (!--removed->numDrawables_)
+                parent->DeleteEmptyChild(removed->index_);
+            removed = parent;
+        }
+    }
+}
+
+void Octant::RemoveDrawable(Drawable* drawable, unsigned index, bool resetOctant)
+{
+    if (this == root_ && root_->spatialIndex_)
+        root_->spatialIndex_->RemoveDrawable(drawable);
+
+    EraseDrawable(drawable, index);
+    if (resetOctant)
+        drawable->SetOctant(nullptr);
+    DecDrawableCount();
+}
+
+void Octant::DeleteEmptyChild(unsigned index)
+{
+    if (root_->deferOctantDeletion_)
+        root_->emptyOctants_.Push(children_[index]);
+    else
+        DeleteChild(index);
+}
+
+void Octant::FreeChildren(AllocatorBlock* allocator)
+{
+    for (auto& child : children_)
+    {
+        if (child)
+        {
+            child->FreeChildren(allocator);
+            child->~Octant();
+            AllocatorFree(allocator, child);
+            child = nullptr;
+        }
+    }
+}
+
 void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
 {
     if (this != root_)
@@ -244,7 +353,7 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
     {
         auto** start = const_cast<Drawable**>(&drawables_[0]);
         Drawable** end = start + drawables_.Size();
-        query.TestDrawables(start, end, inside);
+        query.TestDrawableBounds(start, end, drawableBoxes_, inside);
     }
 
     for (auto child : children_)
@@ -311,6 +420,7 @@ void Octant::GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*
 Octree::Octree(Context* context) :
     Component(context),
     Octant(BoundingBox(-DEFAULT_OCTREE_SIZE, DEFAULT_OCTREE_SIZE), 0, nullptr, this),
+    octantAllocator_(AllocatorInitialize((unsigned)sizeof(Octant), OCTANT_ALLOCATOR_CAPACITY)),
     numLevels_(DEFAULT_OCTREE_LEVELS)
 {
     // If the engine is running headless, subscribe to RenderUpdate events for manually updating the octree
@@ -321,9 +431,14 @@ Octree::Octree(Context* context) :
 
 Octree::~Octree()
 {
-    // Reset root pointer from all child octants now so that they do not move their drawables to root
+    // Reset root pointer from all child octants now so that they do not move their drawables to root, then free them while
+    // the octant allocator still exists
     drawableUpdates_.Clear();
+    if (spatialIndex_)
+        spatialIndex_->Clear();
     ResetRoot();
+    FreeChildren(octantAllocator_);
+    AllocatorUninitialize(octantAllocator_);
 }
 
 void Octree::RegisterObject(Context* context)
@@ -336,6 +451,8 @@ void Octree::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE_EX("Bounding Box Min", Vector3, worldBoundingBox_.min_, UpdateOctreeSize, defaultBoundsMin, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Bounding Box Max", Vector3, worldBoundingBox_.max_, UpdateOctreeSize, defaultBoundsMax, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Number of Levels", int, numLevels_, UpdateOctreeSize, DEFAULT_OCTREE_LEVELS, AM_DEFAULT);
+    URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Spatial Index", GetSpatialIndexType, SetSpatialIndexType, SpatialIndexType, spatialIndexNames,
+        SPATIAL_INDEX_OCTREE, AM_DEFAULT);
 }
 
 void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -345,6 +462,8 @@ void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
         URHO3D_PROFILE(OctreeDrawDebug);
 
         Octant::DrawDebugGeometry(debug, depthTest);
+        if (spatialIndex_)
+            spatialIndex_->DrawDebugGeometry(debug, depthTest);
     }
 }
 
@@ -369,6 +488,19 @@ void Octree::Update(const FrameInfo& frame)
         return;
     }
 
+    // Forget the changes recorded before the previous update. Anything that checked for changes since has done so with a
+    // serial of at least that update
+    if (lastUpdateChangeSerial_ > changesBegin_)
+    {
+        changedBoxes_.Erase(0, lastUpdateChangeSerial_ - changesBegin_);
+        changesBegin_ = lastUpdateChangeSerial_;
+    }
+    lastUpdateChangeSerial_ = GetChangeSerial();
+
+    // The boxes the drawables had when last queried
+    for (PODVector<Drawable*>::ConstIterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
+        RecordChange((*i)->worldBoundingBox_);
+
     // Let drawables update themselves before reinsertion. This can be used for animation
     if (!drawableUpdates_.Empty())
     {
@@ -379,31 +511,26 @@ void Octree::Update(const FrameInfo& frame)
         Scene* scene = GetScene();
         auto* queue = GetSubsystem<WorkQueue>();
         scene->BeginThreadedUpdate();
+        queueAnimationUpdates_ = true;
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = Max((int)(drawableUpdates_.Size() / numWorkItems), 1);
-
-        PODVector<Drawable*>::Iterator start = drawableUpdates_.Begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
+        queue->ParallelFor(0, drawableUpdates_.Size(), 0, [&](unsigned index, unsigned threadIndex)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = UpdateDrawablesWork;
-            item->aux_ = const_cast<FrameInfo*>(&frame);
-
-            PODVector<Drawable*>::Iterator end = drawableUpdates_.End();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
+            Drawable* drawable = drawableUpdates_[index];
+            if (drawable)
+                drawable->Update(frame);
+        }, "UpdateDrawablesWork");
 
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
+        queueAnimationUpdates_ = false;
 
-            start = end;
+        // Apply the animations as a separate phase, where the work is split by the amount of animation tracks rather than
+        // the number of drawables
+        if (!animationUpdates_.Empty())
+        {
+            URHO3D_PROFILE(UpdateAnimations);
+            AnimatedModel::ApplyAnimations(animationUpdates_, queue);
+            animationUpdates_.Clear();
         }
 
-        queue->Complete(M_MAX_UNSIGNED);
         scene->EndThreadedUpdate();
     }
 
@@ -417,6 +544,7 @@ void Octree::Update(const FrameInfo& frame)
             Drawable* drawable = *i;
             if (drawable)
             {
+                RecordChange(drawable->worldBoundingBox_);
                 drawable->Update(frame);
                 drawableUpdates_.Push(drawable);
             }
@@ -437,31 +565,83 @@ void Octree::Update(const FrameInfo& frame)
         scene->SendEvent(E_SCENEDRAWABLEUPDATEFINISHED, eventData);
     }
 
+    // When a spatial index is used, the drawables all stay in the root octant. Update their bounding boxes in worker threads,
+    // then update the index in the main thread
+    if (spatialIndex_ && !drawableUpdates_.Empty())
+    {
+        URHO3D_PROFILE(UpdateSpatialIndex);
+
+        if (scene)
+            scene->BeginThreadedUpdate();
+
+        GetSubsystem<WorkQueue>()->ParallelFor(0, drawableUpdates_.Size(), 0, [&](unsigned index, unsigned threadIndex)
+        {
+            Drawable* drawable = drawableUpdates_[index];
+            drawable->updateQueued_ = false;
+            drawable->GetWorldBoundingBox();
+        }, "UpdateSpatialIndexBoundsWork");
+
+        if (scene)
+            scene->EndThreadedUpdate();
+
+        for (PODVector<Drawable*>::ConstIterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
+        {
+            Drawable* drawable = *i;
+            Octant* octant = drawable->GetOctant();
+            if (octant && octant->GetRoot() == this)
+                InsertDrawable(drawable);
+        }
+    }
     // Reinsert drawables that have been moved or resized, or that have been newly added to the octree and do not sit inside
     // the proper octant yet
-    if (!drawableUpdates_.Empty())
+    else if (!drawableUpdates_.Empty())
     {
         URHO3D_PROFILE(ReinsertToOctree);
 
-        for (PODVector<Drawable*>::Iterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
+        // Find the target octants in worker threads. The octree is not modified meanwhile, so the threads only read it
+        reinsertOctants_.Resize(drawableUpdates_.Size());
+        if (scene)
+            scene->BeginThreadedUpdate();
+
+        GetSubsystem<WorkQueue>()->ParallelFor(0, drawableUpdates_.Size(), 0, [&](unsigned index, unsigned threadIndex)
         {
-            Drawable* drawable = *i;
+            Drawable* drawable = drawableUpdates_[index];
             drawable->updateQueued_ = false;
             Octant* octant = drawable->GetOctant();
             const BoundingBox& box = drawable->GetWorldBoundingBox();
 
-            // Skip if no octant or does not belong to this octree anymore
-            if (!octant || octant->GetRoot() != this)
-                continue;
-            // Skip if still fits the current octant
-            if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
+            // Skip if no octant or does not belong to this octree anymore, or if still fits the current octant
+            if (!octant || octant->GetRoot() != this || (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE &&
+                octant->CheckDrawableFit(box)))
+                reinsertOctants_[index] = nullptr;
+            else
+            {
+                // If the found octant is the current one, a reinsertion is still needed when a child octant must be created
+                Octant* target = FindDrawableOctant(drawable, box);
+                reinsertOctants_[index] = target != octant || !octant->CheckDrawableInsert(drawable, box) ? target : nullptr;
+            }
+        }, "FindReinsertOctantsWork");
+
+        if (scene)
+            scene->EndThreadedUpdate();
+
+        // Then move the drawables in the main thread. Insertion continues from the found octant, creating child octants as
+        // necessary. Octants that become empty are deleted only afterward, as they may be the targets of later drawables
+        deferOctantDeletion_ = true;
+
+        for (unsigned i = 0; i < drawableUpdates_.Size(); ++i)
+        {
+            Octant* target = reinsertOctants_[i];
+            if (!target)
                 continue;
 
-            InsertDrawable(drawable);
+            Drawable* drawable = drawableUpdates_[i];
+            target->InsertDrawable(drawable);
 
 #ifdef _DEBUG
             // Verify that the drawable will be culled correctly
-            octant = drawable->GetOctant();
+            const BoundingBox& box = drawable->GetWorldBoundingBox();
+            Octant* octant = drawable->GetOctant();
             if (octant != this && octant->GetCullingBox().IsInside(box) != INSIDE)
             {
                 URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
@@ -469,8 +649,29 @@ void Octree::Update(const FrameInfo& frame)
             }
 #endif
         }
+
+        deferOctantDeletion_ = false;
+
+        // Delete the octants that are still empty, deepest first so that a parent never deletes an already recorded child
+        if (!emptyOctants_.Empty())
+        {
+            Sort(emptyOctants_.Begin(), emptyOctants_.End(), CompareOctantLevels);
+            Octant* previous = nullptr;
+            for (PODVector<Octant*>::ConstIterator i = emptyOctants_.Begin(); i != emptyOctants_.End(); ++i)
+            {
+                Octant* octant = *i;
+                if (octant != previous && !octant->numDrawables_)
+                    octant->parent_->DeleteChild(octant->index_);
+                previous = octant;
+            }
+            emptyOctants_.Clear();
+        }
     }
 
+    // The boxes the drawables have now
+    for (PODVector<Drawable*>::ConstIterator i = drawableUpdates_.Begin(); i != drawableUpdates_.End(); ++i)
+        RecordChange((*i)->GetWorldBoundingBox());
+
     drawableUpdates_.Clear();
 }
 
@@ -480,6 +681,9 @@ void Octree::AddManualDrawable(Drawable* drawable)
         return;
 
     AddDrawable(drawable);
+    if (spatialIndex_)
+        spatialIndex_->AddDrawable(drawable);
+    RecordChange(drawable->GetWorldBoundingBox());
 }
 
 void Octree::RemoveManualDrawable(Drawable* drawable)
@@ -489,13 +693,77 @@ void Octree::RemoveManualDrawable(Drawable* drawable)
 
     Octant* octant = drawable->GetOctant();
     if (octant && octant->GetRoot() == this)
+    {
+        RecordChange(drawable->worldBoundingBox_);
         octant->RemoveDrawable(drawable);
+    }
+}
+
+void Octree::SetSpatialIndexType(SpatialIndexType type)
+{
+    if (type == spatialIndexType_)
+        return;
+
+    switch (type)
+    {
+    case SPATIAL_INDEX_OCTREE:
+        SetSpatialIndex(nullptr);
+        break;
+
+    case SPATIAL_INDEX_AABB_TREE:
+        SetSpatialIndex(new DynamicAABBTree());
+        spatialIndexType_ = SPATIAL_INDEX_AABB_TREE;
+        break;
+
+    default:
+        URHO3D_LOGWARNING("Custom spatial index must be set with SetSpatialIndex()");
+        break;
+    }
+}
+
+void Octree::SetSpatialIndex(SpatialIndex* index)
+{
+    if (index == spatialIndex_)
+        return;
+
+    URHO3D_PROFILE(SetSpatialIndex);
+
+    if (spatialIndex_)
+        spatialIndex_->Clear();
+
+    if (index)
+    {
+        // Move the drawables from the child octants to the root, then index them all
+        for (unsigned i = 0; i < NUM_OCTANTS; ++i)
+            DeleteChild(i);
+
+        spatialIndex_ = index;
+        for (PODVector<Drawable*>::ConstIterator i = drawables_.Begin(); i != drawables_.End(); ++i)
+            spatialIndex_->AddDrawable(*i);
+        spatialIndexType_ = SPATIAL_INDEX_CUSTOM;
+    }
+    else
+    {
+        // Queue the drawables for reinsertion to the child octants
+        spatialIndex_.Reset();
+        spatialIndexType_ = SPATIAL_INDEX_OCTREE;
+        for (PODVector<Drawable*>::ConstIterator i = drawables_.Begin(); i != drawables_.End(); ++i)
+        {
+            if (!(*i)->updateQueued_)
+                QueueUpdate(*i);
+        }
+    }
+
+    MarkNetworkUpdate();
 }
 
 void Octree::GetDrawables(OctreeQuery& query) const
 {
     query.result_.Clear();
-    GetDrawablesInternal(query, false);
+    if (spatialIndex_)
+        spatialIndex_->GetDrawables(query);
+    else
+        GetDrawablesInternal(query, false);
 }
 
 void Octree::Raycast(RayOctreeQuery& query) const
@@ -503,7 +771,10 @@ void Octree::Raycast(RayOctreeQuery& query) const
     URHO3D_PROFILE(Raycast);
 
     query.result_.Clear();
-    GetDrawablesInternal(query);
+    if (spatialIndex_)
+        spatialIndex_->Raycast(query);
+    else
+        GetDrawablesInternal(query);
     Sort(query.result_.Begin(), query.result_.End(), CompareRayQueryResults);
 }
 
@@ -513,7 +784,10 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
 
     query.result_.Clear();
     rayQueryDrawables_.Clear();
-    GetDrawablesOnlyInternal(query, rayQueryDrawables_);
+    if (spatialIndex_)
+        spatialIndex_->GetRaycastDrawables(query, rayQueryDrawables_);
+    else
+        GetDrawablesOnlyInternal(query, rayQueryDrawables_);
 
     // Sort by increasing hit distance to AABB
     for (PODVector<Drawable*>::Iterator i = rayQueryDrawables_.Begin(); i != rayQueryDrawables_.End(); ++i)
@@ -547,6 +821,33 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
     }
 }
 
+bool Octree::HasChanged(unsigned serial, const BoundingBox& box) const
+{
+    if (serial < changesBegin_ || serial > GetChangeSerial())
+        return true;
+
+    for (unsigned i = serial - changesBegin_; i < changedBoxes_.Size(); ++i)
+    {
+        if (box.IsInsideFast(changedBoxes_[i]) != OUTSIDE)
+            return true;
+    }
+
+    return false;
+}
+
+void Octree::RecordChange(const BoundingBox& box)
+{
+    // When there are too many changes, forget them all, so that every check returns true
+    if (changedBoxes_.Size() >= MAX_OCTREE_CHANGES)
+    {
+        changesBegin_ += changedBoxes_.Size() + 1;
+        changedBoxes_.Clear();
+        return;
+    }
+
+    changedBoxes_.Push(box);
+}
+
 void Octree::QueueUpdate(Drawable* drawable)
 {
     Scene* scene = GetScene();
@@ -569,6 +870,16 @@ void Octree::CancelUpdate(Drawable* drawable)
     drawable->updateQueued_ = false;
 }
 
+bool Octree::QueueAnimationUpdate(AnimatedModel* model)
+{
+    if (!queueAnimationUpdates_)
+        return false;
+
+    MutexLock lock(octreeMutex_);
+    animationUpdates_.Push(model);
+    return true;
+}
+
 void Octree::DrawDebugGeometry(bool depthTest)
 {
     auto* debug = GetComponent<DebugRenderer>();
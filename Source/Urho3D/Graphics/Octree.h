@@ -22,23 +22,31 @@
 
 #pragma once
 
+#include "../Container/Allocator.h"
 #include "../Container/List.h"
 #include "../Core/Mutex.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/OctreeQuery.h"
+#include "../Graphics/SpatialIndex.h"
+#include "../Math/BoundingBoxArray.h"
 
 namespace Urho3D
 {
 
+class AnimatedModel;
 class Octree;
 
 static const int NUM_OCTANTS = 8;
 static const unsigned ROOT_INDEX = M_MAX_UNSIGNED;
+/// Maximum number of drawable bounding box changes the octree keeps. Beyond that, all queries are assumed to have changed.
+static const unsigned MAX_OCTREE_CHANGES = 1024;
 
 /// %Octree octant.
 /// @nobind
 class URHO3D_API Octant
 {
+    friend class Octree;
+
 public:
     /// Construct.
     Octant(const BoundingBox& box, unsigned level, Octant* parent, Octree* root, unsigned index = ROOT_INDEX);
@@ -57,20 +65,21 @@ public:
     /// Add a drawable object to this octant.
     void AddDrawable(Drawable* drawable)
     {
-        drawable->SetOctant(this);
-        drawables_.Push(drawable);
-        IncDrawableCount();
+        AddDrawable(drawable, drawable->GetWorldBoundingBox());
     }
 
     /// Remove a drawable object from this octant.
     void RemoveDrawable(Drawable* drawable, bool resetOctant = true)
     {
-        if (drawables_.Remove(drawable))
-        {
-            if (resetOctant)
-                drawable->SetOctant(nullptr);
-            DecDrawableCount();
-        }
+        if (drawable->octant_ == this)
+            RemoveDrawable(drawable, drawable->octantIndex_, resetOctant);
+    }
+
+    /// Update the stored copy of a drawable object's world bounding box. Called by the drawable when its box is recalculated.
+    void OnDrawableBoxUpdate(Drawable* drawable)
+    {
+        assert(drawable->octant_ == this && drawables_[drawable->octantIndex_] == drawable);
+        drawableBoxes_.Set(drawable->octantIndex_, drawable->worldBoundingBox_);
     }
 
     /// Return world-space bounding box.
@@ -104,6 +113,16 @@ public:
 protected:
     /// Initialize bounding box.
     void Initialize(const BoundingBox& box);
+    /// Return whether a drawable object should be inserted to this octant rather than a child octant.
+    bool CheckDrawableInsert(Drawable* drawable, const BoundingBox& box) const;
+    /// Return the octant a drawable object should be inserted to by descending from this octant, or the deepest existing octant on the way if child octants need to be created. Does not modify the octree, so can be called from worker threads.
+    Octant* FindDrawableOctant(Drawable* drawable, const BoundingBox& box);
+    /// Move a drawable object from another octant of the same octree to this octant.
+    void MoveDrawable(Drawable* drawable, const BoundingBox& box);
+    /// Delete a child octant that has become empty, or defer the deletion while the octree is applying reinsertions.
+    void DeleteEmptyChild(unsigned index);
+    /// Destruct and free child octants recursively without moving their drawables. Called when the whole octree is being destroyed.
+    void FreeChildren(AllocatorBlock* allocator);
     /// Return drawable objects by a query, called internally.
     void GetDrawablesInternal(OctreeQuery& query, bool inside) const;
     /// Return drawable objects by a ray query, called internally.
@@ -111,6 +130,39 @@ protected:
     /// Return drawable objects only for a threaded ray query, called internally.
     void GetDrawablesOnlyInternal(RayOctreeQuery& query, PODVector<Drawable*>& drawables) const;
 
+    /// Add a drawable object with a known world bounding box to this octant.
+    void AddDrawable(Drawable* drawable, const BoundingBox& box)
+    {
+        PushDrawable(drawable, box);
+        IncDrawableCount();
+    }
+
+    /// Remove a drawable object at a known index from this octant. The last drawable object is moved in its place.
+    void RemoveDrawable(Drawable* drawable, unsigned index, bool resetOctant);
+
+    /// Append a drawable object to the drawable list without updating the drawable counts.
+    void PushDrawable(Drawable* drawable, const BoundingBox& box)
+    {
+        drawable->SetOctant(this);
+        drawable->octantIndex_ = drawables_.Size();
+        drawables_.Push(drawable);
+        drawableBoxes_.Push(box);
+    }
+
+    /// Erase a drawable object at a known index from the drawable list without updating the drawable counts. The last drawable object is moved in its place.
+    void EraseDrawable(Drawable* drawable, unsigned index)
+    {
+        assert(drawables_[index] == drawable);
+        Drawable* last = drawables_.Back();
+        if (last != drawable)
+        {
+            drawables_[index] = last;
+            last->octantIndex_ = index;
+        }
+        drawables_.Pop();
+        drawableBoxes_.EraseSwap(index);
+    }
+
     /// Increase drawable object count recursively.
     void IncDrawableCount()
     {
@@ -141,6 +193,8 @@ protected:
     BoundingBox cullingBox_;
     /// Drawable objects.
     PODVector<Drawable*> drawables_;
+    /// World bounding boxes of the drawable objects in the same order, for batched culling.
+    BoundingBoxArray drawableBoxes_;
     /// Child octants.
     Octant* children_[NUM_OCTANTS]{};
     /// World bounding box center.
@@ -164,6 +218,8 @@ class URHO3D_API Octree : public Component, public Octant
 {
     URHO3D_OBJECT(Octree, Component);
 
+    friend class Octant;
+
 public:
     /// Construct.
     explicit Octree(Context* context);
@@ -185,6 +241,13 @@ public:
     /// Remove a manually added drawable.
     void RemoveManualDrawable(Drawable* drawable);
 
+    /// Set the spatial index used to store and query the drawable objects. The octree's own octants are used by default.
+    /// @property
+    void SetSpatialIndexType(SpatialIndexType type);
+    /// Set a custom spatial index, or null to return to the octree's own octants.
+    /// @nobind
+    void SetSpatialIndex(SpatialIndex* index);
+
     /// Return drawable objects by a query.
     /// @nobind
     void GetDrawables(OctreeQuery& query) const;
@@ -197,10 +260,31 @@ public:
     /// @property
     unsigned GetNumLevels() const { return numLevels_; }
 
+    /// Return the spatial index type.
+    /// @property
+    SpatialIndexType GetSpatialIndexType() const { return spatialIndexType_; }
+
+    /// Return the spatial index, or null if the octree's own octants are used.
+    /// @nobind
+    SpatialIndex* GetSpatialIndex() const { return spatialIndex_; }
+
+    /// Return the serial number of the next drawable change. Store it to later check with HasChanged() whether queries within a volume may return different drawables.
+    /// @nobind
+    unsigned GetChangeSerial() const { return changesBegin_ + changedBoxes_.Size(); }
+
+    /// Return whether a drawable has been added, removed or moved or has changed its view mask within a box since the given change serial. Returns true also when the changes are no longer known. The changes are kept until the octree update after the next one.
+    /// @nobind
+    bool HasChanged(unsigned serial, const BoundingBox& box) const;
+    /// Record a change of a drawable that may affect query results within its bounding box. Called by the drawables.
+    /// @nobind
+    void RecordChange(const BoundingBox& box);
+
     /// Mark drawable object as requiring an update and a reinsertion.
     void QueueUpdate(Drawable* drawable);
     /// Cancel drawable object's update.
     void CancelUpdate(Drawable* drawable);
+    /// Queue an animated model to apply its animation in the parallel animation phase that follows the drawable updates. Return false if not inside the drawable updates, in which case the model should apply the animation itself. Thread-safe.
+    bool QueueAnimationUpdate(AnimatedModel* model);
     /// Visualize the component as debug geometry.
     void DrawDebugGeometry(bool depthTest);
 
@@ -214,12 +298,34 @@ private:
     PODVector<Drawable*> drawableUpdates_;
     /// Drawable objects that were inserted during threaded update phase.
     PODVector<Drawable*> threadedDrawableUpdates_;
+    /// Animated models queued to apply their animation after the drawable updates.
+    PODVector<AnimatedModel*> animationUpdates_;
+    /// Octants found for the drawable objects that require reinsertion, or null if no reinsertion is needed.
+    PODVector<Octant*> reinsertOctants_;
+    /// Octants that have become empty while applying reinsertions.
+    PODVector<Octant*> emptyOctants_;
+    /// Allocator for the child octants.
+    AllocatorBlock* octantAllocator_;
     /// Mutex for octree reinsertions.
     Mutex octreeMutex_;
     /// Ray query temporary list of drawables.
     mutable PODVector<Drawable*> rayQueryDrawables_;
+    /// Spatial index used instead of the octants. All drawables then stay in the root octant.
+    SharedPtr<SpatialIndex> spatialIndex_;
     /// Subdivision level.
     unsigned numLevels_;
+    /// Spatial index type.
+    SpatialIndexType spatialIndexType_{SPATIAL_INDEX_OCTREE};
+    /// Bounding boxes of the drawables that have been added, removed, moved or changed since the update before the previous one.
+    PODVector<BoundingBox> changedBoxes_;
+    /// Change serial of the first recorded box.
+    unsigned changesBegin_{};
+    /// Change serial at the beginning of the previous update.
+    unsigned lastUpdateChangeSerial_{};
+    /// Deferred deletion of empty octants flag. Set while applying reinsertions, as the empty octants may still be their targets.
+    bool deferOctantDeletion_{};
+    /// Animation updates can be queued flag. Set during the threaded drawable updates.
+    bool queueAnimationUpdates_{};
 };
 
 }
@@ -29,6 +29,19 @@
 namespace Urho3D
 {
 
+void OctreeQuery::TestDrawablesInside(Drawable** start, unsigned numInside)
+{
+    if (!numInside)
+        return;
+
+    insideDrawables_.Resize(numInside);
+    for (unsigned i = 0; i < numInside; ++i)
+        insideDrawables_[i] = start[insideIndices_[i]];
+
+    Drawable** insideStart = &insideDrawables_[0];
+    TestDrawables(insideStart, insideStart + numInside, true);
+}
+
 Intersection PointOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
     if (inside)
@@ -95,6 +108,17 @@ void BoxOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool inside
     }
 }
 
+void BoxOctreeQuery::TestDrawableBounds(Drawable** start, Drawable** end, const BoundingBoxArray& boxes, bool inside)
+{
+    if (inside)
+        TestDrawables(start, end, true);
+    else
+    {
+        insideIndices_.Resize(boxes.Size());
+        TestDrawablesInside(start, boxes.GetInsideFast(box_, &insideIndices_[0]));
+    }
+}
+
 Intersection FrustumOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
     if (inside)
@@ -117,6 +141,18 @@ void FrustumOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool in
     }
 }
 
+void FrustumOctreeQuery::TestDrawableBounds(Drawable** start, Drawable** end, const BoundingBoxArray& boxes, bool inside)
+{
+    // Cull the boxes in batches, then let TestDrawables() filter the survivors. Subclasses that only refine the filtering
+    // therefore get the batched test for free
+    if (inside)
+        TestDrawables(start, end, true);
+    else
+    {
+        insideIndices_.Resize(boxes.Size());
+        TestDrawablesInside(start, boxes.GetInsideFast(frustum_, &insideIndices_[0]));
+    }
+}
 
 Intersection AllContentOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
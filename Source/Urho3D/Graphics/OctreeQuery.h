@@ -26,6 +26,7 @@
 
 #include "../Graphics/Drawable.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/BoundingBoxArray.h"
 #include "../Math/Frustum.h"
 #include "../Math/Ray.h"
 #include "../Math/Sphere.h"
@@ -60,6 +61,12 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Intersection test for drawables with their world bounding boxes in the same order. Calls TestDrawables() by default.
+    /// @nobind
+    virtual void TestDrawableBounds(Drawable** start, Drawable** end, const BoundingBoxArray& boxes, bool inside)
+    {
+        TestDrawables(start, end, inside);
+    }
 
     /// Result vector reference.
     PODVector<Drawable*>& result_;
@@ -67,6 +74,15 @@ public:
     unsigned char drawableFlags_;
     /// Drawable layers to include.
     unsigned viewMask_;
+
+protected:
+    /// Pass the drawables listed in insideIndices_ to TestDrawables() as fully inside.
+    void TestDrawablesInside(Drawable** start, unsigned numInside);
+
+    /// Indices of drawables that passed a batched bounding box test.
+    PODVector<unsigned> insideIndices_;
+    /// Drawables that passed a batched bounding box test.
+    PODVector<Drawable*> insideDrawables_;
 };
 
 /// Point octree query.
@@ -130,6 +146,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for drawables with their world bounding boxes, several boxes at a time.
+    void TestDrawableBounds(Drawable** start, Drawable** end, const BoundingBoxArray& boxes, bool inside) override;
 
     /// Bounding box.
     BoundingBox box_;
@@ -152,6 +170,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for drawables with their world bounding boxes, several boxes at a time.
+    void TestDrawableBounds(Drawable** start, Drawable** end, const BoundingBoxArray& boxes, bool inside) override;
 
     /// Frustum.
     Frustum frustum_;
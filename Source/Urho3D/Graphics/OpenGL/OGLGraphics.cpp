@@ -228,7 +228,13 @@ static const unsigned glElementTypes[] =
     GL_FLOAT,
     GL_FLOAT,
     GL_UNSIGNED_BYTE,
-    GL_UNSIGNED_BYTE
+    GL_UNSIGNED_BYTE,
+#ifndef GL_ES_VERSION_2_0
+    GL_HALF_FLOAT_ARB,
+#else
+    GL_HALF_FLOAT_OES,
+#endif
+    GL_SHORT
 };
 
 static const unsigned glElementComponents[] =
@@ -239,6 +245,8 @@ static const unsigned glElementComponents[] =
     3,
     4,
     4,
+    4,
+    2,
     4
 };
 
@@ -2754,6 +2762,7 @@ void Graphics::CheckFeatureSupport()
         anisotropySupport_ = true;
         sRGBSupport_ = true;
         sRGBWriteSupport_ = true;
+        halfFloatVertexSupport_ = true;
 
         glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS, &numSupportedRTs);
     }
@@ -2764,6 +2773,7 @@ void Graphics::CheckFeatureSupport()
         anisotropySupport_ = GLEW_EXT_texture_filter_anisotropic != 0;
         sRGBSupport_ = GLEW_EXT_texture_sRGB != 0;
         sRGBWriteSupport_ = GLEW_EXT_framebuffer_sRGB != 0;
+        halfFloatVertexSupport_ = GLEW_ARB_half_float_vertex != 0;
 
         glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS_EXT, &numSupportedRTs);
     }
@@ -2799,6 +2809,9 @@ void Graphics::CheckFeatureSupport()
     pvrtcTextureSupport_ = CheckExtension("IMG_texture_compression_pvrtc");
 #endif
 
+    // Half float vertex data is an extension in OpenGL ES 2.0 and WebGL 1
+    halfFloatVertexSupport_ = CheckExtension("OES_vertex_half_float");
+
     // Check for best supported depth renderbuffer format for GLES2
     if (CheckExtension("GL_OES_depth24"))
         glesDepthStencilFormat = GL_DEPTH_COMPONENT24_OES;
@@ -3121,7 +3134,8 @@ void Graphics::PrepareDraw()
 
                     SetVBO(buffer->GetGPUObjectName());
                     glVertexAttribPointer(location, glElementComponents[element.type_], glElementTypes[element.type_],
-                        element.type_ == TYPE_UBYTE4_NORM ? GL_TRUE : GL_FALSE, (unsigned)buffer->GetVertexSize(),
+                        element.type_ == TYPE_UBYTE4_NORM || element.type_ == TYPE_SHORT4_NORM ? GL_TRUE : GL_FALSE,
+                        (unsigned)buffer->GetVertexSize(),
                         (const void *)(size_t)dataStart);
                 }
             }
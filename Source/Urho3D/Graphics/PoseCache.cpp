@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Timer.h"
+#include "../Graphics/PoseCache.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+PoseCache::PoseCache(Context* context) :
+    Object(context),
+    time_(GetSubsystem<Time>())
+{
+}
+
+PoseCache::~PoseCache()
+{
+    for (PODVector<SharedPose*>::Iterator i = poses_.Begin(); i != poses_.End(); ++i)
+        delete *i;
+}
+
+const SharedPose* PoseCache::GetPose(unsigned hash, const PODVector<unsigned>& key)
+{
+    MutexLock lock(mutex_);
+    CheckFrame();
+
+    HashMap<unsigned, unsigned>::ConstIterator i = poseIndices_.Find(hash);
+    if (i == poseIndices_.End())
+        return nullptr;
+
+    // On a hash collision the pose is not shared
+    const SharedPose* pose = poses_[i->second_];
+    return pose->key_ == key ? pose : nullptr;
+}
+
+void PoseCache::StorePose(unsigned hash, const PODVector<unsigned>& key, const PODVector<Vector3>& positions,
+    const PODVector<Quaternion>& rotations, const PODVector<Vector3>& scales, const PODVector<Matrix3x4>& transforms)
+{
+    MutexLock lock(mutex_);
+    CheckFrame();
+
+    if (poseIndices_.Contains(hash))
+        return;
+
+    if (numPoses_ == poses_.Size())
+        poses_.Push(new SharedPose());
+
+    SharedPose& pose = *poses_[numPoses_];
+    pose.key_ = key;
+    pose.positions_ = positions;
+    pose.rotations_ = rotations;
+    pose.scales_ = scales;
+    pose.transforms_ = transforms;
+    poseIndices_[hash] = numPoses_++;
+}
+
+void PoseCache::CheckFrame()
+{
+    unsigned frameNumber = time_ ? time_->GetFrameNumber() : 0;
+    if (frameNumber != frameNumber_)
+    {
+        poseIndices_.Clear();
+        numPoses_ = 0;
+        frameNumber_ = frameNumber;
+    }
+}
+
+}
@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Core/Mutex.h"
+#include "../Core/Object.h"
+#include "../Math/Matrix3x4.h"
+
+namespace Urho3D
+{
+
+class Time;
+
+/// Node-free skeleton pose stored in the pose cache.
+struct SharedPose
+{
+    /// Key describing the model and its animation states.
+    PODVector<unsigned> key_;
+    /// Bone positions relative to the parent bone.
+    PODVector<Vector3> positions_;
+    /// Bone rotations relative to the parent bone.
+    PODVector<Quaternion> rotations_;
+    /// Bone scales relative to the parent bone.
+    PODVector<Vector3> scales_;
+    /// Model-space bone transforms.
+    PODVector<Matrix3x4> transforms_;
+};
+
+/// %Pose cache subsystem. Shares the node-free poses of animated models that play the same animations at the same quantized time positions and weights during a frame.
+/// @nobind
+class URHO3D_API PoseCache : public Object
+{
+    URHO3D_OBJECT(PoseCache, Object);
+
+public:
+    /// Construct.
+    explicit PoseCache(Context* context);
+    /// Destruct.
+    ~PoseCache() override;
+
+    /// Return the pose stored during the current frame with a matching key, or null if none. The pose stays valid until the frame ends. Thread-safe.
+    const SharedPose* GetPose(unsigned hash, const PODVector<unsigned>& key);
+    /// Store a pose for the current frame. Does nothing if a pose with the same key hash is already stored. Thread-safe.
+    void StorePose(unsigned hash, const PODVector<unsigned>& key, const PODVector<Vector3>& positions,
+        const PODVector<Quaternion>& rotations, const PODVector<Vector3>& scales, const PODVector<Matrix3x4>& transforms);
+
+    /// Return number of poses stored during the current frame.
+    unsigned GetNumPoses() const { return numPoses_; }
+
+private:
+    /// Forget the poses of earlier frames. Called with the mutex locked.
+    void CheckFrame();
+
+    /// Poses. They are reused between frames rather than freed, so that their pointers stay valid during a frame.
+    PODVector<SharedPose*> poses_;
+    /// Indices of the poses of the current frame by key hash.
+    HashMap<unsigned, unsigned> poseIndices_;
+    /// Number of poses in use during the current frame.
+    unsigned numPoses_{};
+    /// Frame number the poses belong to.
+    unsigned frameNumber_{};
+    /// Time subsystem.
+    WeakPtr<Time> time_;
+    /// Mutex for the worker threads.
+    Mutex mutex_;
+};
+
+}
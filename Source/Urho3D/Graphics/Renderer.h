@@ -266,6 +266,9 @@ public:
     /// Set whether to thread occluder rendering. Default false.
     /// @property
     void SetThreadedOcclusion(bool enable);
+    /// Set whether views cache the octree queries of point and spot lights until a drawable in their volume changes. Default true.
+    /// @property
+    void SetCacheLightQueries(bool enable);
     /// Set shadow depth bias multiplier for mobile platforms to counteract possible worse shadow map precision. Default 1.0 (no effect).
     /// @property
     void SetMobileShadowBiasMul(float mul);
@@ -385,6 +388,10 @@ public:
     /// @property
     bool GetThreadedOcclusion() const { return threadedOcclusion_; }
 
+    /// Return whether views cache the octree queries of point and spot lights.
+    /// @property
+    bool GetCacheLightQueries() const { return cacheLightQueries_; }
+
     /// Return shadow depth bias multiplier for mobile platforms.
     /// @property
     float GetMobileShadowBiasMul() const { return mobileShadowBiasMul_; }
@@ -584,7 +591,7 @@ private:
     /// Current screen buffer allocations by resolution and format.
     HashMap<unsigned long long, unsigned> screenBufferAllocations_;
     /// Cache for light scissor queries.
-    HashMap<Pair<Light*, Camera*>, Rect> lightScissorCache_;
+    FlatHashMap<Pair<Light*, Camera*>, Rect> lightScissorCache_;
     /// Backbuffer viewports.
     Vector<SharedPtr<Viewport> > viewports_;
     /// Render surface viewports queued for update.
@@ -665,6 +672,8 @@ private:
     int numExtraInstancingBufferElements_{};
     /// Threaded occlusion rendering flag.
     bool threadedOcclusion_{};
+    /// Light query caching flag.
+    bool cacheLightQueries_{true};
     /// Shaders need reloading flag.
     bool shadersDirty_{true};
     /// Initialized flag.
@@ -29,6 +29,7 @@
 #include "../IO/Deserializer.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../Resource/ResourceCache.h"
 
 #include "../DebugNew.h"
@@ -161,24 +162,41 @@ bool Shader::ProcessSource(String& code, Deserializer& source)
 {
     auto* cache = GetSubsystem<ResourceCache>();
 
-    // If the source if a non-packaged file, store the timestamp
+    // If the source is a non-packaged file, store the timestamp. The source may also be the file contents read in
+    // advance by the background loader
     auto* file = dynamic_cast<File*>(&source);
-    if (file && !file->IsPackaged())
+    if (!file || !file->IsPackaged())
     {
         auto* fileSystem = GetSubsystem<FileSystem>();
-        String fullName = cache->GetResourceFileName(file->GetName());
-        unsigned fileTimeStamp = fileSystem->GetLastModifiedTime(fullName);
-        if (fileTimeStamp > timeStamp_)
-            timeStamp_ = fileTimeStamp;
+        String fullName = cache->GetResourceFileName(source.GetName());
+        if (!fullName.Empty())
+        {
+            unsigned fileTimeStamp = fileSystem->GetLastModifiedTime(fullName);
+            if (fileTimeStamp > timeStamp_)
+                timeStamp_ = fileTimeStamp;
+        }
     }
 
     // Store resource dependencies for includes so that we know to reload if any of them changes
     if (source.GetName() != GetName())
         cache->StoreResourceDependency(this, source.GetName());
 
-    while (!source.IsEof())
+    // Parse the text in place if the source is in memory, for example a memory-mapped file. Otherwise read it at once
+    // rather than byte by byte
+    unsigned dataSize = source.GetSize() - source.GetPosition();
+    const unsigned char* data = source.ReadInPlace(dataSize);
+    PODVector<unsigned char> buffer;
+    if (!data)
+    {
+        buffer.Resize(dataSize);
+        dataSize = source.Read(buffer.Buffer(), dataSize);
+        data = buffer.Buffer();
+    }
+
+    MemoryBuffer text(data, dataSize);
+    while (!text.IsEof())
     {
-        String line = source.ReadLine();
+        String line = text.ReadLine();
 
         if (line.StartsWith("#include"))
         {
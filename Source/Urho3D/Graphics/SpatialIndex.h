@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Container/RefCounted.h"
+#include "../Graphics/Drawable.h"
+
+namespace Urho3D
+{
+
+class DebugRenderer;
+class OctreeQuery;
+class RayOctreeQuery;
+
+/// Spatial index used by an Octree component to store and query its drawables.
+enum SpatialIndexType
+{
+    /// The octree's own octants.
+    SPATIAL_INDEX_OCTREE = 0,
+    /// Dynamic bounding volume hierarchy.
+    SPATIAL_INDEX_AABB_TREE,
+    /// An index set with Octree::SetSpatialIndex().
+    SPATIAL_INDEX_CUSTOM
+};
+
+/// Base class for spatial indices that an Octree component can store its drawables in instead of its octants. The octree keeps owning the drawables and calls the index from the main thread when they are added, moved or removed. The query functions may be called from worker threads concurrently, but never during the modifications.
+/// @nobind
+class URHO3D_API SpatialIndex : public RefCounted
+{
+public:
+    /// Sentinel for a drawable that has no proxy in the index.
+    static const unsigned NO_PROXY = M_MAX_UNSIGNED;
+
+    /// Add a drawable.
+    virtual void AddDrawable(Drawable* drawable) = 0;
+    /// Remove a drawable.
+    virtual void RemoveDrawable(Drawable* drawable) = 0;
+    /// Update a drawable after its world bounding box or occludee flag has changed.
+    virtual void UpdateDrawable(Drawable* drawable) = 0;
+    /// Remove all drawables.
+    virtual void Clear() = 0;
+    /// Add the drawables that pass an octree query to its result. The query's TestOctant() may be called with any box that contains the drawables being tested.
+    virtual void GetDrawables(OctreeQuery& query) const = 0;
+    /// Process a ray query on the drawables whose bounds the ray hits within the query's maximum distance. The results are not sorted.
+    virtual void Raycast(RayOctreeQuery& query) const = 0;
+    /// Return the drawables that match a ray query's flags and whose bounds the ray hits within the query's maximum distance, without processing them.
+    virtual void GetRaycastDrawables(RayOctreeQuery& query, PODVector<Drawable*>& drawables) const = 0;
+    /// Draw the index structure to the debug graphics.
+    virtual void DrawDebugGeometry(DebugRenderer* debug, bool depthTest) const { }
+
+protected:
+    /// Return the proxy of a drawable in this index.
+    static unsigned GetProxy(const Drawable* drawable) { return drawable->spatialIndexProxy_; }
+    /// Set the proxy of a drawable in this index.
+    static void SetProxy(Drawable* drawable, unsigned proxy) { drawable->spatialIndexProxy_ = proxy; }
+};
+
+}
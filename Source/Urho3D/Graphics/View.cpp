@@ -226,12 +226,34 @@ void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
     }
 }
 
-void ProcessLightWork(const WorkItem* item, unsigned threadIndex)
+void CombineSceneResultsWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* view = reinterpret_cast<View*>(item->aux_);
-    auto* query = reinterpret_cast<LightQueryResult*>(item->start_);
 
-    view->ProcessLight(*query, threadIndex);
+    view->CombineSceneResults();
+    view->PrepareLightQueries();
+    view->sceneResultsReady_.store(true, std::memory_order_release);
+}
+
+void ProcessLightsWork(const WorkItem* item, unsigned threadIndex)
+{
+    auto* view = reinterpret_cast<View*>(item->aux_);
+    FrameArena* arena = view->GetSubsystem<WorkQueue>()->GetFrameArena(threadIndex);
+
+    // Take one light at a time, as the cost per light varies a lot
+    for (;;)
+    {
+        unsigned index = view->nextLightQuery_++;
+        if (index >= view->lightQueryResults_.Size())
+            break;
+
+        // The results only need to live until the end of the frame, so allocate them from the thread's frame arena
+        LightQueryResult& query = view->lightQueryResults_[index];
+        query.litGeometries_.SetArena(arena);
+        query.shadowCasters_.SetArena(arena);
+        view->ProcessLight(query, threadIndex);
+        view->lightQueriesDone_[index].store(true, std::memory_order_release);
+    }
 }
 
 void UpdateDrawableGeometriesWork(const WorkItem* item, unsigned threadIndex)
@@ -252,29 +274,44 @@ void UpdateDrawableGeometriesWork(const WorkItem* item, unsigned threadIndex)
 void SortBatchQueueFrontToBackWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* queue = reinterpret_cast<BatchQueue*>(item->start_);
+    FrameArena* arena = reinterpret_cast<WorkQueue*>(item->aux_)->GetFrameArena(threadIndex);
 
-    queue->SortFrontToBack();
+    queue->SortFrontToBack(arena);
 }
 
 void SortBatchQueueBackToFrontWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* queue = reinterpret_cast<BatchQueue*>(item->start_);
+    FrameArena* arena = reinterpret_cast<WorkQueue*>(item->aux_)->GetFrameArena(threadIndex);
 
-    queue->SortBackToFront();
+    queue->SortBackToFront(arena);
 }
 
 void SortLightQueueWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* start = reinterpret_cast<LightBatchQueue*>(item->start_);
-    start->litBaseBatches_.SortFrontToBack();
-    start->litBatches_.SortFrontToBack();
+    FrameArena* arena = reinterpret_cast<WorkQueue*>(item->aux_)->GetFrameArena(threadIndex);
+    start->litBaseBatches_.SortFrontToBack(arena);
+    start->litBatches_.SortFrontToBack(arena);
 }
 
 void SortShadowQueueWork(const WorkItem* item, unsigned threadIndex)
 {
     auto* start = reinterpret_cast<LightBatchQueue*>(item->start_);
+    FrameArena* arena = reinterpret_cast<WorkQueue*>(item->aux_)->GetFrameArena(threadIndex);
     for (unsigned i = 0; i < start->shadowSplits_.Size(); ++i)
-        start->shadowSplits_[i].shadowBatches_.SortFrontToBack();
+        start->shadowSplits_[i].shadowBatches_.SortFrontToBack(arena);
+}
+
+/// Return whether two frustums have the same vertices.
+static bool IsSameFrustum(const Frustum& lhs, const Frustum& rhs)
+{
+    for (unsigned i = 0; i < NUM_FRUSTUM_VERTICES; ++i)
+    {
+        if (lhs.vertices_[i] != rhs.vertices_[i])
+            return false;
+    }
+    return true;
 }
 
 StringHash ParseTextureTypeXml(ResourceCache* cache, const String& filename);
@@ -496,6 +533,7 @@ bool View::Define(RenderSurface* renderTarget, Viewport* viewport)
     materialQuality_ = renderer_->GetMaterialQuality();
     maxOccluderTriangles_ = renderer_->GetMaxOccluderTriangles();
     minInstances_ = renderer_->GetMinInstances();
+    cacheLightQueries_ = renderer_->GetCacheLightQueries();
 
     // Set possible quality overrides from the camera
     // Note that the culling camera is used here (its settings are authoritative) while the render camera
@@ -530,6 +568,7 @@ void View::Update(const FrameInfo& frame)
 
     SendViewEvent(E_BEGINVIEWUPDATE);
 
+    frameArena_ = GetSubsystem<WorkQueue>()->GetFrameArena(0);
     int maxSortedInstances = renderer_->GetMaxSortedInstances();
 
     // Clear buffers, geometry, light, occluder & batch list
@@ -894,7 +933,29 @@ void View::GetDrawables()
             result.maxZ_ = 0.0f;
         }
 
+        // Combine the results as a continuation of the visibility checks, so that it runs on whichever thread finishes last.
+        // The visible lights are then processed as continuations of the combine. ProcessLights() only waits for the combine,
+        // and GetLightBatches() for each light when it gets to it
+        sceneResultsReady_ = false;
+        SharedPtr<WorkItem> combineItem = queue->GetFreeItem();
+        combineItem->priority_ = M_MAX_UNSIGNED;
+        combineItem->workFunction_ = CombineSceneResultsWork;
+        combineItem->aux_ = this;
+
         int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
+
+        Vector<SharedPtr<WorkItem> > lightItems;
+        nextLightQuery_ = 0;
+        for (int i = 0; i < numWorkItems; ++i)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = ProcessLightsWork;
+            item->aux_ = this;
+            queue->AddDependency(item, combineItem);
+            lightItems.Push(item);
+        }
+
         int drawablesPerItem = tempDrawables.Size() / numWorkItems;
 
         PODVector<Drawable*>::Iterator start = tempDrawables.Begin();
@@ -912,14 +973,20 @@ void View::GetDrawables()
 
             item->start_ = &(*start);
             item->end_ = &(*end);
+            queue->AddDependency(combineItem, item);
             queue->AddWorkItem(item);
 
             start = end;
         }
 
-        queue->Complete(M_MAX_UNSIGNED);
+        queue->AddWorkItem(combineItem);
+        for (unsigned i = 0; i < lightItems.Size(); ++i)
+            queue->AddWorkItem(lightItems[i]);
     }
+}
 
+void View::CombineSceneResults()
+{
     // Combine lights, geometries & scene Z range from the threads
     geometries_.Clear();
     lights_.Clear();
@@ -966,6 +1033,8 @@ void View::GetBatches()
     if (!octree_ || !cullCamera_)
         return;
 
+    URHO3D_PROFILE(GetBatches);
+
     nonThreadedGeometries_.Clear();
     threadedGeometries_.Clear();
 
@@ -974,30 +1043,69 @@ void View::GetBatches()
     GetBaseBatches();
 }
 
-void View::ProcessLights()
+void View::PrepareLightQueries()
 {
-    // Process lit geometries and shadow casters for each light
-    URHO3D_PROFILE(ProcessLights);
-
-    auto* queue = GetSubsystem<WorkQueue>();
     lightQueryResults_.Resize(lights_.Size());
 
+    if (lightQueriesDoneSize_ < lights_.Size())
+    {
+        lightQueriesDoneSize_ = lights_.Size();
+        lightQueriesDone_ = new std::atomic<bool>[lightQueriesDoneSize_];
+    }
+    for (unsigned i = 0; i < lights_.Size(); ++i)
+        lightQueriesDone_[i].store(false, std::memory_order_relaxed);
+
     for (unsigned i = 0; i < lightQueryResults_.Size(); ++i)
     {
-        SharedPtr<WorkItem> item = queue->GetFreeItem();
-        item->priority_ = M_MAX_UNSIGNED;
-        item->workFunction_ = ProcessLightWork;
-        item->aux_ = this;
+        lightQueryResults_[i].light_ = lights_[i];
+        lightQueryResults_[i].cache_ = nullptr;
+    }
+
+    if (cacheLightQueries_)
+    {
+        // Create the caches first, as inserting may move the existing ones
+        for (unsigned i = 0; i < lights_.Size(); ++i)
+        {
+            if (lights_[i]->GetLightType() != LIGHT_DIRECTIONAL)
+                lightQueryCaches_[lights_[i]];
+        }
+        for (unsigned i = 0; i < lights_.Size(); ++i)
+        {
+            if (lights_[i]->GetLightType() != LIGHT_DIRECTIONAL)
+            {
+                LightQueryCache& cache = lightQueryCaches_[lights_[i]];
+                cache.lastUsed_ = frame_.frameNumber_;
+                lightQueryResults_[i].cache_ = &cache;
+            }
+        }
+    }
+    else
+        lightQueryCaches_.Clear();
+}
 
-        LightQueryResult& query = lightQueryResults_[i];
-        query.light_ = lights_[i];
+void View::WaitForLightQuery(unsigned index)
+{
+    if (!lightQueriesDone_[index].load(std::memory_order_acquire))
+    {
+        URHO3D_PROFILE(WaitForLightQuery);
 
-        item->start_ = &query;
-        queue->AddWorkItem(item);
+        GetSubsystem<WorkQueue>()->CompleteUntil(M_MAX_UNSIGNED, [this, index]()
+        {
+            return lightQueriesDone_[index].load(std::memory_order_acquire);
+        });
     }
+}
 
-    // Ensure all lights have been processed before proceeding
-    queue->Complete(M_MAX_UNSIGNED);
+void View::ProcessLights()
+{
+    // Lit geometries and shadow casters of each light are found in the work items chained after the visibility checks.
+    // Only wait for the combined results here, and let the light work items run while the light queues are built
+    URHO3D_PROFILE(ProcessLights);
+
+    GetSubsystem<WorkQueue>()->CompleteUntil(M_MAX_UNSIGNED, [this]()
+    {
+        return sceneResultsReady_.load(std::memory_order_acquire);
+    });
 }
 
 void View::GetLightBatches()
@@ -1008,12 +1116,13 @@ void View::GetLightBatches()
     {
         URHO3D_PROFILE(GetLightBatches);
 
-        // Preallocate light queues: per-pixel lights which have lit geometries
+        // Preallocate light queues for the per-pixel lights, as they are referred to by pointer. The lights without lit
+        // geometries are only known once their queries have been processed, so the unused queues are removed afterward
         unsigned numLightQueues = 0;
         unsigned usedLightQueues = 0;
         for (Vector<LightQueryResult>::ConstIterator i = lightQueryResults_.Begin(); i != lightQueryResults_.End(); ++i)
         {
-            if (!i->light_->GetPerVertex() && i->litGeometries_.Size())
+            if (!i->light_->GetPerVertex())
                 ++numLightQueues;
         }
 
@@ -1021,9 +1130,11 @@ void View::GetLightBatches()
         maxLightsDrawables_.Clear();
         auto maxSortedInstances = (unsigned)renderer_->GetMaxSortedInstances();
 
-        for (Vector<LightQueryResult>::Iterator i = lightQueryResults_.Begin(); i != lightQueryResults_.End(); ++i)
+        for (unsigned i = 0; i < lightQueryResults_.Size(); ++i)
         {
-            LightQueryResult& query = *i;
+            // Wait only for this light's query, so that the remaining lights are processed while its batches are generated
+            WaitForLightQuery(i);
+            LightQueryResult& query = lightQueryResults_[i];
 
             // If light has no affected geometries, no need to process further
             if (query.litGeometries_.Empty())
@@ -1080,59 +1191,43 @@ void View::GetLightBatches()
                     shadowQueue.shadowViewport_ = GetShadowMapViewport(light, j, lightQueue.shadowMap_);
                     FinalizeShadowCamera(shadowCamera, light, shadowQueue.shadowViewport_, query.shadowCasterBox_[j]);
 
-                    // Loop through shadow casters
-                    for (PODVector<Drawable*>::ConstIterator k = query.shadowCasters_.Begin() + query.shadowCasterBegin_[j];
-                         k < query.shadowCasters_.Begin() + query.shadowCasterEnd_[j]; ++k)
-                    {
-                        Drawable* drawable = *k;
-                        // If drawable is not in actual view frustum, mark it in view here and check its geometry update type
-                        if (!drawable->IsInView(frame_, true))
-                        {
-                            drawable->MarkInView(frame_.frameNumber_);
-                            UpdateGeometryType type = drawable->GetUpdateGeometryType();
-                            if (type == UPDATE_MAIN_THREAD)
-                                nonThreadedGeometries_.Push(drawable);
-                            else if (type == UPDATE_WORKER_THREAD)
-                                threadedGeometries_.Push(drawable);
-                        }
-
-                        const Vector<SourceBatch>& batches = drawable->GetBatches();
-
-                        for (unsigned l = 0; l < batches.Size(); ++l)
+                    // Get shadow caster batches
+                    Drawable* const* casters = query.shadowCasters_.Buffer() + query.shadowCasterBegin_[j];
+                    unsigned numCasters = query.shadowCasterEnd_[j] - query.shadowCasterBegin_[j];
+                    if (!GenerateBatches(casters, numCasters, [this, &shadowQueue](Drawable* drawable, BatchGenerationResult* result)
                         {
-                            const SourceBatch& srcBatch = batches[l];
-
-                            Technique* tech = GetTechnique(drawable, srcBatch.material_);
-                            if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
-                                continue;
-
-                            Pass* pass = tech->GetSupportedPass(Technique::shadowPassIndex);
-                            // Skip if material has no shadow pass
-                            if (!pass)
-                                continue;
-
-                            Batch destBatch(srcBatch);
-                            destBatch.pass_ = pass;
-                            destBatch.zone_ = nullptr;
-
-                            AddBatchToQueue(shadowQueue.shadowBatches_, destBatch, tech);
-                        }
+                            GetShadowBatches(drawable, shadowQueue, result);
+                        }))
+                    {
+                        for (unsigned k = 0; k < numCasters; ++k)
+                            GetShadowBatches(casters[k], shadowQueue, nullptr);
                     }
                 }
 
                 // Process lit geometries
-                for (PODVector<Drawable*>::ConstIterator j = query.litGeometries_.Begin(); j != query.litGeometries_.End(); ++j)
+                litBatchDrawables_.Clear();
+                for (FrameVector<Drawable*>::ConstIterator j = query.litGeometries_.Begin(); j != query.litGeometries_.End(); ++j)
                 {
                     Drawable* drawable = *j;
                     drawable->AddLight(light);
 
                     // If drawable limits maximum lights, only record the light, and check maximum count / build batches later
                     if (!drawable->GetMaxLights())
-                        GetLitBatches(drawable, lightQueue, alphaQueue);
+                        litBatchDrawables_.Push(drawable);
                     else
                         maxLightsDrawables_.Insert(drawable);
                 }
 
+                if (!GenerateBatches(litBatchDrawables_.Buffer(), litBatchDrawables_.Size(),
+                    [this, &lightQueue, alphaQueue](Drawable* drawable, BatchGenerationResult* result)
+                    {
+                        GetLitBatches(drawable, lightQueue, alphaQueue, result);
+                    }))
+                {
+                    for (PODVector<Drawable*>::ConstIterator j = litBatchDrawables_.Begin(); j != litBatchDrawables_.End(); ++j)
+                        GetLitBatches(*j, lightQueue, alphaQueue);
+                }
+
                 // In deferred modes, store the light volume batch now. Since light mask 8 lowest bits are output to the stencil,
                 // lights that have all zeroes in the low 8 bits can be skipped; they would not affect geometry anyway
                 if (deferred_ && (light->GetLightMask() & 0xffu) != 0)
@@ -1157,13 +1252,27 @@ void View::GetLightBatches()
             else
             {
                 // Add the vertex light to lit drawables. It will be processed later during base pass batch generation
-                for (PODVector<Drawable*>::ConstIterator j = query.litGeometries_.Begin(); j != query.litGeometries_.End(); ++j)
+                for (FrameVector<Drawable*>::ConstIterator j = query.litGeometries_.Begin(); j != query.litGeometries_.End(); ++j)
                 {
                     Drawable* drawable = *j;
                     drawable->AddVertexLight(light);
                 }
             }
         }
+
+        lightQueues_.Resize(usedLightQueues);
+    }
+
+    // All light queries have been processed now. Forget the caches of lights which went out of view once there are enough of them
+    if (lightQueryCaches_.Size() > 2 * lights_.Size())
+    {
+        for (auto i = lightQueryCaches_.Begin(); i != lightQueryCaches_.End();)
+        {
+            if (i->second_.lastUsed_ != frame_.frameNumber_)
+                i = lightQueryCaches_.Erase(i);
+            else
+                ++i;
+        }
     }
 
     // Process drawables with limited per-pixel light count
@@ -1171,7 +1280,7 @@ void View::GetLightBatches()
     {
         URHO3D_PROFILE(GetMaxLightsBatches);
 
-        for (HashSet<Drawable*>::Iterator i = maxLightsDrawables_.Begin(); i != maxLightsDrawables_.End(); ++i)
+        for (FlatHashSet<Drawable*>::ConstIterator i = maxLightsDrawables_.Begin(); i != maxLightsDrawables_.End(); ++i)
         {
             Drawable* drawable = *i;
             drawable->LimitLights();
@@ -1193,6 +1302,20 @@ void View::GetBaseBatches()
 {
     URHO3D_PROFILE(GetBaseBatches);
 
+    if (GenerateBatches(geometries_.Buffer(), geometries_.Size(), [this](Drawable* drawable, BatchGenerationResult* result)
+    {
+        if (result)
+        {
+            UpdateGeometryType type = drawable->GetUpdateGeometryType();
+            if (type == UPDATE_MAIN_THREAD)
+                result->nonThreadedGeometries_.Push(drawable);
+            else if (type == UPDATE_WORKER_THREAD)
+                result->threadedGeometries_.Push(drawable);
+        }
+        GetBaseBatches(drawable, result);
+    }))
+        return;
+
     for (PODVector<Drawable*>::ConstIterator i = geometries_.Begin(); i != geometries_.End(); ++i)
     {
         Drawable* drawable = *i;
@@ -1202,79 +1325,185 @@ void View::GetBaseBatches()
         else if (type == UPDATE_WORKER_THREAD)
             threadedGeometries_.Push(drawable);
 
-        const Vector<SourceBatch>& batches = drawable->GetBatches();
-        bool vertexLightsProcessed = false;
+        GetBaseBatches(drawable, nullptr);
+    }
+}
 
-        for (unsigned j = 0; j < batches.Size(); ++j)
-        {
-            const SourceBatch& srcBatch = batches[j];
+void View::GetBaseBatches(Drawable* drawable, BatchGenerationResult* result)
+{
+    // The vertex light queues are shared, so leave vertex lit drawables to the main thread
+    if (result && !drawable->GetVertexLights().Empty())
+    {
+        result->mainThreadDrawables_.Push(drawable);
+        return;
+    }
 
-            // Check here if the material refers to a rendertarget texture with camera(s) attached
-            // Only check this for backbuffer views (null rendertarget)
-            if (srcBatch.material_ && srcBatch.material_->GetAuxViewFrameNumber() != frame_.frameNumber_ && !renderTarget_)
+    const Vector<SourceBatch>& batches = drawable->GetBatches();
+    bool vertexLightsProcessed = false;
+
+    for (unsigned i = 0; i < batches.Size(); ++i)
+    {
+        const SourceBatch& srcBatch = batches[i];
+
+        // Check here if the material refers to a rendertarget texture with camera(s) attached
+        // Only check this for backbuffer views (null rendertarget)
+        if (srcBatch.material_ && srcBatch.material_->GetAuxViewFrameNumber() != frame_.frameNumber_ && !renderTarget_)
+        {
+            if (result)
+                result->auxViewMaterials_.Insert(srcBatch.material_);
+            else
                 CheckMaterialForAuxView(srcBatch.material_);
+        }
 
-            Technique* tech = GetTechnique(drawable, srcBatch.material_);
-            if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
+        Technique* tech = GetTechnique(drawable, srcBatch.material_);
+        if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
+            continue;
+
+        // Check each of the scene passes
+        for (unsigned j = 0; j < scenePasses_.Size(); ++j)
+        {
+            ScenePassInfo& info = scenePasses_[j];
+            // Skip forward base pass if the corresponding litbase pass already exists
+            if (info.passIndex_ == basePassIndex_ && i < 32 && drawable->HasBasePass(i))
                 continue;
 
-            // Check each of the scene passes
-            for (unsigned k = 0; k < scenePasses_.Size(); ++k)
-            {
-                ScenePassInfo& info = scenePasses_[k];
-                // Skip forward base pass if the corresponding litbase pass already exists
-                if (info.passIndex_ == basePassIndex_ && j < 32 && drawable->HasBasePass(j))
-                    continue;
+            Pass* pass = tech->GetSupportedPass(info.passIndex_);
+            if (!pass)
+                continue;
 
-                Pass* pass = tech->GetSupportedPass(info.passIndex_);
-                if (!pass)
-                    continue;
+            Batch destBatch(srcBatch);
+            destBatch.pass_ = pass;
+            destBatch.zone_ = GetZone(drawable);
+            destBatch.isBase_ = true;
+            destBatch.lightMask_ = (unsigned char)GetLightMask(drawable);
 
-                Batch destBatch(srcBatch);
-                destBatch.pass_ = pass;
-                destBatch.zone_ = GetZone(drawable);
-                destBatch.isBase_ = true;
-                destBatch.lightMask_ = (unsigned char)GetLightMask(drawable);
+            if (info.vertexLights_)
+            {
+                const PODVector<Light*>& drawableVertexLights = drawable->GetVertexLights();
+                if (drawableVertexLights.Size() && !vertexLightsProcessed)
+                {
+                    // Limit vertex lights. If this is a deferred opaque batch, remove converted per-pixel lights,
+                    // as they will be rendered as light volumes in any case, and drawing them also as vertex lights
+                    // would result in double lighting
+                    drawable->LimitVertexLights(deferred_ && destBatch.pass_->GetBlendMode() == BLEND_REPLACE);
+                    vertexLightsProcessed = true;
+                }
 
-                if (info.vertexLights_)
+                if (drawableVertexLights.Size())
                 {
-                    const PODVector<Light*>& drawableVertexLights = drawable->GetVertexLights();
-                    if (drawableVertexLights.Size() && !vertexLightsProcessed)
+                    // Find a vertex light queue. If not found, create new
+                    unsigned long long hash = GetVertexLightQueueHash(drawableVertexLights);
+                    HashMap<unsigned long long, LightBatchQueue>::Iterator k = vertexLightQueues_.Find(hash);
+                    if (k == vertexLightQueues_.End())
                     {
-                        // Limit vertex lights. If this is a deferred opaque batch, remove converted per-pixel lights,
-                        // as they will be rendered as light volumes in any case, and drawing them also as vertex lights
-                        // would result in double lighting
-                        drawable->LimitVertexLights(deferred_ && destBatch.pass_->GetBlendMode() == BLEND_REPLACE);
-                        vertexLightsProcessed = true;
+                        k = vertexLightQueues_.Insert(MakePair(hash, LightBatchQueue()));
+                        k->second_.light_ = nullptr;
+                        k->second_.shadowMap_ = nullptr;
+                        k->second_.vertexLights_ = drawableVertexLights;
                     }
 
-                    if (drawableVertexLights.Size())
-                    {
-                        // Find a vertex light queue. If not found, create new
-                        unsigned long long hash = GetVertexLightQueueHash(drawableVertexLights);
-                        HashMap<unsigned long long, LightBatchQueue>::Iterator i = vertexLightQueues_.Find(hash);
-                        if (i == vertexLightQueues_.End())
-                        {
-                            i = vertexLightQueues_.Insert(MakePair(hash, LightBatchQueue()));
-                            i->second_.light_ = nullptr;
-                            i->second_.shadowMap_ = nullptr;
-                            i->second_.vertexLights_ = drawableVertexLights;
-                        }
-
-                        destBatch.lightQueue_ = &(i->second_);
-                    }
+                    destBatch.lightQueue_ = &(k->second_);
                 }
-                else
-                    destBatch.lightQueue_ = nullptr;
+            }
+            else
+                destBatch.lightQueue_ = nullptr;
 
-                bool allowInstancing = info.allowInstancing_;
-                if (allowInstancing && info.markToStencil_ && destBatch.lightMask_ != (destBatch.zone_->GetLightMask() & 0xffu))
-                    allowInstancing = false;
+            bool allowInstancing = info.allowInstancing_;
+            if (allowInstancing && info.markToStencil_ && destBatch.lightMask_ != (destBatch.zone_->GetLightMask() & 0xffu))
+                allowInstancing = false;
 
-                AddBatchToQueue(*info.batchQueue_, destBatch, tech, allowInstancing);
-            }
+            AddBatch(result, *info.batchQueue_, destBatch, tech, allowInstancing);
+        }
+    }
+}
+
+void View::GetShadowBatches(Drawable* drawable, ShadowBatchQueue& shadowQueue, BatchGenerationResult* result)
+{
+    // If drawable is not in actual view frustum, mark it in view here and check its geometry update type
+    if (!drawable->IsInView(frame_, true))
+    {
+        drawable->MarkInView(frame_.frameNumber_);
+        UpdateGeometryType type = drawable->GetUpdateGeometryType();
+        if (type == UPDATE_MAIN_THREAD)
+            (result ? result->nonThreadedGeometries_ : nonThreadedGeometries_).Push(drawable);
+        else if (type == UPDATE_WORKER_THREAD)
+            (result ? result->threadedGeometries_ : threadedGeometries_).Push(drawable);
+    }
+
+    const Vector<SourceBatch>& batches = drawable->GetBatches();
+
+    for (unsigned i = 0; i < batches.Size(); ++i)
+    {
+        const SourceBatch& srcBatch = batches[i];
+
+        Technique* tech = GetTechnique(drawable, srcBatch.material_);
+        if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
+            continue;
+
+        Pass* pass = tech->GetSupportedPass(Technique::shadowPassIndex);
+        // Skip if material has no shadow pass
+        if (!pass)
+            continue;
+
+        Batch destBatch(srcBatch);
+        destBatch.pass_ = pass;
+        destBatch.zone_ = nullptr;
+
+        AddBatch(result, shadowQueue.shadowBatches_, destBatch, tech);
+    }
+}
+
+template <class T> bool View::GenerateBatches(Drawable* const* drawables, unsigned count, const T& function)
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (count < 2 * BATCH_GENERATION_GRAIN || !queue->GetNumThreads())
+        return false;
+
+    URHO3D_PROFILE(GenerateBatches);
+
+    // Split the drawables to fixed size work items, so that the merged result does not depend on the number of threads
+    unsigned numResults = (count + BATCH_GENERATION_GRAIN - 1) / BATCH_GENERATION_GRAIN;
+    if (batchResults_.Size() < numResults)
+        batchResults_.Resize(numResults);
+
+    queue->ParallelFor(0, numResults, 1, [this, queue, drawables, count, &function](unsigned index, unsigned threadIndex)
+    {
+        BatchGenerationResult& result = batchResults_[index];
+        result.numQueues_ = 0;
+        result.arena_ = queue->GetFrameArena(threadIndex);
+        result.mainThreadDrawables_.Clear();
+        result.auxViewMaterials_.Clear();
+        result.nonThreadedGeometries_.Clear();
+        result.threadedGeometries_.Clear();
+
+        unsigned end = Min((index + 1) * BATCH_GENERATION_GRAIN, count);
+        for (unsigned i = index * BATCH_GENERATION_GRAIN; i < end; ++i)
+            function(drawables[i], &result);
+    }, "GenerateBatchesWork");
+
+    URHO3D_PROFILE(MergeBatches);
+
+    for (unsigned i = 0; i < numResults; ++i)
+    {
+        BatchGenerationResult& result = batchResults_[i];
+
+        for (FlatHashSet<Material*>::ConstIterator j = result.auxViewMaterials_.Begin(); j != result.auxViewMaterials_.End(); ++j)
+        {
+            if ((*j)->GetAuxViewFrameNumber() != frame_.frameNumber_)
+                CheckMaterialForAuxView(*j);
         }
+
+        for (unsigned j = 0; j < result.numQueues_; ++j)
+            MergeWorkerBatchQueue(result.queues_[j]);
+
+        nonThreadedGeometries_.Push(result.nonThreadedGeometries_);
+        threadedGeometries_.Push(result.threadedGeometries_);
+
+        for (PODVector<Drawable*>::ConstIterator j = result.mainThreadDrawables_.Begin(); j != result.mainThreadDrawables_.End(); ++j)
+            function(*j, nullptr);
     }
+
+    return true;
 }
 
 void View::UpdateGeometries()
@@ -1305,6 +1534,7 @@ void View::UpdateGeometries()
                 item->workFunction_ =
                     command.sortMode_ == SORT_FRONTTOBACK ? SortBatchQueueFrontToBackWork : SortBatchQueueBackToFrontWork;
                 item->start_ = &batchQueues_[command.passIndex_];
+                item->aux_ = queue;
                 queue->AddWorkItem(item);
             }
         }
@@ -1315,6 +1545,7 @@ void View::UpdateGeometries()
             lightItem->priority_ = M_MAX_UNSIGNED;
             lightItem->workFunction_ = SortLightQueueWork;
             lightItem->start_ = &(*i);
+            lightItem->aux_ = queue;
             queue->AddWorkItem(lightItem);
 
             if (i->shadowSplits_.Size())
@@ -1323,6 +1554,7 @@ void View::UpdateGeometries()
                 shadowItem->priority_ = M_MAX_UNSIGNED;
                 shadowItem->workFunction_ = SortShadowQueueWork;
                 shadowItem->start_ = &(*i);
+                shadowItem->aux_ = queue;
                 queue->AddWorkItem(shadowItem);
             }
         }
@@ -1376,7 +1608,7 @@ void View::UpdateGeometries()
     geometriesUpdated_ = true;
 }
 
-void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue)
+void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue, BatchGenerationResult* result)
 {
     Light* light = lightQueue.light_;
     Zone* zone = GetZone(drawable);
@@ -1434,15 +1666,15 @@ void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQ
         if (!isLitAlpha)
         {
             if (destBatch.isBase_)
-                AddBatchToQueue(lightQueue.litBaseBatches_, destBatch, tech);
+                AddBatch(result, lightQueue.litBaseBatches_, destBatch, tech);
             else
-                AddBatchToQueue(lightQueue.litBatches_, destBatch, tech);
+                AddBatch(result, lightQueue.litBatches_, destBatch, tech);
         }
         else if (alphaQueue)
         {
             // Transparent batches can not be instanced, and shadows on transparencies can only be rendered if shadow maps are
             // not reused
-            AddBatchToQueue(*alphaQueue, destBatch, tech, false, !renderer_->GetReuseShadowMaps());
+            AddBatch(result, *alphaQueue, destBatch, tech, false, !renderer_->GetReuseShadowMaps());
         }
     }
 }
@@ -1750,7 +1982,7 @@ void View::SetRenderTargets(RenderPathCommand& command)
             {
                 useColorWrite = false;
                 useCustomDepth = true;
-#if !defined(URHO3D_OPENGL) && !defined(URHO3D_D3D11)
+#if !defined(URHO3D_OPENGL) && !defined(URHO3D_D3D11) && !defined(URHO3D_NULL_GRAPHICS)
                 // On D3D9 actual depth-only rendering is illegal, we need a color rendertarget
                 if (!depthOnlyDummyTexture_)
                 {
@@ -2305,27 +2537,13 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
         break;
 
     case LIGHT_SPOT:
-        {
-            FrustumOctreeQuery octreeQuery(tempDrawables, light->GetFrustum(), DRAWABLE_GEOMETRY,
-                cullCamera_->GetViewMask());
-            octree_->GetDrawables(octreeQuery);
-            for (unsigned i = 0; i < tempDrawables.Size(); ++i)
-            {
-                if (tempDrawables[i]->IsInView(frame_) && (GetLightMask(tempDrawables[i]) & lightMask))
-                    query.litGeometries_.Push(tempDrawables[i]);
-            }
-        }
-        break;
-
     case LIGHT_POINT:
         {
-            SphereOctreeQuery octreeQuery(tempDrawables, Sphere(light->GetNode()->GetWorldPosition(), light->GetRange()),
-                DRAWABLE_GEOMETRY, cullCamera_->GetViewMask());
-            octree_->GetDrawables(octreeQuery);
-            for (unsigned i = 0; i < tempDrawables.Size(); ++i)
+            const PODVector<Drawable*>& lightDrawables = GetLightDrawables(query, tempDrawables);
+            for (unsigned i = 0; i < lightDrawables.Size(); ++i)
             {
-                if (tempDrawables[i]->IsInView(frame_) && (GetLightMask(tempDrawables[i]) & lightMask))
-                    query.litGeometries_.Push(tempDrawables[i]);
+                if (lightDrawables[i]->IsInView(frame_) && (GetLightMask(lightDrawables[i]) & lightMask))
+                    query.litGeometries_.Push(lightDrawables[i]);
             }
         }
         break;
@@ -2367,7 +2585,33 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
         }
 
         // Check which shadow casters actually contribute to the shadowing
-        ProcessShadowCasters(query, tempDrawables, i);
+        if (query.cache_)
+        {
+            LightQueryCache& cache = *query.cache_;
+
+            // Point light splits have their own frustums, so find the geometries within them once
+            if (type == LIGHT_POINT)
+            {
+                if (!cache.splitValid_[i] || !IsSameFrustum(cache.splitFrustums_[i], shadowCameraFrustum))
+                {
+                    PODVector<Drawable*>& splitDrawables = cache.splitDrawables_[i];
+                    splitDrawables.Clear();
+                    for (PODVector<Drawable*>::ConstIterator j = cache.drawables_.Begin(); j != cache.drawables_.End(); ++j)
+                    {
+                        if (shadowCameraFrustum.IsInsideFast((*j)->GetWorldBoundingBox()) != OUTSIDE)
+                            splitDrawables.Push(*j);
+                    }
+                    cache.splitFrustums_[i] = shadowCameraFrustum;
+                    cache.splitValid_[i] = true;
+                }
+
+                ProcessShadowCasters(query, cache.splitDrawables_[i], i, false);
+            }
+            else
+                ProcessShadowCasters(query, cache.drawables_, i);
+        }
+        else
+            ProcessShadowCasters(query, tempDrawables, i);
     }
 
     // If no shadow casters, the light can be rendered unshadowed. At this point we have not allocated a shadow map yet, so the
@@ -2376,10 +2620,81 @@ void View::ProcessLight(LightQueryResult& query, unsigned threadIndex)
         query.numSplits_ = 0;
 }
 
-void View::ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawable*>& drawables, unsigned splitIndex)
+const PODVector<Drawable*>& View::GetLightDrawables(LightQueryResult& query, PODVector<Drawable*>& tempDrawables)
+{
+    Light* light = query.light_;
+    LightType type = light->GetLightType();
+    LightQueryCache* cache = query.cache_;
+
+    if (!cache)
+    {
+        if (type == LIGHT_SPOT)
+        {
+            FrustumOctreeQuery octreeQuery(tempDrawables, light->GetFrustum(), DRAWABLE_GEOMETRY, cullCamera_->GetViewMask());
+            octree_->GetDrawables(octreeQuery);
+        }
+        else
+        {
+            SphereOctreeQuery octreeQuery(tempDrawables, Sphere(light->GetNode()->GetWorldPosition(), light->GetRange()),
+                DRAWABLE_GEOMETRY, cullCamera_->GetViewMask());
+            octree_->GetDrawables(octreeQuery);
+        }
+        return tempDrawables;
+    }
+
+    // Reuse the previous query unless the light's volume has changed, or a drawable has been added, removed or moved within it
+    Sphere sphere;
+    Frustum frustum;
+    BoundingBox volumeBox;
+    bool sameVolume = cache->valid_ && cache->light_ == light && cache->octree_ == octree_ && cache->type_ == type;
+    if (type == LIGHT_SPOT)
+    {
+        frustum = light->GetFrustum();
+        volumeBox.Define(frustum);
+        sameVolume = sameVolume && IsSameFrustum(cache->frustum_, frustum);
+    }
+    else
+    {
+        sphere.Define(light->GetNode()->GetWorldPosition(), light->GetRange());
+        volumeBox.Define(sphere);
+        sameVolume = sameVolume && cache->sphere_ == sphere;
+    }
+
+    if (!sameVolume || octree_->HasChanged(cache->changeSerial_, volumeBox))
+    {
+        // Query regardless of the view mask, so that the result can be shared by cameras with different masks. The view mask
+        // is checked when processing the shadow casters, and lit geometries have passed it already by being in view
+        if (type == LIGHT_SPOT)
+        {
+            FrustumOctreeQuery octreeQuery(cache->drawables_, frustum, DRAWABLE_GEOMETRY);
+            octree_->GetDrawables(octreeQuery);
+        }
+        else
+        {
+            SphereOctreeQuery octreeQuery(cache->drawables_, sphere, DRAWABLE_GEOMETRY);
+            octree_->GetDrawables(octreeQuery);
+        }
+
+        cache->light_ = light;
+        cache->octree_ = octree_;
+        cache->type_ = type;
+        cache->sphere_ = sphere;
+        cache->frustum_ = frustum;
+        for (bool& splitValid : cache->splitValid_)
+            splitValid = false;
+        cache->valid_ = true;
+    }
+
+    cache->changeSerial_ = octree_->GetChangeSerial();
+    return cache->drawables_;
+}
+
+void View::ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawable*>& drawables, unsigned splitIndex,
+    bool checkSplitFrustum)
 {
     Light* light = query.light_;
     unsigned lightMask = light->GetLightMask();
+    unsigned viewMask = cullCamera_->GetViewMask();
 
     Camera* shadowCamera = query.shadowCameras_[splitIndex];
     const Frustum& shadowCameraFrustum = shadowCamera->GetFrustum();
@@ -2418,8 +2733,11 @@ void View::ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawabl
         // Check shadow mask
         if (!(GetShadowMask(drawable) & lightMask))
             continue;
+        // Check view mask in case this is a cached query result
+        if (!(drawable->GetViewMask() & viewMask))
+            continue;
         // For point light, check that this drawable is inside the split shadow camera frustum
-        if (type == LIGHT_POINT && shadowCameraFrustum.IsInsideFast(drawable->GetWorldBoundingBox()) == OUTSIDE)
+        if (checkSplitFrustum && type == LIGHT_POINT && shadowCameraFrustum.IsInsideFast(drawable->GetWorldBoundingBox()) == OUTSIDE)
             continue;
 
         // Check shadow distance
@@ -2907,12 +3225,13 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
     {
         BatchGroupKey key(batch);
 
-        HashMap<BatchGroupKey, BatchGroup>::Iterator i = queue.batchGroups_.Find(key);
+        FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = queue.batchGroups_.Find(key);
         if (i == queue.batchGroups_.End())
         {
             // Create a new group based on the batch
             // In case the group remains below the instancing limit, do not enable instancing shaders yet
             BatchGroup newGroup(batch);
+            newGroup.instances_.SetArena(frameArena_);
             newGroup.geometryType_ = GEOM_STATIC;
             renderer_->SetBatchShaders(newGroup, tech, allowShadows, queue);
             newGroup.CalculateSortKey();
@@ -2951,6 +3270,111 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
     }
 }
 
+void View::AddBatch(BatchGenerationResult* result, BatchQueue& queue, Batch& batch, Technique* tech, bool allowInstancing,
+    bool allowShadows)
+{
+    if (!result)
+    {
+        AddBatchToQueue(queue, batch, tech, allowInstancing, allowShadows);
+        return;
+    }
+
+    // Find the worker batch queue. There are only a few queues per work item, so search linearly
+    WorkerBatchQueue* workerQueue = nullptr;
+    for (unsigned i = 0; i < result->numQueues_; ++i)
+    {
+        WorkerBatchQueue& candidate = result->queues_[i];
+        if (candidate.queue_ == &queue && candidate.allowShadows_ == allowShadows)
+        {
+            workerQueue = &candidate;
+            break;
+        }
+    }
+
+    if (!workerQueue)
+    {
+        if (result->queues_.Size() <= result->numQueues_)
+            result->queues_.Resize(result->numQueues_ + 1);
+        workerQueue = &result->queues_[result->numQueues_++];
+        workerQueue->queue_ = &queue;
+        workerQueue->allowShadows_ = allowShadows;
+        workerQueue->batchGroups_.Clear();
+        workerQueue->groupTechniques_.Clear();
+        workerQueue->batches_.Clear();
+        workerQueue->batchTechniques_.Clear();
+    }
+
+    AddBatchToWorkerQueue(*workerQueue, batch, tech, allowInstancing, result->arena_);
+}
+
+void View::AddBatchToWorkerQueue(WorkerBatchQueue& queue, Batch& batch, Technique* tech, bool allowInstancing, FrameArena* arena)
+{
+    if (!batch.material_)
+        batch.material_ = renderer_->GetDefaultMaterial();
+
+    // Convert to instanced if possible
+    if (allowInstancing && batch.geometryType_ == GEOM_STATIC && batch.geometry_->GetIndexBuffer())
+        batch.geometryType_ = GEOM_INSTANCED;
+
+    if (batch.geometryType_ == GEOM_INSTANCED)
+    {
+        BatchGroupKey key(batch);
+
+        FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = queue.batchGroups_.Find(key);
+        if (i == queue.batchGroups_.End())
+        {
+            BatchGroup newGroup(batch);
+            newGroup.instances_.SetArena(arena);
+            i = queue.batchGroups_.Insert(MakePair(key, newGroup));
+            queue.groupTechniques_.Push(tech);
+        }
+
+        i->second_.AddTransforms(batch);
+    }
+    else
+    {
+        queue.batches_.Push(batch);
+        queue.batchTechniques_.Push(tech);
+    }
+}
+
+void View::MergeWorkerBatchQueue(WorkerBatchQueue& queue)
+{
+    BatchQueue& destQueue = *queue.queue_;
+
+    // The groups are iterated in insertion order, so they are created and filled in the same order as without threading
+    unsigned index = 0;
+    for (FlatHashMap<BatchGroupKey, BatchGroup>::Iterator i = queue.batchGroups_.Begin(); i != queue.batchGroups_.End(); ++i, ++index)
+    {
+        Technique* tech = queue.groupTechniques_[index];
+
+        FlatHashMap<BatchGroupKey, BatchGroup>::Iterator j = destQueue.batchGroups_.Find(i->first_);
+        if (j == destQueue.batchGroups_.End())
+        {
+            // In case the group remains below the instancing limit, do not enable instancing shaders yet
+            BatchGroup newGroup(static_cast<const Batch&>(i->second_));
+            newGroup.instances_.SetArena(frameArena_);
+            newGroup.geometryType_ = GEOM_STATIC;
+            renderer_->SetBatchShaders(newGroup, tech, queue.allowShadows_, destQueue);
+            newGroup.CalculateSortKey();
+            j = destQueue.batchGroups_.Insert(MakePair(i->first_, newGroup));
+        }
+
+        int oldSize = j->second_.instances_.Size();
+        j->second_.instances_.Push(i->second_.instances_);
+        // Convert to using instancing shaders when the instancing limit is reached
+        if (oldSize < minInstances_ && (int)j->second_.instances_.Size() >= minInstances_)
+        {
+            j->second_.geometryType_ = GEOM_INSTANCED;
+            renderer_->SetBatchShaders(j->second_, tech, queue.allowShadows_, destQueue);
+            j->second_.CalculateSortKey();
+        }
+    }
+
+    for (unsigned i = 0; i < queue.batches_.Size(); ++i)
+        AddBatchToQueue(destQueue, queue.batches_[i], queue.batchTechniques_[i], false, queue.allowShadows_);
+}
+
 void View::PrepareInstancingBuffer()
 {
     // Prepare instancing buffer from the source view
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include "../Container/ArrayPtr.h"
+#include "../Container/FlatHashSet.h"
 #include "../Container/HashSet.h"
 #include "../Container/List.h"
 #include "../Core/Object.h"
@@ -30,6 +32,8 @@
 #include "../Graphics/Zone.h"
 #include "../Math/Polyhedron.h"
 
+#include <atomic>
+
 namespace Urho3D
 {
 
@@ -51,15 +55,44 @@ class Zone;
 struct RenderPathCommand;
 struct WorkItem;
 
+/// Octree query results of a point or spot light, reused while neither the light nor the drawables within its volume change.
+struct LightQueryCache
+{
+    /// Light. Compared as a weak pointer, so that a new light at the same address is not mistaken for it.
+    WeakPtr<Light> light_;
+    /// Octree queried.
+    Octree* octree_{};
+    /// Light type.
+    LightType type_{};
+    /// Point light volume.
+    Sphere sphere_;
+    /// Spot light volume.
+    Frustum frustum_;
+    /// Geometries within the light volume, regardless of view mask.
+    PODVector<Drawable*> drawables_;
+    /// Shadow camera frustums of the point light splits.
+    Frustum splitFrustums_[MAX_LIGHT_SPLITS];
+    /// Geometries within each point light split.
+    PODVector<Drawable*> splitDrawables_[MAX_LIGHT_SPLITS];
+    /// Whether the geometries of each point light split have been found.
+    bool splitValid_[MAX_LIGHT_SPLITS]{};
+    /// Octree change serial when last used.
+    unsigned changeSerial_{};
+    /// Frame number when last used.
+    unsigned lastUsed_{};
+    /// Whether has been queried.
+    bool valid_{};
+};
+
 /// Intermediate light processing result.
 struct LightQueryResult
 {
     /// Light.
     Light* light_;
-    /// Lit geometries.
-    PODVector<Drawable*> litGeometries_;
-    /// Shadow casters.
-    PODVector<Drawable*> shadowCasters_;
+    /// Lit geometries. Allocated from the frame arena of the processing thread.
+    FrameVector<Drawable*> litGeometries_;
+    /// Shadow casters. Allocated from the frame arena of the processing thread.
+    FrameVector<Drawable*> shadowCasters_;
     /// Shadow cameras.
     Camera* shadowCameras_[MAX_LIGHT_SPLITS];
     /// Shadow caster start indices.
@@ -74,6 +107,8 @@ struct LightQueryResult
     float shadowFarSplits_[MAX_LIGHT_SPLITS];
     /// Shadow map split count.
     unsigned numSplits_;
+    /// Cached octree query results, or null if not caching.
+    LightQueryCache* cache_;
 };
 
 /// Scene render pass info.
@@ -91,6 +126,42 @@ struct ScenePassInfo
     BatchQueue* batchQueue_;
 };
 
+/// Batches added by a worker thread for one batch queue. Their shaders are chosen when they are merged to the queue in the main thread.
+struct WorkerBatchQueue
+{
+    /// Batch queue to merge to.
+    BatchQueue* queue_{};
+    /// Whether the batches may receive shadows.
+    bool allowShadows_{};
+    /// Instanced draw calls without shaders.
+    FlatHashMap<BatchGroupKey, BatchGroup> batchGroups_;
+    /// Techniques of the instanced draw calls.
+    PODVector<Technique*> groupTechniques_;
+    /// Non-instanced draw calls without shaders.
+    PODVector<Batch> batches_;
+    /// Techniques of the non-instanced draw calls.
+    PODVector<Technique*> batchTechniques_;
+};
+
+/// Batches and drawables collected by one work item of batch generation. Merged to the view in work item order, so that the batch queues do not depend on thread scheduling.
+struct BatchGenerationResult
+{
+    /// Worker batch queues. Only the first numQueues_ are in use.
+    Vector<WorkerBatchQueue> queues_;
+    /// Number of worker batch queues in use.
+    unsigned numQueues_{};
+    /// Frame arena of the thread generating the batches.
+    FrameArena* arena_{};
+    /// Drawables whose batches must be generated in the main thread.
+    PODVector<Drawable*> mainThreadDrawables_;
+    /// Materials to check for auxiliary views.
+    FlatHashSet<Material*> auxViewMaterials_;
+    /// Geometry objects that will be updated in the main thread.
+    PODVector<Drawable*> nonThreadedGeometries_;
+    /// Geometry objects that will be updated in worker threads.
+    PODVector<Drawable*> threadedGeometries_;
+};
+
 /// Per-thread geometry, light and scene range collection structure.
 struct PerThreadSceneResult
 {
@@ -105,12 +176,15 @@ struct PerThreadSceneResult
 };
 
 static const unsigned MAX_VIEWPORT_TEXTURES = 2;
+/// Number of drawables per work item when generating batches in worker threads. Smaller sets are processed in the main thread.
+static const unsigned BATCH_GENERATION_GRAIN = 1024;
 
 /// Internal structure for 3D rendering work. Created for each backbuffer and texture viewport, but not for shadow cameras.
 class URHO3D_API View : public Object
 {
     friend void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex);
-    friend void ProcessLightWork(const WorkItem* item, unsigned threadIndex);
+    friend void CombineSceneResultsWork(const WorkItem* item, unsigned threadIndex);
+    friend void ProcessLightsWork(const WorkItem* item, unsigned threadIndex);
 
     URHO3D_OBJECT(View, Object);
 
@@ -198,18 +272,30 @@ public:
 private:
     /// Query the octree for drawable objects.
     void GetDrawables();
+    /// Combine lights, geometries and scene Z range from the per-thread visibility check results, and sort the lights.
+    void CombineSceneResults();
     /// Construct batches from the drawable objects.
     void GetBatches();
-    /// Get lit geometries and shadowcasters for visible lights.
+    /// Set up the light processing results and caches for the visible lights.
+    void PrepareLightQueries();
+    /// Wait for a light query to be processed, helping with queued work in the meanwhile.
+    void WaitForLightQuery(unsigned index);
+    /// Wait until the visibility check results have been combined. The lit geometries and shadowcasters of the visible lights are found in work items that may still be running.
     void ProcessLights();
     /// Get batches from lit geometries and shadowcasters.
     void GetLightBatches();
     /// Get unlit batches.
     void GetBaseBatches();
+    /// Get unlit batches for a drawable. If a worker thread's result is given, add them to it instead of the batch queues.
+    void GetBaseBatches(Drawable* drawable, BatchGenerationResult* result);
+    /// Get shadow batches for a shadow caster. If a worker thread's result is given, add them to it instead of the batch queues.
+    void GetShadowBatches(Drawable* drawable, ShadowBatchQueue& shadowQueue, BatchGenerationResult* result);
+    /// Generate batches for drawables in worker threads and merge the results in order. The function is called as function(drawable, result) in the worker threads, and again with a null result in the main thread for the drawables it added to the result's main thread drawables. Return false without doing anything if there are no worker threads or too few drawables.
+    template <class T> bool GenerateBatches(Drawable* const* drawables, unsigned count, const T& function);
     /// Update geometries and sort batches.
     void UpdateGeometries();
-    /// Get pixel lit batches for a certain light and drawable.
-    void GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue);
+    /// Get pixel lit batches for a certain light and drawable. If a worker thread's result is given, add them to it instead of the batch queues.
+    void GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue, BatchGenerationResult* result = nullptr);
     /// Execute render commands.
     void ExecuteRenderPathCommands();
     /// Set rendertargets for current render command.
@@ -236,8 +322,11 @@ private:
     void DrawOccluders(OcclusionBuffer* buffer, const PODVector<Drawable*>& occluders);
     /// Query for lit geometries and shadow casters for a light.
     void ProcessLight(LightQueryResult& query, unsigned threadIndex);
-    /// Process shadow casters' visibilities and build their combined view- or projection-space bounding box.
-    void ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawable*>& drawables, unsigned splitIndex);
+    /// Return the geometries within a point or spot light's volume, using the light's cached query result if valid. Otherwise query into the temporary vector.
+    const PODVector<Drawable*>& GetLightDrawables(LightQueryResult& query, PODVector<Drawable*>& tempDrawables);
+    /// Process shadow casters' visibilities and build their combined view- or projection-space bounding box. Point light casters can be given already checked against the split frustum.
+    void ProcessShadowCasters(LightQueryResult& query, const PODVector<Drawable*>& drawables, unsigned splitIndex,
+        bool checkSplitFrustum = true);
     /// Set up initial shadow camera view(s).
     void SetupShadowCameras(LightQueryResult& query);
     /// Set up a directional light shadow camera.
@@ -263,6 +352,13 @@ private:
     void SetQueueShaderDefines(BatchQueue& queue, const RenderPathCommand& command);
     /// Choose shaders for a batch and add it to queue.
     void AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, bool allowInstancing = true, bool allowShadows = true);
+    /// Add a batch to a queue, or to the corresponding worker batch queue of a worker thread's result if not null.
+    void AddBatch(BatchGenerationResult* result, BatchQueue& queue, Batch& batch, Technique* tech, bool allowInstancing = true,
+        bool allowShadows = true);
+    /// Add a batch to a worker batch queue without choosing shaders.
+    void AddBatchToWorkerQueue(WorkerBatchQueue& queue, Batch& batch, Technique* tech, bool allowInstancing, FrameArena* arena);
+    /// Choose shaders for a worker batch queue's batches and add them to the batch queue it is for.
+    void MergeWorkerBatchQueue(WorkerBatchQueue& queue);
     /// Prepare instancing buffer by filling it with all instance transforms.
     void PrepareInstancingBuffer();
     /// Set up a light volume rendering batch.
@@ -312,6 +408,8 @@ private:
     WeakPtr<Graphics> graphics_;
     /// Renderer subsystem.
     WeakPtr<Renderer> renderer_;
+    /// Main thread frame arena for batch group instances.
+    FrameArena* frameArena_{};
     /// Scene to use.
     Scene* scene_{};
     /// Octree to use.
@@ -404,11 +502,25 @@ private:
     unsigned activeOccluders_{};
 
     /// Drawables that limit their maximum light count.
-    HashSet<Drawable*> maxLightsDrawables_;
+    FlatHashSet<Drawable*> maxLightsDrawables_;
     /// Rendertargets defined by the renderpath.
-    HashMap<StringHash, Texture*> renderTargets_;
+    FlatHashMap<StringHash, Texture*> renderTargets_;
     /// Intermediate light processing results.
     Vector<LightQueryResult> lightQueryResults_;
+    /// Index of the next light to process in the light processing work items.
+    std::atomic<unsigned> nextLightQuery_{};
+    /// Processed flag of each light query, set by the light processing work items.
+    SharedArrayPtr<std::atomic<bool> > lightQueriesDone_;
+    /// Size of the light query processed flag array.
+    unsigned lightQueriesDoneSize_{};
+    /// Whether the visibility check results have been combined and the light queries prepared, set by the combine work item.
+    std::atomic<bool> sceneResultsReady_{};
+    /// Cached octree query results of point and spot lights.
+    FlatHashMap<Light*, LightQueryCache> lightQueryCaches_;
+    /// Batch generation results of the worker thread work items.
+    Vector<BatchGenerationResult> batchResults_;
+    /// Lit drawables for which to generate batches in worker threads.
+    PODVector<Drawable*> litBatchDrawables_;
     /// Info for scene render passes defined by the renderpath.
     PODVector<ScenePassInfo> scenePasses_;
     /// Per-pixel light queues.
@@ -437,6 +549,8 @@ private:
     const RenderPathCommand* passCommand_{};
     /// Flag for scene being resolved from the backbuffer.
     bool usedResolve_{};
+    /// Cache point and spot light queries flag.
+    bool cacheLightQueries_{};
 };
 
 }
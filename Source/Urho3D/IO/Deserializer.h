@@ -45,6 +45,8 @@ public:
     virtual unsigned Read(void* dest, unsigned size) = 0;
     /// Set position from the beginning of the stream. Return actual new position.
     virtual unsigned Seek(unsigned position) = 0;
+    /// Return a pointer to the next size bytes and advance the position past them, if the stream holds them contiguously in memory. Otherwise, or if fewer bytes remain, return null without advancing, and the data must be read with Read() instead. The pointer is valid until the stream is closed or destroyed.
+    virtual const unsigned char* ReadInPlace(unsigned size) { return nullptr; }
     /// Return name of the stream.
     /// @property
     virtual const String& GetName() const;
@@ -36,6 +36,12 @@
 #include <cstdio>
 #include <LZ4/lz4.h>
 
+#if defined(__linux__) || defined(__APPLE__)
+#define URHO3D_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -64,6 +70,8 @@ const char* APK = "/apk/";
 static const unsigned READ_BUFFER_SIZE = 32768;
 #endif
 static const unsigned SKIP_BUFFER_SIZE = 1024;
+/// Minimum size of a file to memory-map. Smaller files are cheaper to read with buffered IO than to map and page fault.
+static const unsigned MIN_MEMORY_MAP_SIZE = 16384;
 
 File::File(Context* context) :
     Object(context),
@@ -74,6 +82,11 @@ File::File(Context* context) :
 #endif
     readBufferOffset_(0),
     readBufferSize_(0),
+    blockSize_(0),
+    blockBufferSize_(0),
+    mapping_(nullptr),
+    mappingSize_(0),
+    mappedData_(nullptr),
     offset_(0),
     checksum_(0),
     compressed_(false),
@@ -91,6 +104,11 @@ File::File(Context* context, const String& fileName, FileMode mode) :
 #endif
     readBufferOffset_(0),
     readBufferSize_(0),
+    blockSize_(0),
+    blockBufferSize_(0),
+    mapping_(nullptr),
+    mappingSize_(0),
+    mappedData_(nullptr),
     offset_(0),
     checksum_(0),
     compressed_(false),
@@ -109,6 +127,11 @@ File::File(Context* context, PackageFile* package, const String& fileName) :
 #endif
     readBufferOffset_(0),
     readBufferSize_(0),
+    blockSize_(0),
+    blockBufferSize_(0),
+    mapping_(nullptr),
+    mappingSize_(0),
+    mappedData_(nullptr),
     offset_(0),
     checksum_(0),
     compressed_(false),
@@ -149,9 +172,23 @@ bool File::Open(PackageFile* package, const String& fileName)
     checksum_ = entry->checksum_;
     size_ = entry->size_;
     compressed_ = package->IsCompressed();
+    blockSize_ = package->GetBlockSize();
 
     // Seek to beginning of package entry's file data
     SeekInternal(offset_);
+    if (!compressed_)
+        MapInternal();
+    else if (blockSize_)
+    {
+        // Read the block offset table, which is followed by the first block
+        blockOffsets_.Resize((size_ + blockSize_ - 1) / blockSize_ + 1);
+        if (!ReadInternal(blockOffsets_.Buffer(), blockOffsets_.Size() * sizeof(unsigned)))
+        {
+            URHO3D_LOGERROR("Could not read block offsets of package file " + fileName);
+            Close();
+            return false;
+        }
+    }
     return true;
 }
 
@@ -174,6 +211,13 @@ unsigned File::Read(void* dest, unsigned size)
     if (!size)
         return 0;
 
+    if (mappedData_)
+    {
+        memcpy(dest, mappedData_ + position_, size);
+        position_ += size;
+        return size;
+    }
+
 #ifdef __ANDROID__
     if (assetHandle_ && !compressed_)
     {
@@ -216,27 +260,10 @@ unsigned File::Read(void* dest, unsigned size)
 
         while (sizeLeft)
         {
-            if (!readBuffer_ || readBufferOffset_ >= readBufferSize_)
+            if (readBufferOffset_ >= readBufferSize_ && !ReadBlock())
             {
-                unsigned char blockHeaderBytes[4];
-                ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes);
-
-                MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
-                unsigned unpackedSize = blockHeader.ReadUShort();
-                unsigned packedSize = blockHeader.ReadUShort();
-
-                if (!readBuffer_)
-                {
-                    readBuffer_ = new unsigned char[unpackedSize];
-                    inputBuffer_ = new unsigned char[LZ4_compressBound(unpackedSize)];
-                }
-
-                /// \todo Handle errors
-                ReadInternal(inputBuffer_.Get(), packedSize);
-                LZ4_decompress_fast((const char*)inputBuffer_.Get(), (char*)readBuffer_.Get(), unpackedSize);
-
-                readBufferSize_ = unpackedSize;
-                readBufferOffset_ = 0;
+                URHO3D_LOGERROR("Error while decompressing file " + GetName());
+                return size - sizeLeft;
             }
 
             unsigned copySize = Min((readBufferSize_ - readBufferOffset_), sizeLeft);
@@ -270,6 +297,16 @@ unsigned File::Read(void* dest, unsigned size)
     return size;
 }
 
+const unsigned char* File::ReadInPlace(unsigned size)
+{
+    if (!mappedData_ || size > size_ - position_)
+        return nullptr;
+
+    const unsigned char* ptr = mappedData_ + position_;
+    position_ += size;
+    return ptr;
+}
+
 unsigned File::Seek(unsigned position)
 {
     if (!IsOpen())
@@ -284,27 +321,68 @@ unsigned File::Seek(unsigned position)
 
     if (compressed_)
     {
-        // Start over from the beginning
-        if (position == 0)
+        // The read buffer holds the most recently decompressed block, which begins at this position
+        unsigned bufferStart = position_ - readBufferOffset_;
+
+        // Move within the decompressed block
+        if (readBufferSize_ && position >= bufferStart && position < bufferStart + readBufferSize_)
         {
-            position_ = 0;
+            readBufferOffset_ = position - bufferStart;
+            position_ = position;
+        }
+        else if (position >= size_)
+        {
+            // Nothing left to read, so no need to decompress
+            position_ = size_;
             readBufferOffset_ = 0;
             readBufferSize_ = 0;
-            SeekInternal(offset_);
         }
-        // Skip bytes
-        else if (position >= position_)
+        else if (blockSize_)
         {
+            // Decompress the block containing the position
+            unsigned blockIndex = position / blockSize_;
+            SeekInternal(offset_ + blockOffsets_[blockIndex]);
+            readBufferOffset_ = 0;
+            readBufferSize_ = 0;
+            if (ReadBlock())
+            {
+                readBufferOffset_ = position - blockIndex * blockSize_;
+                position_ = position;
+            }
+            else
+            {
+                URHO3D_LOGERROR("Error while decompressing file " + GetName());
+                position_ = size_;
+            }
+        }
+        else
+        {
+            // Without a block index, start over from the beginning if seeking backward, then skip bytes
+            if (position < position_)
+            {
+                position_ = 0;
+                readBufferOffset_ = 0;
+                readBufferSize_ = 0;
+                SeekInternal(offset_);
+            }
+
             unsigned char skipBuffer[SKIP_BUFFER_SIZE];
             while (position > position_)
-                Read(skipBuffer, Min(position - position_, SKIP_BUFFER_SIZE));
+            {
+                if (!Read(skipBuffer, Min(position - position_, SKIP_BUFFER_SIZE)))
+                    break;
+            }
         }
-        else
-            URHO3D_LOGERROR("Seeking backward in a compressed file is not supported");
 
         return position_;
     }
 
+    if (mappedData_)
+    {
+        position_ = position;
+        return position_;
+    }
+
     SeekInternal(position + offset_);
     position_ = position;
     readSyncNeeded_ = false;
@@ -393,6 +471,12 @@ void File::Close()
 
     readBuffer_.Reset();
     inputBuffer_.Reset();
+    blockOffsets_.Clear();
+    blockSize_ = 0;
+    blockBufferSize_ = 0;
+    readBufferOffset_ = 0;
+    readBufferSize_ = 0;
+    UnmapInternal();
 
     if (handle_)
     {
@@ -515,6 +599,10 @@ bool File::OpenInternal(const String& fileName, FileMode mode, bool fromPackage)
     position_ = 0;
     checksum_ = 0;
 
+    // Package entries are mapped after their offset and size are known
+    if (mode == FILE_READ && !fromPackage)
+        MapInternal();
+
     return true;
 }
 
@@ -545,4 +633,77 @@ void File::SeekInternal(unsigned newPosition)
         fseek((FILE*)handle_, newPosition, SEEK_SET);
 }
 
+bool File::ReadBlock()
+{
+    unsigned char blockHeaderBytes[4];
+    if (!ReadInternal(blockHeaderBytes, sizeof blockHeaderBytes))
+        return false;
+
+    MemoryBuffer blockHeader(&blockHeaderBytes[0], sizeof blockHeaderBytes);
+    unsigned unpackedSize = blockHeader.ReadUShort();
+    unsigned packedSize = blockHeader.ReadUShort();
+
+    // Without a block index the first block is read first, and it is the largest
+    if (!readBuffer_)
+    {
+        blockBufferSize_ = Max(unpackedSize, blockSize_);
+        readBuffer_ = new unsigned char[blockBufferSize_];
+        inputBuffer_ = new unsigned char[LZ4_compressBound(blockBufferSize_)];
+    }
+
+    if (unpackedSize > blockBufferSize_ || packedSize > (unsigned)LZ4_compressBound(blockBufferSize_))
+        return false;
+    if (!ReadInternal(inputBuffer_.Get(), packedSize))
+        return false;
+    if (LZ4_decompress_safe((const char*)inputBuffer_.Get(), (char*)readBuffer_.Get(), packedSize, unpackedSize) != (int)unpackedSize)
+        return false;
+
+    readBufferSize_ = unpackedSize;
+    readBufferOffset_ = 0;
+    return true;
+}
+
+void File::MapInternal()
+{
+#ifdef URHO3D_MMAP
+    if (!handle_ || mode_ != FILE_READ || size_ < MIN_MEMORY_MAP_SIZE)
+        return;
+
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    if (fileSystem && !fileSystem->GetMemoryMappedReads())
+        return;
+
+    // The mapping must start at a page boundary, so also map the part of the page before a package entry
+    static const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mappingOffset = offset_ & ~(pageSize - 1);
+    size_t alignment = offset_ - mappingOffset;
+
+    void* mapping = mmap(nullptr, size_ + alignment, PROT_READ, MAP_PRIVATE, fileno((FILE*)handle_), (off_t)mappingOffset);
+    if (mapping == MAP_FAILED)
+    {
+        URHO3D_LOGDEBUG("Could not memory-map file {}, using buffered reads", name_.CString());
+        return;
+    }
+
+    // Resources are usually parsed from start to end
+    posix_madvise(mapping, size_ + alignment, POSIX_MADV_SEQUENTIAL);
+
+    mapping_ = mapping;
+    mappingSize_ = size_ + alignment;
+    mappedData_ = static_cast<const unsigned char*>(mapping) + alignment;
+#endif
+}
+
+void File::UnmapInternal()
+{
+#ifdef URHO3D_MMAP
+    if (mapping_)
+        munmap(mapping_, mappingSize_);
+#endif
+
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    mappedData_ = nullptr;
+}
+
 }
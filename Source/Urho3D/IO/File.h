@@ -75,6 +75,8 @@ public:
 
     /// Read bytes from the file. Return number of bytes actually read.
     unsigned Read(void* dest, unsigned size) override;
+    /// Return a pointer to the next bytes of a memory-mapped file and advance past them, or null if the file is not memory-mapped or fewer bytes remain.
+    const unsigned char* ReadInPlace(unsigned size) override;
     /// Set position from the beginning of the file.
     unsigned Seek(unsigned position) override;
     /// Write bytes to the file. Return number of bytes actually written.
@@ -106,6 +108,10 @@ public:
     /// Return whether the file originates from a package.
     /// @property
     bool IsPackaged() const { return offset_ != 0; }
+    /// Return whether reads are served from a memory mapping of the file.
+    bool IsMemoryMapped() const { return mappedData_ != nullptr; }
+    /// Return the memory-mapped contents of the file, or null if not memory-mapped. For a packaged file, this is the data of the package entry.
+    const unsigned char* GetMappedData() const { return mappedData_; }
 
 private:
     /// Open file internally using either C standard IO functions or SDL RWops for Android asset files. Return true if successful.
@@ -114,6 +120,12 @@ private:
     bool ReadInternal(void* dest, unsigned size);
     /// Seek in file internally using either C standard IO functions or SDL RWops for Android asset files.
     void SeekInternal(unsigned newPosition);
+    /// Read and decompress the compressed block at the current file position into the read buffer. Return true if successful.
+    bool ReadBlock();
+    /// Memory-map the file contents for reading if supported and enabled. Falls back to buffered reads on failure.
+    void MapInternal();
+    /// Unmap the file contents.
+    void UnmapInternal();
 
     /// Open mode.
     FileMode mode_;
@@ -127,10 +139,22 @@ private:
     SharedArrayPtr<unsigned char> readBuffer_;
     /// Decompression input buffer for compressed file loading.
     SharedArrayPtr<unsigned char> inputBuffer_;
+    /// Offsets of the compressed blocks and the end of the data, relative to the package entry, if the package is block-indexed.
+    PODVector<unsigned> blockOffsets_;
+    /// Unpacked size of compressed blocks if the package is block-indexed, 0 otherwise.
+    unsigned blockSize_;
+    /// Size of the read buffer for compressed file loading.
+    unsigned blockBufferSize_;
     /// Read buffer position.
     unsigned readBufferOffset_;
     /// Bytes in the current read buffer.
     unsigned readBufferSize_;
+    /// Memory mapping of the file, including the page alignment before the data.
+    void* mapping_;
+    /// Size of the memory mapping.
+    size_t mappingSize_;
+    /// Start of the file data within the memory mapping, or null if not memory-mapped.
+    const unsigned char* mappedData_;
     /// Start position within a package file, 0 for regular files.
     unsigned offset_;
     /// Content checksum.
@@ -57,6 +57,8 @@ public:
     /// Set whether to execute engine console commands as OS-specific system command.
     /// @property
     void SetExecuteConsoleCommands(bool enable);
+    /// Set whether files and uncompressed package entries opened for reading are memory-mapped where supported. Affects files opened afterward.
+    void SetMemoryMappedReads(bool enable) { memoryMappedReads_ = enable; }
     /// Run a program using the command interpreter, block until it exits and return the exit code. Will fail if any allowed paths are defined.
     int SystemCommand(const String& commandLine, bool redirectStdOutToLog = false);
     /// Run a specific program, block until it exits and return the exit code. Will fail if any allowed paths are defined.
@@ -85,6 +87,8 @@ public:
     /// Return whether is executing engine console commands as OS-specific system command.
     /// @property
     bool GetExecuteConsoleCommands() const { return executeConsoleCommands_; }
+    /// Return whether files opened for reading are memory-mapped where supported.
+    bool GetMemoryMappedReads() const { return memoryMappedReads_; }
 
     /// Return whether paths have been registered.
     bool HasRegisteredPaths() const { return allowedPaths_.Size() > 0; }
@@ -128,6 +132,8 @@ private:
     unsigned nextAsyncExecID_{1};
     /// Flag for executing engine console commands as OS-specific system command. Default to true.
     bool executeConsoleCommands_{};
+    /// Flag for memory-mapping files opened for reading. Default to true.
+    bool memoryMappedReads_{true};
 };
 
 /// Split a full path to path, filename and extension. The extension will be converted to lowercase by default.
@@ -34,6 +34,24 @@ URHO3D_EVENT(E_LOGMESSAGE, LogMessage)
     URHO3D_PARAM(P_LEVEL, Level);                  // int
 }
 
+/// Typed event data of the log message event.
+struct LogMessageEventData
+{
+    /// Return event type.
+    static StringHash GetEventTypeStatic() { return E_LOGMESSAGE; }
+    /// Convert to event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const
+    {
+        eventData[LogMessage::P_MESSAGE] = message_;
+        eventData[LogMessage::P_LEVEL] = level_;
+    }
+
+    /// Message text. Valid only during the event.
+    const String& message_;
+    /// Message level.
+    int level_;
+};
+
 /// Async system command execution finished.
 URHO3D_EVENT(E_ASYNCEXECFINISHED, AsyncExecFinished)
 {
@@ -33,6 +33,7 @@
 #include "../IO/Log.h"
 
 #include <cstdio>
+#include <cstring>
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -56,11 +57,82 @@ const char* logLevelPrefixes[] =
     nullptr
 };
 
+/// Capacity of the writer thread and event queues.
+static const unsigned LOG_QUEUE_SIZE = 4096;
+/// Maximum number of messages the writer thread handles at once.
+static const unsigned LOG_MAX_BATCH = 256;
+/// Binary log file format version.
+static const unsigned LOG_BINARY_VERSION = 1;
+/// Level byte of raw messages in the binary log file.
+static const unsigned char LOG_BINARY_RAW = 0xff;
+
 static Log* logInstance = nullptr;
 static bool threadErrorDisplayed = false;
 
+/// Writer thread of the asynchronous log.
+class LogWriterThread : public RefCounted, public Thread
+{
+public:
+    /// Construct.
+    explicit LogWriterThread(Log* log) :
+        log_(log)
+    {
+    }
+
+    /// Write queued messages until stopped.
+    void ThreadFunction() override
+    {
+        for (;;)
+        {
+            if (!log_->WriteQueuedMessages() && !log_->WaitForMessages())
+                break;
+        }
+
+        // Write the messages queued before stopping
+        while (log_->WriteQueuedMessages())
+        {
+        }
+    }
+
+private:
+    /// Log subsystem.
+    Log* log_;
+};
+
+static String FormatLogMessage(int level, const String& message, const String& timeStamp)
+{
+    String formattedMessage;
+    if (!timeStamp.Empty())
+        formattedMessage = "[" + timeStamp + "] ";
+    formattedMessage += logLevelPrefixes[level];
+    formattedMessage += ": " + message;
+
+    return formattedMessage;
+}
+
+static void AppendBytes(PODVector<unsigned char>& dest, const void* data, unsigned size)
+{
+    if (!size)
+        return;
+
+    unsigned oldSize = dest.Size();
+    dest.Resize(oldSize + size);
+    memcpy(&dest[oldSize], data, size);
+}
+
+template <class T> static void AppendValue(PODVector<unsigned char>& dest, const T& value)
+{
+    AppendBytes(dest, &value, sizeof value);
+}
+
 Log::Log(Context* context) :
     Object(context),
+    outputQueue_(LOG_QUEUE_SIZE),
+    eventQueue_(LOG_QUEUE_SIZE),
+    numQueued_(0),
+    numWritten_(0),
+    writerWaiting_(false),
+    stopWriter_(false),
 #ifdef _DEBUG
     level_(LOG_DEBUG),
 #else
@@ -68,15 +140,27 @@ Log::Log(Context* context) :
 #endif
     timeStamp_(true),
     inWrite_(false),
-    quiet_(false)
+    inOutput_(false),
+    quiet_(false),
+    async_(false),
+    binary_(false),
+    fileBinary_(false),
+    unflushed_(false),
+    flushPolicy_(LOG_FLUSH_BATCH),
+    flushInterval_(1000)
 {
     logInstance = this;
 
+#ifdef URHO3D_THREADING
+    SetAsync(true);
+#endif
+
     SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(Log, HandleEndFrame));
 }
 
 Log::~Log()
 {
+    StopWriter();
     logInstance = nullptr;
 }
 
@@ -93,14 +177,27 @@ void Log::Open(const String& fileName)
             Close();
     }
 
-    logFile_ = new File(context_);
-    if (logFile_->Open(fileName, FILE_WRITE))
+    SharedPtr<File> file(new File(context_));
+    if (file->Open(fileName, FILE_WRITE))
+    {
+        {
+            MutexLock lock(fileMutex_);
+            logFile_ = file;
+            fileBinary_ = binary_;
+            // The header stores the wall clock time and the message clock at the same moment, so that message times can be converted to absolute time
+            if (fileBinary_)
+            {
+                logFile_->WriteFileID("ULOG");
+                logFile_->WriteUInt(LOG_BINARY_VERSION);
+                logFile_->WriteUInt(Time::GetTimeSinceEpoch());
+                logFile_->WriteInt64(clock_.GetUSec(false));
+            }
+        }
+
         Write(LOG_INFO, "Opened log file " + fileName);
+    }
     else
-    {
-        logFile_.Reset();
         Write(LOG_ERROR, "Failed to create log file " + fileName);
-    }
 #endif
 }
 
@@ -109,12 +206,59 @@ void Log::Close()
 #if !defined(__ANDROID__) && !defined(IOS) && !defined(TVOS)
     if (logFile_ && logFile_->IsOpen())
     {
+        Flush();
+
+        MutexLock lock(fileMutex_);
         logFile_->Close();
         logFile_.Reset();
     }
 #endif
 }
 
+void Log::Flush()
+{
+    if (writer_)
+    {
+        unsigned numQueued = numQueued_.load();
+        std::unique_lock<std::mutex> lock(writerMutex_);
+        writtenCondition_.wait(lock, [this, numQueued] { return (int)(numWritten_.load() - numQueued) >= 0; });
+    }
+
+    MutexLock lock(fileMutex_);
+    if (logFile_)
+    {
+        logFile_->Flush();
+        unflushed_ = false;
+    }
+}
+
+void Log::SetAsync(bool enable)
+{
+#ifndef URHO3D_THREADING
+    enable = false;
+#endif
+
+    if (enable == async_)
+        return;
+
+    async_ = enable;
+    if (enable)
+        StartWriter();
+    else
+        StopWriter();
+}
+
+void Log::SetFlushPolicy(LogFlushPolicy policy, unsigned intervalMs)
+{
+    flushPolicy_ = policy;
+    flushInterval_ = intervalMs;
+}
+
+void Log::SetBinary(bool enable)
+{
+    binary_ = enable;
+}
+
 void Log::SetLevel(int level)
 {
     if (level < LOG_TRACE || level > LOG_NONE)
@@ -164,120 +308,330 @@ void Log::Write(int level, const String& message)
     if (level < LOG_TRACE || level >= LOG_NONE)
         return;
 
-    // If not in the main thread, store message for later processing
+    // Do not log if message level excluded
+    if (!logInstance || logInstance->level_ > level)
+        return;
+
+    StoredLogMessage stored(message, level, false);
+    stored.time_ = logInstance->clock_.GetUSec(false);
+    stored.threadID_ = (unsigned long long)Thread::GetCurrentThreadID();
+    logInstance->WriteMessage(stored);
+}
+
+void Log::WriteRaw(const String& message, bool error)
+{
+    if (!logInstance)
+        return;
+
+    StoredLogMessage stored(message, LOG_RAW, error);
+    stored.time_ = logInstance->clock_.GetUSec(false);
+    stored.threadID_ = (unsigned long long)Thread::GetCurrentThreadID();
+    logInstance->WriteMessage(stored);
+}
+
+bool Log::WriteQueuedMessages()
+{
+    MutexLock lock(fileMutex_);
+
+    // A message logged while outputting, for example a file error, was already added to the current batch
+    if (inOutput_)
+        return false;
+    inOutput_ = true;
+
+    StoredLogMessage message;
+    unsigned count = 0;
+    bool error = false;
+    // The timestamp has a resolution of one second, so one is enough for the batch
+    String timeStamp;
+    while (count < LOG_MAX_BATCH && outputQueue_.TryPop(message))
+    {
+        if (timeStamp_ && timeStamp.Empty())
+            timeStamp = Time::GetTimeStamp();
+        OutputMessage(message, timeStamp);
+        error |= message.level_ == LOG_RAW ? message.error_ : message.level_ == LOG_ERROR;
+        ++count;
+    }
+
+    WriteFileBatch(error);
+    inOutput_ = false;
+
+    if (!count)
+        return false;
+
+    numWritten_.fetch_add(count);
+    {
+        std::lock_guard<std::mutex> writerLock(writerMutex_);
+    }
+    writtenCondition_.notify_all();
+    return true;
+}
+
+bool Log::WaitForMessages()
+{
+    // With the interval flush policy, wake up when the last written batch is due to be flushed, so that it is not left
+    // unflushed if nothing more is logged
+    unsigned flushWait = 0;
+    {
+        MutexLock lock(fileMutex_);
+        if (unflushed_ && flushPolicy_ == LOG_FLUSH_INTERVAL)
+        {
+            unsigned elapsed = flushTimer_.GetMSec(false);
+            flushWait = elapsed < flushInterval_ ? flushInterval_ - elapsed : 1;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(writerMutex_);
+    writerWaiting_.store(true);
+    auto wakeUp = [this] { return stopWriter_ || (int)(numQueued_.load() - numWritten_.load()) > 0; };
+    if (flushWait)
+    {
+        // On timeout the writer thread writes an empty batch, which flushes
+        queuedCondition_.wait_for(lock, std::chrono::milliseconds(flushWait), wakeUp);
+    }
+    else
+        queuedCondition_.wait(lock, wakeUp);
+    writerWaiting_.store(false);
+    return !stopWriter_;
+}
+
+void Log::WriteMessage(StoredLogMessage& message)
+{
     if (!Thread::IsMainThread())
     {
-        if (logInstance)
+        if (async_)
+        {
+            // Output right away through the writer thread. The log event can only be sent in the main thread, so
+            // queue a copy for the end of the frame. If that queue is full, store the copy with the messages of the
+            // synchronous mode instead
+            StoredLogMessage eventMessage(message);
+            eventMessage.output_ = true;
+            if (!eventQueue_.TryPush(eventMessage))
+            {
+                MutexLock lock(logMutex_);
+                threadMessages_.Push(eventMessage);
+            }
+            QueueOutput(message);
+        }
+        else
         {
-            MutexLock lock(logInstance->logMutex_);
-            logInstance->threadMessages_.Push(StoredLogMessage(message, level, false));
+            // Store message for later processing
+            MutexLock lock(logMutex_);
+            threadMessages_.Push(message);
         }
 
         return;
     }
 
-    // Do not log if message level excluded or if currently sending a log event
-    if (!logInstance || logInstance->level_ > level || logInstance->inWrite_)
+    // Do not log if currently sending a log event
+    if (inWrite_)
         return;
 
-    String formattedMessage = logLevelPrefixes[level];
-    formattedMessage += ": " + message;
-    logInstance->lastMessage_ = message;
+    lastMessage_ = message.message_;
 
-    if (logInstance->timeStamp_)
-        formattedMessage = "[" + Time::GetTimeStamp() + "] " + formattedMessage;
+    if (async_)
+    {
+        SendMessageEvent(message);
+        QueueOutput(message);
+    }
+    else
+    {
+        {
+            MutexLock lock(fileMutex_);
+            // Output first what other threads queued while the writer thread was stopping
+            while (WriteQueuedMessages())
+            {
+            }
+            OutputMessage(message, timeStamp_ ? Time::GetTimeStamp() : String::EMPTY);
+            if (logFile_ && fileBatch_.Size())
+            {
+                logFile_->Write(&fileBatch_[0], fileBatch_.Size());
+                logFile_->Flush();
+            }
+            fileBatch_.Clear();
+        }
+
+        SendMessageEvent(message);
+    }
+}
+
+void Log::OutputMessage(const StoredLogMessage& message, const String& timeStamp)
+{
+    bool raw = message.level_ == LOG_RAW;
+    bool error = raw ? message.error_ : message.level_ == LOG_ERROR;
+    String formattedMessage = raw ? message.message_ : FormatLogMessage(message.level_, message.message_, timeStamp);
 
 #if defined(__ANDROID__)
-    int androidLevel = ANDROID_LOG_VERBOSE + level;
-    __android_log_print(androidLevel, "Urho3D", "%s", message.CString());
+    if (raw)
+    {
+        if (!quiet_ || error)
+            __android_log_print(error ? ANDROID_LOG_ERROR : ANDROID_LOG_INFO, "Urho3D", "%s", message.message_.CString());
+    }
+    else
+    {
+        int androidLevel = ANDROID_LOG_VERBOSE + message.level_;
+        __android_log_print(androidLevel, "Urho3D", "%s", message.message_.CString());
+    }
 #elif defined(IOS) || defined(TVOS)
-    SDL_IOS_LogMessage(message.CString());
+    SDL_IOS_LogMessage(message.message_.CString());
 #else
-    if (logInstance->quiet_)
+    // If in quiet mode, still print the error message to the standard error stream
+    if (!quiet_ || error)
     {
-        // If in quiet mode, still print the error message to the standard error stream
-        if (level == LOG_ERROR)
-            PrintUnicodeLine(formattedMessage, true);
+        if (raw)
+            PrintUnicode(formattedMessage, error);
+        else
+            PrintUnicodeLine(formattedMessage, error);
     }
-    else
-        PrintUnicodeLine(formattedMessage, level == LOG_ERROR);
 #endif
 
-    if (logInstance->logFile_)
+    if (!logFile_)
+        return;
+
+    if (fileBinary_)
+    {
+        // Record: time in microseconds, thread ID, message length, level (0xff for raw), error flag, message
+        AppendValue(fileBatch_, message.time_);
+        AppendValue(fileBatch_, message.threadID_);
+        AppendValue(fileBatch_, message.message_.Length());
+        AppendValue(fileBatch_, raw ? LOG_BINARY_RAW : (unsigned char)message.level_);
+        AppendValue(fileBatch_, (unsigned char)(error ? 1 : 0));
+        AppendBytes(fileBatch_, message.message_.CString(), message.message_.Length());
+    }
+    else
+    {
+        AppendBytes(fileBatch_, formattedMessage.CString(), formattedMessage.Length());
+        if (!raw)
+            AppendBytes(fileBatch_, "\r\n", 2);
+    }
+}
+
+void Log::WriteFileBatch(bool error)
+{
+    // Write the whole batch to the log file at once
+    if (logFile_ && fileBatch_.Size())
     {
-        logInstance->logFile_->WriteLine(formattedMessage);
-        logInstance->logFile_->Flush();
+        logFile_->Write(&fileBatch_[0], fileBatch_.Size());
+        unflushed_ = true;
     }
+    fileBatch_.Clear();
 
-    logInstance->inWrite_ = true;
+    if (unflushed_ && (error || flushPolicy_ == LOG_FLUSH_BATCH || (flushPolicy_ == LOG_FLUSH_INTERVAL &&
+        flushTimer_.GetMSec(false) >= flushInterval_)))
+    {
+        if (logFile_)
+            logFile_->Flush();
+        unflushed_ = false;
+        flushTimer_.Reset();
+    }
+}
 
-    using namespace LogMessage;
+void Log::QueueOutput(StoredLogMessage& message)
+{
+    if (PushOutput(message))
+        return;
 
-    VariantMap& eventData = logInstance->GetEventDataMap();
-    eventData[P_MESSAGE] = formattedMessage;
-    eventData[P_LEVEL] = level;
-    logInstance->SendEvent(E_LOGMESSAGE, eventData);
+    // The writer thread has fallen behind. Rather than wait for it, write the queued messages in the calling thread
+    // to make room, which also keeps the order
+    MutexLock lock(fileMutex_);
+    // The writer thread itself logs while outputting: add the message to the current batch
+    if (inOutput_)
+    {
+        OutputMessage(message, timeStamp_ ? Time::GetTimeStamp() : String::EMPTY);
+        return;
+    }
 
-    logInstance->inWrite_ = false;
+    for (;;)
+    {
+        // When another thread has not finished pushing the oldest message, nothing can be written until it does.
+        // It does not depend on the writer thread, so this wait is short
+        if (!WriteQueuedMessages() && !outputQueue_.IsEmpty())
+            Time::Sleep(0);
+        else if (PushOutput(message))
+            return;
+    }
 }
 
-void Log::WriteRaw(const String& message, bool error)
+bool Log::PushOutput(StoredLogMessage& message)
 {
-    // If not in the main thread, store message for later processing
-    if (!Thread::IsMainThread())
+    if (!outputQueue_.TryPush(message))
+        return false;
+
+    // The queued count is incremented after the push, so that the writer thread can pop the message once it sees it
+    numQueued_.fetch_add(1);
+    if (writerWaiting_.load())
     {
-        if (logInstance)
         {
-            MutexLock lock(logInstance->logMutex_);
-            logInstance->threadMessages_.Push(StoredLogMessage(message, LOG_RAW, error));
+            std::lock_guard<std::mutex> lock(writerMutex_);
         }
-
-        return;
+        queuedCondition_.notify_one();
     }
 
-    // Prevent recursion during log event
-    if (!logInstance || logInstance->inWrite_)
+    return true;
+}
+
+void Log::SendMessageEvent(const StoredLogMessage& message)
+{
+    // Formatting the event message has a cost, so skip it when nothing listens
+    if (!HasMessageEventReceivers())
         return;
 
-    logInstance->lastMessage_ = message;
+    inWrite_ = true;
 
-#if defined(__ANDROID__)
-    if (logInstance->quiet_)
-    {
-        if (error)
-            __android_log_print(ANDROID_LOG_ERROR, "Urho3D", "%s", message.CString());
-    }
+    if (message.level_ == LOG_RAW)
+        SendTypedEvent(LogMessageEventData{message.message_, message.error_ ? LOG_ERROR : LOG_INFO});
     else
-        __android_log_print(error ? ANDROID_LOG_ERROR : ANDROID_LOG_INFO, "Urho3D", "%s", message.CString());
-#elif defined(IOS) || defined(TVOS)
-    SDL_IOS_LogMessage(message.CString());
-#else
-    if (logInstance->quiet_)
+        SendTypedEvent(LogMessageEventData{FormatLogMessage(message.level_, message.message_, timeStamp_ ?
+            Time::GetTimeStamp() : String::EMPTY), message.level_});
+
+    inWrite_ = false;
+}
+
+bool Log::HasMessageEventReceivers() const
+{
+    EventReceiverGroup* group = context_->GetEventReceivers(const_cast<Log*>(this), E_LOGMESSAGE);
+    if (group && !group->receivers_.Empty())
+        return true;
+
+    group = context_->GetEventReceivers(E_LOGMESSAGE);
+    if (group && !group->receivers_.Empty())
+        return true;
+
+    TypedEventReceiverGroup* typedGroup = context_->GetTypedEventReceivers(GetTypedEventIndex<LogMessageEventData>());
+    return typedGroup && !typedGroup->handlers_.Empty();
+}
+
+void Log::StartWriter()
+{
     {
-        // If in quiet mode, still print the error message to the standard error stream
-        if (error)
-            PrintUnicode(message, true);
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        stopWriter_ = false;
     }
-    else
-        PrintUnicode(message, error);
-#endif
 
-    if (logInstance->logFile_)
+    writer_ = new LogWriterThread(this);
+    if (!writer_->Run())
     {
-        logInstance->logFile_->Write(message.CString(), message.Length());
-        logInstance->logFile_->Flush();
+        writer_.Reset();
+        async_ = false;
     }
+}
 
-    logInstance->inWrite_ = true;
-
-    using namespace LogMessage;
-
-    VariantMap& eventData = logInstance->GetEventDataMap();
-    eventData[P_MESSAGE] = message;
-    eventData[P_LEVEL] = error ? LOG_ERROR : LOG_INFO;
-    logInstance->SendEvent(E_LOGMESSAGE, eventData);
+void Log::StopWriter()
+{
+    if (writer_)
+    {
+        {
+            std::lock_guard<std::mutex> lock(writerMutex_);
+            stopWriter_ = true;
+        }
+        queuedCondition_.notify_one();
+        writer_->Stop();
+        writer_.Reset();
+    }
 
-    logInstance->inWrite_ = false;
+    // Write what other threads queued after the writer thread made its last pass
+    while (WriteQueuedMessages())
+    {
+    }
 }
 
 void Log::HandleEndFrame(StringHash eventType, VariantMap& eventData)
@@ -293,18 +647,30 @@ void Log::HandleEndFrame(StringHash eventType, VariantMap& eventData)
         return;
     }
 
+    // Send events for the messages other threads have already output asynchronously
+    StoredLogMessage message;
+    while (eventQueue_.TryPop(message))
+    {
+        lastMessage_ = message.message_;
+        if (!inWrite_)
+            SendMessageEvent(message);
+    }
+
     MutexLock lock(logMutex_);
 
     // Process messages accumulated from other threads (if any)
     while (!threadMessages_.Empty())
     {
-        const StoredLogMessage& stored = threadMessages_.Front();
-
-        if (stored.level_ != LOG_RAW)
-            Write(stored.level_, stored.message_);
+        StoredLogMessage& stored = threadMessages_.Front();
+        if (stored.output_)
+        {
+            // Already output by the writer thread, only the event remains
+            lastMessage_ = stored.message_;
+            if (!inWrite_)
+                SendMessageEvent(stored);
+        }
         else
-            WriteRaw(stored.message_, stored.error_);
-
+            WriteMessage(stored);
         threadMessages_.PopFront();
     }
 }
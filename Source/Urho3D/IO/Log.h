@@ -23,9 +23,14 @@
 #pragma once
 
 #include "../Container/List.h"
+#include "../Container/MPSCRingBuffer.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Core/StringUtils.h"
+#include "../Core/Timer.h"
+
+#include <condition_variable>
+#include <mutex>
 
 namespace Urho3D
 {
@@ -45,7 +50,19 @@ static const int LOG_ERROR = 4;
 /// Disable all log messages.
 static const int LOG_NONE = 5;
 
+/// Log file flush policy when writing asynchronously. Errors are always flushed right away.
+enum LogFlushPolicy
+{
+    /// Flush after each batch of messages.
+    LOG_FLUSH_BATCH = 0,
+    /// Flush at most once per flush interval.
+    LOG_FLUSH_INTERVAL,
+    /// Flush only when the log file is closed or explicitly flushed.
+    LOG_FLUSH_MANUAL
+};
+
 class File;
+class LogWriterThread;
 
 /// Stored log message from another thread.
 struct StoredLogMessage
@@ -67,6 +84,12 @@ struct StoredLogMessage
     int level_{};
     /// Error flag for raw messages.
     bool error_{};
+    /// Time in microseconds since the log was created.
+    long long time_{};
+    /// Identifier of the thread that wrote the message.
+    unsigned long long threadID_{};
+    /// Whether the message has already been output, so that only its log message event remains to be sent.
+    bool output_{};
 };
 
 /// Logging subsystem.
@@ -74,6 +97,8 @@ class URHO3D_API Log : public Object
 {
     URHO3D_OBJECT(Log, Object);
 
+    friend class LogWriterThread;
+
 public:
     /// Construct.
     explicit Log(Context* context);
@@ -84,6 +109,14 @@ public:
     void Open(const String& fileName);
     /// Close the log file.
     void Close();
+    /// Wait until the queued messages have been written and flush the log file.
+    void Flush();
+    /// Set whether console and file output is done by a writer thread. When enabled (default if threading is supported), messages from any thread are queued without locking and written in batches; when disabled, messages from the main thread are written immediately and flushed line by line.
+    void SetAsync(bool enable);
+    /// Set log file flush policy and the interval in milliseconds for LOG_FLUSH_INTERVAL. Only used when writing asynchronously.
+    void SetFlushPolicy(LogFlushPolicy policy, unsigned intervalMs = 1000);
+    /// Set whether the log file is written as binary records for high-rate tracing instead of text. Takes effect when the log file is next opened.
+    void SetBinary(bool enable);
     /// Set logging level.
     /// @property
     void SetLevel(int level);
@@ -110,6 +143,18 @@ public:
     /// @property
     bool IsQuiet() const { return quiet_; }
 
+    /// Return whether output is done by a writer thread.
+    bool IsAsync() const { return async_; }
+
+    /// Return log file flush policy.
+    LogFlushPolicy GetFlushPolicy() const { return flushPolicy_; }
+
+    /// Return flush interval in milliseconds.
+    unsigned GetFlushInterval() const { return flushInterval_; }
+
+    /// Return whether the log file is written as binary records.
+    bool IsBinary() const { return binary_; }
+
     /// Write to the log. If logging level is higher than the level of the message, the message is ignored.
     /// @nobind
     static void Write(int level, const String& message);
@@ -125,13 +170,63 @@ public:
     }
 
 private:
+    /// Write queued messages in the writer thread. Return false if there were none.
+    bool WriteQueuedMessages();
+    /// Wait in the writer thread until messages are queued, or until an unflushed batch is due to be flushed. Return false when the writer thread should stop.
+    bool WaitForMessages();
     /// Handle end of frame. Process the threaded log messages.
     void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+    /// Output a message from any thread, or queue it for the main thread.
+    void WriteMessage(StoredLogMessage& message);
+    /// Print a message to the console and append its log file output to the file batch. An empty timestamp is omitted.
+    void OutputMessage(const StoredLogMessage& message, const String& timeStamp);
+    /// Write the file batch to the log file and flush according to the flush policy.
+    void WriteFileBatch(bool error);
+    /// Queue a message for the writer thread. If the queue is full, write it in the calling thread instead.
+    void QueueOutput(StoredLogMessage& message);
+    /// Push a message to the writer thread queue and wake up the writer thread. Return false if the queue is full.
+    bool PushOutput(StoredLogMessage& message);
+    /// Send the log message event.
+    void SendMessageEvent(const StoredLogMessage& message);
+    /// Return whether anything listens to the log message event.
+    bool HasMessageEventReceivers() const;
+    /// Start the writer thread.
+    void StartWriter();
+    /// Stop the writer thread after it has written the queued messages.
+    void StopWriter();
 
     /// Mutex for threaded operation.
     Mutex logMutex_;
+    /// Mutex for the log file, which the writer thread holds while writing a batch.
+    Mutex fileMutex_;
     /// Log messages from other threads.
     List<StoredLogMessage> threadMessages_;
+    /// Messages waiting for the writer thread.
+    MPSCRingBuffer<StoredLogMessage> outputQueue_;
+    /// Messages from other threads waiting to be sent as events in the main thread.
+    MPSCRingBuffer<StoredLogMessage> eventQueue_;
+    /// Writer thread.
+    SharedPtr<LogWriterThread> writer_;
+    /// Mutex for waking up the writer thread and for waiting on it.
+    std::mutex writerMutex_;
+    /// Condition for the writer thread to wake up when messages are queued or it should stop.
+    std::condition_variable queuedCondition_;
+    /// Condition for Flush() to wake up when the writer thread has written a batch.
+    std::condition_variable writtenCondition_;
+    /// Whether the writer thread is waiting for messages.
+    std::atomic<bool> writerWaiting_;
+    /// Whether the writer thread should stop. Guarded by the writer mutex.
+    bool stopWriter_;
+    /// Batch of file output assembled by the writer thread.
+    PODVector<unsigned char> fileBatch_;
+    /// Timer for message timestamps.
+    HiresTimer clock_;
+    /// Timer for the interval flush policy.
+    Timer flushTimer_;
+    /// Number of messages queued for the writer thread.
+    std::atomic<unsigned> numQueued_;
+    /// Number of messages written by the writer thread.
+    std::atomic<unsigned> numWritten_;
     /// Log file.
     SharedPtr<File> logFile_;
     /// Last log message.
@@ -142,8 +237,22 @@ private:
     bool timeStamp_;
     /// In write flag to prevent recursion.
     bool inWrite_;
+    /// Whether queued messages are being output. Guarded by the file mutex.
+    bool inOutput_;
     /// Quiet mode flag.
     bool quiet_;
+    /// Asynchronous output flag.
+    bool async_;
+    /// Binary log file flag.
+    bool binary_;
+    /// Binary flag of the currently open log file.
+    bool fileBinary_;
+    /// Whether the log file has unflushed output.
+    bool unflushed_;
+    /// Log file flush policy.
+    LogFlushPolicy flushPolicy_;
+    /// Flush interval in milliseconds.
+    unsigned flushInterval_;
 };
 
 #ifdef URHO3D_LOGGING
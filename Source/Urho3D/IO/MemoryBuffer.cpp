@@ -75,6 +75,16 @@ unsigned MemoryBuffer::Read(void* dest, unsigned size)
     return size;
 }
 
+const unsigned char* MemoryBuffer::ReadInPlace(unsigned size)
+{
+    if (size > size_ - position_)
+        return nullptr;
+
+    const unsigned char* ptr = buffer_ + position_;
+    position_ += size;
+    return ptr;
+}
+
 unsigned MemoryBuffer::Seek(unsigned position)
 {
     if (position > size_)
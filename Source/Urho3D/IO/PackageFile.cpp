@@ -34,6 +34,7 @@ PackageFile::PackageFile(Context* context) :
     totalSize_(0),
     totalDataSize_(0),
     checksum_(0),
+    blockSize_(0),
     compressed_(false)
 {
 }
@@ -43,6 +44,7 @@ PackageFile::PackageFile(Context* context, const String& fileName, unsigned star
     totalSize_(0),
     totalDataSize_(0),
     checksum_(0),
+    blockSize_(0),
     compressed_(false)
 {
     Open(fileName, startOffset);
@@ -59,7 +61,7 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
     // Check ID, then read the directory
     file->Seek(startOffset);
     String id = file->ReadFileID();
-    if (id != "UPAK" && id != "ULZ4")
+    if (id != "UPAK" && id != "ULZ4" && id != "ULZI")
     {
         // If start offset has not been explicitly specified, also try to read package size from the end of file
         // to know how much we must rewind to find the package start
@@ -76,7 +78,7 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
             }
         }
 
-        if (id != "UPAK" && id != "ULZ4")
+        if (id != "UPAK" && id != "ULZ4" && id != "ULZI")
         {
             URHO3D_LOGERROR(fileName + " is not a valid package file");
             return false;
@@ -86,10 +88,17 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
     fileName_ = fileName;
     nameHash_ = fileName_;
     totalSize_ = file->GetSize();
-    compressed_ = id == "ULZ4";
+    compressed_ = id == "ULZ4" || id == "ULZI";
 
     unsigned numFiles = file->ReadUInt();
     checksum_ = file->ReadUInt();
+    blockSize_ = id == "ULZI" ? file->ReadUInt() : 0;
+    // Block sizes are stored as 16-bit values
+    if (id == "ULZI" && (!blockSize_ || blockSize_ > 65535))
+    {
+        URHO3D_LOGERROR(fileName + " has invalid compressed block size");
+        return false;
+    }
 
     for (unsigned i = 0; i < numFiles; ++i)
     {
@@ -38,7 +38,10 @@ struct PackageEntry
     unsigned checksum_;
 };
 
-/// Stores files of a directory tree sequentially for convenient access.
+/// Stores files of a directory tree sequentially for convenient access. Package formats by file ID:
+/// - UPAK: uncompressed.
+/// - ULZ4: LZ4 compressed blocks, each preceded by its unpacked and packed size as 16-bit values. Seeking requires decompressing from the beginning.
+/// - ULZI: as ULZ4, but the header also stores the unpacked block size, and each entry's data begins with a table of the offsets of its blocks and the end of the data, relative to the entry offset. Any position can be sought by decompressing a single block.
 class URHO3D_API PackageFile : public Object
 {
     URHO3D_OBJECT(PackageFile, Object);
@@ -88,6 +91,12 @@ public:
     /// @property
     bool IsCompressed() const { return compressed_; }
 
+    /// Return whether the compressed files have a block offset table for random access.
+    bool IsBlockIndexed() const { return blockSize_ != 0; }
+
+    /// Return the unpacked size of compressed blocks in a block-indexed package, or 0 if not block-indexed.
+    unsigned GetBlockSize() const { return blockSize_; }
+
     /// Return list of file names in the package.
     const Vector<String> GetEntryNames() const { return entries_.Keys(); }
 
@@ -104,6 +113,8 @@ private:
     unsigned totalDataSize_;
     /// Package file checksum.
     unsigned checksum_;
+    /// Unpacked size of compressed blocks if block-indexed, 0 otherwise.
+    unsigned blockSize_;
     /// Compressed flag.
     bool compressed_;
 };
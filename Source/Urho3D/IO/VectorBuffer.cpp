@@ -60,6 +60,16 @@ unsigned VectorBuffer::Read(void* dest, unsigned size)
     return size;
 }
 
+const unsigned char* VectorBuffer::ReadInPlace(unsigned size)
+{
+    if (size > size_ - position_)
+        return nullptr;
+
+    const unsigned char* ptr = buffer_.Buffer() + position_;
+    position_ += size;
+    return ptr;
+}
+
 unsigned VectorBuffer::Seek(unsigned position)
 {
     if (position > size_)
@@ -42,6 +42,8 @@ public:
 
     /// Read bytes from the buffer. Return number of bytes actually read.
     unsigned Read(void* dest, unsigned size) override;
+    /// Return a pointer to the next bytes in the buffer and advance past them, or null if fewer bytes remain.
+    const unsigned char* ReadInPlace(unsigned size) override;
     /// Set position from the beginning of the buffer. Return actual new position.
     unsigned Seek(unsigned position) override;
     /// Write bytes to the buffer. Return number of bytes actually written.
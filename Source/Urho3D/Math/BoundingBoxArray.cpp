@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Math/BoundingBoxArray.h"
+#include "../Math/Frustum.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Write the indices of the boxes in a block whose lanes are not marked outside, skipping the padding lanes of the last block.
+static inline unsigned WriteInsideIndices(unsigned outsideMask, unsigned blockStart, unsigned size, unsigned* indices)
+{
+    unsigned numInside = 0;
+    for (unsigned i = 0; i < BoundingBoxArray::BLOCK_SIZE && blockStart + i < size; ++i)
+    {
+        if (!(outsideMask & (1u << i)))
+            indices[numInside++] = blockStart + i;
+    }
+    return numInside;
+}
+
+unsigned BoundingBoxArray::GetInsideFast(const Frustum& frustum, unsigned* indices) const
+{
+    unsigned numInside = 0;
+    const float* block = data_.Buffer();
+
+    for (unsigned blockStart = 0; blockStart < size_; blockStart += BLOCK_SIZE, block += BLOCK_FLOATS)
+    {
+#ifdef URHO3D_SSE
+        // Same operations as Frustum::IsInsideFast() for four boxes at a time, so that the results match exactly
+        __m128 minX = _mm_loadu_ps(block);
+        __m128 minY = _mm_loadu_ps(block + BLOCK_SIZE);
+        __m128 minZ = _mm_loadu_ps(block + BLOCK_SIZE * 2);
+        __m128 half = _mm_set1_ps(0.5f);
+        __m128 centerX = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(block + BLOCK_SIZE * 3), minX), half);
+        __m128 centerY = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(block + BLOCK_SIZE * 4), minY), half);
+        __m128 centerZ = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(block + BLOCK_SIZE * 5), minZ), half);
+        __m128 edgeX = _mm_sub_ps(centerX, minX);
+        __m128 edgeY = _mm_sub_ps(centerY, minY);
+        __m128 edgeZ = _mm_sub_ps(centerZ, minZ);
+        __m128 outside = _mm_setzero_ps();
+
+        for (const auto& plane : frustum.planes_)
+        {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(plane.normal_.x_), centerX),
+                _mm_mul_ps(_mm_set1_ps(plane.normal_.y_), centerY)),
+                _mm_mul_ps(_mm_set1_ps(plane.normal_.z_), centerZ)),
+                _mm_set1_ps(plane.d_));
+            __m128 absDist = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(plane.absNormal_.x_), edgeX),
+                _mm_mul_ps(_mm_set1_ps(plane.absNormal_.y_), edgeY)),
+                _mm_mul_ps(_mm_set1_ps(plane.absNormal_.z_), edgeZ));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_sub_ps(_mm_setzero_ps(), absDist)));
+        }
+
+        unsigned outsideMask = (unsigned)_mm_movemask_ps(outside);
+#else
+        unsigned outsideMask = 0;
+        for (unsigned i = 0; i < BLOCK_SIZE; ++i)
+        {
+            Vector3 min(block[i], block[BLOCK_SIZE + i], block[BLOCK_SIZE * 2 + i]);
+            Vector3 max(block[BLOCK_SIZE * 3 + i], block[BLOCK_SIZE * 4 + i], block[BLOCK_SIZE * 5 + i]);
+            if (frustum.IsInsideFast(BoundingBox(min, max)) == OUTSIDE)
+                outsideMask |= 1u << i;
+        }
+#endif
+
+        numInside += WriteInsideIndices(outsideMask, blockStart, size_, indices + numInside);
+    }
+
+    return numInside;
+}
+
+unsigned BoundingBoxArray::GetInsideFast(const BoundingBox& box, unsigned* indices) const
+{
+    unsigned numInside = 0;
+    const float* block = data_.Buffer();
+
+    for (unsigned blockStart = 0; blockStart < size_; blockStart += BLOCK_SIZE, block += BLOCK_FLOATS)
+    {
+#ifdef URHO3D_SSE
+        __m128 outside = _mm_or_ps(_mm_or_ps(
+            _mm_cmplt_ps(_mm_loadu_ps(block + BLOCK_SIZE * 3), _mm_set1_ps(box.min_.x_)),
+            _mm_cmpgt_ps(_mm_loadu_ps(block), _mm_set1_ps(box.max_.x_))),
+            _mm_or_ps(_mm_or_ps(
+            _mm_cmplt_ps(_mm_loadu_ps(block + BLOCK_SIZE * 4), _mm_set1_ps(box.min_.y_)),
+            _mm_cmpgt_ps(_mm_loadu_ps(block + BLOCK_SIZE), _mm_set1_ps(box.max_.y_))),
+            _mm_or_ps(
+            _mm_cmplt_ps(_mm_loadu_ps(block + BLOCK_SIZE * 5), _mm_set1_ps(box.min_.z_)),
+            _mm_cmpgt_ps(_mm_loadu_ps(block + BLOCK_SIZE * 2), _mm_set1_ps(box.max_.z_)))));
+
+        unsigned outsideMask = (unsigned)_mm_movemask_ps(outside);
+#else
+        unsigned outsideMask = 0;
+        for (unsigned i = 0; i < BLOCK_SIZE; ++i)
+        {
+            Vector3 min(block[i], block[BLOCK_SIZE + i], block[BLOCK_SIZE * 2 + i]);
+            Vector3 max(block[BLOCK_SIZE * 3 + i], block[BLOCK_SIZE * 4 + i], block[BLOCK_SIZE * 5 + i]);
+            if (box.IsInsideFast(BoundingBox(min, max)) == OUTSIDE)
+                outsideMask |= 1u << i;
+        }
+#endif
+
+        numInside += WriteInsideIndices(outsideMask, blockStart, size_, indices + numInside);
+    }
+
+    return numInside;
+}
+
+}
@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2008-2025 the U3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Math/BoundingBox.h"
+
+namespace Urho3D
+{
+
+class Frustum;
+
+/// Bounding boxes stored as a structure of arrays in blocks of four, for testing several boxes at once with SIMD instructions.
+/// @nobind
+class URHO3D_API BoundingBoxArray
+{
+public:
+    /// Number of boxes in one block.
+    static const unsigned BLOCK_SIZE = 4;
+    /// Number of floats in one block: min and max of each axis for every box in the block.
+    static const unsigned BLOCK_FLOATS = BLOCK_SIZE * 6;
+
+    /// Construct empty.
+    BoundingBoxArray() noexcept = default;
+
+    /// Add a box to the end.
+    void Push(const BoundingBox& box)
+    {
+        unsigned index = size_++;
+        if (!(index % BLOCK_SIZE))
+        {
+            // Zero the unused lanes of a new block so that they never hold garbage floats
+            unsigned oldSize = data_.Size();
+            data_.Resize(oldSize + BLOCK_FLOATS);
+            memset(&data_[oldSize], 0, BLOCK_FLOATS * sizeof(float));
+        }
+        Set(index, box);
+    }
+
+    /// Replace the box at index.
+    void Set(unsigned index, const BoundingBox& box)
+    {
+        assert(index < size_);
+        float* block = &data_[index / BLOCK_SIZE * BLOCK_FLOATS] + index % BLOCK_SIZE;
+        block[0] = box.min_.x_;
+        block[BLOCK_SIZE] = box.min_.y_;
+        block[BLOCK_SIZE * 2] = box.min_.z_;
+        block[BLOCK_SIZE * 3] = box.max_.x_;
+        block[BLOCK_SIZE * 4] = box.max_.y_;
+        block[BLOCK_SIZE * 5] = box.max_.z_;
+    }
+
+    /// Remove the box at index by moving the last box in its place.
+    void EraseSwap(unsigned index)
+    {
+        assert(index < size_);
+        unsigned last = size_ - 1;
+        if (index != last)
+            Set(index, Get(last));
+        --size_;
+        if (!(size_ % BLOCK_SIZE))
+            data_.Resize(size_ / BLOCK_SIZE * BLOCK_FLOATS);
+    }
+
+    /// Remove all boxes.
+    void Clear()
+    {
+        data_.Clear();
+        size_ = 0;
+    }
+
+    /// Return the box at index.
+    BoundingBox Get(unsigned index) const
+    {
+        assert(index < size_);
+        const float* block = &data_[index / BLOCK_SIZE * BLOCK_FLOATS] + index % BLOCK_SIZE;
+        return BoundingBox(Vector3(block[0], block[BLOCK_SIZE], block[BLOCK_SIZE * 2]),
+            Vector3(block[BLOCK_SIZE * 3], block[BLOCK_SIZE * 4], block[BLOCK_SIZE * 5]));
+    }
+
+    /// Return number of boxes.
+    unsigned Size() const { return size_; }
+
+    /// Return whether has no boxes.
+    bool Empty() const { return !size_; }
+
+    /// Write the indices of boxes that are (partially) inside the frustum and return their count. Gives the same results as Frustum::IsInsideFast() per box. The index buffer must hold Size() elements.
+    unsigned GetInsideFast(const Frustum& frustum, unsigned* indices) const;
+    /// Write the indices of boxes that are (partially) inside the bounding box and return their count. Gives the same results as BoundingBox::IsInsideFast() per box. The index buffer must hold Size() elements.
+    unsigned GetInsideFast(const BoundingBox& box, unsigned* indices) const;
+
+private:
+    /// Box data in blocks of BLOCK_FLOATS.
+    PODVector<float> data_;
+    /// Number of boxes.
+    unsigned size_{};
+};
+
+}
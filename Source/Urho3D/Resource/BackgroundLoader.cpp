@@ -25,8 +25,11 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../Resource/BackgroundLoader.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
@@ -36,91 +39,181 @@
 namespace Urho3D
 {
 
-BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
-    owner_(owner)
+void BackgroundLoadQueue::Push(BackgroundLoadItem* item)
 {
+    // Find the bucket of the priority, or create it in descending priority order
+    List<Bucket>::Iterator bucket = buckets_.Begin();
+    while (bucket != buckets_.End() && bucket->priority_ > item->priority_)
+        ++bucket;
+    if (bucket == buckets_.End() || bucket->priority_ != item->priority_)
+    {
+        Bucket newBucket;
+        newBucket.priority_ = item->priority_;
+        buckets_.Insert(bucket, newBucket);
+        --bucket;
+    }
+
+    // New items go last. An item with a raised priority may be older than the items already in the bucket
+    List<BackgroundLoadItem*>& items = bucket->items_;
+    List<BackgroundLoadItem*>::Iterator position = items.End();
+    while (position != items.Begin())
+    {
+        List<BackgroundLoadItem*>::Iterator previous = position;
+        --previous;
+        if ((*previous)->order_ < item->order_)
+            break;
+        position = previous;
+    }
+
+    items.Insert(position, item);
+    item->queuePosition_ = --position;
 }
 
-BackgroundLoader::~BackgroundLoader()
+void BackgroundLoadQueue::Remove(BackgroundLoadItem* item)
 {
-    MutexLock lock(backgroundLoadMutex_);
+    for (List<Bucket>::Iterator bucket = buckets_.Begin(); bucket != buckets_.End(); ++bucket)
+    {
+        if (bucket->priority_ == item->priority_)
+        {
+            bucket->items_.Erase(item->queuePosition_);
+            if (bucket->items_.Empty())
+                buckets_.Erase(bucket);
+            return;
+        }
+    }
+}
 
-    backgroundLoadQueue_.Clear();
+BackgroundLoadItem* BackgroundLoadQueue::Take(int minPriority)
+{
+    if (buckets_.Empty() || buckets_.Front().priority_ < minPriority)
+        return nullptr;
+
+    List<BackgroundLoadItem*>& items = buckets_.Front().items_;
+    BackgroundLoadItem* item = items.Front();
+    items.PopFront();
+    if (items.Empty())
+        buckets_.PopFront();
+    return item;
 }
 
-void BackgroundLoader::ThreadFunction()
+unsigned BackgroundLoadSignal::GetCount()
 {
-    URHO3D_PROFILE_THREAD("BackgroundLoader Thread");
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
 
-    while (shouldRun_)
+void BackgroundLoadSignal::Notify(bool all)
+{
     {
-        backgroundLoadMutex_.Acquire();
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++count_;
+    }
 
-        // Search for a queued resource that has not been loaded yet
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-        while (i != backgroundLoadQueue_.End())
-        {
-            if (i->second_.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
-        }
+    if (all)
+        condition_.notify_all();
+    else
+        condition_.notify_one();
+}
 
-        if (i == backgroundLoadQueue_.End())
-        {
-            // No resources to load found
-            backgroundLoadMutex_.Release();
-            Time::Sleep(5);
-        }
-        else
-        {
-            BackgroundLoadItem& item = i->second_;
-            Resource* resource = item.resource_;
-            // We can be sure that the item is not removed from the queue as long as it is in the
-            // "queued" or "loading" state
-            backgroundLoadMutex_.Release();
+void BackgroundLoadSignal::Wait(unsigned count)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this, count] { return count_ != count || released_; });
+}
 
-            bool success = false;
-            SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
-            {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
-            }
+void BackgroundLoadSignal::SetReleased(bool released)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released_ = released;
+    }
 
-            // Process dependencies now
-            // Need to lock the queue again when manipulating other entries
-            Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
-            backgroundLoadMutex_.Acquire();
-            if (item.dependents_.Size())
-            {
-                for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependents_.Begin();
-                     i != item.dependents_.End(); ++i)
-                {
-                    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
-                    if (j != backgroundLoadQueue_.End())
-                        j->second_.dependencies_.Erase(key);
-                }
+    condition_.notify_all();
+}
 
-                item.dependents_.Clear();
-            }
+BackgroundLoaderThread::BackgroundLoaderThread(BackgroundLoader* owner, BackgroundLoadStage stage) :
+    owner_(owner),
+    stage_(stage)
+{
+}
 
-            resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
-            backgroundLoadMutex_.Release();
-        }
+void BackgroundLoaderThread::ThreadFunction()
+{
+    URHO3D_PROFILE_THREAD(stage_ == BLS_QUEUED_IO ? "BackgroundLoader IO Thread" : "BackgroundLoader Decode Thread");
+
+    while (shouldRun_)
+    {
+        // Take the notification count before checking for work, so that work queued in between is not missed
+        unsigned signal = owner_->GetWorkSignal(stage_);
+        if (!owner_->ProcessItem(stage_))
+            owner_->WaitForWork(stage_, signal);
     }
 }
 
-bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller)
+BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
+    owner_(owner),
+    nextOrder_(0),
+    numIOThreads_(1),
+    numDecodeThreads_(Clamp(GetNumPhysicalCPUs() / 2, 1U, 4U))
+{
+}
+
+BackgroundLoader::~BackgroundLoader()
+{
+    StopThreads();
+
+    MutexLock lock(backgroundLoadMutex_);
+
+    ioQueue_.Clear();
+    decodeQueue_.Clear();
+    backgroundLoadQueue_.Clear();
+}
+
+void BackgroundLoader::SetNumThreads(unsigned numIOThreads, unsigned numDecodeThreads)
+{
+    numIOThreads = Max(numIOThreads, 1U);
+    numDecodeThreads = Max(numDecodeThreads, 1U);
+    if (numIOThreads == numIOThreads_ && numDecodeThreads == numDecodeThreads_)
+        return;
+
+    StopThreads();
+
+    MutexLock lock(backgroundLoadMutex_);
+
+    numIOThreads_ = numIOThreads;
+    numDecodeThreads_ = numDecodeThreads;
+    if (backgroundLoadQueue_.Size() && threads_.Empty())
+        StartThreads();
+}
+
+bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller, int priority)
 {
     StringHash nameHash(name);
     Pair<StringHash, StringHash> key = MakePair(type, nameHash);
 
     MutexLock lock(backgroundLoadMutex_);
 
+    // If this is a resource calling for the background load of more resources, the dependency is at least as urgent
+    BackgroundLoadItem* callerItem = nullptr;
+    Pair<StringHash, StringHash> callerKey;
+    if (caller)
+    {
+        callerKey = MakePair(caller->GetType(), caller->GetNameHash());
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(callerKey);
+        if (j != backgroundLoadQueue_.End())
+        {
+            callerItem = &j->second_;
+            priority = Max(priority, callerItem->priority_);
+        }
+    }
+
     // Check if already exists in the queue
-    if (backgroundLoadQueue_.Find(key) != backgroundLoadQueue_.End())
+    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(key);
+    if (i != backgroundLoadQueue_.End())
+    {
+        RaisePriorityInternal(i->second_, priority);
         return false;
+    }
 
     BackgroundLoadItem& item = backgroundLoadQueue_[key];
     item.sendEventOnFailure_ = sendEventOnFailure;
@@ -148,27 +241,38 @@ bool BackgroundLoader::QueueResource(StringHash type, const String& name, bool s
 
     item.resource_->SetName(name);
     item.resource_->SetAsyncLoadState(ASYNC_QUEUED);
-
-    // If this is a resource calling for the background load of more resources, mark the dependency as necessary
-    if (caller)
+    item.priority_ = priority;
+    item.order_ = nextOrder_++;
+    item.stage_ = BLS_QUEUED_IO;
+    ioQueue_.Push(&item);
+    ioSignal_.Notify(false);
+
+    // Mark the dependency as necessary for finishing the caller
+    if (callerItem)
     {
-        Pair<StringHash, StringHash> callerKey = MakePair(caller->GetType(), caller->GetNameHash());
-        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(callerKey);
-        if (j != backgroundLoadQueue_.End())
-        {
-            BackgroundLoadItem& callerItem = j->second_;
-            item.dependents_.Insert(callerKey);
-            callerItem.dependencies_.Insert(key);
-        }
-        else
-            URHO3D_LOGWARNING("Resource " + caller->GetName() +
-                       " requested for a background loaded resource but was not in the background load queue");
+        item.dependents_.Insert(callerKey);
+        callerItem->dependencies_.Insert(key);
     }
+    else if (caller)
+        URHO3D_LOGWARNING("Resource " + caller->GetName() +
+                   " requested for a background loaded resource but was not in the background load queue");
+
+    // Start the background loader threads now
+    if (threads_.Empty())
+        StartThreads();
+
+    return true;
+}
+
+bool BackgroundLoader::RaisePriority(StringHash type, StringHash nameHash, int priority)
+{
+    MutexLock lock(backgroundLoadMutex_);
 
-    // Start the background loader thread now
-    if (!IsStarted())
-        Run();
+    HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(MakePair(type, nameHash));
+    if (i == backgroundLoadQueue_.End())
+        return false;
 
+    RaisePriorityInternal(i->second_, priority);
     return true;
 }
 
@@ -181,6 +285,8 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Find(key);
     if (i != backgroundLoadQueue_.End())
     {
+        // The resource is needed right now, so move it and everything it depends on ahead of the other queued items
+        RaisePriorityInternal(i->second_, M_MAX_INT);
         backgroundLoadMutex_.Release();
 
         {
@@ -190,20 +296,33 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
             for (;;)
             {
-                unsigned numDeps = i->second_.dependencies_.Size();
+                unsigned signal = progressSignal_.GetCount();
+                unsigned numDeps;
+                {
+                    MutexLock lock(backgroundLoadMutex_);
+                    numDeps = i->second_.dependencies_.Size();
+                }
                 AsyncLoadState state = resource->GetAsyncLoadState();
                 if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
                 {
                     didWait = true;
-                    Time::Sleep(1);
+                    // Rather than only wait, load the urgent items the worker threads have not picked up yet
+                    if (!ProcessItem(BLS_QUEUED_DECODE, M_MAX_INT) && !ProcessItem(BLS_QUEUED_IO, M_MAX_INT))
+                        progressSignal_.Wait(signal);
                 }
                 else
                     break;
             }
 
             if (didWait)
-                URHO3D_LOGDEBUG("Waited " + String(waitTimer.GetUSec(false) / 1000) + " ms for background loaded resource " +
+            {
+                long long waitTime = waitTimer.GetUSec(false);
+                URHO3D_LOGDEBUG("Waited " + String(waitTime / 1000) + " ms for background loaded resource " +
                          resource->GetName());
+
+                MutexLock lock(backgroundLoadMutex_);
+                stats_.waitTime_ += waitTime;
+            }
         }
 
         // This may take a long time and may potentially wait on other resources, so it is important we do not hold the mutex during this
@@ -219,37 +338,70 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
 void BackgroundLoader::FinishResources(int maxMs)
 {
-    if (IsStarted())
+    HiresTimer timer;
+
+    backgroundLoadMutex_.Acquire();
+
+    for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
+         i != backgroundLoadQueue_.End();)
     {
-        HiresTimer timer;
+        Resource* resource = i->second_.resource_;
+        unsigned numDeps = i->second_.dependencies_.Size();
+        AsyncLoadState state = resource->GetAsyncLoadState();
+        if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
+            ++i;
+        else
+        {
+            // Finishing a resource may need it to wait for other resources to load, in which case we can not
+            // hold on to the mutex
+            backgroundLoadMutex_.Release();
+            FinishBackgroundLoading(i->second_);
+            backgroundLoadMutex_.Acquire();
+            i = backgroundLoadQueue_.Erase(i);
+        }
 
-        backgroundLoadMutex_.Acquire();
+        // Break when the time limit passed so that we keep sufficient FPS
+        if (timer.GetUSec(false) >= maxMs * 1000LL)
+            break;
+    }
+
+    backgroundLoadMutex_.Release();
+}
+
+bool BackgroundLoader::ProcessItem(BackgroundLoadStage stage, int minPriority)
+{
+    backgroundLoadMutex_.Acquire();
+
+    // We can be sure that the item is not removed from the queue before it has completed the decode stage
+    BackgroundLoadItem* item = (stage == BLS_QUEUED_IO ? ioQueue_ : decodeQueue_).Take(minPriority);
+    if (!item)
+    {
+        backgroundLoadMutex_.Release();
+        return false;
+    }
+
+    item->stage_ = stage == BLS_QUEUED_IO ? BLS_READING : BLS_DECODING;
+    backgroundLoadMutex_.Release();
 
-        for (HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator i = backgroundLoadQueue_.Begin();
-             i != backgroundLoadQueue_.End();)
+    if (stage == BLS_QUEUED_IO)
+    {
+        if (ReadItem(*item))
         {
-            Resource* resource = i->second_.resource_;
-            unsigned numDeps = i->second_.dependencies_.Size();
-            AsyncLoadState state = resource->GetAsyncLoadState();
-            if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
-                ++i;
-            else
             {
-                // Finishing a resource may need it to wait for other resources to load, in which case we can not
-                // hold on to the mutex
-                backgroundLoadMutex_.Release();
-                FinishBackgroundLoading(i->second_);
-                backgroundLoadMutex_.Acquire();
-                i = backgroundLoadQueue_.Erase(i);
+                MutexLock lock(backgroundLoadMutex_);
+                item->stage_ = BLS_QUEUED_DECODE;
+                decodeQueue_.Push(item);
             }
-
-            // Break when the time limit passed so that we keep sufficient FPS
-            if (timer.GetUSec(false) >= maxMs * 1000LL)
-                break;
+            decodeSignal_.Notify(false);
+            progressSignal_.Notify(true);
         }
-
-        backgroundLoadMutex_.Release();
+        else
+            CompleteItem(*item, false);
     }
+    else
+        CompleteItem(*item, DecodeItem(*item));
+
+    return true;
 }
 
 unsigned BackgroundLoader::GetNumQueuedResources() const
@@ -258,11 +410,154 @@ unsigned BackgroundLoader::GetNumQueuedResources() const
     return backgroundLoadQueue_.Size();
 }
 
+BackgroundLoadStats BackgroundLoader::GetStats() const
+{
+    MutexLock lock(backgroundLoadMutex_);
+    return stats_;
+}
+
+void BackgroundLoader::StartThreads()
+{
+    for (unsigned i = 0; i < numIOThreads_ + numDecodeThreads_; ++i)
+    {
+        SharedPtr<BackgroundLoaderThread> thread(new BackgroundLoaderThread(this, i < numIOThreads_ ? BLS_QUEUED_IO :
+            BLS_QUEUED_DECODE));
+        thread->Run();
+        threads_.Push(thread);
+    }
+}
+
+void BackgroundLoader::StopThreads()
+{
+    // The threads need the mutex to finish their current item, so do not hold it while joining them
+    Vector<SharedPtr<BackgroundLoaderThread> > threads;
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        threads.Swap(threads_);
+    }
+
+    // Wake the waiting threads so that they notice being stopped
+    ioSignal_.SetReleased(true);
+    decodeSignal_.SetReleased(true);
+    for (unsigned i = 0; i < threads.Size(); ++i)
+        threads[i]->Stop();
+    ioSignal_.SetReleased(false);
+    decodeSignal_.SetReleased(false);
+}
+
+void BackgroundLoader::RaisePriorityInternal(BackgroundLoadItem& item, int priority)
+{
+    // Priorities only increase, which also ends the recursion
+    if (item.priority_ >= priority)
+        return;
+
+    // Move a queued item to the bucket of its new priority
+    BackgroundLoadQueue* queue = item.stage_ == BLS_QUEUED_IO ? &ioQueue_ : item.stage_ == BLS_QUEUED_DECODE ? &decodeQueue_ : nullptr;
+    if (queue)
+        queue->Remove(&item);
+    item.priority_ = priority;
+    if (queue)
+        queue->Push(&item);
+
+    for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependencies_.Begin(); i != item.dependencies_.End(); ++i)
+    {
+        HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
+        if (j != backgroundLoadQueue_.End())
+            RaisePriorityInternal(j->second_, priority);
+    }
+}
+
+bool BackgroundLoader::ReadItem(BackgroundLoadItem& item)
+{
+    HiresTimer timer;
+    Resource* resource = item.resource_;
+
+    SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
+    if (!file)
+        return false;
+
+    resource->SetAsyncLoadState(ASYNC_LOADING);
+
+    // A memory-mapped file is decoded directly from the mapping. Otherwise read the whole file now so that the decode
+    // threads never block on I/O
+    unsigned size = file->GetSize();
+    bool success = true;
+    if (file->IsMemoryMapped())
+        item.file_ = file;
+    else
+    {
+        item.data_.Resize(size);
+        if (size)
+            success = file->Read(&item.data_[0], size) == size;
+        item.fileName_ = file->GetName();
+    }
+
+    MutexLock lock(backgroundLoadMutex_);
+    stats_.bytesRead_ += size;
+    stats_.readTime_ += timer.GetUSec(false);
+
+    return success;
+}
+
+bool BackgroundLoader::DecodeItem(BackgroundLoadItem& item)
+{
+    HiresTimer timer;
+    bool success;
+
+    if (item.file_)
+    {
+        success = item.resource_->BeginLoad(*item.file_);
+        item.file_.Reset();
+    }
+    else
+    {
+        MemoryBuffer source(item.data_);
+        source.SetName(item.fileName_);
+        success = item.resource_->BeginLoad(source);
+        // Free the file contents right away, the resource may wait a while for its dependencies and EndLoad()
+        item.data_.Clear();
+        item.data_.Compact();
+    }
+
+    MutexLock lock(backgroundLoadMutex_);
+    stats_.decodeTime_ += timer.GetUSec(false);
+
+    return success;
+}
+
+void BackgroundLoader::CompleteItem(BackgroundLoadItem& item, bool success)
+{
+    Resource* resource = item.resource_;
+    Pair<StringHash, StringHash> key = MakePair(resource->GetType(), resource->GetNameHash());
+
+    // Need to lock the queue when manipulating other entries
+    MutexLock lock(backgroundLoadMutex_);
+
+    // Process dependencies now
+    if (item.dependents_.Size())
+    {
+        for (HashSet<Pair<StringHash, StringHash> >::Iterator i = item.dependents_.Begin();
+             i != item.dependents_.End(); ++i)
+        {
+            HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem>::Iterator j = backgroundLoadQueue_.Find(*i);
+            if (j != backgroundLoadQueue_.End())
+                j->second_.dependencies_.Erase(key);
+        }
+
+        item.dependents_.Clear();
+    }
+
+    item.stage_ = BLS_LOADED;
+    resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+    progressSignal_.Notify(true);
+}
+
 void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
 {
     Resource* resource = item.resource_;
 
     bool success = resource->GetAsyncLoadState() == ASYNC_SUCCESS;
+    long long finishTime = 0;
     // If BeginLoad() phase was successful, call EndLoad() and get the final success/failure result
     if (success)
     {
@@ -280,7 +575,9 @@ void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
 #endif
 
         URHO3D_LOGDEBUG("Finishing background loaded resource " + resource->GetName());
+        HiresTimer finishTimer;
         success = resource->EndLoad();
+        finishTime = finishTimer.GetUSec(false);
 
 #ifdef URHO3D_PROFILING
         if (profiler)
@@ -289,6 +586,15 @@ void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
     }
     resource->SetAsyncLoadState(ASYNC_DONE);
 
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        stats_.finishTime_ += finishTime;
+        if (success)
+            ++stats_.numLoaded_;
+        else
+            ++stats_.numFailed_;
+    }
+
     if (!success && item.sendEventOnFailure_)
     {
         using namespace LoadFailed;
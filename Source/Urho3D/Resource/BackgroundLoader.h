@@ -24,17 +24,39 @@
 
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
+#include "../Container/List.h"
 #include "../Core/Mutex.h"
 #include "../Container/Ptr.h"
 #include "../Container/RefCounted.h"
 #include "../Core/Thread.h"
+#include "../IO/File.h"
+#include "../Math/MathDefs.h"
 #include "../Math/StringHash.h"
+#include "../Resource/ResourceCache.h"
+
+#include <condition_variable>
+#include <mutex>
 
 namespace Urho3D
 {
 
+class BackgroundLoader;
 class Resource;
-class ResourceCache;
+
+/// Pipeline stage of a background loaded resource.
+enum BackgroundLoadStage
+{
+    /// Waiting for an I/O thread.
+    BLS_QUEUED_IO = 0,
+    /// File being opened and read.
+    BLS_READING,
+    /// Waiting for a decode thread.
+    BLS_QUEUED_DECODE,
+    /// BeginLoad() in progress.
+    BLS_DECODING,
+    /// BeginLoad() finished, waiting for dependencies and EndLoad() in the main thread.
+    BLS_LOADED
+};
 
 /// Queue item for background loading of a resource.
 struct BackgroundLoadItem
@@ -45,35 +67,146 @@ struct BackgroundLoadItem
     HashSet<Pair<StringHash, StringHash> > dependencies_;
     /// Resources that depend on this resource's loading.
     HashSet<Pair<StringHash, StringHash> > dependents_;
+    /// Memory-mapped source file, which the decode stage reads directly.
+    SharedPtr<File> file_;
+    /// Source file contents read by the I/O stage.
+    PODVector<unsigned char> data_;
+    /// Source file name.
+    String fileName_;
+    /// Priority. Higher priority items are processed first in both stages.
+    int priority_{};
+    /// Queue order for processing equal priority items first in, first out.
+    unsigned order_{};
+    /// Position in the priority bucket of the stage queue while waiting for a stage.
+    List<BackgroundLoadItem*>::Iterator queuePosition_;
+    /// Pipeline stage.
+    BackgroundLoadStage stage_{BLS_QUEUED_IO};
     /// Whether to send failure event.
-    bool sendEventOnFailure_;
+    bool sendEventOnFailure_{};
 };
 
-/// Background loader of resources. Owned by the ResourceCache.
+/// Queue of items waiting for a pipeline stage, bucketed by priority. Items of equal priority are taken in queue order.
 /// @nobind
-class BackgroundLoader : public RefCounted, public Thread
+class BackgroundLoadQueue
+{
+public:
+    /// Add an item to the bucket of its priority.
+    void Push(BackgroundLoadItem* item);
+    /// Remove a queued item.
+    void Remove(BackgroundLoadItem* item);
+    /// Remove and return the first item of the highest priority, or null if none has at least the minimum priority.
+    BackgroundLoadItem* Take(int minPriority);
+    /// Remove all items.
+    void Clear() { buckets_.Clear(); }
+
+private:
+    /// Items of one priority.
+    struct Bucket
+    {
+        /// Priority.
+        int priority_;
+        /// Items in queue order.
+        List<BackgroundLoadItem*> items_;
+    };
+
+    /// Non-empty buckets in descending priority order.
+    List<Bucket> buckets_;
+};
+
+/// Notification that threads can wait on without missing notifications sent between checking for work and starting to wait.
+/// @nobind
+struct BackgroundLoadSignal
+{
+    /// Return the notification count to pass to Wait().
+    unsigned GetCount();
+    /// Wake waiting threads.
+    void Notify(bool all);
+    /// Wait until notified after the count was taken, or until released.
+    void Wait(unsigned count);
+    /// Set whether waiting returns immediately, used to stop the threads.
+    void SetReleased(bool released);
+
+    /// Mutex for the count and the released flag.
+    std::mutex mutex_;
+    /// Condition variable for waiting.
+    std::condition_variable condition_;
+    /// Notification count.
+    unsigned count_{};
+    /// Released flag.
+    bool released_{};
+};
+
+/// Worker thread of the background loader, serving either the I/O or the decode stage.
+/// @nobind
+class BackgroundLoaderThread : public RefCounted, public Thread
+{
+public:
+    /// Construct.
+    BackgroundLoaderThread(BackgroundLoader* owner, BackgroundLoadStage stage);
+
+    /// Process queued items of the stage until stopped.
+    void ThreadFunction() override;
+
+private:
+    /// Background loader.
+    BackgroundLoader* owner_;
+    /// Served stage, either BLS_QUEUED_IO or BLS_QUEUED_DECODE.
+    BackgroundLoadStage stage_;
+};
+
+/// Background loader of resources. Owned by the ResourceCache. Files are read by a pool of I/O threads, after which a
+/// pool of decode threads calls BeginLoad() on the resources.
+/// @nobind
+class BackgroundLoader : public RefCounted
 {
 public:
     /// Construct.
     explicit BackgroundLoader(ResourceCache* owner);
 
-    /// Destruct. Forcibly clear the load queue.
+    /// Destruct. Stop the threads and forcibly clear the load queue.
     ~BackgroundLoader() override;
 
-    /// Resource background loading loop.
-    void ThreadFunction() override;
-
-    /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
-    bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller);
-    /// Wait and finish possible loading of a resource when being requested from the cache.
+    /// Set number of I/O and decode threads. Threads are (re)started on the next queued resource.
+    void SetNumThreads(unsigned numIOThreads, unsigned numDecodeThreads);
+    /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type). If already queued, raise the priority if the new one is higher.
+    bool QueueResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller, int priority);
+    /// Raise the priority of a queued resource and the resources it depends on. Return true if the resource was in the queue.
+    bool RaisePriority(StringHash type, StringHash nameHash, int priority);
+    /// Wait and finish possible loading of a resource when being requested from the cache. Raises the resource to the highest priority and helps loading it in the calling thread.
     void WaitForResource(StringHash type, StringHash nameHash);
     /// Process resources that are ready to finish.
     void FinishResources(int maxMs);
+    /// Process the highest priority item queued for a stage. Called by the worker threads. Return false if there was nothing to process.
+    bool ProcessItem(BackgroundLoadStage stage, int minPriority = M_MIN_INT);
+    /// Return the work notification count of a stage, to be taken before checking for work.
+    unsigned GetWorkSignal(BackgroundLoadStage stage) { return GetStageSignal(stage).GetCount(); }
+    /// Block until work is queued for a stage after the notification count was taken, or the threads are stopped.
+    void WaitForWork(BackgroundLoadStage stage, unsigned signal) { GetStageSignal(stage).Wait(signal); }
 
     /// Return amount of resources in the load queue.
     unsigned GetNumQueuedResources() const;
+    /// Return number of I/O threads.
+    unsigned GetNumIOThreads() const { return numIOThreads_; }
+    /// Return number of decode threads.
+    unsigned GetNumDecodeThreads() const { return numDecodeThreads_; }
+    /// Return throughput counters.
+    BackgroundLoadStats GetStats() const;
 
 private:
+    /// Start the worker threads.
+    void StartThreads();
+    /// Stop the worker threads. They finish the item in progress first.
+    void StopThreads();
+    /// Raise priority recursively. Must be called with the mutex held.
+    void RaisePriorityInternal(BackgroundLoadItem& item, int priority);
+    /// Return the work notification of a stage.
+    BackgroundLoadSignal& GetStageSignal(BackgroundLoadStage stage) { return stage == BLS_QUEUED_IO ? ioSignal_ : decodeSignal_; }
+    /// Open and read the source file of an item. Return true on success.
+    bool ReadItem(BackgroundLoadItem& item);
+    /// Call BeginLoad() on an item. Return true on success.
+    bool DecodeItem(BackgroundLoadItem& item);
+    /// Mark an item loaded after the decode stage or a failure and release its dependents.
+    void CompleteItem(BackgroundLoadItem& item, bool success);
     /// Finish one background loaded resource.
     void FinishBackgroundLoading(BackgroundLoadItem& item);
 
@@ -83,6 +216,26 @@ private:
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
     HashMap<Pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Items waiting for the I/O stage.
+    BackgroundLoadQueue ioQueue_;
+    /// Items waiting for the decode stage.
+    BackgroundLoadQueue decodeQueue_;
+    /// Notification of items queued for the I/O stage.
+    BackgroundLoadSignal ioSignal_;
+    /// Notification of items queued for the decode stage.
+    BackgroundLoadSignal decodeSignal_;
+    /// Notification of items moving to the decode stage or completing, for threads waiting for a resource.
+    BackgroundLoadSignal progressSignal_;
+    /// Worker threads.
+    Vector<SharedPtr<BackgroundLoaderThread> > threads_;
+    /// Throughput counters.
+    BackgroundLoadStats stats_;
+    /// Next queue order number.
+    unsigned nextOrder_;
+    /// Number of I/O threads.
+    unsigned numIOThreads_;
+    /// Number of decode threads.
+    unsigned numDecodeThreads_;
 };
 
 }
@@ -787,17 +787,22 @@ bool Image::BeginLoad(Deserializer& source)
             return false;
         }
 
-        // Read the file to buffer.
+        // Decode in place if the source is in memory, otherwise read the file to buffer.
         size_t dataSize(source.GetSize());
-        SharedArrayPtr<uint8_t> data(new uint8_t[dataSize]);
-
-        memset(data.Get(), 0, sizeof(uint8_t) * dataSize);
         source.Seek(0);
-        source.Read(data.Get(), dataSize);
+        const uint8_t* data = source.ReadInPlace(dataSize);
+        SharedArrayPtr<uint8_t> buffer;
+        if (!data)
+        {
+            buffer = new uint8_t[dataSize];
+            memset(buffer.Get(), 0, sizeof(uint8_t) * dataSize);
+            source.Read(buffer.Get(), dataSize);
+            data = buffer.Get();
+        }
 
         WebPBitstreamFeatures features;
 
-        if (WebPGetFeatures(data.Get(), dataSize, &features) != VP8_STATUS_OK)
+        if (WebPGetFeatures(data, dataSize, &features) != VP8_STATUS_OK)
         {
             URHO3D_LOGERROR("Error reading WebP image: " + source.GetName());
             return false;
@@ -809,11 +814,11 @@ bool Image::BeginLoad(Deserializer& source)
         bool decodeError(false);
         if (features.has_alpha)
         {
-            decodeError = WebPDecodeRGBAInto(data.Get(), dataSize, pixelData.Get(), imgSize, 4 * features.width) == nullptr;
+            decodeError = WebPDecodeRGBAInto(data, dataSize, pixelData.Get(), imgSize, 4 * features.width) == nullptr;
         }
         else
         {
-            decodeError = WebPDecodeRGBInto(data.Get(), dataSize, pixelData.Get(), imgSize, 3 * features.width) == nullptr;
+            decodeError = WebPDecodeRGBInto(data, dataSize, pixelData.Get(), imgSize, 3 * features.width) == nullptr;
         }
         if (decodeError)
         {
@@ -2340,9 +2345,17 @@ unsigned char* Image::GetImageData(Deserializer& source, int& width, int& height
 {
     unsigned dataSize = source.GetSize();
 
-    SharedArrayPtr<unsigned char> buffer(new unsigned char[dataSize]);
-    source.Read(buffer.Get(), dataSize);
-    return stbi_load_from_memory(buffer.Get(), dataSize, &width, &height, (int*)&components, 0);
+    // Decode in place if the source is in memory, for example a memory-mapped file
+    const unsigned char* data = source.ReadInPlace(dataSize);
+    SharedArrayPtr<unsigned char> buffer;
+    if (!data)
+    {
+        buffer = new unsigned char[dataSize];
+        source.Read(buffer.Get(), dataSize);
+        data = buffer.Get();
+    }
+
+    return stbi_load_from_memory(data, dataSize, &width, &height, (int*)&components, 0);
 }
 
 void Image::FreeImageData(unsigned char* pixelData)
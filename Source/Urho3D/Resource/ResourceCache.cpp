@@ -79,7 +79,7 @@ ResourceCache::ResourceCache(Context* context) :
     RegisterResourceLibrary(context_);
 
 #ifdef URHO3D_THREADING
-    // Create resource background loader. Its thread will start on the first background request
+    // Create resource background loader. Its threads will start on the first background request
     backgroundLoader_ = new BackgroundLoader(this);
 #endif
 
@@ -635,7 +635,7 @@ Resource* ResourceCache::GetResource(StringHash type, const String& name, bool s
     return resource;
 }
 
-bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller)
+bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure, Resource* caller, int priority)
 {
 #ifdef URHO3D_THREADING
     // If empty name, fail immediately
@@ -648,7 +648,7 @@ bool ResourceCache::BackgroundLoadResource(StringHash type, const String& name,
     if (FindResource(type, nameHash) != noResource)
         return false;
 
-    return backgroundLoader_->QueueResource(type, sanitatedName, sendEventOnFailure, caller);
+    return backgroundLoader_->QueueResource(type, sanitatedName, sendEventOnFailure, caller, priority);
 #else
     // When threading not supported, fall back to synchronous loading
     return GetResource(type, name, sendEventOnFailure);
@@ -708,6 +708,22 @@ SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const String
     return resource;
 }
 
+bool ResourceCache::SetBackgroundLoadPriority(StringHash type, const String& name, int priority)
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->RaisePriority(type, StringHash(SanitateResourceName(name)), priority);
+#else
+    return false;
+#endif
+}
+
+void ResourceCache::SetBackgroundLoadThreads(unsigned numIOThreads, unsigned numDecodeThreads)
+{
+#ifdef URHO3D_THREADING
+    backgroundLoader_->SetNumThreads(numIOThreads, numDecodeThreads);
+#endif
+}
+
 unsigned ResourceCache::GetNumBackgroundLoadResources() const
 {
 #ifdef URHO3D_THREADING
@@ -717,6 +733,33 @@ unsigned ResourceCache::GetNumBackgroundLoadResources() const
 #endif
 }
 
+unsigned ResourceCache::GetNumBackgroundLoadIOThreads() const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->GetNumIOThreads();
+#else
+    return 0;
+#endif
+}
+
+unsigned ResourceCache::GetNumBackgroundLoadDecodeThreads() const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->GetNumDecodeThreads();
+#else
+    return 0;
+#endif
+}
+
+BackgroundLoadStats ResourceCache::GetBackgroundLoadStats() const
+{
+#ifdef URHO3D_THREADING
+    return backgroundLoader_->GetStats();
+#else
+    return BackgroundLoadStats();
+#endif
+}
+
 void ResourceCache::GetResources(PODVector<Resource*>& result, StringHash type) const
 {
     result.Clear();
@@ -1095,6 +1138,7 @@ void ResourceCache::HandleBeginFrame(StringHash eventType, VariantMap& eventData
         URHO3D_PROFILE(FinishBackgroundResources);
         backgroundLoader_->FinishResources(finishBackgroundResourcesMs_);
     }
+    URHO3D_PROFILE_VALUE("BackgroundLoadQueued", backgroundLoader_->GetNumQueuedResources());
 #endif
 }
 
@@ -58,6 +58,25 @@ struct ResourceGroup
     HashMap<StringHash, SharedPtr<Resource> > resources_;
 };
 
+/// Background resource loading throughput counters, accumulated since the resource cache was created.
+struct BackgroundLoadStats
+{
+    /// Number of resources that finished loading successfully.
+    unsigned numLoaded_{};
+    /// Number of resources that failed to load.
+    unsigned numFailed_{};
+    /// Bytes read by the I/O stage.
+    unsigned long long bytesRead_{};
+    /// Time spent opening and reading files in microseconds, summed over threads.
+    long long readTime_{};
+    /// Time spent in BeginLoad() in microseconds, summed over threads.
+    long long decodeTime_{};
+    /// Time spent in EndLoad() in the main thread in microseconds.
+    long long finishTime_{};
+    /// Time the main thread spent waiting for background loaded resources in microseconds.
+    long long waitTime_{};
+};
+
 /// Resource request types.
 enum ResourceRequest
 {
@@ -136,6 +155,8 @@ public:
     /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources.
     /// @property
     void SetFinishBackgroundResourcesMs(int ms) { finishBackgroundResourcesMs_ = Max(ms, 1); }
+    /// Set number of background loading threads for reading files and for decoding them with BeginLoad(). Both are at least 1.
+    void SetBackgroundLoadThreads(unsigned numIOThreads, unsigned numDecodeThreads);
 
     /// Add a resource router object. By default there is none, so the routing process is skipped.
     void AddResourceRouter(ResourceRouter* router, bool addAsFirst = false);
@@ -148,11 +169,19 @@ public:
     Resource* GetResource(StringHash type, const String& name, bool sendEventOnFailure = true);
     /// Load a resource without storing it in the resource cache. Return null if not found or if fails. Can be called from outside the main thread if the resource itself is safe to load completely (it does not possess for example GPU data).
     SharedPtr<Resource> GetTempResource(StringHash type, const String& name, bool sendEventOnFailure = true);
-    /// Background load a resource. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Can be called from outside the main thread.
-    bool BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure = true, Resource* caller = nullptr);
+    /// Background load a resource. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Higher priority resources are loaded first; resources requested by a caller inherit its priority. Can be called from outside the main thread.
+    bool BackgroundLoadResource(StringHash type, const String& name, bool sendEventOnFailure = true, Resource* caller = nullptr, int priority = 0);
+    /// Raise the priority of a background-loaded resource and the resources it depends on. Return true if the resource is in the load queue.
+    bool SetBackgroundLoadPriority(StringHash type, const String& name, int priority);
     /// Return number of pending background-loaded resources.
     /// @property
     unsigned GetNumBackgroundLoadResources() const;
+    /// Return number of background loading threads reading files.
+    unsigned GetNumBackgroundLoadIOThreads() const;
+    /// Return number of background loading threads decoding resources.
+    unsigned GetNumBackgroundLoadDecodeThreads() const;
+    /// Return background loading throughput counters.
+    BackgroundLoadStats GetBackgroundLoadStats() const;
     /// Return all loaded resources of a specific type.
     void GetResources(PODVector<Resource*>& result, StringHash type) const;
     /// Return an already loaded resource of specific type & name, or null if not found. Will not load if does not exist.
@@ -178,7 +207,7 @@ public:
     /// Template version of releasing a resource by name.
     template <class T> void ReleaseResource(const String& name, bool force = false);
     /// Template version of queueing a resource background load.
-    template <class T> bool BackgroundLoadResource(const String& name, bool sendEventOnFailure = true, Resource* caller = nullptr);
+    template <class T> bool BackgroundLoadResource(const String& name, bool sendEventOnFailure = true, Resource* caller = nullptr, int priority = 0);
     /// Template version of returning loaded resources of a specific type.
     template <class T> void GetResources(PODVector<T*>& result) const;
     /// Return whether a file exists in the resource directories or package files. Does not check manually added in-memory resources.
@@ -296,10 +325,10 @@ template <class T> SharedPtr<T> ResourceCache::GetTempResource(const String& nam
     return StaticCast<T>(GetTempResource(type, name, sendEventOnFailure));
 }
 
-template <class T> bool ResourceCache::BackgroundLoadResource(const String& name, bool sendEventOnFailure, Resource* caller)
+template <class T> bool ResourceCache::BackgroundLoadResource(const String& name, bool sendEventOnFailure, Resource* caller, int priority)
 {
     StringHash type = T::GetTypeStatic();
-    return BackgroundLoadResource(type, name, sendEventOnFailure, caller);
+    return BackgroundLoadResource(type, name, sendEventOnFailure, caller, priority);
 }
 
 template <class T> void ResourceCache::GetResources(PODVector<T*>& result) const
@@ -30,6 +30,9 @@
 namespace Urho3D
 {
 
+struct SceneUpdateEventData;
+struct ScenePostUpdateEventData;
+
 enum UpdateEvent : unsigned
 {
     /// Bitmask for not using any events.
@@ -95,9 +98,9 @@ private:
     /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
     void UpdateEventSubscription();
     /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleSceneUpdate(const SceneUpdateEventData& event);
     /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleScenePostUpdate(const ScenePostUpdateEventData& event);
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
     /// Handle physics pre-step event.
     void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
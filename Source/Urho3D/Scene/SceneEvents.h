@@ -27,6 +27,8 @@
 namespace Urho3D
 {
 
+class Scene;
+
 /// Variable timestep scene update.
 URHO3D_EVENT(E_SCENEUPDATE, SceneUpdate)
 {
@@ -34,6 +36,20 @@ URHO3D_EVENT(E_SCENEUPDATE, SceneUpdate)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Typed event data of the variable timestep scene update.
+struct URHO3D_API SceneUpdateEventData
+{
+    /// Return event type.
+    static StringHash GetEventTypeStatic() { return E_SCENEUPDATE; }
+    /// Convert to event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const;
+
+    /// Scene.
+    Scene* scene_;
+    /// Timestep in seconds, scaled by the scene's time scale.
+    float timeStep_;
+};
+
 /// Scene subsystem update.
 URHO3D_EVENT(E_SCENESUBSYSTEMUPDATE, SceneSubsystemUpdate)
 {
@@ -93,6 +109,20 @@ URHO3D_EVENT(E_SCENEPOSTUPDATE, ScenePostUpdate)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Typed event data of the variable timestep scene post-update.
+struct URHO3D_API ScenePostUpdateEventData
+{
+    /// Return event type.
+    static StringHash GetEventTypeStatic() { return E_SCENEPOSTUPDATE; }
+    /// Convert to event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const;
+
+    /// Scene.
+    Scene* scene_;
+    /// Timestep in seconds, scaled by the scene's time scale.
+    float timeStep_;
+};
+
 /// Asynchronous scene loading progress.
 URHO3D_EVENT(E_ASYNCLOADPROGRESS, AsyncLoadProgress)
 {
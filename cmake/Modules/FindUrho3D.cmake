@@ -37,6 +37,7 @@
 #  URHO3D_64BIT (may be used as input variable for multilib-capable compilers; must always be specified as input variable for MSVC due to CMake/VS generator limitation)
 #  URHO3D_LIB_TYPE (may be used as input variable as well to limit the search of library type)
 #  URHO3D_OPENGL
+#  URHO3D_NULL_GRAPHICS
 #  URHO3D_SSE
 #  URHO3D_DATABASE_ODBC
 #  URHO3D_DATABASE_SQLITE
@@ -324,7 +325,7 @@ else ()
         endif ()
 
         set (AUTO_DISCOVER_VARS
-            URHO3D_STATIC_DEFINE URHO3D_OPENGL URHO3D_D3D11 URHO3D_SSE URHO3D_DATABASE_ODBC 
+            URHO3D_STATIC_DEFINE URHO3D_OPENGL URHO3D_D3D11 URHO3D_NULL_GRAPHICS URHO3D_SSE URHO3D_DATABASE_ODBC 
             URHO3D_DATABASE_SQLITE URHO3D_LUAJIT URHO3D_TESTING CLANG_PRE_STANDARD URHO3D_STATIC_RUNTIME 
             URHO3D_SPINE WAYLAND_CLIENT
         )
@@ -252,6 +252,8 @@ if (IS_URHO3D)
     # On Windows platform Direct3D11 can be optionally chosen
     # Using Direct3D11 on non-MSVC compiler may require copying and renaming Microsoft official libraries (.lib to .a), else link failures or non-functioning graphics may result
     cmake_dependent_option (URHO3D_D3D11 "Use Direct3D11 instead of Direct3D9 (Windows platform only); overrides URHO3D_OPENGL option" FALSE "WIN32" FALSE)
+    # The null graphics backend accepts all rendering calls without a GPU device, so that Renderer and View can run in headless mode for tests and benchmarks
+    option (URHO3D_NULL_GRAPHICS "Use the null (CPU-only) graphics backend instead of a real graphics API; overrides URHO3D_OPENGL and URHO3D_D3D11 options" FALSE)
     if (X86 OR E2K OR WEB)
         # TODO: Rename URHO3D_SSE to URHO3D_SIMD
         if (MINGW AND CMAKE_CXX_COMPILER_VERSION VERSION_LESS 4.9.1)
@@ -466,6 +468,12 @@ if (URHO3D_D3D11)
     set (URHO3D_OPENGL 0)
     unset (URHO3D_OPENGL CACHE)
 endif ()
+if (URHO3D_NULL_GRAPHICS)
+    set (URHO3D_OPENGL 0)
+    unset (URHO3D_OPENGL CACHE)
+    set (URHO3D_D3D11 0)
+    unset (URHO3D_D3D11 CACHE)
+endif ()
 if (URHO3D_DATABASE_ODBC)
     set (URHO3D_DATABASE_SQLITE 0)
     unset (URHO3D_DATABASE_SQLITE CACHE)
@@ -566,7 +574,7 @@ endforeach ()
 if (WIN32 AND NOT CMAKE_PROJECT_NAME MATCHES ^Urho3D-ExternalProject-)
     set (DIRECTX_REQUIRED_COMPONENTS)
     set (DIRECTX_OPTIONAL_COMPONENTS DInput DSound XInput)
-    if (NOT URHO3D_OPENGL)
+    if (NOT URHO3D_OPENGL AND NOT URHO3D_NULL_GRAPHICS)
         if (URHO3D_D3D11)
             list (APPEND DIRECTX_REQUIRED_COMPONENTS D3D11)
         else ()